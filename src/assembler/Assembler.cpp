@@ -3171,7 +3171,7 @@ void Assembler::TrimWhiteSpace(char *pszSourceLine)
 
     // Keep shifting left, while left most character is white space...
     while(IsCharacterWhiteSpace(pszSourceLine[0]))
-        strcpy(pszSourceLine, pszSourceLine + 1);
+        memmove(pszSourceLine, pszSourceLine + 1, strlen(pszSourceLine));
 
     // Check if new line is at the end...
     bNewLineTerminated = pszSourceLine[strlen(pszSourceLine) - 1] == '\n';
@@ -3273,7 +3273,7 @@ void Assembler::WriteExecutable()
 
         // Initialize signature...
         memset(szBuffer, '\x90', sizeof(szBuffer));
-        strncpy(&szBuffer[2], "AGNI", strlen("AGNI"));
+        memcpy(&szBuffer[2], "AGNI", strlen("AGNI"));
         memcpy(&MainHeader.Signature, szBuffer, sizeof(MainHeader.Signature));
 
         // Major and minor assemble / compile time Agni version...
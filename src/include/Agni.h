@@ -13,6 +13,14 @@
 
 // Includes...
 
+    // Build options that change the layout of what follows, generated by the
+    //  build so hosts see the same layout as the library. Only a build passing
+    //  every such option to the library and its hosts alike, as the layout
+    //  benchmark does, goes without...
+    #if !defined(AGNI_NO_CONFIG_HEADER)
+    #include "AgniConfig.h"
+    #endif
+
     // Data types...
     #include "AgniPlatformSpecific.h"
 
@@ -28,13 +36,28 @@
     // String manipulation...
     #include <cstring>
 
+    // Character classification and case folding...
+    #include <cctype>
+
     // Exponentiation, trigonometric, and other miscellaneous math routines...
     #include <cmath>
 
+    // Structure member offsets...
+    #include <cstddef>
+
+    // Worker threads...
+    #if defined(AGNI_WORKER_THREADS)
+    #include <pthread.h>
+    #endif
+
 // Within the Agni namespace...
 namespace Agni
 {
-    // Virtual machine class definition...
+    // Virtual machine class definition. Every script slot is held within it,
+    //  MAXIMUM_THREADS of them, so a machine takes 600 to 700 KB on 64-bit
+    //  platforms, depending on the build's options, before it loads anything,
+    //  and is best created statically or on the heap rather than on a
+    //  thread's stack...
     class VirtualMachine
     {
         // Public macros and data types...
@@ -63,21 +86,268 @@ namespace Agni
                 SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW
             };
 
+            // Instruction dispatch engines...
+            enum DispatchEngine
+            {
+                // Whichever engine the library was built to default to...
+                Dispatch_Default = 0,
+
+                // Decode and execute one instruction at a time via switch...
+                Dispatch_Switch,
+
+                // Pre-decoded threaded code...
+                Dispatch_Threaded,
+
+                // Threaded code translated to move values between frame slots
+                //  and registers directly, rather than through the stack...
+                Dispatch_Register,
+
+                // Native code compiled at load time, with the switch engine
+                //  interpreting whatever could not be compiled. Only offered
+                //  where the library can generate it...
+                #if defined(AGNI_NATIVE_CODE)
+                Dispatch_Native
+                #endif
+            };
+
+            // Tiers a function's threaded code is promoted through as it
+            //  gets hot...
+            enum ExecutionTier
+            {
+                // Run by generic handlers...
+                Tier_Interpreted = 0,
+
+                // Quickened into handlers specialized on operand kinds...
+                Tier_Quickened,
+
+                // Quickened and fused into superinstructions, or prepared up
+                //  front by an engine that does not tier...
+                Tier_Optimized
+            };
+
+            // Default hotness, in invocations plus backward branches taken,
+            //  at which a function is promoted to each tier...
+            #define DEFAULT_QUICKEN_THRESHOLD   2
+            #define DEFAULT_OPTIMIZE_THRESHOLD  64
+
+            // Function's hotness and the tier it has been promoted to...
+            typedef struct _FunctionProfile
+            {
+                // Times invoked...
+                uint32          unInvocations;
+
+                // Backward branches taken within it...
+                uint32          unBackwardBranches;
+
+                // Tier...
+                ExecutionTier   Tier;
+
+            }FunctionProfile;
+
+            // String interning table's effectiveness and footprint so far...
+            typedef struct _InternStatistics
+            {
+                // Strings looked up, from literals as scripts load and from
+                //  host functions returning them...
+                uint32          unLookups;
+
+                // Lookups that found the string already interned...
+                uint32          unHits;
+
+                // Strings interned now...
+                uint32          unStrings;
+
+                // Bytes the table and the strings interned now occupy...
+                uint32          unBytes;
+
+            }InternStatistics;
+
             // Script handle...
             typedef uint32 Script;
 
+            // Resolved script function handle, valid until its script is
+            //  unloaded, and refused once it is even if another script is
+            //  loaded in its place...
+            typedef int32 Function;
+
+            // Function handle that did not resolve...
+            #define INVALID_FUNCTION -1
+
+            // Workers to run scripts in parallel on when one per core is
+            //  wanted, and the most there can be...
+            #define AUTOMATIC_WORKERS   0
+            #define MAXIMUM_WORKERS     64
+
             // Host provided function signature...
             typedef void (HostProvidedFunction)(Script hScript);
 
             // Global host function flag...
             #define GLOBAL_HOST_FUNCTION -1
 
+            // How a precompiled script's body left off running a thread...
+            enum PrecompiledStatus
+            {
+                // At a safe point, with the instruction pointer stored...
+                Precompiled_SafePoint = 0,
+
+                // At the stack base...
+                Precompiled_StackBase,
+
+                // At an instruction it left to the interpreter...
+                Precompiled_Interpret
+            };
+
+            // Context a precompiled script's body runs a thread through...
+            class PrecompiledContext;
+
+            // Precompiled script's body, translated ahead of time from its
+            //  executable, which runs a thread from its instruction pointer
+            //  up to its next safe point...
+            typedef PrecompiledStatus (*PrecompiledBody)(
+                PrecompiledContext &Context);
+
+            // Precompiled script, as generated by the translator...
+            typedef struct _PrecompiledScript
+            {
+                // Executable it was translated from, still loaded for its
+                //  tables and literals...
+                const uint8        *pImage;
+                uint32              unImageSize;
+
+                // Body...
+                PrecompiledBody     pBody;
+
+            }PrecompiledScript;
+
+            // Tag of an allocation made for no script in particular...
+            #define UNTAGGED_ALLOCATION ((Script) -1)
+
+            // Alignment the virtual machine requests its allocations at...
+            #define ALLOCATION_ALIGNMENT    16
+
+            // Interface a host can implement to supply every byte the virtual
+            //  machine allocates, such as from its own pools or against a
+            //  memory budget. Each allocation is tagged with the script it is
+            //  made for, or UNTAGGED_ALLOCATION, which an implementation is
+            //  free to ignore...
+            class Allocator
+            {
+                // Public methods...
+                public:
+
+                    // Allocate a block of at least the given size, at the
+                    //  given alignment, a power of two, or NULL if out of
+                    //  memory...
+                    virtual void *Allocate(size_t Size, size_t Alignment,
+                                           Script hTag) = 0;
+
+                    // Resize a block, moving it if need be, or NULL if out of
+                    //  memory, leaving it as it was...
+                    virtual void *Reallocate(void *pBlock, size_t OldSize,
+                                             size_t Size, size_t Alignment,
+                                             Script hTag) = 0;
+
+                    // Free a block, given the size, alignment, and tag it was
+                    //  allocated with...
+                    virtual void Free(void *pBlock, size_t Size,
+                                      size_t Alignment, Script hTag) = 0;
+
+                    // Deconstructor...
+                    virtual ~Allocator() {}
+            };
+
+            // Default allocator's smallest size class, as a power of two
+            //  bytes, and how many classes there are, each twice the size of
+            //  the last...
+            #define SLAB_SMALLEST_CLASS_SHIFT   4
+            #define SLAB_SIZE_CLASSES           13
+
+            // Bytes of blocks carved from each slab, but never fewer blocks
+            //  than the minimum...
+            #define SLAB_SIZE                   65536
+            #define SLAB_MINIMUM_BLOCKS         4
+
+            // Greatest alignment blocks are carved at, beyond which a request
+            //  is served by the system allocator instead...
+            #define SLAB_MAXIMUM_ALIGNMENT      4096
+
+            // Bits of a free list head holding the address of its first
+            //  block, above which it counts the blocks popped from it...
+            #define SLAB_POINTER_BITS           48
+
+            // Default allocator, which carves blocks of power of two size
+            //  classes from slabs obtained from the system allocator, keeping
+            //  them once freed on a lock-free free list per class. Slabs are
+            //  only given back when it is destroyed...
+            class SlabAllocator : public Allocator
+            {
+                // Public methods...
+                public:
+
+                    // Constructor...
+                    SlabAllocator();
+
+                    // Allocate a block, or NULL if out of memory...
+                    void *Allocate(size_t Size, size_t Alignment, Script hTag);
+
+                    // Resize a block, or NULL if out of memory...
+                    void *Reallocate(void *pBlock, size_t OldSize, size_t Size,
+                                     size_t Alignment, Script hTag);
+
+                    // Free a block...
+                    void Free(void *pBlock, size_t Size, size_t Alignment,
+                              Script hTag);
+
+                    // Get the bytes obtained from the system allocator...
+                    size_t GetBytesReserved() const;
+
+                    // Deconstructor gives back every slab...
+                   ~SlabAllocator();
+
+                // Protected methods...
+                protected:
+
+                    // Size class a block of the given size and alignment is
+                    //  carved from, or SLAB_SIZE_CLASSES if none...
+                    static uint32 SizeClass(size_t Size, size_t Alignment);
+
+                    // Push a chain of blocks onto a free list...
+                    void PushBlocks(uint32 unClass, void *pFirst, void *pLast);
+
+                    // Carve a new slab into a class's free list, or return
+                    //  false if out of memory...
+                    bool Refill(uint32 unClass);
+
+                // Protected attributes...
+                protected:
+
+                    // Head of each class's free list, its first block's
+                    //  address counted against the pops so far, so that a
+                    //  block popped and pushed back meanwhile is not mistaken
+                    //  for an unchanged list...
+                    volatile unsigned long long FreeBlocks[SLAB_SIZE_CLASSES];
+
+                    // Address of the newest slab, each linking the one
+                    //  before...
+                    volatile unsigned long long Slabs;
+
+                    // Bytes obtained from the system allocator...
+                    volatile unsigned long long BytesReserved;
+            };
+
         // Public API methods...
         public:
 
             // Constructor initializes runtime enviroment...
             VirtualMachine(char *_pszHostName, uint8 _HostVersionMajor,
-                           uint8 _HostVersionMinor);
+                           uint8 _HostVersionMinor,
+                           DispatchEngine _Engine = Dispatch_Default,
+                           uint32 _unQuickenThreshold =
+                            DEFAULT_QUICKEN_THRESHOLD,
+                           uint32 _unOptimizeThreshold =
+                            DEFAULT_OPTIMIZE_THRESHOLD,
+                           boolean _bInternStrings = false,
+                           Allocator *_pAllocator = NULL);
 
             // Script function calling...
 
@@ -87,6 +357,18 @@ namespace Agni
                 // Call script function synchronously... (non-blocking)
                 boolean CallFunctionSynchronously(Script hScript, char *pszName);
 
+                // Resolve a script function's name once to a handle the
+                //  calls below take instead, or INVALID_FUNCTION if none...
+                Function ResolveFunction(Script hScript, const char *pszName);
+
+                // Call resolved script function asynchronously... (blocking)
+                boolean CallFunction(Script hScript, Function hFunction);
+
+                // Call resolved script function synchronously...
+                //  (non-blocking)
+                boolean CallFunctionSynchronously(Script hScript,
+                                                  Function hFunction);
+
                 // Pass float parameter...
                 boolean PassFloatParameter(Script hScript, float fValue);
 
@@ -124,11 +406,49 @@ namespace Agni
                 // Load script, store handle, return a status code...
                 Status LoadScript(const char *pszPath, Script &hScript);
 
+                // Load a precompiled script, store handle, return a status
+                //  code...
+                Status LoadScript(const PrecompiledScript &Precompiled,
+                                  Script &hScript);
+
                 // Unload script...
                 boolean UnloadScript(Script &hScript);
 
+                // Get how many superinstructions have been fused so far...
+                uint32 GetFusedInstructionCount(Script hScript);
+
+                // Get a function's hotness and tier, or return false if there
+                //  is no such function...
+                boolean GetFunctionProfile(Script hScript, char *pszName,
+                                           FunctionProfile &Profile);
+
+                // Get the hotness at which functions are quickened...
+                uint32 GetQuickenThreshold() const;
+
+                // Get the bytes a script's arenas have obtained, or zero if
+                //  there is no such script...
+                uint32 GetMemoryUsed(Script hScript) const;
+
+                // Get the bytes the virtual machine occupies, including every
+                //  script's arenas...
+                uint32 GetMemoryUsed() const;
+
+                // Get the hotness at which functions are optimized, or zero if
+                //  they are optimized when loaded...
+                uint32 GetOptimizeThreshold() const;
+
+                // Get the string interning table's statistics, or return false
+                //  if strings are not being interned...
+                boolean GetInternStatistics(InternStatistics &Statistics) const;
+
             // Script playback...
 
+                // Get the microseconds until a script is next due to run,
+                //  zero if one can run now, or return false if none is
+                //  executing. Hosts running scripts from their own event loop
+                //  can wait this long before running them again...
+                boolean GetNextWakeup(uint32 &unMicroSeconds) const;
+
                 // Pause a script for a certain duration...
                 boolean PauseScript(Script hScript, uint32 unDuration);
 
@@ -138,6 +458,24 @@ namespace Agni
                 // Run scripts for specified milliseconds, or use macros...
                 boolean RunScripts(uint32 unDuration);
 
+                // Run scripts for specified milliseconds, or use macros, on a
+                //  number of worker threads, the caller's among them, or one
+                //  per core if AUTOMATIC_WORKERS. Each runs a different
+                //  script at a time, so host functions may be called
+                //  concurrently, though never two at once for the same
+                //  script. From within one, use only the methods to be
+                //  called from a host function, parameter retrieval, and
+                //  script playback, and only on the script that called it.
+                //  Loading and unloading scripts, registering host
+                //  functions, and anything on another script must wait
+                //  until this returns. Whatever the host functions share,
+                //  including any allocator passed to the constructor, must
+                //  be safe to use from several threads at once, and they may
+                //  throw nothing but what the virtual machine does. Where
+                //  threads are unavailable, scripts run as RunScripts()...
+                boolean RunScriptsInParallel(
+                    uint32 unDuration, uint32 unWorkers = AUTOMATIC_WORKERS);
+
                 // Start the execution of a script...
                 boolean StartScript(Script hScript);
 
@@ -149,11 +487,16 @@ namespace Agni
 
             // Host provided function methods...
 
-                // Register host provided function...
+                // Register host provided function, replacing any already
+                //  registered under the same name and visibility...
                 bool RegisterHostProvidedFunction(
                                     Script hThread, const char *pszName,
                                     HostProvidedFunction *pHostProvidedFunction);
 
+                // Unregister host provided function...
+                bool UnregisterHostProvidedFunction(Script hThread,
+                                                    const char *pszName);
+
             // Methods to be called from within a script called host function...
 
                 // Return nothing from within host function...
@@ -177,23 +520,269 @@ namespace Agni
         // Protected data types, macros, and other miscellaneous things...
         protected:
 
-            // Host provided function...
+            // Host provided function, a slot of the registry...
             typedef struct _AVM_HostProvidedFunction
             {
                 // Host function loaded flag...
                 boolean                 bLoaded;
 
+                // Vacated by unregistration, so lookups must probe past it...
+                boolean                 bVacated;
+
+                // Hash of case folded name and visibility...
+                uint32                  unHash;
+
                 // Script this function is visible to...
                 Script                  hScriptVisibleTo;
 
                 // Function name...
-                char                    szName[256];
+                char                   *pszName;
 
                 // Host routine's entry point...
                 HostProvidedFunction   *pEntryPoint;
 
             }AVM_HostProvidedFunction;
 
+            // Arena's smallest size class, as a power of two bytes, and how many
+            //  classes there are, each twice the size of the last...
+            #define ARENA_SMALLEST_CLASS_SHIFT  4
+            #define ARENA_SIZE_CLASSES          9
+
+            // Class of a block too large for any size class, which gets a
+            //  chunk of its own...
+            #define ARENA_LARGE_CLASS           ARENA_SIZE_CLASSES
+
+            // Size of an arena's first chunk, and the most each one after
+            //  doubles to...
+            #define ARENA_INITIAL_CHUNK_SIZE    4096
+            #define ARENA_MAXIMUM_CHUNK_SIZE    65536
+
+            // Round a size up to the alignment arena blocks are handed out
+            //  at...
+            #define ARENA_ALIGN(Size)           (((Size) + 7) & ~((size_t) 7))
+
+            // Chunk an arena carves blocks from, or a large block's own...
+            typedef struct _AVM_ArenaChunk
+            {
+                // Neighbouring chunks, so a large block's can be unlinked...
+                struct _AVM_ArenaChunk *pPrevious;
+                struct _AVM_ArenaChunk *pNext;
+
+                // Bytes, including this header...
+                size_t                  Size;
+
+            }AVM_ArenaChunk;
+
+            // Header preceding each block an arena hands out, whose body holds
+            //  the link to the next free block of its class once freed...
+            typedef struct _AVM_ArenaBlock
+            {
+                // Bytes usable...
+                uint32                  unSize;
+
+                // Size class, or ARENA_LARGE_CLASS...
+                uint32                  unClass;
+
+            }AVM_ArenaBlock;
+
+            // Region allocator a script's memory comes from, released in one
+            //  shot, with blocks freed before then kept by size class for
+            //  reuse...
+            typedef struct _AVM_Arena
+            {
+                // Script its chunks are tagged with when allocated...
+                Script                  hOwner;
+
+                // Chunks obtained so far...
+                AVM_ArenaChunk         *pChunks;
+
+                // Remainder of the newest chunk not yet carved into blocks...
+                char                   *pNext;
+                char                   *pEnd;
+
+                // Size of the next chunk to obtain...
+                size_t                  NextChunkSize;
+
+                // Freed blocks of each size class...
+                AVM_ArenaBlock         *pFreeBlocks[ARENA_SIZE_CLASSES];
+
+                // Bytes in blocks handed out and not yet freed, and bytes
+                //  obtained in chunks...
+                uint32                  unBytesUsed;
+                uint32                  unBytesReserved;
+
+            }AVM_Arena;
+
+            // Owner of a string allocated on the heap rather than in any
+            //  script's arena...
+            #define HEAP_STRING_OWNER   ((Script) -1)
+
+            // Runtime string, immutable while shared, whose characters are what
+            //  a runtime value's string literal points to...
+            typedef struct _AVM_String
+            {
+                // References runtime values hold to it, or zero for a literal
+                //  pooled in its script's code image that is never counted
+                //  or freed...
+                uint32          unReferences;
+
+                // Length, not counting the terminator...
+                uint32          unLength;
+
+                // Characters it has room for, not counting the terminator,
+                //  which appending to it in place may use up before it has to
+                //  grow...
+                uint32          unCapacity;
+
+                // Hash of its characters, if interned...
+                uint32          unHash;
+
+                // Script whose runtime arena it was allocated from, or
+                //  HEAP_STRING_OWNER...
+                Script          hOwner;
+
+                // Interned, and so never modified in place, even when it holds
+                //  the only reference...
+                boolean         bInterned;
+
+                // Characters, terminated...
+                char            szCharacters[1];
+
+            }AVM_String;
+
+            // Interned string, a slot of the interning table...
+            typedef struct _AVM_InternedString
+            {
+                // String, or NULL if the slot is free...
+                AVM_String             *pString;
+
+                // Vacated when its string was freed, so lookups must probe past
+                //  it...
+                boolean                 bVacated;
+
+            }AVM_InternedString;
+
+            // String whose characters a runtime value's string literal points
+            //  to...
+            #define AVM_STRING_OF(pszCharacters) \
+                ((AVM_String *) ((pszCharacters) - \
+                                 offsetof(AVM_String, szCharacters)))
+
+            // Bytes a string with room for a given number of characters
+            //  occupies, keeping the next one in a pool aligned...
+            #define AVM_STRING_SIZE(unCapacity) \
+                ((offsetof(AVM_String, szCharacters) + (unCapacity) + \
+                  sizeof(uint32)) & ~(sizeof(uint32) - 1))
+
+            // Operand type of a string short enough to live inline in its
+            //  runtime value, never shared and so copied like any number...
+            #define OT_AVM_SHORT_STRING     (OT_AVM_STACK_BASE_MARKER + 1)
+
+            // Room for an inline string, including its terminator, in the
+            //  bytes a runtime value's operand occupies...
+            #if defined(AGNI_COMPACT_VALUES)
+                #define SHORT_STRING_SIZE   7
+            #else
+                #define SHORT_STRING_SIZE   8
+            #endif
+
+            // Bytes of each script's scratch for coercing host function
+            //  parameters to strings...
+            #define COERCION_SCRATCH_SIZE   256
+
+            // Is a runtime value a string of either form?
+            #define AVM_IS_STRING(Value) \
+                ((Value).OperandType == OT_AVM_STRING || \
+                 (Value).OperandType == OT_AVM_SHORT_STRING)
+
+            // Characters of a string runtime value of either form...
+            #define AVM_CHARACTERS_OF(Value) \
+                ((Value).OperandType == OT_AVM_SHORT_STRING ? \
+                    (char *) (Value).szShortString : AVM_LITERAL_STRING(Value))
+
+            // Runtime values packed into a single 64-bit word...
+            #if defined(AGNI_COMPACT_VALUES)
+
+            // String literal a runtime value points to, and pointing it to
+            //  one...
+            #define AVM_LITERAL_STRING(Value) \
+                ((char *) (size_t) (Value).StringAddress)
+            #define AVM_SET_LITERAL_STRING(Value, pszString) \
+                ((Value).StringAddress = (size_t) (pszString))
+
+            // Offset index of a relative stack index, or the caller's stack
+            //  frame saved in a function index...
+            #define AVM_STACK_OFFSET(Value)     (Value).nStackOffset
+
+            // Bits an offset index or saved stack frame is limited to, and so
+            //  the most elements a stack can have...
+            #define STACK_OFFSET_BITS           24
+            #define MAXIMUM_STACK_SIZE          (1 << (STACK_OFFSET_BITS - 1))
+
+            // Runtime value... (used in stack, registers, and instruction
+            //  stream) Its operand type is the top byte of the word and its
+            //  operand the bytes below, so it is copied, passed, and returned
+            //  in a single register...
+            typedef union _AVM_RuntimeValue
+            {
+                // Operand type...
+                struct
+                {
+                    uint8                   OperandBytes[7];
+                    uint8                   OperandType;
+                };
+
+                // Literal integer...
+                int32                       nLiteralInteger;
+
+                // Literal float...
+                float32                     fLiteralFloat;
+
+                // String literal's address, which fits below the type...
+                struct
+                {
+                    unsigned long long      StringAddress   : 56;
+                    unsigned long long      StringTypeBits  : 8;
+                };
+
+                // Short string, inline...
+                char                        szShortString[SHORT_STRING_SIZE];
+
+                // Stack index, and offset index with relative stack indices...
+                struct
+                {
+                    int32                   nStackIndex[1];
+                    int32                   nStackOffset    : STACK_OFFSET_BITS;
+                    int32                   StackTypeBits   : 8;
+                };
+
+                // Instruction index...
+                int32                       nInstructionIndex;
+
+                // Function index...
+                int32                       nFunctionIndex;
+
+                // Host function index...
+                int32                       nHostFunctionIndex;
+
+                // Register identifier...
+                uint8                       Register;
+
+            }AVM_RuntimeValue;
+
+            // Runtime values as an operand type alongside an operand...
+            #else
+
+            // String literal a runtime value points to, and pointing it to
+            //  one...
+            #define AVM_LITERAL_STRING(Value)   (Value).pszLiteralString
+            #define AVM_SET_LITERAL_STRING(Value, pszString) \
+                ((Value).pszLiteralString = (pszString))
+
+            // Offset index of a relative stack index, or the caller's stack
+            //  frame saved in a function index...
+            #define AVM_STACK_OFFSET(Value)     (Value).nStackIndex[1]
+
             // Runtime value... (used in stack, registers, and instruction stream)
             typedef struct _AVM_RuntimeValue
             {
@@ -212,6 +801,9 @@ namespace Agni
                     // String literal...
                     char           *pszLiteralString;
 
+                    // Short string, inline...
+                    char            szShortString[SHORT_STRING_SIZE];
+
                     // Stack index... (second element needed only with relative
                     //  stack indices to store offset)
                     int32           nStackIndex[2];
@@ -231,6 +823,8 @@ namespace Agni
 
             }AVM_RuntimeValue;
 
+            #endif
+
             // Instruction structure...
             typedef struct _AVM_Instruction
             {
@@ -256,6 +850,134 @@ namespace Agni
 
             }AVM_InstructionStream;
 
+            // Operand kinds, as known after loading, that quickened handlers
+            //  are specialized on...
+            enum OperandKind
+            {
+                // Integer literal...
+                OperandKind_Integer = 0,
+
+                // Float literal...
+                OperandKind_Float,
+
+                // Any other value inlined in the instruction stream...
+                OperandKind_Literal,
+
+                // Absolute stack index of a global variable...
+                OperandKind_StackGlobal,
+
+                // Absolute stack index into the current stack frame...
+                OperandKind_StackLocal,
+
+                // Stack index offset by the value of a variable...
+                OperandKind_StackRelative,
+
+                // Register...
+                OperandKind_Register,
+
+                // Anything else, which cannot be quickened...
+                OperandKind_Unknown
+            };
+
+            // Threaded engine's own operation codes, beyond the instruction
+            //  set's...
+            enum ThreadedOperationCode
+            {
+                // Quickened instruction...
+                INSTRUCTION_AVM_QUICKENED = INSTRUCTION_AVM_EXIT + 1,
+
+                // Quickened conditional jump...
+                INSTRUCTION_AVM_QUICKENED_BRANCH,
+
+                // Superinstruction of two pushes and a host call...
+                INSTRUCTION_AVM_FUSED_PUSH_PUSH_CALLHOST,
+
+                // Superinstruction of an increment or decrement and a
+                //  conditional jump testing the same variable...
+                INSTRUCTION_AVM_FUSED_STEP_JUMP,
+
+                // Superinstruction of a move and an arithmetic operation on
+                //  the same destination...
+                INSTRUCTION_AVM_FUSED_MOV_ARITHMETIC
+            };
+
+            // Quickened instruction handler, returns true if branching...
+            typedef bool (VirtualMachine::*QuickenedHandler)(
+                Script hScript, AVM_RuntimeValue *pOperandList);
+
+            // Maximum operands any instruction takes...
+            #define MAXIMUM_OPERANDS                3
+
+            // Alignment of a script's code image, one cache line...
+            #define CODE_IMAGE_ALIGNMENT            64
+
+            // Deepest run of pushes the register tier can translate away...
+            #define MAXIMUM_DEFERRED_PUSHES         16
+
+            // Backward branches native code takes before a safe point...
+            #define NATIVE_SAFE_POINT_INTERVAL      256
+
+            // Backward branches a precompiled body takes before a safe point...
+            #define PRECOMPILED_SAFE_POINT_INTERVAL 256
+
+            // Threaded instruction, a fixed width word of a script's code
+            //  image with its operands inlined...
+            typedef struct _AVM_ThreadedInstruction
+            {
+                // Handler address, or operation code without computed goto...
+                const void                         *pHandler;
+
+                // Handler specialized on operand kinds, if quickened...
+                QuickenedHandler                    Quickened;
+
+                // Branch target resolved at load time, or NULL if none...
+                struct _AVM_ThreadedInstruction    *pJumpTarget;
+
+                // Operation code...
+                uint16                              usOperationCode;
+
+                // Operand count...
+                uint8                               OperandCount;
+
+                // Function the instruction belongs to, for hotness counting,
+                //  or -1 if none...
+                uint32                              unFunctionIndex;
+
+                // Operands...
+                AVM_RuntimeValue                    Operands[MAXIMUM_OPERANDS];
+
+            }AVM_ThreadedInstruction;
+
+            // Function's runtime state...
+            typedef struct _AVM_FunctionState
+            {
+                // Hotness and tier...
+                FunctionProfile     Profile;
+
+                // Instructions belonging to it, the last exclusive...
+                uint32              unFirstInstruction;
+                uint32              unLastInstruction;
+
+                // Is the deepest its own pushes take the stack above its frame
+                //  known, so that it is checked once when it is called
+                //  instead of on each push, and how deep...
+                bool                bStackBounded;
+                uint32              unMaximumStackDepth;
+
+            }AVM_FunctionState;
+
+            // Executable image being loaded...
+            typedef struct _AVM_ScriptImage
+            {
+                // Bytes...
+                const uint8        *pBytes;
+                uint32              unSize;
+
+                // Offset of the next byte to load...
+                uint32              unOffset;
+
+            }AVM_ScriptImage;
+
             // Runtime stack structure...
             typedef struct _AVM_RuntimeStack
             {
@@ -268,26 +990,158 @@ namespace Agni
                 // Index of the top of the current stack frame...
                 uint32              unCurrentStackFrameTopIndex;
 
+                #if defined(AGNI_GUARDED_STACKS)
+                // Address space reserved for the stack and the guard pages
+                //  either side of it, its size, and the size of each guard...
+                char               *pReservation;
+                size_t              ReservationSize;
+                size_t              GuardSize;
+
+                // Slot the fault handler finds its guards in...
+                uint32              unGuardSlot;
+                #endif
+
             }AVM_RuntimeStack;
 
+            // Queue of scripts linked through their own structures, in round
+            //  robin order from its head...
+            typedef struct _AVM_ScriptQueue
+            {
+                // First script, if any are queued...
+                Script              hHead;
+
+                // Scripts queued...
+                uint32              unSize;
+
+            }AVM_ScriptQueue;
+
+            // Scheduler state of a thread running scripts, the host's own
+            //  or a worker running them in parallel...
+            typedef struct _AVM_Worker
+            {
+                // Virtual machine it runs scripts for...
+                VirtualMachine     *pMachine;
+
+                // Threading mode, the script it is running, and when that
+                //  script took over...
+                uint8               ThreadingMode;
+                Script              hCurrentThread;
+                uint32              unCurrentThreadActivationTime;
+
+                // Does it hold the current thread out of the run queue while
+                //  running it in parallel?
+                boolean             bHolding;
+
+                // Scheduler iterations run between reads of the clock, those
+                //  left until the next, and how many it runs a millisecond,
+                //  or zero until measured...
+                uint32              unClockQuantum;
+                uint32              unClockCountdown;
+                uint32              unIterationsPerMilliSecond;
+
+                // Iterations run since the calibration window started, and
+                //  when it did...
+                uint32              unClockWindowIterations;
+                uint32              unClockWindowStartTime;
+
+            }AVM_Worker;
+
             // Script structure...
             typedef struct _AVM_Script
             {
                 // Is this script loaded?
                 boolean                         bLoaded;
 
+                // Serial of this load, which function handles resolved
+                //  against it carry...
+                uint32                          unLoadSerial;
+
                 // Is it executing?
                 boolean                         bExecuting;
 
+                // Queue the scheduler keeps it in, or NULL if none, and its
+                //  neighbours there...
+                AVM_ScriptQueue                *pQueue;
+                Script                          hNextQueued;
+                Script                          hPreviousQueued;
+
+                // Is a worker running it in parallel, out of every queue?
+                boolean                         bHeld;
+
                 // Main header...
                 Agni_MainHeader                 MainHeader;
 
+                // Arena everything loaded for the script comes from, released
+                //  when it is unloaded...
+                AVM_Arena                       ImageArena;
+
+                // Arena the strings it makes as it runs come from, released
+                //  when it is reset or unloaded...
+                AVM_Arena                       RuntimeArena;
+
                 // Instruction stream header...
                 Agni_InstructionStreamHeader    InstructionStreamHeader;
 
                 // Instruction stream...
                 AVM_InstructionStream           InstructionStream;
 
+                // Code image, a single cache line aligned allocation holding
+                //  threaded code, the instruction stream indexing into it,
+                //  and string literals...
+                void                           *pCodeImage;
+
+                // String literals interned instead of pooled in the code
+                //  image, each holding a reference, if strings are being
+                //  interned...
+                char                          **ppszInternedLiterals;
+
+                // Threaded code within the code image...
+                AVM_ThreadedInstruction        *pThreadedCode;
+
+                // Have threaded code handler addresses been linked yet?
+                boolean                         bThreadedCodeLinked;
+
+                // Superinstructions fused within the threaded code...
+                uint32                          unFusedInstructions;
+
+                // Register tier's image, a single cache line aligned
+                //  allocation holding its code and index maps, or NULL if
+                //  the script was not translated...
+                void                           *pRegisterImage;
+
+                // Register tier's threaded code within its image...
+                AVM_ThreadedInstruction        *pRegisterCode;
+
+                // Register code index of each instruction...
+                uint32                         *punRegisterIndex;
+
+                // Instruction index each register code word came from...
+                uint32                         *punRegisterSource;
+
+                // Register code words, not counting the terminating one...
+                uint32                          unRegisterCodeSize;
+
+                // Have register code handler addresses been linked yet?
+                boolean                         bRegisterCodeLinked;
+
+                // Native code's executable mapping, or NULL if the script was
+                //  not compiled...
+                void                           *pNativeCode;
+                size_t                          NativeCodeSize;
+
+                // Precompiled body running the script instead, if any...
+                PrecompiledBody                 pPrecompiledBody;
+
+                // Native code address of each instruction, or NULL where the
+                //  instruction must be interpreted...
+                void                          **ppNativeEntry;
+
+                // Execution exception caught on behalf of native code, to be
+                //  rethrown once it has returned, by type...
+                uint8                           NativeExceptionType;
+                SCRIPT_EXECUTION_EXCEPTION      NativeException;
+                const char                     *pszNativeException;
+
                 // String stream header...
                 Agni_StringStreamHeader         StringStreamHeader;
 
@@ -297,15 +1151,44 @@ namespace Agni
                 // Function table...
                 Agni_Function                  *pFunctionTable;
 
+                // Runtime state of each function in the function table...
+                AVM_FunctionState              *pFunctionState;
+
+                // Export index hashing each function's case folded name to
+                //  one past its index in the function table, or zero if the
+                //  slot is empty, and its size which is a power of two...
+                uint32                         *punFunctionIndex;
+                uint32                          unFunctionIndexSlots;
+
+                // Are any functions still to be promoted as they get hot?
+                boolean                         bTiering;
+
                 // Host function table header...
                 Agni_HostFunctionTableHeader    HostFunctionTableHeader;
 
                 // Host function table...
                 Agni_HostFunction              *pHostFunctionTable;
 
-                // Paused, and if so, until what time?
+                // Host provided function each host function is bound to, or
+                //  NULL if none is registered under its name...
+                HostProvidedFunction          **ppHostFunctionBindings;
+
+                // Registry generation the bindings were made against...
+                uint32                          unHostFunctionBindingGeneration;
+
+                // Scratch the numeric parameters a host function asks for as
+                //  strings are formatted into, allocated from the image arena
+                //  the first time one is, so scripts whose host functions
+                //  never do leave every slot that much smaller, and how much
+                //  of it is in use by host functions still running...
+                char                           *pszCoercionScratch;
+                uint32                          unCoercionScratchUsed;
+
+                // Paused, and if so, until what time in microseconds, and its
+                //  slot in the pause heap plus one, or zero if not in it...
                 boolean                         bPaused;
-                uint32                          unPauseEndTime;
+                unsigned long long              PauseEndTime;
+                uint32                          unPauseHeapSlot;
 
                 // Thread time slice...
                 uint32                          unThreadTimeSlice;
@@ -327,20 +1210,38 @@ namespace Agni
             // Default stack size...
             #define DEFAULT_STACK_SIZE              1024
 
+            // Most passes over a function finding how deep it takes the
+            //  stack before giving up on it ever settling...
+            #define MAXIMUM_STACK_DEPTH_PASSES      16
+
             // Maximum string coercion length...
             #define MAXIMUM_COERCION_LENGTH         63
 
+            // Bits of a function handle holding the function's index, above
+            //  which sits the serial of the load it was resolved against, so
+            //  that only scripts with fewer functions can hand them out, and
+            //  a handle could only be mistaken for one from a later load
+            //  once the serial wraps...
+            #define FUNCTION_HANDLE_INDEX_BITS      16
+            #define FUNCTION_HANDLE_SERIAL_MASK     0x7FFF
+
             // Maximum number of threads...
             #define MAXIMUM_THREADS                 1024
 
-            // Maximum number of host provided functions...
-            #define MAXIMUM_HOST_PROVIDED_FUNCTIONS 256
+            // Host provided function registry's initial slots, a power of
+            //  two it doubles from as it fills...
+            #define INITIAL_HOST_PROVIDED_FUNCTION_SLOTS 64
+
+            // String interning table's initial slots, a power of two it
+            //  doubles from as it fills...
+            #define INITIAL_INTERNED_STRING_SLOTS   256
 
             // Threading modes...
             enum THREADING_MODE
             {
                 THREADING_MODE_MULTIPLE = 0,
-                THREADING_MODE_SINGLE
+                THREADING_MODE_SINGLE,
+                THREADING_MODE_PARALLEL
             };
 
             // Threading priority time slice durations...
@@ -351,6 +1252,13 @@ namespace Agni
                 THREAD_PRIORITY_HIGH_DURATION   = 80
             };
 
+            // Clock reads the scheduler aims for in each time slice, the
+            //  milliseconds over which it counts its iterations to calibrate
+            //  how many to run between reads, and the most it ever runs...
+            #define CLOCK_READS_PER_TIME_SLICE      8
+            #define CLOCK_CALIBRATION_WINDOW        50
+            #define MAXIMUM_CLOCK_QUANTUM           1048576
+
             // Resolve stack index for current thread if relative to absolute...
             #define ResolveStackIndex(hScript, nIndex) \
                 (nIndex < 0 ? nIndex += Scripts[hScript].Stack. \
@@ -371,12 +1279,98 @@ namespace Agni
                 (nIndex < 0 || nIndex > Scripts[hScript]. \
                     HostFunctionTableHeader.unSize ? false : true)
 
+        // Precompiled script support...
+        public:
+
+            // Context a precompiled script's body runs a thread through, for
+            //  use only by code the translator generates...
+            class PrecompiledContext
+            {
+                public:
+
+                    // Runtime value...
+                    typedef AVM_RuntimeValue Value;
+
+                    // Constructor...
+                    PrecompiledContext(VirtualMachine &_Machine,
+                                       Script _hScript);
+
+                    // Instruction pointer...
+                    uint32 GetInstructionPointer() const
+                        { return CurrentScript.InstructionStream.
+                                    unInstructionPointer; }
+                    void SetInstructionPointer(uint32 unIndex)
+                        { CurrentScript.InstructionStream.
+                            unInstructionPointer = unIndex; }
+
+                    // Global variable...
+                    Value &Global(int32 nIndex)
+                        { return CurrentScript.Stack.pElements[nIndex]; }
+
+                    // Variable in the current stack frame...
+                    Value &Local(int32 nIndex)
+                        { return CurrentScript.Stack.pElements[nIndex +
+                            CurrentScript.Stack.unCurrentStackFrameTopIndex]; }
+
+                    // Register...
+                    Value &Register(uint8 Identifier)
+                        { return (Identifier == REGISTER_AVM_T0) ?
+                                    CurrentScript._RegisterT0 :
+                                 (Identifier == REGISTER_AVM_T1) ?
+                                    CurrentScript._RegisterT1 :
+                                    CurrentScript._RegisterReturn; }
+
+                    // Was the instruction quickened when loaded?
+                    bool IsQuickened(uint32 unIndex) const
+                        { return CurrentScript.pThreadedCode[unIndex].
+                                    Quickened != NULL; }
+
+                    // Run an instruction's quickened handler and return true
+                    //  if it branches...
+                    bool Quickened(uint32 unIndex)
+                        { return (Machine.*CurrentScript.pThreadedCode[
+                                    unIndex].Quickened)(hScript,
+                                  CurrentScript.pThreadedCode[unIndex].
+                                    Operands); }
+
+                    // Leave an instruction to the interpreter...
+                    PrecompiledStatus Interpret(uint32 unIndex);
+
+                    // Call the function an instruction names...
+                    void Call(uint32 unIndex);
+
+                    // Return from a function and return true if the stack
+                    //  base was reached...
+                    bool Return();
+
+                    // Call the host function an instruction names...
+                    void CallHost(uint32 unIndex);
+
+                    // Pause for the duration an instruction names...
+                    void Pause(uint32 unIndex);
+
+                    // Stop the thread at an instruction...
+                    void Exit(uint32 unIndex);
+
+                protected:
+
+                    // Virtual machine and the thread it is running...
+                    VirtualMachine &Machine;
+                    Script          hScript;
+                    AVM_Script     &CurrentScript;
+            };
+
         // Protected data...
         protected:
 
             // Checksum calculation register...
             uint32  unTempCheckSum;
 
+            // Allocator every byte comes from, the host's if it passed one,
+            //  otherwise the default...
+            SlabAllocator   DefaultAllocator;
+            Allocator      *pAllocator;
+
             // Host version...
             char   *pszHostName;
             uint8   HostVersionMajor;
@@ -385,22 +1379,156 @@ namespace Agni
             // Script array...
             AVM_Script  Scripts[MAXIMUM_THREADS];
 
-            // Host provided function table...
-            AVM_HostProvidedFunction
-                HostProvidedFunctionTable[MAXIMUM_HOST_PROVIDED_FUNCTIONS];
+            // Host provided function registry, open addressed by hash of
+            //  case folded name and visibility...
+            AVM_HostProvidedFunction   *pHostProvidedFunctions;
+
+                // Slots, functions registered, and slots registered or
+                //  vacated...
+                uint32  unHostProvidedFunctionSlots;
+                uint32  unHostProvidedFunctionCount;
+                uint32  unHostProvidedFunctionSlotsUsed;
+
+            // Registry generation, advanced by every registration so scripts
+            //  know to bind their host functions again...
+            uint32  unHostProvidedFunctionGeneration;
+
+            // Serial of the last script loaded, which each load advances...
+            uint32  unScriptLoadSerial;
+
+            // Instruction dispatch engine in use...
+            DispatchEngine  Engine;
+
+            // Hotness at which functions are promoted to each tier...
+            uint32  unQuickenThreshold;
+            uint32  unOptimizeThreshold;
+
+            // String interning table, open addressed by hash of characters, if
+            //  strings are being interned...
+            boolean                 bInternStrings;
+            AVM_InternedString     *pInternedStrings;
+
+                // Slots, strings interned, and slots interned or vacated...
+                uint32  unInternedStringSlots;
+                uint32  unInternedStringCount;
+                uint32  unInternedStringSlotsUsed;
+
+                // Lookups, those that were hits, and bytes interned strings
+                //  occupy...
+                uint32  unInternLookups;
+                uint32  unInternHits;
+                uint32  unInternedStringBytes;
 
             // Threading...
-            uint8   CurrentThreadingMode;
-            Script  hCurrentThread;
-            uint32  unCurrentThreadActivationTime;
+
+                // Scheduler state of the host's thread running scripts, and
+                //  of each worker running them in parallel, the first being
+                //  the host's...
+                AVM_Worker      MainWorker;
+                AVM_Worker      Workers[MAXIMUM_WORKERS];
+
+                // Scripts executing and ready to run, with the current thread
+                //  at its head while it is one of them...
+                AVM_ScriptQueue RunQueue;
+
+                // Those executing but paused, in a heap ordered by when each
+                //  is due to wake, and how many...
+                Script          PauseHeap[MAXIMUM_THREADS];
+                uint32          unPausedScripts;
+
+                // Those workers hold out of every queue while running them
+                //  in parallel...
+                uint32          unHeldScripts;
+
+                // Are scripts running in parallel, and has a worker asked the
+                //  rest to stop?
+                boolean                     bParallel;
+                volatile unsigned long long StopWorkers;
+
+                #if defined(AGNI_WORKER_THREADS)
+                // Lock over the queues and pause heap while running in
+                //  parallel, and the condition workers wait on for a script
+                //  to become runnable. Taken by readers of the queues too...
+                mutable pthread_mutex_t SchedulerLock;
+                pthread_cond_t          SchedulerCondition;
+
+                // Lock over the string interning table while running in
+                //  parallel...
+                pthread_mutex_t InternedStringLock;
+
+                // Pool threads each worker but the first runs on, and how
+                //  many have been started...
+                pthread_t       WorkerThreads[MAXIMUM_WORKERS];
+                uint32          unWorkerThreads;
+
+                // Lock over the pool, and the condition its threads wait on
+                //  between runs and the host's waits on for them to finish
+                //  one...
+                pthread_mutex_t PoolLock;
+                pthread_cond_t  PoolCondition;
+
+                // Runs started, workers taking part in the current one, those
+                //  still running it, and its duration...
+                uint32          unPoolGeneration;
+                uint32          unPoolWorkers;
+                uint32          unPoolWorkersRunning;
+                uint32          unPoolDuration;
+
+                // Are the pool's threads to exit?
+                boolean         bPoolShutdown;
+
+                // First exception a pool thread caught, to be rethrown on the
+                //  host's, by type...
+                uint8                       PoolExceptionType;
+                SCRIPT_EXECUTION_EXCEPTION  PoolException;
+                const char                 *pszPoolException;
+                Status                      PoolStatus;
+                #endif
 
         // Protected methods...
         protected:
 
+            // Arena allocation...
+
+                // Allocate a block from an arena, or NULL if out of memory...
+                void *ArenaAllocate(AVM_Arena &Arena, size_t Size);
+
+                // Allocate a zeroed block for an array from an arena, or NULL
+                //  if out of memory...
+                void *ArenaAllocateZeroed(AVM_Arena &Arena, size_t Count,
+                                          size_t Size);
+
+                // Resize a block allocated from an arena, moving it if it has
+                //  no room, or NULL if out of memory, leaving it as it was...
+                void *ArenaReallocate(AVM_Arena &Arena, void *pBlock,
+                                      size_t Size);
+
+                // Free a block allocated from an arena for reuse...
+                void ArenaFree(AVM_Arena &Arena, void *pBlock);
+
+                // Release everything allocated from an arena in one shot...
+                void ArenaRelease(AVM_Arena &Arena);
+
+            #if defined(AGNI_GUARDED_STACKS)
+            // Guarded stacks...
+
+                // Reserve a script's runtime stack between guard pages, each
+                //  side large enough that no frame can be pushed past it
+                //  without touching it, or throw status code...
+                void ReserveGuardedStack(Script hScript);
+
+                // Give every page of a script's guarded stack that has been
+                //  touched back to the system, leaving the stack zeroed...
+                void DecommitGuardedStack(Script hScript);
+
+                // Give a script's guarded stack back to the system...
+                void ReleaseGuardedStack(Script hScript);
+            #endif
+
             // Checksum calculation...
 
-                // Calculate checksum of executable file at given path...
-                uint32 CalculateCheckSumOfExecutable(const char *pszPath);
+                // Calculate checksum of executable image...
+                uint32 CalculateCheckSumOfImage(const AVM_ScriptImage &Image);
 
                 // Acknowledge bit in calculation...
                 void CheckSum_PutBit(boolean Bit);
@@ -418,7 +1546,13 @@ namespace Agni
 
                 // Load bytes or throw error string...
                 void LoadBytes(void *pStorageBuffer, uint32 unEachOfSize,
-                               uint32 unMembers, FILE *hFile);
+                               uint32 unMembers, AVM_ScriptImage &Image);
+
+                // Load script from an executable image, to be run by a
+                //  precompiled body if one is given, store handle, return a
+                //  status code...
+                Status LoadScriptImage(const uint8 *pImage, uint32 unImageSize,
+                                       PrecompiledBody pBody, Script &hScript);
 
                 // Check version...
                 bool VersionSafe(uint8 AvailableMajor, uint8 AvailableMinor,
@@ -426,17 +1560,51 @@ namespace Agni
 
             // Function interfacing...
 
+                // Bind each of a script's host functions to the host provided
+                //  function registered under its name...
+                void BindHostFunctions(Script hScript);
+
+                // Build a script's function export index...
+                void BuildFunctionIndex(Script hScript);
+
+                // Hash a case folded name...
+                uint32 HashName(const char *pszName);
+
+                // Hash a host provided function's case folded name and
+                //  visibility...
+                uint32 HashHostProvidedFunction(Script hVisibleTo,
+                                                const char *pszName);
+
+                // Find a host provided function registered under a name and
+                //  visibility, or NULL if none...
+                AVM_HostProvidedFunction *FindHostProvidedFunction(
+                    Script hVisibleTo, const char *pszName);
+
+                // Rehash the host provided function registry into room for
+                //  another function, or return false if out of memory...
+                bool GrowHostProvidedFunctions();
+
                 // The actual implementation to call script functions any way...
                 void CallFunctionImplementation(Script hScript, uint32 unIndex);
 
                 // Get a function by index or return NULL on error...
                 Agni_Function GetFunction(Script hScript, uint32 unIndex);
 
+                // Get a function index by resolved handle or return -1 if
+                //  it is stale or was never valid...
+                int32 GetFunctionIndexByHandle(Script hScript,
+                                               Function hFunction);
+
                 // Get a function index by name or return -1 on error...
-                int32 GetFunctionIndexByName(Script hScript, char *pszName);
+                int32 GetFunctionIndexByName(Script hScript,
+                                             const char *pszName);
 
-                // Get script's host function name for current thread by index...
-                char *GetHostFunction(uint32 unIndex);
+                // Invoke a script's host function by index...
+                void InvokeHostFunction(Script hScript, uint32 unIndex);
+
+                // Return from the current script function and return true if
+                //  the stack base was reached or throw error string...
+                bool ReturnFromFunction(Script hScript);
 
             // Operand coercion...
 
@@ -446,49 +1614,154 @@ namespace Agni
                 // Coerce value to float or throw error string...
                 float32 CoerceValueToFloat(AVM_RuntimeValue RuntimeValue);
 
-                // Coerce value to string or throw error string...
-                char *CoerceValueToString(AVM_RuntimeValue RuntimeValue);
+                // Coerce value to string, pointing into it if it holds a
+                //  short string, or formatting a number into the given buffer
+                //  of at least MAXIMUM_COERCION_LENGTH + 1 characters, or throw
+                //  error string...
+                char *CoerceValueToString(const AVM_RuntimeValue &RuntimeValue,
+                                          char *pszBuffer);
+
+                // Format an integer into a buffer, without allocating, and
+                //  return its length...
+                uint32 FormatInteger(int32 nValue, char *pszBuffer);
+
+                // Format a float into a buffer as "%f" would, without
+                //  allocating, and return its length...
+                uint32 FormatFloat(float32 fValue, char *pszBuffer);
+
+            // Runtime strings...
+
+                // Append characters to a string value, in place if it is its
+                //  own, growing it geometrically, or building the result
+                //  inline if it is short enough, or throw error string...
+                void ConcatenateString(Script hScript,
+                                       AVM_RuntimeValue *pDestination,
+                                       const char *pszSource);
+
+                // Store a copy of the given characters in a value, releasing
+                //  whatever it held, inline if short enough, or throw error
+                //  string...
+                void StoreString(Script hScript, AVM_RuntimeValue *pValue,
+                                 const char *pszCharacters, uint32 unLength);
+
+                // Allocate a string of the given length and room holding a
+                //  copy of the given characters, or left for the caller to
+                //  fill in if none, with a single reference, from its owner's
+                //  runtime arena or the heap if HEAP_STRING_OWNER, or NULL if
+                //  out of memory...
+                char *NewString(Script hOwner, const char *pszCharacters,
+                                uint32 unLength, uint32 unCapacity);
+
+                // Drop the reference a value holds to its string, if any,
+                //  freeing the string if it was the last...
+                void ReleaseValue(AVM_RuntimeValue *pValue);
+
+                // Drop a reference to a string, unless a literal, freeing it if
+                //  it was the last...
+                void ReleaseString(char *pszCharacters);
+
+                // Are two string values equal? Interned strings are equal only
+                //  if they are the same string...
+                bool StringsEqual(const AVM_RuntimeValue &Value0,
+                                  const AVM_RuntimeValue &Value1);
+
+                // Make a value's string its own to modify, copying it first if
+                //  it is shared or a literal, or throw error string...
+                char *UniqueString(Script hScript, AVM_RuntimeValue *pValue);
+
+                // Set a character of a value's string, copying the string first
+                //  if it is shared or a literal, ignoring an index outside the
+                //  string, or throw error string...
+                void SetCharacter(Script hScript, AVM_RuntimeValue *pValue,
+                                  int32 nIndex, char Character);
+
+            // String interning...
+
+                // Hash a string's characters, case sensitively...
+                uint32 HashString(const char *pszCharacters, uint32 unLength);
+
+                // Find or intern a string of the given characters, adding a
+                //  reference to it, or NULL if out of memory...
+                char *InternString(const char *pszCharacters, uint32 unLength);
+
+                // Remove an interned string whose last reference was dropped
+                //  from the interning table...
+                void ForgetInternedString(AVM_String *pString);
+
+                // Rehash the interning table into room for another string, or
+                //  return false if out of memory...
+                bool GrowInternedStrings();
 
             // Operand resolution...
 
-                // Copy source value into destination or throw error string...
+                // Copy source value into destination, sharing any string...
                 void CopyValue(AVM_RuntimeValue *pDestinationValue,
                                AVM_RuntimeValue SourceValue);
 
-        		// Get operand type as exists in instruction stream...
-                uint8 GetOperandType(uint8 OperandIndex);
+        		// Get operand type as exists in a script's instruction
+                //  stream...
+                uint8 GetOperandType(Script hScript, uint8 OperandIndex);
 
                 // Resolve operand's stack index, whether relative or absolute
                 //   or throw error string...
-        		int32 ResolveOperandStackIndex(uint8 OperandIndex);
+        		int32 ResolveOperandStackIndex(Script hScript,
+                                               uint8 OperandIndex);
 
         		// Resolve an operand's value or throw error string...
-                AVM_RuntimeValue ResolveOperandValue(uint8 OperandIndex);
+                AVM_RuntimeValue ResolveOperandValue(Script hScript,
+                                                     uint8 OperandIndex);
+
+                // Get a pointer to one of a script's registers or NULL...
+                AVM_RuntimeValue *ResolveRegister(Script hScript,
+                                                  uint8 Register);
+
+                // Resolve a given operand's stack index for a script or throw
+                //  error string...
+                int32 ResolveStackIndexOf(Script hScript,
+                                          const AVM_RuntimeValue &Operand);
+
+                // Resolve a given operand's value for a script or throw error
+                //  string...
+                AVM_RuntimeValue ResolveValueOf(Script hScript,
+                                                const AVM_RuntimeValue &Operand);
+
+                // Resolve a given operand to a pointer to its runtime value
+                //  for a script, or NULL if not applicable...
+                AVM_RuntimeValue *ResolvePointerTo(
+                    Script hScript, const AVM_RuntimeValue &Operand);
 
                 // Resolves final type of operand and returns the resolved type...
-        		uint8 ResolveOperandType(uint8 OperandIndex);
+        		uint8 ResolveOperandType(Script hScript, uint8 OperandIndex);
 
         		// Resolve operand as an integer...
-                int32 ResolveOperandAsInteger(uint8 OperandIndex);
+                int32 ResolveOperandAsInteger(Script hScript,
+                                              uint8 OperandIndex);
 
                 // Resolve operand as a float...
-                float32 ResolveOperandAsFloat(uint8 OperandIndex);
+                float32 ResolveOperandAsFloat(Script hScript,
+                                              uint8 OperandIndex);
 
-        		// Resolve operand as a string...
-                char *ResolveOperandAsString(uint8 OperandIndex);
+        		// Resolve operand as a string, formatting a number into the
+                //  given coercion buffer...
+                char *ResolveOperandAsString(Script hScript, uint8 OperandIndex,
+                                             char *pszBuffer);
 
                 // Resolve operand as an instruction index...
-        		int32 ResolveOperandAsInstructionIndex(uint8 OperandIndex);
+        		int32 ResolveOperandAsInstructionIndex(Script hScript,
+                                                       uint8 OperandIndex);
 
         		// Resolve operand as a function index...
-                int32 ResolveOperandAsFunctionIndex(uint8 OperandIndex);
+                int32 ResolveOperandAsFunctionIndex(Script hScript,
+                                                    uint8 OperandIndex);
 
                 // Resolve operand as a host function call...
-        		int32 ResolveOperandAsHostFunctionIndex(uint8 OperandIndex);
+        		int32 ResolveOperandAsHostFunctionIndex(Script hScript,
+                                                        uint8 OperandIndex);
 
                 // Resolves operand and returns a pointer to it's runtime value or
                 //  NULL if not applicable...
-        		AVM_RuntimeValue *ResolveOperandAsPointer(uint8 OperandIndex);
+        		AVM_RuntimeValue *ResolveOperandAsPointer(Script hScript,
+                                                          uint8 OperandIndex);
 
             // Runtime stack interface...
 
@@ -501,15 +1774,302 @@ namespace Agni
                 // Push value onto the stack or throw error string...
         		void Push(Script hScript, AVM_RuntimeValue RuntimeValue);
 
+                // Push value onto the stack already known to have room...
+                void PushWithinBound(Script hScript,
+                                     AVM_RuntimeValue RuntimeValue);
+
         		// Push a stack frame onto the stack or throw error string...
                 void PushStackFrame(Script hScript, uint32 unSize);
 
+                // Push a stack frame onto the stack already known to have
+                //  room...
+                void PushStackFrameWithinBound(Script hScript, uint32 unSize);
+
+                // Make sure whatever remains of the function a thread resumes
+                //  in still fits on the stack, if its pushes go unchecked, now
+                //  that a host function may have left values on it, or throw
+                //  execution exception...
+                void CheckStackBound(Script hScript);
+
         		// Pop stack frame off of the stack or throw error string...
                 void PopStackFrame(Script hScript, uint32 unSize);
 
                 // Set stack value or throw error string...
         		void SetStackValue(Script hScript, int32 nIndex,
                                    AVM_RuntimeValue RuntimeValue);
+
+            // Scheduling...
+
+                // Count the iterations a worker ran up to a read of the clock
+                //  and size the quantum until its next read to a fraction of
+                //  its current thread's time slice...
+                void CalibrateClockQuantum(AVM_Worker &Worker,
+                                           uint32 unCurrentTime);
+
+                // Run scripts on a worker for specified milliseconds, or use
+                //  macros...
+                boolean RunWorker(AVM_Worker &Worker, uint32 unDuration);
+
+                // Queue a script where its state says it belongs, or nowhere
+                //  if it is not executing...
+                void ScheduleScript(Script hScript);
+
+                // Link a script onto the end of a queue...
+                void LinkScript(AVM_ScriptQueue &Queue, Script hScript);
+
+                // Unlink a script from whichever queue it is in, if any...
+                void UnlinkScript(Script hScript);
+
+                // Time in microseconds a pause lasting some milliseconds from
+                //  now ends, one that is negative having already ended...
+                unsigned long long PauseEndTimeAfter(long long Duration);
+
+                // Add a script to the pause heap...
+                void InsertPausedScript(Script hScript);
+
+                // Take a script out of the pause heap...
+                void RemovePausedScript(Script hScript);
+
+                // Move the script in a slot of the pause heap up or down
+                //  until it is due after its parent and before its
+                //  children...
+                void SiftPausedScript(uint32 unSlot);
+
+                // Make runnable every paused script whose pause has
+                //  elapsed...
+                void WakePausedScripts(unsigned long long CurrentTime);
+
+                // Sleep until a time in microseconds, or until the main
+                //  timeslice that started at a time in milliseconds and lasts
+                //  a duration ends if that is sooner, then read the clock
+                //  into a worker's calibration and return true if the main
+                //  timeslice has ended...
+                bool IdleUntil(AVM_Worker &Worker, unsigned long long WakeTime,
+                               uint32 unMainTimeSliceStartTime,
+                               uint32 unDuration, uint32 &unCurrentTime);
+
+            // Worker threads...
+
+                // Reset a worker's scheduler state...
+                void ResetWorker(AVM_Worker &Worker, uint8 ThreadingMode);
+
+                // Reset every worker and prepare the pool...
+                void InitializeWorkers();
+
+                // Shut the pool down, joining its threads...
+                void ShutdownWorkers();
+
+                // Lock and unlock the string interning table, if running in
+                //  parallel...
+                void LockInternedStrings();
+                void UnlockInternedStrings();
+
+                // Lock and unlock the queues and pause heap, if running in
+                //  parallel...
+                void LockScheduler() const;
+                void UnlockScheduler() const;
+
+                #if defined(AGNI_WORKER_THREADS)
+                // Hand back the script a worker holds, if any, and hold the
+                //  next runnable one, waiting until there is one unless the
+                //  main timeslice ends first, then read the clock and return
+                //  true if the worker is to stop...
+                bool SwitchWorkerScript(AVM_Worker &Worker,
+                                        uint32 unMainTimeSliceStartTime,
+                                        uint32 unDuration,
+                                        uint32 &unCurrentTime);
+
+                // Hand back the script a worker holds, if any...
+                void ReleaseWorkerScript(AVM_Worker &Worker);
+
+                // Ask every worker to stop...
+                void StopWorkerThreads();
+
+                // Wait for every pool thread taking part in the current run to
+                //  finish it...
+                void WaitForPoolThreads();
+
+                // Pool thread's entry point, which runs its worker whenever
+                //  a run it takes part in starts, until shut down...
+                static void *PoolThreadEntry(void *pWorker);
+
+                // Record the first exception a pool thread caught...
+                void RecordPoolException(uint8 Type,
+                                         SCRIPT_EXECUTION_EXCEPTION Exception,
+                                         const char *pszException,
+                                         Status ExceptionStatus);
+                #endif
+
+            // Threaded dispatch engine...
+
+                // Build a script's code image from its loaded instructions
+                //  and string table or throw status code...
+                void BuildCodeImage(Script hScript,
+                                    const AVM_ThreadedInstruction *pLoadedCode,
+                                    char **ppszStringTable);
+
+                // Resolve branch targets, quicken, and fuse a script's
+                //  threaded code or throw status code...
+                void PrepareThreadedCode(Script hScript);
+
+                // Quicken a range of threaded code, the last instruction
+                //  exclusive...
+                void QuickenThreadedCode(Script hScript, uint32 unFirst,
+                                         uint32 unLast);
+
+                // Fuse common instruction sequences within a range of
+                //  threaded code, the last instruction exclusive, into
+                //  superinstructions and return how many were fused or throw
+                //  status code...
+                uint32 FuseThreadedCode(Script hScript, uint32 unFirst,
+                                        uint32 unLast);
+
+                // Find each function's instructions and start it at its tier...
+                void PrepareTiering(Script hScript);
+
+                // Find the deepest each function's own pushes take the stack
+                //  above its frame, where that is known, or throw status
+                //  code...
+                void AnalyzeStackDepth(Script hScript);
+
+                // Count a function's invocation or backward branch and promote
+                //  it if that made it hot enough...
+                void CountHotness(Script hScript, uint32 unFunctionIndex,
+                                  bool bBackwardBranch);
+
+                // Promote a function to a tier...
+                void PromoteFunction(Script hScript, uint32 unFunctionIndex,
+                                     ExecutionTier Tier);
+
+                // Flag each instruction execution can enter other than by
+                //  falling through, or return NULL if branch targets are
+                //  only known at runtime or throw status code...
+                boolean *FindEnteredInstructions(Script hScript);
+
+                // Translate threaded code into register code, turning stack
+                //  traffic into moves, or throw status code...
+                void TranslateToRegisterCode(Script hScript);
+
+                // Does an operand name one variable or register, known at
+                //  load time?
+                bool IsNamedSlot(const AVM_RuntimeValue &Operand);
+
+                // Do two operands name the same runtime value?
+                bool IsSameOperand(const AVM_RuntimeValue &Operand0,
+                                   const AVM_RuntimeValue &Operand1);
+
+                // Run a script's threaded code, or register code, up to its
+                //  next safe point and return true if the stack base was
+                //  reached...
+                template <bool bRegisterCode>
+                bool ExecuteThreadedCode(Script hScript);
+
+            // Native code compiler...
+
+                // Native code's entry point, which enters a script's native
+                //  code at the given address and returns an exit status...
+                typedef uint32 (*NativeEntryPoint)(
+                    VirtualMachine *pVirtualMachine, Script hScript,
+                    AVM_Script *pScript, void *pEntry, uint32 unSafePoints);
+
+                // Compile a script's threaded code to native code, where
+                //  supported, leaving it uncompiled otherwise...
+                void CompileNativeCode(Script hScript);
+
+                // Run a script's native code up to its next safe point, or an
+                //  instruction it must interpret, and return true if the
+                //  stack base was reached...
+                bool ExecuteNativeCode(Script hScript);
+
+                // Release a script's native code...
+                void FreeNativeCode(Script hScript);
+
+                // Run a quickened instruction on behalf of native code...
+                static uint32 NativeQuickened(
+                    VirtualMachine *pVirtualMachine, Script hScript,
+                    AVM_ThreadedInstruction *pInstruction);
+
+                // Call a function on behalf of native code...
+                static uint32 NativeCall(
+                    VirtualMachine *pVirtualMachine, Script hScript,
+                    AVM_ThreadedInstruction *pInstruction);
+
+                // Return from a function on behalf of native code...
+                static uint32 NativeReturn(
+                    VirtualMachine *pVirtualMachine, Script hScript);
+
+            // Operand quickening...
+
+                // Classify an operand by what is known of it after loading...
+                OperandKind GetOperandKind(const AVM_RuntimeValue &Operand);
+
+                // Select a handler specialized on an instruction's operand
+                //  kinds, or NULL if it cannot be quickened...
+                QuickenedHandler SelectQuickenedHandler(
+                    const AVM_Instruction &Instruction, bool bStackBounded);
+
+                // Select a binary operation handler for the given kinds...
+                template <int Operation>
+                QuickenedHandler SelectQuickenedBinary(
+                    OperandKind DestinationKind, OperandKind SourceKind);
+
+                // Select a binary operation handler for the given source kind
+                //  when the destination kind is already known...
+                template <int Operation, int DestinationKind>
+                QuickenedHandler SelectQuickenedBinarySource(
+                    OperandKind SourceKind);
+
+                // Select a unary operation handler for the given kind...
+                template <int Operation>
+                QuickenedHandler SelectQuickenedUnary(
+                    OperandKind DestinationKind);
+
+                // Select a conditional jump handler for the given kinds...
+                template <int Operation>
+                QuickenedHandler SelectQuickenedCompare(
+                    OperandKind Kind0, OperandKind Kind1);
+
+                // Select a conditional jump handler for the given second
+                //  operand kind when the first is already known...
+                template <int Operation, int Kind0>
+                QuickenedHandler SelectQuickenedCompareSecond(
+                    OperandKind Kind1);
+
+                // Resolve an operand of a known kind to its runtime value...
+                template <int Kind>
+                AVM_RuntimeValue *QuickenedOperand(Script hScript,
+                                                   AVM_RuntimeValue &Operand);
+
+                // Quickened binary operation...
+                template <int Operation, int DestinationKind, int SourceKind>
+                bool QuickenedBinary(Script hScript,
+                                     AVM_RuntimeValue *pOperandList);
+
+                // Quickened unary operation...
+                template <int Operation, int DestinationKind>
+                bool QuickenedUnary(Script hScript,
+                                    AVM_RuntimeValue *pOperandList);
+
+                // Quickened comparison for a conditional jump...
+                template <int Operation, int Kind0, int Kind1>
+                bool QuickenedCompare(Script hScript,
+                                      AVM_RuntimeValue *pOperandList);
+
+                // Quickened push, checked unless its function's stack depth
+                //  was checked when it was called...
+                template <int Kind, bool bStackBounded>
+                bool QuickenedPush(Script hScript,
+                                   AVM_RuntimeValue *pOperandList);
+
+                // Quickened pop...
+                template <int Kind>
+                bool QuickenedPop(Script hScript,
+                                  AVM_RuntimeValue *pOperandList);
+
+            // Miscellaneous...
+
+                // Generate a random number within zero and range inclusive...
+                int32 GenerateRandomNumber(int32 nRange);
     };
 }
 
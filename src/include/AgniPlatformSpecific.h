@@ -41,17 +41,76 @@
 
         // Unknown compiler...
         #else
-            #error I don't know how to set the structure packing attributes for your compiler...
+            #error I do not know how to set the structure packing attributes for your compiler...
         #endif
 
 
-    // 32-bit little-endian x86 machine running some flavour of Linux...
+    // Labels as values for the threaded dispatch engine, where available...
+    #if defined(__GNUC__) && !defined(AGNI_NO_COMPUTED_GOTO)
+        #define AGNI_COMPUTED_GOTO
+    #endif
+
+    // Native code generation for the native dispatch engine, where the
+    //  compiler knows how to emit it...
+    #if defined(__x86_64__) && (defined(linux) || defined(__linux)) && \
+        !defined(AGNI_NO_NATIVE_CODE)
+        #define AGNI_NATIVE_CODE
+    #endif
+
+    // Runtime stacks reserved between guard pages, where requested and the
+    //  compiler can unwind out of the handler for a fault on one...
+    #if defined(AGNI_GUARDED_STACKS) && \
+        !(defined(__GNUC__) && (defined(linux) || defined(__linux)))
+        #undef AGNI_GUARDED_STACKS
+    #endif
+
+    // Pool of worker threads running scripts in parallel, where POSIX threads
+    //  are available, or scripts run serially on the caller's thread...
+    #if defined(__GNUC__) && (defined(linux) || defined(__linux)) && \
+        !defined(AGNI_NO_WORKER_THREADS)
+        #define AGNI_WORKER_THREADS
+    #endif
+
+    // Atomic operations on an unsigned long long, for the lock-free default
+    //  allocator...
+
+        // Using a real compiler...
+        #if defined(__GNUC__)
+            #define AGNI_ATOMIC_LOAD(pTarget) \
+                __atomic_load_n((pTarget), __ATOMIC_ACQUIRE)
+            #define AGNI_ATOMIC_COMPARE_AND_SWAP(pTarget, Expected, Desired) \
+                __sync_bool_compare_and_swap((pTarget), (Expected), (Desired))
+            #define AGNI_ATOMIC_ADD(pTarget, Amount) \
+                __sync_fetch_and_add((pTarget), (Amount))
+
+        // Using Visual C++...
+        #elif defined(_MSC_VER)
+            #include <intrin.h>
+            #define AGNI_ATOMIC_LOAD(pTarget) \
+                ((unsigned long long) _InterlockedCompareExchange64( \
+                    (volatile __int64 *) (pTarget), 0, 0))
+            #define AGNI_ATOMIC_COMPARE_AND_SWAP(pTarget, Expected, Desired) \
+                (_InterlockedCompareExchange64((volatile __int64 *) (pTarget), \
+                    (__int64) (Desired), (__int64) (Expected)) == \
+                    (__int64) (Expected))
+            #define AGNI_ATOMIC_ADD(pTarget, Amount) \
+                _InterlockedExchangeAdd64((volatile __int64 *) (pTarget), \
+                    (__int64) (Amount))
+
+        // Unknown compiler...
+        #else
+            #error I do not know how to perform atomic operations with your compiler...
+        #endif
+
+    // 32 or 64-bit little-endian x86 machine running some flavour of Linux,
+    //  whose primitives are the same size on either...
     #if (defined(__i686__) || defined(__i586__) || defined(__i486__) || \
-            defined(__i386__)) && \
+            defined(__i386__) || defined(__x86_64__)) && \
         (defined(Linux) || defined(linux) || defined(__linux))
 
         // Includes...
-        #include <sys/times.h>
+        #include <errno.h>
+        #include <time.h>
         #include <unistd.h>
 
         // Agni namespace...
@@ -79,9 +138,35 @@
 
             // Functions...
 
-                // Get the current time in milliseconds...
+                // Get the current time in microseconds, on a clock that only
+                //  ever moves forward...
+                inline unsigned long long GetSystemMicroSeconds()
+                {
+                    // Variables...
+                    struct timespec Now;
+
+                    // Read...
+                    ::clock_gettime(CLOCK_MONOTONIC, &Now);
+                    return (unsigned long long) Now.tv_sec * 1000000 +
+                           Now.tv_nsec / 1000;
+                }
+
+                // Get the current time in milliseconds, on the same clock...
                 #define GetSystemMilliSeconds()    \
-                    ::times(NULL) * 1000 / ::sysconf(_SC_CLK_TCK)
+                    ((uint32) (GetSystemMicroSeconds() / 1000))
+
+                // Sleep for a number of microseconds...
+                inline void SleepMicroSeconds(unsigned long long Duration)
+                {
+                    // Variables...
+                    struct timespec Remaining;
+
+                    // Sleep, and again for whatever is left if interrupted...
+                    Remaining.tv_sec    = (time_t) (Duration / 1000000);
+                    Remaining.tv_nsec   = (long) (Duration % 1000000) * 1000;
+                    while(::nanosleep(&Remaining, &Remaining) != 0 &&
+                          errno == EINTR);
+                }
         }
 
     // 32-bit little-endian x86 machine running Winblows...
@@ -116,9 +201,33 @@
 
             // Functions...
 
-                // Get the current time in clock ticks...
+                // Get the current time in microseconds, on a clock that only
+                //  ever moves forward...
+                inline unsigned long long GetSystemMicroSeconds()
+                {
+                    // Variables...
+                    LARGE_INTEGER   Frequency;
+                    LARGE_INTEGER   Now;
+
+                    // Read, scaling whole seconds and the remainder apart so
+                    //  it cannot overflow...
+                    ::QueryPerformanceFrequency(&Frequency);
+                    ::QueryPerformanceCounter(&Now);
+                    return (unsigned long long)
+                            (Now.QuadPart / Frequency.QuadPart) * 1000000 +
+                           (unsigned long long)
+                            (Now.QuadPart % Frequency.QuadPart) * 1000000 /
+                            Frequency.QuadPart;
+                }
+
+                // Get the current time in milliseconds, on the same clock...
                 #define GetSystemMilliSeconds() \
-                    ::GetTickCount()
+                    ((uint32) (GetSystemMicroSeconds() / 1000))
+
+                // Sleep for a number of microseconds, rounded up to the
+                //  milliseconds the system sleeps in...
+                inline void SleepMicroSeconds(unsigned long long Duration)
+                    { ::Sleep((DWORD) ((Duration + 999) / 1000)); }
         }
 
     // Unknown target platform, bail out...
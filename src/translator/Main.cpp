@@ -0,0 +1,35 @@
+/*
+  Name:         Main.cpp
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  Entry point for command line interface to AgniTranslator...
+*/
+
+// Includes...
+
+    // Translator definition...
+    #include "Translator.h"
+    
+    // POSIX compliant exit status codes...
+    #include <cstdlib>
+
+// Entry point...
+int main(int const nArguments, char *ppszArguments[])
+{
+    // Translator parameters...
+    Agni::Translator::Parameters TranslatorParameters;
+    
+    // Parse command line and exit if recommended...
+    if(!TranslatorParameters.ParseCommandLine(nArguments, ppszArguments))
+        return 0;
+    
+    // Initialize translator...
+    Agni::Translator Translator(TranslatorParameters);
+
+    // Translate ok...
+    if(Translator.Translate())
+        return EXIT_SUCCESS;
+
+    // Translate failed...
+    else
+        return EXIT_FAILURE;
+}
@@ -0,0 +1,1152 @@
+/*
+  Name:         Translator.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  Routines to translate an Agni executable ahead of time into a
+                C++ translation unit a host links in and loads as a
+                precompiled script...
+*/
+
+// Includes...
+#include "Translator.h"
+#include <getopt.h>
+#include <iostream>
+#include <cstdarg>
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Mnemonics by operation code, for comments in the output...
+static const char *ppszMnemonics[] =
+{
+    "Unknown",
+    "Mov", "Add", "Sub", "Mul", "Div", "Mod", "Exp", "Neg", "Inc", "Dec",
+    "And", "Or", "XOr", "Not", "ShL", "ShR",
+    "Concat", "GetChar", "SetChar",
+    "Jmp", "JE", "JNE", "JG", "JL", "JGE", "JLE",
+    "Push", "Pop",
+    "Call", "Ret", "CallHost",
+    "Rand", "Pause", "Exit"
+};
+
+// Format an integer literal valid in C++, even the most negative one...
+static std::string IntegerLiteral(int32 nValue)
+{
+    // Variables...
+    char    szBuffer[32]    = {0};
+
+    // Most negative has no positive counterpart to negate...
+    if(nValue == (int32) 0x80000000)
+        return "(-2147483647 - 1)";
+
+    // Anything else...
+    sprintf(szBuffer, "%d", nValue);
+    return szBuffer;
+}
+
+// Constructor...
+Translator::Translator(Parameters &_UserParameters)
+    :   UserParameters(_UserParameters),
+        unImageOffset(0),
+        bBackwardBranches(false),
+        hOutput(NULL)
+{
+    // Clear the main executable header...
+    memset(&MainHeader, 0, sizeof(Agni_MainHeader));
+}
+
+// Display an error and abort...
+void Translator::ErrorGeneral(const char *pszFormat, ...)
+{
+    // Variables...
+    va_list     ArgumentList;
+    char        szBuffer[1024]  = {0};
+
+    // Format...
+    va_start(ArgumentList, pszFormat);
+    vsnprintf(szBuffer, sizeof(szBuffer), pszFormat, ArgumentList);
+    va_end(ArgumentList);
+
+    // Display...
+    std::cout << UserParameters.GetProcessName() << ": " << szBuffer
+              << std::endl;
+
+    // Abort...
+    throw false;
+}
+
+// Does any instruction branch to the given one?
+bool Translator::IsBranchTarget(uint32 unIndex) const
+{
+    // Check...
+    return BranchTargets[unIndex];
+}
+
+// Load bytes from the executable or abort...
+void Translator::LoadBytes(void *pStorageBuffer, uint32 unSize)
+{
+    // Check for reading past the end of the image...
+    if(unSize > Image.size() - unImageOffset)
+        ErrorGeneral("%s is truncated", UserParameters.GetInputFile().c_str());
+
+    // Read and advance...
+    memcpy(pStorageBuffer, &Image[unImageOffset], unSize);
+    unImageOffset += unSize;
+}
+
+// Load the input executable, whole...
+void Translator::LoadInput()
+{
+    // Variables...
+    FILE   *hInput          = NULL;
+    uint8   Buffer[4096];
+    size_t  BytesRead       = 0;
+
+    // Open...
+    hInput = fopen(UserParameters.GetInputFile().c_str(), "rb");
+
+        // Failed...
+        if(!hInput)
+            ErrorGeneral("cannot open %s",
+                         UserParameters.GetInputFile().c_str());
+
+    // Read until done...
+    while((BytesRead = fread(Buffer, 1, sizeof(Buffer), hInput)) > 0)
+        Image.insert(Image.end(), Buffer, Buffer + BytesRead);
+
+    // Done...
+    fclose(hInput);
+}
+
+// Parse the executable the way the virtual machine does...
+void Translator::ParseExecutable()
+{
+    // Variables...
+    char                            szSignature[8];
+    Agni_InstructionStreamHeader    InstructionStreamHeader;
+    Agni_StringStreamHeader         StringStreamHeader;
+    Agni_FunctionTableHeader        FunctionTableHeader;
+
+    // Main header...
+    LoadBytes(&MainHeader, sizeof(Agni_MainHeader));
+
+        // Check signature...
+        memset(szSignature, '\x90', sizeof(szSignature));
+        memcpy(&szSignature[2], "AGNI", strlen("AGNI"));
+        if(memcmp(MainHeader.Signature, szSignature, sizeof(szSignature)) != 0)
+            ErrorGeneral("%s is not an Agni executable",
+                         UserParameters.GetInputFile().c_str());
+
+    // Instruction stream...
+    LoadBytes(&InstructionStreamHeader, sizeof(InstructionStreamHeader));
+    Instructions.resize(InstructionStreamHeader.unSize);
+    for(uint32 unIndex = 0; unIndex < InstructionStreamHeader.unSize; unIndex++)
+    {
+        // Variables...
+        AT_Instruction &Instruction = Instructions[unIndex];
+
+        // Operation code and operand count...
+        memset(&Instruction, 0, sizeof(Instruction));
+        LoadBytes(&Instruction.usOperationCode, sizeof(uint16));
+        LoadBytes(&Instruction.OperandCount, sizeof(uint8));
+
+            // More than any instruction takes...
+            if(Instruction.OperandCount > 3)
+                ErrorGeneral("instruction %u has %u operands", unIndex,
+                             Instruction.OperandCount);
+
+        // Each operand...
+        for(uint8 Operand = 0; Operand < Instruction.OperandCount; Operand++)
+        {
+            // Variables...
+            AT_Operand &Current = Instruction.Operands[Operand];
+
+            // Type...
+            LoadBytes(&Current.OperandType, sizeof(uint8));
+
+            // Data, by type...
+            switch(Current.OperandType)
+            {
+                // Four byte values...
+                case OT_AVM_INTEGER:
+                case OT_AVM_FLOAT:
+                case OT_AVM_INDEX_STRING:
+                case OT_AVM_INDEX_INSTRUCTION:
+                case OT_AVM_INDEX_STACK_ABSOLUTE:
+                case OT_AVM_INDEX_FUNCTION:
+                case OT_AVM_INDEX_FUNCTION_HOST:
+                    LoadBytes(&Current.nInteger, sizeof(int32));
+                    break;
+
+                // Base and offset indices...
+                case OT_AVM_INDEX_STACK_RELATIVE:
+                    LoadBytes(&Current.nIndex[0], sizeof(int32));
+                    LoadBytes(&Current.nIndex[1], sizeof(int32));
+                    break;
+
+                // Register identifiers...
+                case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
+                case OT_AVM_REGISTER:
+                    LoadBytes(&Current.Register, sizeof(uint8));
+                    break;
+
+                // Unknown...
+                default:
+                    ErrorGeneral("instruction %u has an unknown operand type",
+                                 unIndex);
+            }
+        }
+    }
+
+    // String stream, which only the virtual machine needs...
+    LoadBytes(&StringStreamHeader, sizeof(StringStreamHeader));
+    for(uint32 unIndex = 0; unIndex < StringStreamHeader.unSize; unIndex++)
+    {
+        // Variables...
+        uint32  unLength    = 0;
+
+        // Skip...
+        LoadBytes(&unLength, sizeof(uint32));
+        if(unLength > Image.size() - unImageOffset)
+            ErrorGeneral("%s is truncated",
+                         UserParameters.GetInputFile().c_str());
+        unImageOffset += unLength;
+    }
+
+    // Function table, for naming entry points in the output...
+    LoadBytes(&FunctionTableHeader, sizeof(FunctionTableHeader));
+    Functions.resize(FunctionTableHeader.unSize);
+    for(uint32 unIndex = 0; unIndex < FunctionTableHeader.unSize; unIndex++)
+    {
+        // Variables...
+        uint8   ParameterCount  = 0;
+        uint32  unLocalDataSize = 0;
+        uint8   NameLength      = 0;
+        char    szName[256]     = {0};
+
+        // Entry point, parameters, locals, and name...
+        LoadBytes(&Functions[unIndex].unEntryPoint, sizeof(uint32));
+        LoadBytes(&ParameterCount, sizeof(uint8));
+        LoadBytes(&unLocalDataSize, sizeof(uint32));
+        LoadBytes(&NameLength, sizeof(uint8));
+        LoadBytes(szName, NameLength);
+        Functions[unIndex].sName = szName;
+    }
+
+    // Find every instruction branched to, and whether any branch backward...
+    BranchTargets.assign(Instructions.size() + 1, false);
+    for(uint32 unIndex = 0; unIndex < Instructions.size(); unIndex++)
+    {
+        // Variables...
+        const AT_Instruction   &Instruction = Instructions[unIndex];
+        const AT_Operand       *pTarget     = NULL;
+
+        // Branch target operand, if any...
+        if(Instruction.usOperationCode == INSTRUCTION_AVM_JMP)
+            pTarget = &Instruction.Operands[0];
+        else if(Instruction.usOperationCode >= INSTRUCTION_AVM_JE &&
+                Instruction.usOperationCode <= INSTRUCTION_AVM_JLE)
+            pTarget = &Instruction.Operands[2];
+        else
+            continue;
+
+        // Flag it, if known now...
+        if(pTarget->OperandType == OT_AVM_INDEX_INSTRUCTION &&
+           (uint32) pTarget->nInteger < Instructions.size())
+        {
+            // Flag...
+            BranchTargets[pTarget->nInteger] = true;
+
+            // Backward...
+            if((uint32) pTarget->nInteger <= unIndex)
+                bBackwardBranches = true;
+        }
+    }
+}
+
+// Expression naming the variable or register an operand refers to, or empty
+//  if it is neither...
+std::string Translator::SlotExpression(const AT_Operand &Operand) const
+{
+    // Variables...
+    char    szBuffer[64]    = {0};
+
+    // Check type...
+    switch(Operand.OperandType)
+    {
+        // Global or local variable...
+        case OT_AVM_INDEX_STACK_ABSOLUTE:
+            sprintf(szBuffer, "Context.%s(%d)",
+                    (Operand.nIndex[0] < 0) ? "Local" : "Global",
+                    Operand.nIndex[0]);
+            break;
+
+        // Register, if it is one we know of...
+        case OT_AVM_REGISTER:
+            if(Operand.Register == REGISTER_AVM_T0)
+                sprintf(szBuffer, "Context.Register(REGISTER_AVM_T0)");
+            else if(Operand.Register == REGISTER_AVM_T1)
+                sprintf(szBuffer, "Context.Register(REGISTER_AVM_T1)");
+            else if(Operand.Register == REGISTER_AVM_RETURN)
+                sprintf(szBuffer, "Context.Register(REGISTER_AVM_RETURN)");
+            break;
+
+        // Neither...
+        default:
+            break;
+    }
+
+    // Done...
+    return szBuffer;
+}
+
+// Translate executable...
+boolean Translator::Translate()
+{
+    // Variables...
+    std::string     sName;
+
+    // Try to translate...
+    try
+    {
+        // Load and parse...
+        LoadInput();
+        ParseExecutable();
+
+        // Open output...
+        if(UserParameters.GetOutputFile() == "stdout")
+            hOutput = stdout;
+        else
+        {
+            // Create...
+            hOutput = fopen(UserParameters.GetOutputFile().c_str(), "w");
+        }
+
+            // Failed...
+            if(!hOutput)
+                ErrorGeneral("cannot create %s",
+                             UserParameters.GetOutputFile().c_str());
+
+        // Header, naming the output without its path...
+        sName = UserParameters.GetOutputFile();
+        if(sName.find_last_of("\\/") != std::string::npos)
+            sName.erase(0, sName.find_last_of("\\/") + 1);
+        Write("/*\n"
+              "  Name:         %s (generated)\n"
+              "  Description:  Precompiled script translated from %s by the\n"
+              "                Agni translator. Do not edit...\n"
+              "*/\n\n",
+              sName.c_str(), UserParameters.GetInputFile().c_str());
+
+        // Includes...
+        Write("// Includes...\n\n"
+              "    // Virtual machine definition...\n"
+              "    #include \"Agni.h\"\n\n"
+              "// Using the Agni namespace...\n"
+              "using namespace Agni;\n\n"
+              "// Runtime value...\n"
+              "typedef VirtualMachine::PrecompiledContext::Value Value;\n\n");
+
+        // Image, body, and the precompiled script tying them together...
+        WriteImage();
+        WriteBody();
+        Write("// Precompiled script to load with VirtualMachine::LoadScript()"
+              "...\n"
+              "extern const VirtualMachine::PrecompiledScript %s;\n"
+              "const VirtualMachine::PrecompiledScript %s =\n"
+              "{\n"
+              "    Image, sizeof(Image), Body\n"
+              "};\n\n",
+              UserParameters.GetScriptName().c_str(),
+              UserParameters.GetScriptName().c_str());
+
+        // Be verbose...
+        if(UserParameters.ShouldBeVerbose())
+            std::cout << UserParameters.GetProcessName() << ": translated "
+                      << Instructions.size() << " instructions and "
+                      << Functions.size() << " functions" << std::endl;
+    }
+
+        // Failed...
+        catch(bool)
+        {
+            // Close and remove partial output...
+            if(hOutput && hOutput != stdout)
+            {
+                fclose(hOutput);
+                remove(UserParameters.GetOutputFile().c_str());
+            }
+            hOutput = NULL;
+
+            // Abort...
+            return false;
+        }
+
+    // Close output...
+    if(hOutput != stdout)
+        fclose(hOutput);
+    hOutput = NULL;
+
+    // Done...
+    return true;
+}
+
+// Write a branch from one instruction to another...
+void Translator::WriteBranch(uint32 unFrom, uint32 unTarget,
+                             const char *pszIndent)
+{
+    // Forward branches cannot loop, so go straight there...
+    if(unTarget > unFrom)
+    {
+        Write("%sgoto Instruction%u;\n", pszIndent, unTarget);
+        return;
+    }
+
+    // Backward branches give the scheduler a chance to run now and then...
+    Write("%sif(--unSafePoints == 0)\n"
+          "%s{\n"
+          "%s    Context.SetInstructionPointer(%u);\n"
+          "%s    return VirtualMachine::Precompiled_SafePoint;\n"
+          "%s}\n"
+          "%sgoto Instruction%u;\n",
+          pszIndent, pszIndent, pszIndent, unTarget, pszIndent, pszIndent,
+          pszIndent, unTarget);
+}
+
+// Write the body...
+void Translator::WriteBody()
+{
+    // Variables...
+    bool    bDispatches = false;
+
+    // Calls and returns continue wherever the instruction pointer lands...
+    for(uint32 unIndex = 0; unIndex < Instructions.size(); unIndex++)
+    {
+        // Found one...
+        if(Instructions[unIndex].usOperationCode == INSTRUCTION_AVM_CALL ||
+           Instructions[unIndex].usOperationCode == INSTRUCTION_AVM_RET)
+            bDispatches = true;
+    }
+
+    // Prologue...
+    Write("// Body, running a thread from its instruction pointer up to its "
+          "next safe\n"
+          "//  point...\n"
+          "static VirtualMachine::PrecompiledStatus Body(\n"
+          "    VirtualMachine::PrecompiledContext &Context)\n"
+          "{\n"
+          "    // Variables...\n");
+    if(bBackwardBranches)
+        Write("    uint32  unSafePoints    = "
+              "PRECOMPILED_SAFE_POINT_INTERVAL;\n");
+    Write("    uint32  unCulprit       = Context.GetInstructionPointer();\n\n"
+          "    // Execute until the next safe point...\n"
+          "    try\n"
+          "    {\n");
+    if(bDispatches)
+        Write("        // Resume wherever the instruction pointer is...\n"
+              "        Dispatch:\n");
+    Write("        switch(Context.GetInstructionPointer())\n"
+          "        {\n");
+
+    // Each instruction...
+    for(uint32 unIndex = 0; unIndex < Instructions.size(); unIndex++)
+        WriteInstruction(unIndex);
+
+    // Running off the end of the stream terminates the script, as does
+    //  resuming anywhere else...
+    Write("            // Running off the end terminates the script...\n"
+          "            case %u:\n"
+          "            default:\n",
+          (uint32) Instructions.size());
+    if(IsBranchTarget(Instructions.size()))
+        Write("            Instruction%u:\n", (uint32) Instructions.size());
+    Write("                Context.Exit(%u);\n"
+          "                return VirtualMachine::Precompiled_SafePoint;\n"
+          "        }\n"
+          "    }\n\n"
+          "        // Execution exception, leave instruction pointer at "
+          "culprit...\n"
+          "        catch(...)\n"
+          "        {\n"
+          "            // Remember where the thread was...\n"
+          "            Context.SetInstructionPointer(unCulprit);\n\n"
+          "            // Pass on to host...\n"
+          "            throw;\n"
+          "        }\n"
+          "}\n\n",
+          (uint32) Instructions.size());
+}
+
+// Write the executable image as a byte array...
+void Translator::WriteImage()
+{
+    // Declaration...
+    Write("// Executable image, still loaded for its tables and literals...\n"
+          "static const uint8 Image[] =\n"
+          "{");
+
+    // Each byte...
+    for(size_t Offset = 0; Offset < Image.size(); Offset++)
+        Write("%s0x%02X%s", (Offset % 12 == 0) ? "\n    " : " ", Image[Offset],
+              (Offset + 1 < Image.size()) ? "," : "");
+
+    // Done...
+    Write("\n};\n\n");
+}
+
+// Write one instruction...
+void Translator::WriteInstruction(uint32 unIndex)
+{
+    // Variables...
+    const AT_Instruction   &Instruction     = Instructions[unIndex];
+    uint16                  usOperationCode = Instruction.usOperationCode;
+    const AT_Operand       &Operand0        = Instruction.Operands[0];
+    const AT_Operand       &Operand1        = Instruction.Operands[1];
+    std::string             sSlot0          = SlotExpression(Operand0);
+    std::string             sSlot1          = SlotExpression(Operand1);
+    const AT_Operand       *pTarget         = NULL;
+    const char             *pszOperator     = NULL;
+
+    // Name any function entered here...
+    for(size_t Function = 0; Function < Functions.size(); Function++)
+    {
+        // Found...
+        if(Functions[Function].unEntryPoint == unIndex)
+            Write("            // Function %s...\n\n",
+                  Functions[Function].sName.c_str());
+    }
+
+    // Label...
+    Write("            // %s...\n"
+          "            case %u:\n",
+          (usOperationCode < sizeof(ppszMnemonics) / sizeof(ppszMnemonics[0]))
+            ? ppszMnemonics[usOperationCode] : ppszMnemonics[0],
+          unIndex);
+    if(IsBranchTarget(unIndex))
+        Write("            Instruction%u:\n", unIndex);
+
+    // Translate by operation code...
+    switch(usOperationCode)
+    {
+        // Move...
+        case INSTRUCTION_AVM_MOV:
+        {
+            // Into a variable from a numeric literal, unless it holds a string
+            //  that would need freeing...
+            if(!sSlot0.empty() &&
+               (Operand1.OperandType == OT_AVM_INTEGER ||
+                (Operand1.OperandType == OT_AVM_FLOAT &&
+                 Operand1.fFloat - Operand1.fFloat == 0.0f)))
+            {
+                // Check...
+                Write("            {\n"
+                      "                Value &Destination = %s;\n"
+                      "                if(Destination.OperandType != "
+                      "OT_AVM_STRING)\n"
+                      "                {\n", sSlot0.c_str());
+
+                // Integer...
+                if(Operand1.OperandType == OT_AVM_INTEGER)
+                    Write("                    Destination.OperandType     = "
+                          "OT_AVM_INTEGER;\n"
+                          "                    Destination.nLiteralInteger = "
+                          "%s;\n", IntegerLiteral(Operand1.nInteger).c_str());
+
+                // Float...
+                else
+                    Write("                    Destination.OperandType     = "
+                          "OT_AVM_FLOAT;\n"
+                          "                    Destination.fLiteralFloat   = "
+                          "%.9ef;\n", Operand1.fFloat);
+
+                // Otherwise...
+                Write("                }\n"
+                      "                else\n"
+                      "                {\n");
+                WriteQuickened(unIndex, "                    ");
+                Write("                }\n"
+                      "            }\n");
+            }
+
+            // Into a variable from another, unless either holds a string...
+            else if(!sSlot0.empty() && !sSlot1.empty())
+            {
+                // Check...
+                Write("            {\n"
+                      "                Value &Destination = %s;\n"
+                      "                Value &Source = %s;\n"
+                      "                if(Destination.OperandType != "
+                      "OT_AVM_STRING &&\n"
+                      "                   Source.OperandType != "
+                      "OT_AVM_STRING)\n"
+                      "                    Destination = Source;\n"
+                      "                else\n"
+                      "                {\n", sSlot0.c_str(), sSlot1.c_str());
+                WriteQuickened(unIndex, "                    ");
+                Write("                }\n"
+                      "            }\n");
+            }
+
+            // Anything else...
+            else
+                WriteQuickened(unIndex, "            ");
+
+            // Done...
+            break;
+        }
+
+        // Integral arithmetic and bitwise operations...
+        case INSTRUCTION_AVM_ADD: pszOperator = "+="; goto Arithmetic;
+        case INSTRUCTION_AVM_SUB: pszOperator = "-="; goto Arithmetic;
+        case INSTRUCTION_AVM_MUL: pszOperator = "*="; goto Arithmetic;
+        case INSTRUCTION_AVM_AND: pszOperator = "&="; goto Arithmetic;
+        case INSTRUCTION_AVM_OR:  pszOperator = "|="; goto Arithmetic;
+        case INSTRUCTION_AVM_XOR: pszOperator = "^="; goto Arithmetic;
+        Arithmetic:
+        {
+            // Variables...
+            bool    bBitwise    = (usOperationCode >= INSTRUCTION_AVM_AND);
+
+            // On a variable from an integer literal... (bitwise operations
+            //  leave anything but integers alone)
+            if(!sSlot0.empty() && Operand1.OperandType == OT_AVM_INTEGER)
+            {
+                // Bitwise...
+                if(bBitwise)
+                    Write("            {\n"
+                          "                Value &Destination = %s;\n"
+                          "                if(Destination.OperandType == "
+                          "OT_AVM_INTEGER)\n"
+                          "                    Destination.nLiteralInteger %s "
+                          "%s;\n"
+                          "            }\n", sSlot0.c_str(), pszOperator,
+                          IntegerLiteral(Operand1.nInteger).c_str());
+
+                // Arithmetic...
+                else
+                    Write("            %s.nLiteralInteger %s %s;\n",
+                          sSlot0.c_str(), pszOperator,
+                          IntegerLiteral(Operand1.nInteger).c_str());
+            }
+
+            // On a variable from another holding an integer...
+            else if(!sSlot0.empty() && !sSlot1.empty())
+            {
+                // Check...
+                Write("            {\n"
+                      "                Value &Destination = %s;\n"
+                      "                Value &Source = %s;\n"
+                      "                if(Source.OperandType == "
+                      "OT_AVM_INTEGER)\n"
+                      "                {\n", sSlot0.c_str(), sSlot1.c_str());
+
+                // Bitwise...
+                if(bBitwise)
+                    Write("                    if(Destination.OperandType == "
+                          "OT_AVM_INTEGER)\n"
+                          "                        Destination.nLiteralInteger "
+                          "%s\n"
+                          "                            Source.nLiteralInteger;\n",
+                          pszOperator);
+
+                // Arithmetic...
+                else
+                    Write("                    Destination.nLiteralInteger %s "
+                          "Source.nLiteralInteger;\n", pszOperator);
+
+                // Otherwise...
+                Write("                }\n"
+                      "                else\n"
+                      "                {\n");
+                WriteQuickened(unIndex, "                    ");
+                Write("                }\n"
+                      "            }\n");
+            }
+
+            // Anything else...
+            else
+                WriteQuickened(unIndex, "            ");
+
+            // Done...
+            break;
+        }
+
+        // Increment and decrement...
+        case INSTRUCTION_AVM_INC:
+        case INSTRUCTION_AVM_DEC:
+        {
+            // A variable holding an integer...
+            if(!sSlot0.empty())
+            {
+                // Check...
+                Write("            {\n"
+                      "                Value &Destination = %s;\n"
+                      "                if(Destination.OperandType == "
+                      "OT_AVM_INTEGER)\n"
+                      "                    Destination.nLiteralInteger%s;\n"
+                      "                else\n"
+                      "                {\n", sSlot0.c_str(),
+                      (usOperationCode == INSTRUCTION_AVM_INC) ? "++" : "--");
+                WriteQuickened(unIndex, "                    ");
+                Write("                }\n"
+                      "            }\n");
+            }
+
+            // Anything else...
+            else
+                WriteQuickened(unIndex, "            ");
+
+            // Done...
+            break;
+        }
+
+        // Operations only ever run by their quickened handler...
+        case INSTRUCTION_AVM_DIV:
+        case INSTRUCTION_AVM_MOD:
+        case INSTRUCTION_AVM_NEG:
+        case INSTRUCTION_AVM_NOT:
+        case INSTRUCTION_AVM_SHL:
+        case INSTRUCTION_AVM_SHR:
+        case INSTRUCTION_AVM_PUSH:
+        case INSTRUCTION_AVM_POP:
+            WriteQuickened(unIndex, "            ");
+            break;
+
+        // Unconditional jump...
+        case INSTRUCTION_AVM_JMP:
+        {
+            // Target only known at runtime...
+            if(Operand0.OperandType != OT_AVM_INDEX_INSTRUCTION ||
+               (uint32) Operand0.nInteger >= Instructions.size())
+            {
+                Write("            return Context.Interpret(%u);\n", unIndex);
+                break;
+            }
+
+            // Branch...
+            WriteBranch(unIndex, Operand0.nInteger, "            ");
+            break;
+        }
+
+        // Conditional jumps...
+        case INSTRUCTION_AVM_JE:  pszOperator = "=="; goto Compare;
+        case INSTRUCTION_AVM_JNE: pszOperator = "!="; goto Compare;
+        case INSTRUCTION_AVM_JG:  pszOperator = ">";  goto Compare;
+        case INSTRUCTION_AVM_JL:  pszOperator = "<";  goto Compare;
+        case INSTRUCTION_AVM_JGE: pszOperator = ">="; goto Compare;
+        case INSTRUCTION_AVM_JLE: pszOperator = "<="; goto Compare;
+        Compare:
+        {
+            // Target only known at runtime...
+            pTarget = &Instruction.Operands[2];
+            if(pTarget->OperandType != OT_AVM_INDEX_INSTRUCTION ||
+               (uint32) pTarget->nInteger >= Instructions.size())
+            {
+                Write("            return Context.Interpret(%u);\n", unIndex);
+                break;
+            }
+
+            // Integer variable against an integer literal or variable, as
+            //  integral comparisons read the second operand's raw value...
+            if(!sSlot0.empty() &&
+               (!sSlot1.empty() || Operand1.OperandType == OT_AVM_INTEGER))
+            {
+                // Compare...
+                Write("            {\n"
+                      "                Value &Operand = %s;\n"
+                      "                if(Operand.OperandType == "
+                      "OT_AVM_INTEGER)\n"
+                      "                {\n"
+                      "                    if(Operand.nLiteralInteger %s %s%s)\n"
+                      "                    {\n",
+                      sSlot0.c_str(), pszOperator,
+                      sSlot1.empty() ?
+                        IntegerLiteral(Operand1.nInteger).c_str() :
+                        sSlot1.c_str(),
+                      sSlot1.empty() ? "" : ".nLiteralInteger");
+                WriteBranch(unIndex, pTarget->nInteger,
+                            "                        ");
+                Write("                    }\n"
+                      "                }\n"
+                      "                else\n"
+                      "                {\n"
+                      "                    unCulprit = %u;\n"
+                      "                    if(!Context.IsQuickened(%u))\n"
+                      "                        return Context.Interpret(%u);\n"
+                      "                    if(Context.Quickened(%u))\n"
+                      "                    {\n",
+                      unIndex, unIndex, unIndex, unIndex);
+                WriteBranch(unIndex, pTarget->nInteger,
+                            "                        ");
+                Write("                    }\n"
+                      "                }\n"
+                      "            }\n");
+                break;
+            }
+
+            // Anything else by its quickened handler...
+            Write("            unCulprit = %u;\n"
+                  "            if(!Context.IsQuickened(%u))\n"
+                  "                return Context.Interpret(%u);\n"
+                  "            if(Context.Quickened(%u))\n"
+                  "            {\n", unIndex, unIndex, unIndex, unIndex);
+            WriteBranch(unIndex, pTarget->nInteger, "                ");
+            Write("            }\n");
+            break;
+        }
+
+        // Call a function, then continue at its entry point...
+        case INSTRUCTION_AVM_CALL:
+            Write("            unCulprit = %u;\n"
+                  "            Context.Call(%u);\n"
+                  "            goto Dispatch;\n", unIndex, unIndex);
+            break;
+
+        // Return from a function, then continue at the return address...
+        case INSTRUCTION_AVM_RET:
+            Write("            unCulprit = %u;\n"
+                  "            if(Context.Return())\n"
+                  "                return VirtualMachine::"
+                  "Precompiled_StackBase;\n"
+                  "            goto Dispatch;\n", unIndex);
+            break;
+
+        // Call a host function, which may pause, stop, or redirect us...
+        case INSTRUCTION_AVM_CALLHOST:
+            Write("            unCulprit = %u;\n"
+                  "            Context.CallHost(%u);\n"
+                  "            return VirtualMachine::Precompiled_SafePoint;\n",
+                  unIndex, unIndex);
+            break;
+
+        // Pause...
+        case INSTRUCTION_AVM_PAUSE:
+            Write("            unCulprit = %u;\n"
+                  "            Context.Pause(%u);\n"
+                  "            return VirtualMachine::Precompiled_SafePoint;\n",
+                  unIndex, unIndex);
+            break;
+
+        // Exit...
+        case INSTRUCTION_AVM_EXIT:
+            Write("            Context.Exit(%u);\n"
+                  "            return VirtualMachine::Precompiled_SafePoint;\n",
+                  unIndex);
+            break;
+
+        // String operations, exponentiation, random numbers, and anything
+        //  else are left to the interpreter...
+        default:
+            Write("            return Context.Interpret(%u);\n", unIndex);
+            break;
+    }
+
+    // Separate from the next...
+    Write("\n");
+}
+
+// Write the slow path running an instruction through its quickened handler,
+//  or the interpreter if it has none...
+void Translator::WriteQuickened(uint32 unIndex, const char *pszIndent)
+{
+    // Write...
+    Write("%sunCulprit = %u;\n"
+          "%sif(!Context.IsQuickened(%u))\n"
+          "%s    return Context.Interpret(%u);\n"
+          "%sContext.Quickened(%u);\n",
+          pszIndent, unIndex, pszIndent, unIndex, pszIndent, unIndex,
+          pszIndent, unIndex);
+}
+
+// Write formatted output...
+void Translator::Write(const char *pszFormat, ...)
+{
+    // Variables...
+    va_list     ArgumentList;
+
+    // Write...
+    va_start(ArgumentList, pszFormat);
+    vfprintf(hOutput, pszFormat, ArgumentList);
+    va_end(ArgumentList);
+}
+
+// Deconstructor...
+Translator::~Translator()
+{
+    // Close output, if still open...
+    if(hOutput && hOutput != stdout)
+        fclose(hOutput);
+}
+
+// Parameters default constructor...
+Translator::Parameters::Parameters()
+    : sOutputFile("stdout"),
+      bVerbose(false)
+{
+
+}
+
+// Get the input file name...
+std::string const &Translator::Parameters::GetInputFile() const
+{
+    // Return it...
+    return sInputFile;
+}
+
+// Get the output file name...
+std::string const &Translator::Parameters::GetOutputFile() const
+{
+    // Return it...
+    return sOutputFile;
+}
+
+// Get the process name...
+std::string const &Translator::Parameters::GetProcessName() const
+{
+    // Return it...
+    return sProcessName;
+}
+
+// Get the name of the precompiled script to define...
+std::string const &Translator::Parameters::GetScriptName() const
+{
+    // Return it...
+    return sScriptName;
+}
+
+// Initialize from the command line automatically...
+bool Translator::Parameters::ParseCommandLine(
+    int const nArguments,
+    char * const ppszArguments[])
+{
+    // Variables...
+    int     cOption = 0;
+    int     nOption = 0;
+
+    // Extract translator executable name...
+    sProcessName = ppszArguments[0];
+
+        // Remove path...
+        if(sProcessName.find_last_of("\\/") != std::string::npos)
+            sProcessName.erase(0, sProcessName.find_last_of("\\/") + 1);
+
+    // Parse command line until done...
+    for(nOption = 1; true; nOption++)
+    {
+        // Unused option index...
+        int nOptionIndex = 0;
+
+        // Declare valid command line options...
+        static struct option LongOptions[] =
+        {
+            // Help: No parameters...
+            {"help", no_argument, NULL, 'h'},
+
+            // Name: Precompiled script's name as mandatory parameter...
+            {"name", required_argument, NULL, 'n'},
+
+            // Output: File name as parameter...
+            {"output", required_argument, NULL, 'o'},
+
+            // Translate: File name as mandatory parameter...
+            {"translate", required_argument, NULL, 't'},
+
+            // Verbose: No parameters...
+            {"verbose", no_argument, NULL, 'V'},
+
+            // Version: No parameters...
+            {"version", no_argument, NULL, 'v'},
+
+            // End of parameter list...
+            {0, 0, 0, 0}
+        };
+
+        // Prevent getopt_long from printing to stderr...
+        opterr = 0;
+
+        // Grab an option...
+        cOption = getopt_long(nArguments, ppszArguments, "hn:o:t:Vv",
+                              LongOptions, &nOptionIndex);
+
+            // End of option list...
+            if(cOption == -1)
+            {
+                // No parameters were passed, display help...
+                if(nOption == 1)
+                {
+                    PrintHelp();
+                    return false;
+                }
+
+                // Done parsing...
+                break;
+            }
+
+        // Process option...
+        switch(cOption)
+        {
+            // Help...
+            case 'h':
+
+                // Display help...
+                PrintHelp();
+
+                // No more parsing necessary...
+                return false;
+
+            // Name...
+            case 'n':
+
+                // Remember...
+                sScriptName = optarg;
+
+                // Done...
+                break;
+
+            // Output...
+            case 'o':
+
+                // Remember...
+                sOutputFile = optarg;
+
+                // Done...
+                break;
+
+            // Translate...
+            case 't':
+
+                // Remember input file name...
+                sInputFile = optarg;
+
+                // Done...
+                break;
+
+            // Verbose...
+            case 'V':
+
+                // Remember...
+                bVerbose = true;
+
+                // Done...
+                break;
+
+            // Version...
+            case 'v':
+
+                // Display version...
+                PrintVersion();
+
+                // No more parsing necessary...
+                return false;
+
+            // Missing parameter or unrecognized switch...
+            case '?':
+            default:
+
+                // Unknown switch, alert...
+                std::cout << sProcessName << ": \"" << (char) optopt
+                          << "\" unrecognized option" << std::endl;
+
+                // No more parsing necessary...
+                return false;
+        }
+    }
+
+    // Too many options...
+    if(optind < nArguments)
+    {
+        // List unknown parameters...
+        while(optind < nArguments)
+        {
+            // Display...
+            std::cout << sProcessName << ": option \""
+                      << ppszArguments[optind++] << "\" unknown" << std::endl;
+        }
+
+        // No more parsing should be done...
+        return false;
+    }
+
+    // Nothing to translate...
+    if(sInputFile.empty())
+    {
+        // Alert...
+        std::cout << sProcessName << ": no input file" << std::endl;
+        return false;
+    }
+
+    // Name the precompiled script after the input file, if not named...
+    if(sScriptName.empty())
+    {
+        // Strip path and extension...
+        sScriptName = sInputFile;
+        if(sScriptName.find_last_of("\\/") != std::string::npos)
+            sScriptName.erase(0, sScriptName.find_last_of("\\/") + 1);
+        if(sScriptName.find('.') != std::string::npos)
+            sScriptName.erase(sScriptName.find('.'));
+
+        // Make a valid identifier of it...
+        for(size_t Character = 0; Character < sScriptName.length();
+            Character++)
+        {
+            // Replace anything else...
+            if(!isalnum((unsigned char) sScriptName[Character]))
+                sScriptName[Character] = '_';
+        }
+
+        // Prefix...
+        sScriptName = "Precompiled" + sScriptName;
+    }
+
+    // Recommend ok to continue with translation...
+    return true;
+}
+
+// Print usage...
+void Translator::Parameters::PrintHelp() const
+{
+    // Display help...
+    std::cout <<
+        "Usage: agt [option(s)] [input-file] [output-file]\n"
+        "Purpose: Translates Agni executables ahead of time into C++...\n\n"
+        " Options:\n"
+        "  -h --help                    Print this help message\n"
+        "  -n --name=<symbol>           Name the precompiled script\n"
+        "  -o --output=<outfile>        Name output file\n"
+        "  -t --translate=<infile>      Input file\n"
+        "  -V --verbose                 Be verbose\n"
+        "  -v --version                 Print version information\n\n"
+        "  SYMBOL defaults to \"Precompiled\" and the input file's name.\n"
+        "  OUTFILE can be \"stdout\" or a file name. Default is \"stdout\".\n\n"
+
+        " The output defines a VirtualMachine::PrecompiledScript for the\n"
+        " host to declare extern and pass to VirtualMachine::LoadScript().\n\n"
+
+        " Examples:\n"
+        "  agt -t MyGeneratedExecutable.age -o MyPrecompiledScript.cpp\n\n"
+
+        " Written by Kip Warner. Questions or comments may be sent to\n"
+        " Kip@TheVertigo.com. You can visit me out on the wasteland at\n"
+        " http://TheVertigo.com." << std::endl << std::endl;
+}
+
+// Print version...
+void Translator::Parameters::PrintVersion() const
+{
+    // Version...
+    std::cout << "AgniTranslator "  << AGNI_VERSION_MAJOR << "."
+                                    << AGNI_VERSION_MINOR << "svn"
+                                    << AGNI_VERSION_SVN << std::endl
+                                    << std::endl
+              << "Compiler:\t"      << __VERSION__ << std::endl
+              << "Date:\t\t"        << __DATE__ << " at " << __TIME__
+                                    << std::endl
+              << "Platform:\t"      << HOST_TARGET << std::endl;
+}
+
+// Should we be verbose?
+bool Translator::Parameters::ShouldBeVerbose() const
+{
+    // Return flag...
+    return bVerbose;
+}
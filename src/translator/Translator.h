@@ -0,0 +1,230 @@
+/*
+  Name:         Translator.h (definition)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  Routines to translate an Agni executable ahead of time into a
+                C++ translation unit a host links in and loads as a
+                precompiled script...
+*/
+
+// Multiple include protection...
+#ifndef _AGNITRANSLATOR_H_
+#define _AGNITRANSLATOR_H_
+
+// Pre-processor directives...
+
+    // Includes...
+
+        // Data types...
+        #include "../include/AgniPlatformSpecific.h"
+
+        // Common structures...
+        #include "../include/AgniCommonDefinitions.h"
+
+        // Standard I/O...
+        #include <cstdio>
+
+        // Standard library...
+        #include <cstdlib>
+
+        // Both lower level C string processing and higher level C++...
+        #include <cstring>
+        #include <string>
+
+        // Containers...
+        #include <vector>
+
+// Within the Agni namespace...
+namespace Agni
+{
+    // Translator class definition...
+    class Translator
+    {
+        // Public helper classes...
+        public:
+
+            // Translator parameters...
+            class Parameters
+            {
+                // Public stuff...
+                public:
+
+                    // Default constructor...
+                    Parameters();
+
+                    // Accessors...
+
+                        // Should we be verbose?
+                        bool                ShouldBeVerbose() const;
+
+                        // Get the process name...
+                        std::string const  &GetProcessName() const;
+
+                        // Get the input file name...
+                        std::string const  &GetInputFile() const;
+
+                        // Get the output file name...
+                        std::string const  &GetOutputFile() const;
+
+                        // Get the name of the precompiled script to define...
+                        std::string const  &GetScriptName() const;
+
+                        // Print out the help...
+                        void                PrintHelp() const;
+
+                        // Print out the version...
+                        void                PrintVersion() const;
+
+                    // Mutators...
+
+                        // Initialize from the command line automatically...
+                        bool ParseCommandLine(int const nArguments,
+                                              char * const ppszArguments[]);
+
+                // Protected stuff...
+                protected:
+
+                    // Attributes...
+                    std::string     sProcessName;
+                    std::string     sInputFile;
+                    std::string     sOutputFile;
+                    std::string     sScriptName;
+                    bool            bVerbose;
+            };
+
+        // Executable structures...
+        protected:
+
+            // Operand as it exists in the instruction stream...
+            typedef struct _AT_Operand
+            {
+                // Operand type...
+                uint8           OperandType;
+
+                // Operand data, by type...
+                union
+                {
+                    int32       nInteger;
+                    float32     fFloat;
+                    int32       nIndex[2];
+                    uint8       Register;
+                };
+
+            }AT_Operand;
+
+            // Instruction as it exists in the instruction stream...
+            typedef struct _AT_Instruction
+            {
+                // Operation code...
+                uint16          usOperationCode;
+
+                // Operand count...
+                uint8           OperandCount;
+
+                // Operands...
+                AT_Operand      Operands[3];
+
+            }AT_Instruction;
+
+            // Function as it exists in the function table...
+            typedef struct _AT_Function
+            {
+                // Entry point...
+                uint32          unEntryPoint;
+
+                // Name...
+                std::string     sName;
+
+            }AT_Function;
+
+        // Public methods...
+        public:
+
+            // Constructor...
+            Translator(Parameters &_UserParameters);
+
+            // Translate executable...
+            boolean Translate();
+
+            // Deconstructor...
+           ~Translator();
+
+        // Protected methods...
+        protected:
+
+            // Error handling...
+
+                // Display an error and abort...
+                void ErrorGeneral(const char *pszFormat, ...);
+
+            // Loading...
+
+                // Load the input executable, whole...
+                void LoadInput();
+
+                // Load bytes from the executable or abort...
+                void LoadBytes(void *pStorageBuffer, uint32 unSize);
+
+                // Parse the executable the way the virtual machine does...
+                void ParseExecutable();
+
+            // Translating...
+
+                // Does any instruction branch to the given one?
+                bool IsBranchTarget(uint32 unIndex) const;
+
+                // Expression naming the variable or register an operand
+                //  refers to, or empty if it is neither...
+                std::string SlotExpression(const AT_Operand &Operand) const;
+
+                // Write the executable image as a byte array...
+                void WriteImage();
+
+                // Write the body...
+                void WriteBody();
+
+                // Write one instruction...
+                void WriteInstruction(uint32 unIndex);
+
+                // Write a branch from one instruction to another...
+                void WriteBranch(uint32 unFrom, uint32 unTarget,
+                                 const char *pszIndent);
+
+                // Write the slow path running an instruction through its
+                //  quickened handler, or the interpreter if it has none...
+                void WriteQuickened(uint32 unIndex, const char *pszIndent);
+
+                // Write formatted output...
+                void Write(const char *pszFormat, ...);
+
+        // Protected attributes...
+        protected:
+
+            // Translator interface parameters...
+            Parameters                 &UserParameters;
+
+            // Executable image and the offset of the next byte to parse...
+            std::vector<uint8>          Image;
+            uint32                      unImageOffset;
+
+            // Executable's main header...
+            Agni_MainHeader             MainHeader;
+
+            // Instructions...
+            std::vector<AT_Instruction> Instructions;
+
+            // Functions...
+            std::vector<AT_Function>    Functions;
+
+            // Instructions branched to from anywhere...
+            std::vector<bool>           BranchTargets;
+
+            // Does any branch go backward, needing a safe point countdown?
+            bool                        bBackwardBranches;
+
+            // Output...
+            FILE                       *hOutput;
+    };
+}
+
+#endif
+
@@ -0,0 +1,252 @@
+/*
+  Name:         Arena.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  VirtualMachine arena allocator. Each script's memory is carved
+                from chunks of its own arenas, obtained from the virtual
+                machine's allocator, with freed blocks kept by size class for
+                reuse, and released all at once...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Bytes a chunk's header occupies, keeping the blocks after it aligned...
+#define ARENA_CHUNK_HEADER_SIZE     ARENA_ALIGN(sizeof(AVM_ArenaChunk))
+
+// Allocate a block from an arena, or NULL if out of memory...
+void *VirtualMachine::ArenaAllocate(AVM_Arena &Arena, size_t Size)
+{
+    // Variables...
+    uint32              unClass     = 0;
+    size_t              BlockSize   = 0;
+    size_t              ChunkSize   = 0;
+    AVM_ArenaChunk     *pChunk      = NULL;
+    AVM_ArenaBlock     *pBlock      = NULL;
+
+    // Find the smallest size class it fits in...
+    while(unClass < ARENA_SIZE_CLASSES &&
+          ((size_t) 1 << (unClass + ARENA_SMALLEST_CLASS_SHIFT)) < Size)
+        unClass++;
+
+    // Too large for any, so give it a chunk of its own...
+    if(unClass == ARENA_LARGE_CLASS)
+    {
+        // Allocate...
+        ChunkSize = ARENA_CHUNK_HEADER_SIZE + sizeof(AVM_ArenaBlock) +
+                    ARENA_ALIGN(Size);
+        pChunk = (AVM_ArenaChunk *) pAllocator->Allocate(
+            ChunkSize, ALLOCATION_ALIGNMENT, Arena.hOwner);
+
+            // Failed...
+            if(!pChunk)
+                return NULL;
+
+        // Link it in first...
+        pChunk->pPrevious   = NULL;
+        pChunk->pNext       = Arena.pChunks;
+        pChunk->Size        = ChunkSize;
+        if(Arena.pChunks)
+            Arena.pChunks->pPrevious = pChunk;
+        Arena.pChunks = pChunk;
+        Arena.unBytesReserved += ChunkSize;
+
+        // Its block follows the header...
+        pBlock = (AVM_ArenaBlock *) ((char *) pChunk + ARENA_CHUNK_HEADER_SIZE);
+        pBlock->unSize  = ARENA_ALIGN(Size);
+        pBlock->unClass = ARENA_LARGE_CLASS;
+    }
+
+    // A block of its class was freed, so reuse it...
+    else if(Arena.pFreeBlocks[unClass])
+    {
+        // Unlink it...
+        pBlock = Arena.pFreeBlocks[unClass];
+        Arena.pFreeBlocks[unClass] = *(AVM_ArenaBlock **) (pBlock + 1);
+    }
+
+    // Otherwise carve a new one...
+    else
+    {
+        // Room it takes...
+        BlockSize = sizeof(AVM_ArenaBlock) +
+                    ((size_t) 1 << (unClass + ARENA_SMALLEST_CLASS_SHIFT));
+
+        // Newest chunk has no room left, so obtain another, each twice the
+        //  last up to a limit...
+        if((size_t) (Arena.pEnd - Arena.pNext) < BlockSize)
+        {
+            // Size it...
+            if(!Arena.NextChunkSize)
+                Arena.NextChunkSize = ARENA_INITIAL_CHUNK_SIZE;
+            ChunkSize = Arena.NextChunkSize;
+            if(ChunkSize < ARENA_CHUNK_HEADER_SIZE + BlockSize)
+                ChunkSize = ARENA_CHUNK_HEADER_SIZE + BlockSize;
+
+            // Allocate...
+            pChunk = (AVM_ArenaChunk *) pAllocator->Allocate(
+                ChunkSize, ALLOCATION_ALIGNMENT, Arena.hOwner);
+
+                // Failed...
+                if(!pChunk)
+                    return NULL;
+
+            // Link it in first...
+            pChunk->pPrevious   = NULL;
+            pChunk->pNext       = Arena.pChunks;
+            pChunk->Size        = ChunkSize;
+            if(Arena.pChunks)
+                Arena.pChunks->pPrevious = pChunk;
+            Arena.pChunks = pChunk;
+            Arena.unBytesReserved += ChunkSize;
+
+            // Carve from it from now on...
+            Arena.pNext = (char *) pChunk + ARENA_CHUNK_HEADER_SIZE;
+            Arena.pEnd  = (char *) pChunk + ChunkSize;
+
+            // Next one is larger...
+            if(Arena.NextChunkSize < ARENA_MAXIMUM_CHUNK_SIZE)
+                Arena.NextChunkSize *= 2;
+        }
+
+        // Carve...
+        pBlock = (AVM_ArenaBlock *) Arena.pNext;
+        pBlock->unSize  = BlockSize - sizeof(AVM_ArenaBlock);
+        pBlock->unClass = unClass;
+        Arena.pNext += BlockSize;
+    }
+
+    // Account...
+    Arena.unBytesUsed += pBlock->unSize;
+
+    // Body follows the header...
+    return pBlock + 1;
+}
+
+// Allocate a zeroed block for an array from an arena, or NULL if out of
+//  memory...
+void *VirtualMachine::ArenaAllocateZeroed(AVM_Arena &Arena, size_t Count,
+                                          size_t Size)
+{
+    // Variables...
+    void   *pBlock  = NULL;
+
+    // Too large to size...
+    if(Size && Count > ((size_t) -1) / Size)
+        return NULL;
+
+    // Allocate...
+    pBlock = ArenaAllocate(Arena, Count * Size);
+
+        // Failed...
+        if(!pBlock)
+            return NULL;
+
+    // Zero it...
+    memset(pBlock, '\x0', Count * Size);
+
+    // Done...
+    return pBlock;
+}
+
+// Resize a block allocated from an arena, moving it if it has no room, or NULL
+//  if out of memory, leaving it as it was...
+void *VirtualMachine::ArenaReallocate(AVM_Arena &Arena, void *pBlock,
+                                      size_t Size)
+{
+    // Variables...
+    AVM_ArenaBlock *pHeader     = NULL;
+    void           *pNewBlock   = NULL;
+
+    // Nothing yet, so allocate it...
+    if(!pBlock)
+        return ArenaAllocate(Arena, Size);
+
+    // Already has room...
+    pHeader = (AVM_ArenaBlock *) pBlock - 1;
+    if(Size <= pHeader->unSize)
+        return pBlock;
+
+    // Otherwise move it into a larger one...
+    pNewBlock = ArenaAllocate(Arena, Size);
+
+        // Failed...
+        if(!pNewBlock)
+            return NULL;
+
+    // Copy and free the old one...
+    memcpy(pNewBlock, pBlock, pHeader->unSize);
+    ArenaFree(Arena, pBlock);
+
+    // Done...
+    return pNewBlock;
+}
+
+// Free a block allocated from an arena for reuse...
+void VirtualMachine::ArenaFree(AVM_Arena &Arena, void *pBlock)
+{
+    // Variables...
+    AVM_ArenaBlock *pHeader = NULL;
+    AVM_ArenaChunk *pChunk  = NULL;
+
+    // Nothing...
+    if(!pBlock)
+        return;
+
+    // Account...
+    pHeader = (AVM_ArenaBlock *) pBlock - 1;
+    Arena.unBytesUsed -= pHeader->unSize;
+
+    // Large block, so give back its chunk...
+    if(pHeader->unClass == ARENA_LARGE_CLASS)
+    {
+        // Find it...
+        pChunk = (AVM_ArenaChunk *) ((char *) pHeader - ARENA_CHUNK_HEADER_SIZE);
+
+        // Unlink it...
+        if(pChunk->pPrevious)
+            pChunk->pPrevious->pNext = pChunk->pNext;
+        else
+            Arena.pChunks = pChunk->pNext;
+        if(pChunk->pNext)
+            pChunk->pNext->pPrevious = pChunk->pPrevious;
+
+        // Free it...
+        Arena.unBytesReserved -= pChunk->Size;
+        pAllocator->Free(pChunk, pChunk->Size, ALLOCATION_ALIGNMENT,
+                         Arena.hOwner);
+
+        // Done...
+        return;
+    }
+
+    // Otherwise keep it for the next block of its class...
+   *(AVM_ArenaBlock **) pBlock = Arena.pFreeBlocks[pHeader->unClass];
+    Arena.pFreeBlocks[pHeader->unClass] = pHeader;
+}
+
+// Release everything allocated from an arena in one shot...
+void VirtualMachine::ArenaRelease(AVM_Arena &Arena)
+{
+    // Variables...
+    AVM_ArenaChunk *pChunk  = Arena.pChunks;
+    AVM_ArenaChunk *pNext   = NULL;
+    Script          hOwner  = Arena.hOwner;
+
+    // Free each chunk...
+    while(pChunk)
+    {
+        // Free...
+        pNext = pChunk->pNext;
+        pAllocator->Free(pChunk, pChunk->Size, ALLOCATION_ALIGNMENT, hOwner);
+        pChunk = pNext;
+    }
+
+    // Arena is empty again, but still its owner's...
+    memset(&Arena, '\x0', sizeof(AVM_Arena));
+    Arena.hOwner = hOwner;
+}
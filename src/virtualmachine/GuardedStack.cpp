@@ -0,0 +1,286 @@
+/*
+  Name:         GuardedStack.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  VirtualMachine guarded runtime stacks. Each script's stack is
+                reserved from the system between inaccessible guard pages and
+                committed by it only as pages are first touched. Touching a
+                guard page raises a fault the handler here turns into the
+                stack overflow or underflow execution exception, so pushes and
+                pops need not check the stack's bounds themselves...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+    // Memory mapping and signals...
+    #if defined(AGNI_GUARDED_STACKS)
+    #include <pthread.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #endif
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Guarded stacks supported on this platform...
+#if defined(AGNI_GUARDED_STACKS)
+
+// Most guarded stacks reserved at once, across every virtual machine in the
+//  process...
+#define GUARDED_STACK_SLOTS     4096
+
+// Round a size up to a multiple of a page, a power of two...
+#define GUARDED_PAGE_ALIGN(Size, PageSize) \
+    (((size_t) (Size) + (PageSize) - 1) & ~((size_t) (PageSize) - 1))
+
+// Reserved range of a guarded stack the fault handler recognizes, each bound
+//  written with nothing reserved before and cleared before it is given back...
+typedef struct _GuardedStackSlot
+{
+    // Start of the reservation, where the lower guard begins, or zero if the
+    //  slot is free...
+    volatile unsigned long long Start;
+
+    // End of the lower guard, where the stack begins...
+    volatile unsigned long long LowerGuardEnd;
+
+    // Start of the upper guard, where the stack ends...
+    volatile unsigned long long UpperGuardStart;
+
+    // End of the reservation, where the upper guard ends...
+    volatile unsigned long long End;
+
+}GuardedStackSlot;
+
+// Every guarded stack reserved...
+static GuardedStackSlot     GuardedStackSlots[GUARDED_STACK_SLOTS];
+
+// One past the highest slot in use, so the handler need search no further,
+//  only ever changed under its lock...
+static volatile unsigned long long  GuardedStackSlotsInUse  = 0;
+static pthread_mutex_t              GuardedStackSlotsLock   =
+                                        PTHREAD_MUTEX_INITIALIZER;
+
+// Has the fault handler been installed, and the action it replaced...
+static volatile unsigned long long  GuardedStackHandlerInstalled    = 0;
+static struct sigaction             PreviousFaultAction;
+
+// Turn a fault on a guard page into the execution exception it means, or pass
+//  any other on to whatever handled it before...
+static void GuardedStackFault(int nSignal, siginfo_t *pInformation,
+                              void *pContext)
+{
+    // Variables...
+    unsigned long long  Address = (size_t) pInformation->si_addr;
+    unsigned long long  Start   = 0;
+    unsigned long long  InUse   = GuardedStackSlotsInUse;
+
+    // Find the stack whose guard it touched...
+    for(uint32 unSlot = 0; unSlot < InUse; unSlot++)
+    {
+        // Free...
+        Start = GuardedStackSlots[unSlot].Start;
+        if(!Start || Address < Start ||
+           Address >= GuardedStackSlots[unSlot].End)
+            continue;
+
+        // Below the stack. Unwinding out of the handler leaves the faulting
+        //  script's frames to their usual catch, since the virtual machine
+        //  is built with non-call exceptions...
+        if(Address < GuardedStackSlots[unSlot].LowerGuardEnd)
+            throw VirtualMachine::SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+
+        // Above it...
+        if(Address >= GuardedStackSlots[unSlot].UpperGuardStart)
+            throw VirtualMachine::SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    }
+
+    // Not ours, so pass it to the handler that was there before...
+    if((PreviousFaultAction.sa_flags & SA_SIGINFO) &&
+        PreviousFaultAction.sa_sigaction)
+    {
+        PreviousFaultAction.sa_sigaction(nSignal, pInformation, pContext);
+        return;
+    }
+    if(!(PreviousFaultAction.sa_flags & SA_SIGINFO) &&
+       PreviousFaultAction.sa_handler != SIG_DFL &&
+       PreviousFaultAction.sa_handler != SIG_IGN)
+    {
+        PreviousFaultAction.sa_handler(nSignal);
+        return;
+    }
+
+    // Or if there was none, restore the default action, which the fault then
+    //  takes when the faulting instruction runs again...
+    signal(nSignal, SIG_DFL);
+}
+
+// Reserve a script's runtime stack between guard pages, each side large
+//  enough that no frame can be pushed past it without touching it, or throw
+//  status code...
+void VirtualMachine::ReserveGuardedStack(Script hScript)
+{
+    // Variables...
+    AVM_RuntimeStack   &Stack           = Scripts[hScript].Stack;
+    size_t              PageSize        = (size_t) sysconf(_SC_PAGESIZE);
+    uint32              unLargestFrame  = 0;
+    size_t              StackSize       = 0;
+    size_t              GuardSize       = 0;
+    char               *pReservation    = NULL;
+    unsigned long long  Start           = 0;
+    uint32              unSlot          = 0;
+    struct sigaction    FaultAction;
+
+    // Find the largest frame any function pushes...
+    for(uint32 unIndex = 0;
+        unIndex < Scripts[hScript].FunctionTableHeader.unSize; unIndex++)
+        if(Scripts[hScript].pFunctionTable[unIndex].unStackFrameSize >
+           unLargestFrame)
+            unLargestFrame =
+                Scripts[hScript].pFunctionTable[unIndex].unStackFrameSize;
+
+    // Size the stack and its guards, which must also cover the globals
+    //  pushed with Main()'s frame before anything on the stack is touched...
+    StackSize = GUARDED_PAGE_ALIGN(
+        (size_t) Scripts[hScript].MainHeader.unStackSize *
+            sizeof(AVM_RuntimeValue), PageSize);
+    GuardSize = GUARDED_PAGE_ALIGN(
+        ((size_t) Scripts[hScript].MainHeader.unGlobalDataSize +
+         unLargestFrame + 1) * sizeof(AVM_RuntimeValue), PageSize);
+
+    // Install the fault handler, once for the process, taking its own signal
+    //  again while unwinding out of it...
+    if(AGNI_ATOMIC_COMPARE_AND_SWAP(&GuardedStackHandlerInstalled, 0, 1))
+    {
+        // Prepare...
+        memset(&FaultAction, '\x0', sizeof(FaultAction));
+        FaultAction.sa_sigaction = GuardedStackFault;
+        FaultAction.sa_flags     = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&FaultAction.sa_mask);
+
+        // Install...
+        if(sigaction(SIGSEGV, &FaultAction, &PreviousFaultAction) != 0)
+        {
+            // Let the next stack try again...
+            GuardedStackHandlerInstalled = 0;
+            throw Memory_Allocation;
+        }
+    }
+
+    // Reserve the stack's address space, committed by the system only as its
+    //  pages are touched, and zero until then...
+    pReservation = (char *) mmap(NULL, GuardSize + StackSize + GuardSize,
+                                 PROT_NONE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+
+        // Failed...
+        if(pReservation == (char *) MAP_FAILED)
+            throw Memory_Allocation;
+
+    // Open the stack between its guards...
+    if(mprotect(pReservation + GuardSize, StackSize,
+                PROT_READ | PROT_WRITE) != 0)
+    {
+        // Give it back and abort...
+        munmap(pReservation, GuardSize + StackSize + GuardSize);
+        throw Memory_Allocation;
+    }
+
+    // Claim a free slot for the fault handler to find it in...
+    Start = (size_t) pReservation;
+    for(unSlot = 0; unSlot < GUARDED_STACK_SLOTS; unSlot++)
+    {
+        // Bounds first, so the handler never sees a half written range...
+        if(GuardedStackSlots[unSlot].Start)
+            continue;
+        if(AGNI_ATOMIC_COMPARE_AND_SWAP(&GuardedStackSlots[unSlot].End, 0,
+                                        Start + GuardSize + StackSize +
+                                            GuardSize))
+        {
+            // Claimed...
+            GuardedStackSlots[unSlot].LowerGuardEnd    = Start + GuardSize;
+            GuardedStackSlots[unSlot].UpperGuardStart  = Start + GuardSize +
+                                                         StackSize;
+            GuardedStackSlots[unSlot].Start            = Start;
+            break;
+        }
+    }
+
+        // Every slot is taken...
+        if(unSlot == GUARDED_STACK_SLOTS)
+        {
+            // Give it back and abort...
+            munmap(pReservation, GuardSize + StackSize + GuardSize);
+            throw Memory_Allocation;
+        }
+
+    // Have the handler search as far as it, before the stack can be touched...
+    pthread_mutex_lock(&GuardedStackSlotsLock);
+    if(GuardedStackSlotsInUse <= unSlot)
+        GuardedStackSlotsInUse = unSlot + 1;
+    pthread_mutex_unlock(&GuardedStackSlotsLock);
+
+    // Remember it...
+    Stack.pReservation      = pReservation;
+    Stack.ReservationSize   = GuardSize + StackSize + GuardSize;
+    Stack.GuardSize         = GuardSize;
+    Stack.unGuardSlot       = unSlot;
+    Stack.pElements         = (AVM_RuntimeValue *) (pReservation + GuardSize);
+}
+
+// Give every page of a script's guarded stack that has been touched back to
+//  the system, leaving the stack zeroed as it was when reserved...
+void VirtualMachine::DecommitGuardedStack(Script hScript)
+{
+    // Variables...
+    AVM_RuntimeStack   &Stack   = Scripts[hScript].Stack;
+
+    // Nothing reserved...
+    if(!Stack.pReservation)
+        return;
+
+    // Discard...
+    madvise(Stack.pReservation + Stack.GuardSize,
+            Stack.ReservationSize - 2 * Stack.GuardSize, MADV_DONTNEED);
+}
+
+// Give a script's guarded stack back to the system...
+void VirtualMachine::ReleaseGuardedStack(Script hScript)
+{
+    // Variables...
+    AVM_RuntimeStack   &Stack   = Scripts[hScript].Stack;
+
+    // Nothing reserved...
+    if(!Stack.pReservation)
+        return;
+
+    // Free its slot, from the start so the handler stops matching it first...
+    GuardedStackSlots[Stack.unGuardSlot].Start             = 0;
+    GuardedStackSlots[Stack.unGuardSlot].LowerGuardEnd     = 0;
+    GuardedStackSlots[Stack.unGuardSlot].UpperGuardStart   = 0;
+    AGNI_ATOMIC_COMPARE_AND_SWAP(&GuardedStackSlots[Stack.unGuardSlot].End,
+                                 GuardedStackSlots[Stack.unGuardSlot].End, 0);
+
+    // Stop the handler searching past the highest slot still in use. A slot
+    //  claimed meanwhile is either seen here or raises the bound itself...
+    pthread_mutex_lock(&GuardedStackSlotsLock);
+    while(GuardedStackSlotsInUse > 0 &&
+          !GuardedStackSlots[GuardedStackSlotsInUse - 1].End)
+        GuardedStackSlotsInUse--;
+    pthread_mutex_unlock(&GuardedStackSlotsLock);
+
+    // Give it back...
+    munmap(Stack.pReservation, Stack.ReservationSize);
+
+    // Forget it...
+    Stack.pReservation      = NULL;
+    Stack.ReservationSize   = 0;
+    Stack.GuardSize         = 0;
+    Stack.pElements         = NULL;
+}
+
+#endif
@@ -0,0 +1,1170 @@
+/*
+  Name:         NativeCode.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  VirtualMachine native code compiler. Translates each script's
+                threaded code into x86-64 machine code, one template per
+                instruction, written into its own executable mapping...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+    // Memory mapping...
+    #if defined(AGNI_NATIVE_CODE)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <cstddef>
+    #endif
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Status native code and the helpers it calls return...
+
+    // Helper returned false, or native code reached a safe point or an
+    //  instruction it must interpret with the instruction pointer stored...
+    #define NATIVE_FALSE                    0
+
+    // Helper returned true, or native code reached the stack base...
+    #define NATIVE_TRUE                     1
+
+    // Helper caught an execution exception for native code to pass on...
+    #define NATIVE_EXCEPTION                2
+
+// Types of execution exception caught on behalf of native code...
+#define NATIVE_EXCEPTION_EXECUTION          1
+#define NATIVE_EXCEPTION_STRING             2
+
+// Catch an execution exception on behalf of native code, which cannot unwind
+//  through the native frames, and have it passed on once they have returned...
+#define NATIVE_CATCH(pVirtualMachine, hScript) \
+    catch(SCRIPT_EXECUTION_EXCEPTION Exception) \
+    { \
+        pVirtualMachine->Scripts[hScript].NativeExceptionType = \
+            NATIVE_EXCEPTION_EXECUTION; \
+        pVirtualMachine->Scripts[hScript].NativeException = Exception; \
+        return NATIVE_EXCEPTION; \
+    } \
+    catch(const char *pszException) \
+    { \
+        pVirtualMachine->Scripts[hScript].NativeExceptionType = \
+            NATIVE_EXCEPTION_STRING; \
+        pVirtualMachine->Scripts[hScript].pszNativeException = pszException; \
+        return NATIVE_EXCEPTION; \
+    }
+
+// Native code generation supported on this platform...
+#if defined(AGNI_NATIVE_CODE)
+
+// Native code bytes reserved for each instruction, more than any needs...
+#define NATIVE_BYTES_PER_INSTRUCTION        256
+
+// Native code bytes reserved for the entry and exit stubs...
+#define NATIVE_BYTES_FOR_STUBS              128
+
+// x86-64 registers native code uses as scratch...
+#define NATIVE_RAX                          0
+#define NATIVE_RCX                          1
+
+// x86-64 condition codes of conditional jumps...
+#define NATIVE_CONDITION_E                  0x4
+#define NATIVE_CONDITION_NE                 0x5
+#define NATIVE_CONDITION_L                  0xC
+#define NATIVE_CONDITION_GE                 0xD
+#define NATIVE_CONDITION_LE                 0xE
+#define NATIVE_CONDITION_G                  0xF
+
+// Where a variable or register operand lives...
+enum NativeSlotBase
+{
+    // Not a variable or register known at load time...
+    NativeSlot_None = 0,
+
+    // Global, at a fixed index from the bottom of the stack...
+    NativeSlot_Global,
+
+    // Local, at an index relative to the current stack frame...
+    NativeSlot_Local,
+
+    // Register, at a fixed offset within the script...
+    NativeSlot_Script
+};
+
+// Variable or register operand...
+typedef struct _NativeSlot
+{
+    // Where it lives...
+    NativeSlotBase  Base;
+
+    // Stack index, or byte offset for a register...
+    int32           nIndex;
+
+}NativeSlot;
+
+// Layout of the structures native code reaches into...
+typedef struct _NativeLayout
+{
+    // Offsets within a script...
+    int32           nInstructionPointer;
+    int32           nFrameTop;
+    int32           nElements;
+
+    // Size of a runtime value and offsets within it...
+    int32           nValueSize;
+    int32           nType;
+    int32           nValue;
+
+}NativeLayout;
+
+// Native code being emitted...
+typedef struct _NativeBuffer
+{
+    // Code...
+    uint8          *pCode;
+
+    // Bytes available and bytes emitted, which may run past the end...
+    size_t          Capacity;
+    size_t          Offset;
+
+}NativeBuffer;
+
+// Branch to an instruction whose native code is not emitted yet...
+typedef struct _NativeFixup
+{
+    // Where its 32-bit displacement is...
+    size_t          At;
+
+    // Instruction it branches to...
+    uint32          unTarget;
+
+}NativeFixup;
+
+// Emit a byte...
+static void EmitByte(NativeBuffer &Buffer, uint8 Byte)
+{
+    // Store, if there is room, and count it either way...
+    if(Buffer.Offset < Buffer.Capacity)
+        Buffer.pCode[Buffer.Offset] = Byte;
+    Buffer.Offset++;
+}
+
+// Emit a 32-bit little endian value...
+static void EmitDword(NativeBuffer &Buffer, uint32 unValue)
+{
+    // Emit each byte...
+    for(uint8 Byte = 0; Byte < 4; Byte++)
+        EmitByte(Buffer, (uint8) (unValue >> (Byte * 8)));
+}
+
+// Emit a 64-bit little endian value...
+static void EmitQword(NativeBuffer &Buffer, size_t Value)
+{
+    // Emit each byte...
+    for(uint8 Byte = 0; Byte < 8; Byte++)
+        EmitByte(Buffer, (uint8) (Value >> (Byte * 8)));
+}
+
+// Point the 32-bit displacement at the given offset to a target...
+static void PatchDisplacement(NativeBuffer &Buffer, size_t At, size_t Target)
+{
+    // Variables...
+    uint32  unDisplacement  = (uint32) (Target - (At + 4));
+
+    // Store, if it was emitted...
+    if(At + 4 <= Buffer.Capacity)
+    {
+        // Store each byte...
+        for(uint8 Byte = 0; Byte < 4; Byte++)
+            Buffer.pCode[At + Byte] = (uint8) (unDisplacement >> (Byte * 8));
+    }
+}
+
+// Emit a jump, conditional unless condition is negative, to a target not yet
+//  known and return where its displacement is to be patched...
+static size_t EmitJumpForward(NativeBuffer &Buffer, int Condition)
+{
+    // Unconditional... (jmp rel32)
+    if(Condition < 0)
+        EmitByte(Buffer, 0xE9);
+
+    // Conditional... (jcc rel32)
+    else
+    {
+        EmitByte(Buffer, 0x0F);
+        EmitByte(Buffer, 0x80 | Condition);
+    }
+
+    // Leave room for displacement...
+    EmitDword(Buffer, 0);
+
+    // Done...
+    return Buffer.Offset - 4;
+}
+
+// Emit a jump, conditional unless condition is negative, to a known target...
+static void EmitJump(NativeBuffer &Buffer, int Condition, size_t Target)
+{
+    // Emit and point at target...
+    PatchDisplacement(Buffer, EmitJumpForward(Buffer, Condition), Target);
+}
+
+// Point a jump emitted earlier to the current offset...
+static void BindJump(NativeBuffer &Buffer, size_t At)
+{
+    // Patch...
+    PatchDisplacement(Buffer, At, Buffer.Offset);
+}
+
+// Emit storing the instruction pointer... (mov dword [r13 + disp32], imm32)
+static void EmitStoreInstructionPointer(NativeBuffer &Buffer,
+                                        const NativeLayout &Layout,
+                                        uint32 unIndex)
+{
+    // Emit...
+    EmitByte(Buffer, 0x41);
+    EmitByte(Buffer, 0xC7);
+    EmitByte(Buffer, 0x85);
+    EmitDword(Buffer, Layout.nInstructionPointer);
+    EmitDword(Buffer, unIndex);
+}
+
+// Emit code leaving a variable or register's address in the given register...
+static void EmitSlotAddress(NativeBuffer &Buffer, const NativeLayout &Layout,
+                            uint8 Register, const NativeSlot &Slot)
+{
+    // Emit by where it lives...
+    switch(Slot.Base)
+    {
+        // Global... (lea r64, [rbx + disp32])
+        case NativeSlot_Global:
+            EmitByte(Buffer, 0x48);
+            EmitByte(Buffer, 0x8D);
+            EmitByte(Buffer, 0x83 | (Register << 3));
+            EmitDword(Buffer, Slot.nIndex * Layout.nValueSize);
+            break;
+
+        // Local...
+        case NativeSlot_Local:
+
+            // Frame top index... (mov r32, [r13 + disp32])
+            EmitByte(Buffer, 0x41);
+            EmitByte(Buffer, 0x8B);
+            EmitByte(Buffer, 0x85 | (Register << 3));
+            EmitDword(Buffer, Layout.nFrameTop);
+
+            // Plus negative index... (add r32, imm32)
+            EmitByte(Buffer, 0x81);
+            EmitByte(Buffer, 0xC0 | Register);
+            EmitDword(Buffer, Slot.nIndex);
+
+            // Scaled to a byte offset... (imul r64, r64, imm32)
+            EmitByte(Buffer, 0x48);
+            EmitByte(Buffer, 0x69);
+            EmitByte(Buffer, 0xC0 | (Register << 3) | Register);
+            EmitDword(Buffer, Layout.nValueSize);
+
+            // From the bottom of the stack... (add r64, rbx)
+            EmitByte(Buffer, 0x48);
+            EmitByte(Buffer, 0x01);
+            EmitByte(Buffer, 0xD8 | Register);
+            break;
+
+        // Register... (lea r64, [r13 + disp32])
+        default:
+            EmitByte(Buffer, 0x49);
+            EmitByte(Buffer, 0x8D);
+            EmitByte(Buffer, 0x85 | (Register << 3));
+            EmitDword(Buffer, Slot.nIndex);
+            break;
+    }
+}
+
+// Emit a check of the operand type of the value the given register addresses,
+//  jumping if it is or is not the given type and returning where the jump's
+//  displacement is to be patched...
+static size_t EmitTypeCheck(NativeBuffer &Buffer, const NativeLayout &Layout,
+                            uint8 Register, uint8 Type, bool bJumpIfEqual)
+{
+    // Compare... (cmp byte [r64 + disp8], imm8)
+    EmitByte(Buffer, 0x80);
+    EmitByte(Buffer, 0x78 | Register);
+    EmitByte(Buffer, (uint8) Layout.nType);
+    EmitByte(Buffer, Type);
+
+    // Jump...
+    return EmitJumpForward(Buffer, bJumpIfEqual ? NATIVE_CONDITION_E
+                                                : NATIVE_CONDITION_NE);
+}
+
+// Emit a call to a helper taking the virtual machine, the script, and
+//  optionally a threaded instruction...
+static void EmitHelperCall(NativeBuffer &Buffer, size_t Helper,
+                           const void *pInstruction)
+{
+    // Virtual machine... (mov rdi, r12)
+    EmitByte(Buffer, 0x4C);
+    EmitByte(Buffer, 0x89);
+    EmitByte(Buffer, 0xE7);
+
+    // Script... (mov esi, r14d)
+    EmitByte(Buffer, 0x44);
+    EmitByte(Buffer, 0x89);
+    EmitByte(Buffer, 0xF6);
+
+    // Threaded instruction... (mov rdx, imm64)
+    if(pInstruction)
+    {
+        EmitByte(Buffer, 0x48);
+        EmitByte(Buffer, 0xBA);
+        EmitQword(Buffer, (size_t) pInstruction);
+    }
+
+    // Call helper... (mov rax, imm64; call rax)
+    EmitByte(Buffer, 0x48);
+    EmitByte(Buffer, 0xB8);
+    EmitQword(Buffer, Helper);
+    EmitByte(Buffer, 0xFF);
+    EmitByte(Buffer, 0xD0);
+}
+
+// Emit a check for an exception caught by the helper just called, leaving
+//  native code with the instruction pointer at the culprit if so...
+static void EmitExceptionCheck(NativeBuffer &Buffer, const NativeLayout &Layout,
+                               uint32 unIndex, size_t Epilogue)
+{
+    // Variables...
+    size_t  NoException     = 0;
+
+    // Caught one? (cmp eax, imm8)
+    EmitByte(Buffer, 0x83);
+    EmitByte(Buffer, 0xF8);
+    EmitByte(Buffer, NATIVE_EXCEPTION);
+    NoException = EmitJumpForward(Buffer, NATIVE_CONDITION_NE);
+
+    // Leave with status still in eax...
+    EmitStoreInstructionPointer(Buffer, Layout, unIndex);
+    EmitJump(Buffer, -1, Epilogue);
+
+    // Otherwise carry on...
+    BindJump(Buffer, NoException);
+}
+
+// Emit a jump to wherever the instruction pointer now is, leaving native code
+//  if it has to be interpreted...
+static void EmitDispatch(NativeBuffer &Buffer, const NativeLayout &Layout,
+                         void **ppEntries, size_t ExitStored)
+{
+    // Instruction pointer... (mov eax, [r13 + disp32])
+    EmitByte(Buffer, 0x41);
+    EmitByte(Buffer, 0x8B);
+    EmitByte(Buffer, 0x85);
+    EmitDword(Buffer, Layout.nInstructionPointer);
+
+    // Its native code address... (mov rcx, imm64; mov rax, [rcx + rax * 8])
+    EmitByte(Buffer, 0x48);
+    EmitByte(Buffer, 0xB9);
+    EmitQword(Buffer, (size_t) ppEntries);
+    EmitByte(Buffer, 0x48);
+    EmitByte(Buffer, 0x8B);
+    EmitByte(Buffer, 0x04);
+    EmitByte(Buffer, 0xC1);
+
+    // None, so leave... (test rax, rax; jz)
+    EmitByte(Buffer, 0x48);
+    EmitByte(Buffer, 0x85);
+    EmitByte(Buffer, 0xC0);
+    EmitJump(Buffer, NATIVE_CONDITION_E, ExitStored);
+
+    // Otherwise go there... (jmp rax)
+    EmitByte(Buffer, 0xFF);
+    EmitByte(Buffer, 0xE0);
+}
+
+// Emit a branch from one instruction to another, forward branches jumping
+//  straight there and backward branches counting down to a safe point...
+static void EmitBranch(NativeBuffer &Buffer, const NativeLayout &Layout,
+                       uint32 unFrom, uint32 unTarget, const size_t *pLabels,
+                       NativeFixup *pFixups, uint32 &unFixups,
+                       size_t ExitStored)
+{
+    // Forward, to be patched once the target is emitted...
+    if(unTarget > unFrom)
+    {
+        pFixups[unFixups].At        = EmitJumpForward(Buffer, -1);
+        pFixups[unFixups].unTarget  = unTarget;
+        unFixups++;
+        return;
+    }
+
+    // Backward, count down... (sub r15d, 1)
+    EmitByte(Buffer, 0x41);
+    EmitByte(Buffer, 0x83);
+    EmitByte(Buffer, 0xEF);
+    EmitByte(Buffer, 0x01);
+
+    // And loop while there are branches left before the next safe point...
+    EmitJump(Buffer, NATIVE_CONDITION_NE, pLabels[unTarget]);
+
+    // Otherwise let the scheduler run, resuming at the target...
+    EmitStoreInstructionPointer(Buffer, Layout, unTarget);
+    EmitJump(Buffer, -1, ExitStored);
+}
+
+#endif
+
+// Compile a script's threaded code to native code, where supported, leaving it
+//  uncompiled otherwise...
+void VirtualMachine::CompileNativeCode(Script hScript)
+{
+#if defined(AGNI_NATIVE_CODE)
+
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_Instruction            *pInstructions   = NULL;
+    AVM_ThreadedInstruction    *pThreaded       = NULL;
+    NativeLayout                Layout;
+    NativeBuffer                Buffer          = {NULL, 0, 0};
+    NativeSlot                  Slots[2];
+    NativeFixup                *pFixups         = NULL;
+    size_t                     *pLabels         = NULL;
+    size_t                      Epilogue        = 0;
+    size_t                      ExitStored      = 0;
+    size_t                      ExitStackBase   = 0;
+    size_t                      Slow[2]         = {0, 0};
+    size_t                      Inline          = 0;
+    size_t                      Done            = 0;
+    size_t                      Next            = 0;
+    size_t                      Taken           = 0;
+    uint32                      unSize          = 0;
+    uint32                      unIndex         = 0;
+    uint32                      unFixups        = 0;
+    uint8                       SlowJumps       = 0;
+    uint8                       Condition       = 0;
+    bool                        bCompiled       = false;
+
+    // Find the layout of the structures native code reaches into...
+    Layout.nInstructionPointer  = offsetof(AVM_Script, InstructionStream) +
+                                  offsetof(AVM_InstructionStream,
+                                           unInstructionPointer);
+    Layout.nFrameTop            = offsetof(AVM_Script, Stack) +
+                                  offsetof(AVM_RuntimeStack,
+                                           unCurrentStackFrameTopIndex);
+    Layout.nElements            = offsetof(AVM_Script, Stack) +
+                                  offsetof(AVM_RuntimeStack, pElements);
+    Layout.nValueSize           = sizeof(AVM_RuntimeValue);
+    Layout.nType                = offsetof(AVM_RuntimeValue, OperandType);
+    Layout.nValue               = offsetof(AVM_RuntimeValue, nLiteralInteger);
+
+        // Values must be copyable in quadwords and reachable by 8-bit
+        //  displacements...
+        if(Layout.nValueSize % 8 != 0 || Layout.nValueSize > 127)
+            return;
+
+    // Allocate table of native code addresses, one for each instruction...
+    unSize = CurrentScript.InstructionStreamHeader.unSize;
+    CurrentScript.ppNativeEntry = (void **) ArenaAllocateZeroed(
+        CurrentScript.ImageArena, unSize + 1, sizeof(void *));
+    pLabels = (size_t *) ArenaAllocateZeroed(CurrentScript.ImageArena,
+                                             unSize + 1, sizeof(size_t));
+    pFixups = (NativeFixup *) ArenaAllocateZeroed(CurrentScript.ImageArena,
+                                                  unSize + 1,
+                                                  sizeof(NativeFixup));
+
+        // Failed...
+        if(!CurrentScript.ppNativeEntry || !pLabels || !pFixups)
+            goto Failed;
+
+    // Map writable pages for the code...
+    Buffer.Capacity = NATIVE_BYTES_FOR_STUBS +
+                      (unSize + 1) * NATIVE_BYTES_PER_INSTRUCTION;
+    Buffer.Capacity = (Buffer.Capacity + ::sysconf(_SC_PAGESIZE) - 1) &
+                      ~(::sysconf(_SC_PAGESIZE) - 1);
+    Buffer.Offset   = 0;
+    Buffer.pCode    = (uint8 *) ::mmap(NULL, Buffer.Capacity,
+                                       PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        // Failed...
+        if(Buffer.pCode == (uint8 *) MAP_FAILED)
+        {
+            Buffer.pCode = NULL;
+            goto Failed;
+        }
+
+    // Entry point...
+
+        // Save callee saved registers, keeping the stack aligned for calls...
+        //  (push rbp, rbx, r12, r13, r14, r15; sub rsp, 8)
+        EmitByte(Buffer, 0x55);
+        EmitByte(Buffer, 0x53);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x54);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x55);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x56);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x57);
+        EmitByte(Buffer, 0x48); EmitByte(Buffer, 0x83);
+        EmitByte(Buffer, 0xEC); EmitByte(Buffer, 0x08);
+
+        // Keep virtual machine, script, and safe point countdown in them...
+        //  (mov r12, rdi; mov r14d, esi; mov r13, rdx; mov r15d, r8d)
+        EmitByte(Buffer, 0x49); EmitByte(Buffer, 0x89); EmitByte(Buffer, 0xFC);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x89); EmitByte(Buffer, 0xF6);
+        EmitByte(Buffer, 0x49); EmitByte(Buffer, 0x89); EmitByte(Buffer, 0xD5);
+        EmitByte(Buffer, 0x45); EmitByte(Buffer, 0x89); EmitByte(Buffer, 0xC7);
+
+        // And the bottom of the stack... (mov rbx, [r13 + disp32])
+        EmitByte(Buffer, 0x49); EmitByte(Buffer, 0x8B); EmitByte(Buffer, 0x9D);
+        EmitDword(Buffer, Layout.nElements);
+
+        // Enter at the requested instruction... (jmp rcx)
+        EmitByte(Buffer, 0xFF); EmitByte(Buffer, 0xE1);
+
+    // Exit, with status in eax...
+    Epilogue = Buffer.Offset;
+
+        // Restore callee saved registers and return...
+        //  (add rsp, 8; pop r15, r14, r13, r12, rbx, rbp; ret)
+        EmitByte(Buffer, 0x48); EmitByte(Buffer, 0x83);
+        EmitByte(Buffer, 0xC4); EmitByte(Buffer, 0x08);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x5F);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x5E);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x5D);
+        EmitByte(Buffer, 0x41); EmitByte(Buffer, 0x5C);
+        EmitByte(Buffer, 0x5B);
+        EmitByte(Buffer, 0x5D);
+        EmitByte(Buffer, 0xC3);
+
+    // Exit with the instruction pointer already stored... (xor eax, eax)
+    ExitStored = Buffer.Offset;
+    EmitByte(Buffer, 0x31); EmitByte(Buffer, 0xC0);
+    EmitJump(Buffer, -1, Epilogue);
+
+    // Exit at the stack base... (mov eax, imm32)
+    ExitStackBase = Buffer.Offset;
+    EmitByte(Buffer, 0xB8); EmitDword(Buffer, NATIVE_TRUE);
+    EmitJump(Buffer, -1, Epilogue);
+
+    // Compile each instruction, and the terminating one...
+    pInstructions   = CurrentScript.InstructionStream.pInstructions;
+    pThreaded       = CurrentScript.pThreadedCode;
+    for(unIndex = 0; unIndex <= unSize; unIndex++)
+    {
+        // Variables...
+        AVM_ThreadedInstruction &Threaded = pThreaded[unIndex];
+        uint16 usOperationCode = (unIndex < unSize) ?
+            pInstructions[unIndex].usOperationCode : INSTRUCTION_AVM_EXIT;
+
+        // Native code for this instruction starts here...
+        pLabels[unIndex]    = Buffer.Offset;
+        bCompiled           = true;
+
+        // Find where its first two operands live, if they are variables or
+        //  registers...
+        for(uint8 Operand = 0; Operand < 2; Operand++)
+        {
+            // Assume it is neither...
+            Slots[Operand].Base     = NativeSlot_None;
+            Slots[Operand].nIndex   = 0;
+            if(unIndex == unSize || Operand >= Threaded.OperandCount)
+                continue;
+
+            // Check its kind...
+            AVM_RuntimeValue &Value = Threaded.Operands[Operand];
+            switch(GetOperandKind(Value))
+            {
+                // Global...
+                case OperandKind_StackGlobal:
+                    Slots[Operand].Base     = NativeSlot_Global;
+                    Slots[Operand].nIndex   = Value.nStackIndex[0];
+                    break;
+
+                // Local...
+                case OperandKind_StackLocal:
+                    Slots[Operand].Base     = NativeSlot_Local;
+                    Slots[Operand].nIndex   = Value.nStackIndex[0];
+                    break;
+
+                // Register...
+                case OperandKind_Register:
+                    Slots[Operand].Base     = NativeSlot_Script;
+                    if(Value.Register == REGISTER_AVM_T0)
+                        Slots[Operand].nIndex = offsetof(AVM_Script, _RegisterT0);
+                    else if(Value.Register == REGISTER_AVM_T1)
+                        Slots[Operand].nIndex = offsetof(AVM_Script, _RegisterT1);
+                    else
+                        Slots[Operand].nIndex =
+                            offsetof(AVM_Script, _RegisterReturn);
+                    break;
+
+                // Neither...
+                default:
+                    break;
+            }
+        }
+
+        // Compile by operation code...
+        switch(usOperationCode)
+        {
+            // Unconditional jump, when resolved at load time...
+            case INSTRUCTION_AVM_JMP:
+            {
+                // Not resolved, interpret...
+                if(!Threaded.pJumpTarget)
+                {
+                    bCompiled = false;
+                    break;
+                }
+
+                // Branch...
+                EmitBranch(Buffer, Layout, unIndex,
+                           Threaded.pJumpTarget - pThreaded, pLabels, pFixups,
+                           unFixups, ExitStored);
+                break;
+            }
+
+            // Conditional jumps, when quickened and resolved at load time...
+            case INSTRUCTION_AVM_JE:
+            case INSTRUCTION_AVM_JNE:
+            case INSTRUCTION_AVM_JG:
+            case INSTRUCTION_AVM_JL:
+            case INSTRUCTION_AVM_JGE:
+            case INSTRUCTION_AVM_JLE:
+            {
+                // Neither, interpret...
+                if(!Threaded.Quickened || !Threaded.pJumpTarget)
+                {
+                    bCompiled = false;
+                    break;
+                }
+
+                // Integral comparison the legacy engines make...
+                switch(usOperationCode)
+                {
+                    case INSTRUCTION_AVM_JE:  Condition = NATIVE_CONDITION_E;  break;
+                    case INSTRUCTION_AVM_JNE: Condition = NATIVE_CONDITION_NE; break;
+                    case INSTRUCTION_AVM_JG:  Condition = NATIVE_CONDITION_G;  break;
+                    case INSTRUCTION_AVM_JL:  Condition = NATIVE_CONDITION_L;  break;
+                    case INSTRUCTION_AVM_JGE: Condition = NATIVE_CONDITION_GE; break;
+                    default:                  Condition = NATIVE_CONDITION_LE; break;
+                }
+
+                // Integer variable compared inline against a literal or
+                //  variable's integral value...
+                SlowJumps = 0;
+                Next = Taken = 0;
+                if(Slots[0].Base != NativeSlot_None &&
+                   (Slots[1].Base != NativeSlot_None ||
+                    GetOperandKind(Threaded.Operands[1]) <=
+                        OperandKind_Literal))
+                {
+                    // First operand must hold an integer...
+                    EmitSlotAddress(Buffer, Layout, NATIVE_RAX, Slots[0]);
+                    Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                      NATIVE_RAX,
+                                                      OT_AVM_INTEGER, false);
+
+                    // Its value... (mov edx, [rax + disp8])
+                    EmitByte(Buffer, 0x8B);
+                    EmitByte(Buffer, 0x50);
+                    EmitByte(Buffer, (uint8) Layout.nValue);
+
+                    // Against a variable's... (cmp edx, [rcx + disp8])
+                    if(Slots[1].Base != NativeSlot_None)
+                    {
+                        EmitSlotAddress(Buffer, Layout, NATIVE_RCX, Slots[1]);
+                        EmitByte(Buffer, 0x3B);
+                        EmitByte(Buffer, 0x51);
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+                    }
+
+                    // Or a literal's... (cmp edx, imm32)
+                    else
+                    {
+                        EmitByte(Buffer, 0x81);
+                        EmitByte(Buffer, 0xFA);
+                        EmitDword(Buffer,
+                                  Threaded.Operands[1].nLiteralInteger);
+                    }
+
+                    // Fall through or take it...
+                    Next    = EmitJumpForward(Buffer, Condition ^ 1);
+                    Taken   = EmitJumpForward(Buffer, -1);
+                    while(SlowJumps)
+                        BindJump(Buffer, Slow[--SlowJumps]);
+                }
+
+                // Anything else is compared by its quickened handler...
+                EmitHelperCall(Buffer,
+                               (size_t) &VirtualMachine::NativeQuickened,
+                               &Threaded);
+                EmitExceptionCheck(Buffer, Layout, unIndex, Epilogue);
+
+                // Not taken... (test eax, eax; jz)
+                EmitByte(Buffer, 0x85);
+                EmitByte(Buffer, 0xC0);
+                Done = EmitJumpForward(Buffer, NATIVE_CONDITION_E);
+
+                // Taken...
+                if(Taken)
+                    BindJump(Buffer, Taken);
+                EmitBranch(Buffer, Layout, unIndex,
+                           Threaded.pJumpTarget - pThreaded, pLabels, pFixups,
+                           unFixups, ExitStored);
+
+                // Fall through...
+                BindJump(Buffer, Done);
+                if(Next)
+                    BindJump(Buffer, Next);
+                break;
+            }
+
+            // Increment and decrement...
+            case INSTRUCTION_AVM_INC:
+            case INSTRUCTION_AVM_DEC:
+
+            // Binary operations...
+            case INSTRUCTION_AVM_MOV:
+            case INSTRUCTION_AVM_ADD:
+            case INSTRUCTION_AVM_SUB:
+            case INSTRUCTION_AVM_MUL:
+            case INSTRUCTION_AVM_AND:
+            case INSTRUCTION_AVM_OR:
+            case INSTRUCTION_AVM_XOR:
+
+            // Those only ever run by their quickened handler...
+            case INSTRUCTION_AVM_DIV:
+            case INSTRUCTION_AVM_MOD:
+            case INSTRUCTION_AVM_NEG:
+            case INSTRUCTION_AVM_NOT:
+            case INSTRUCTION_AVM_SHL:
+            case INSTRUCTION_AVM_SHR:
+            case INSTRUCTION_AVM_PUSH:
+            case INSTRUCTION_AVM_POP:
+            {
+                // Not quickened, interpret...
+                if(!Threaded.Quickened)
+                {
+                    bCompiled = false;
+                    break;
+                }
+
+                // Integer step of a variable inline...
+                SlowJumps   = 0;
+                Inline      = Buffer.Offset;
+                if((usOperationCode == INSTRUCTION_AVM_INC ||
+                    usOperationCode == INSTRUCTION_AVM_DEC) &&
+                   Slots[0].Base != NativeSlot_None)
+                {
+                    // Must hold an integer...
+                    EmitSlotAddress(Buffer, Layout, NATIVE_RAX, Slots[0]);
+                    Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                      NATIVE_RAX,
+                                                      OT_AVM_INTEGER, false);
+
+                    // Step... (add dword [rax + disp8], imm8)
+                    EmitByte(Buffer, 0x83);
+                    EmitByte(Buffer, 0x40);
+                    EmitByte(Buffer, (uint8) Layout.nValue);
+                    EmitByte(Buffer, (usOperationCode == INSTRUCTION_AVM_INC)
+                                        ? 0x01 : 0xFF);
+                }
+
+                // Move into a variable inline, unless strings are involved...
+                else if(usOperationCode == INSTRUCTION_AVM_MOV &&
+                        Slots[0].Base != NativeSlot_None &&
+                        (Slots[1].Base != NativeSlot_None ||
+                         Threaded.Operands[1].OperandType == OT_AVM_INTEGER ||
+                         Threaded.Operands[1].OperandType == OT_AVM_FLOAT))
+                {
+                    // Destination's string would need freeing...
+                    EmitSlotAddress(Buffer, Layout, NATIVE_RAX, Slots[0]);
+                    Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                      NATIVE_RAX,
+                                                      OT_AVM_STRING, true);
+
+                    // From a variable, whose string would need copying...
+                    if(Slots[1].Base != NativeSlot_None)
+                    {
+                        // Check...
+                        EmitSlotAddress(Buffer, Layout, NATIVE_RCX, Slots[1]);
+                        Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                          NATIVE_RCX,
+                                                          OT_AVM_STRING, true);
+
+                        // Copy each quadword...
+                        //  (mov rdx, [rcx + disp8]; mov [rax + disp8], rdx)
+                        for(int32 nQuadword = 0;
+                            nQuadword < Layout.nValueSize;
+                            nQuadword += 8)
+                        {
+                            EmitByte(Buffer, 0x48);
+                            EmitByte(Buffer, 0x8B);
+                            EmitByte(Buffer, 0x51);
+                            EmitByte(Buffer, (uint8) nQuadword);
+                            EmitByte(Buffer, 0x48);
+                            EmitByte(Buffer, 0x89);
+                            EmitByte(Buffer, 0x50);
+                            EmitByte(Buffer, (uint8) nQuadword);
+                        }
+                    }
+
+                    // From a numeric literal...
+                    else
+                    {
+                        // Variables...
+                        size_t  Literal = 0;
+
+                        // Type... (mov byte [rax + disp8], imm8)
+                        EmitByte(Buffer, 0xC6);
+                        EmitByte(Buffer, 0x40);
+                        EmitByte(Buffer, (uint8) Layout.nType);
+                        EmitByte(Buffer, Threaded.Operands[1].OperandType);
+
+                        // Value... (mov rdx, imm64; mov [rax + disp8], rdx)
+                        memcpy(&Literal, (uint8 *) &Threaded.Operands[1] +
+                                            Layout.nValue, sizeof(Literal));
+                        EmitByte(Buffer, 0x48);
+                        EmitByte(Buffer, 0xBA);
+                        EmitQword(Buffer, Literal);
+                        EmitByte(Buffer, 0x48);
+                        EmitByte(Buffer, 0x89);
+                        EmitByte(Buffer, 0x50);
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+                    }
+                }
+
+                // Integer arithmetic on a variable inline, from an integer
+                //  literal or variable...
+                else if(usOperationCode >= INSTRUCTION_AVM_ADD &&
+                        usOperationCode != INSTRUCTION_AVM_DIV &&
+                        usOperationCode != INSTRUCTION_AVM_MOD &&
+                        usOperationCode <= INSTRUCTION_AVM_XOR &&
+                        usOperationCode != INSTRUCTION_AVM_EXP &&
+                        usOperationCode != INSTRUCTION_AVM_NEG &&
+                        usOperationCode != INSTRUCTION_AVM_INC &&
+                        usOperationCode != INSTRUCTION_AVM_DEC &&
+                        Slots[0].Base != NativeSlot_None &&
+                        (Slots[1].Base != NativeSlot_None ||
+                         Threaded.Operands[1].OperandType == OT_AVM_INTEGER))
+                {
+                    // Variables...
+                    bool    bBitwise    = (usOperationCode >= INSTRUCTION_AVM_AND);
+                    uint8   Extension   = 0;
+                    uint8   Operation   = 0;
+
+                    // Pick encodings... (81 /digit and its r/m32, r32 form)
+                    switch(usOperationCode)
+                    {
+                        case INSTRUCTION_AVM_ADD: Extension = 0; Operation = 0x01; break;
+                        case INSTRUCTION_AVM_SUB: Extension = 5; Operation = 0x29; break;
+                        case INSTRUCTION_AVM_AND: Extension = 4; Operation = 0x21; break;
+                        case INSTRUCTION_AVM_OR:  Extension = 1; Operation = 0x09; break;
+                        case INSTRUCTION_AVM_XOR: Extension = 6; Operation = 0x31; break;
+                        default:                  break;
+                    }
+
+                    // Destination, which must be an integer for bitwise
+                    //  operations...
+                    EmitSlotAddress(Buffer, Layout, NATIVE_RAX, Slots[0]);
+                    if(bBitwise)
+                        Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                          NATIVE_RAX,
+                                                          OT_AVM_INTEGER,
+                                                          false);
+
+                    // From a variable, which must be an integer...
+                    if(Slots[1].Base != NativeSlot_None)
+                    {
+                        // Check...
+                        EmitSlotAddress(Buffer, Layout, NATIVE_RCX, Slots[1]);
+                        Slow[SlowJumps++] = EmitTypeCheck(Buffer, Layout,
+                                                          NATIVE_RCX,
+                                                          OT_AVM_INTEGER,
+                                                          false);
+
+                        // Its value... (mov edx, [rcx + disp8])
+                        EmitByte(Buffer, 0x8B);
+                        EmitByte(Buffer, 0x51);
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+
+                        // Multiply... (imul edx, [rax + disp8])
+                        if(usOperationCode == INSTRUCTION_AVM_MUL)
+                        {
+                            EmitByte(Buffer, 0x0F);
+                            EmitByte(Buffer, 0xAF);
+                            EmitByte(Buffer, 0x50);
+                            EmitByte(Buffer, (uint8) Layout.nValue);
+                        }
+
+                        // Otherwise... (op [rax + disp8], edx)
+                        else
+                        {
+                            EmitByte(Buffer, Operation);
+                            EmitByte(Buffer, 0x50);
+                            EmitByte(Buffer, (uint8) Layout.nValue);
+                        }
+                    }
+
+                    // From an integer literal, multiply...
+                    //  (mov edx, [rax + disp8]; imul edx, edx, imm32)
+                    else if(usOperationCode == INSTRUCTION_AVM_MUL)
+                    {
+                        EmitByte(Buffer, 0x8B);
+                        EmitByte(Buffer, 0x50);
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+                        EmitByte(Buffer, 0x69);
+                        EmitByte(Buffer, 0xD2);
+                        EmitDword(Buffer, Threaded.Operands[1].nLiteralInteger);
+                    }
+
+                    // Otherwise... (op dword [rax + disp8], imm32)
+                    else
+                    {
+                        EmitByte(Buffer, 0x81);
+                        EmitByte(Buffer, 0x40 | (Extension << 3));
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+                        EmitDword(Buffer, Threaded.Operands[1].nLiteralInteger);
+                    }
+
+                    // Store product... (mov [rax + disp8], edx)
+                    if(usOperationCode == INSTRUCTION_AVM_MUL)
+                    {
+                        EmitByte(Buffer, 0x89);
+                        EmitByte(Buffer, 0x50);
+                        EmitByte(Buffer, (uint8) Layout.nValue);
+                    }
+                }
+
+                // Anything else only by its quickened handler...
+                if(Buffer.Offset == Inline)
+                {
+                    EmitHelperCall(Buffer,
+                                   (size_t) &VirtualMachine::NativeQuickened,
+                                   &Threaded);
+                    EmitExceptionCheck(Buffer, Layout, unIndex, Epilogue);
+                    break;
+                }
+
+                // Inline path needs no checks...
+                if(!SlowJumps)
+                    break;
+
+                // Inline path done...
+                Done = EmitJumpForward(Buffer, -1);
+
+                // Otherwise run it by its quickened handler...
+                while(SlowJumps)
+                    BindJump(Buffer, Slow[--SlowJumps]);
+                EmitHelperCall(Buffer,
+                               (size_t) &VirtualMachine::NativeQuickened,
+                               &Threaded);
+                EmitExceptionCheck(Buffer, Layout, unIndex, Epilogue);
+                BindJump(Buffer, Done);
+                break;
+            }
+
+            // Call a function, then continue at its entry point...
+            case INSTRUCTION_AVM_CALL:
+            {
+                // Call...
+                EmitHelperCall(Buffer, (size_t) &VirtualMachine::NativeCall,
+                               &Threaded);
+                EmitExceptionCheck(Buffer, Layout, unIndex, Epilogue);
+
+                // Continue...
+                EmitDispatch(Buffer, Layout, CurrentScript.ppNativeEntry,
+                             ExitStored);
+                break;
+            }
+
+            // Return from a function, then continue at the return address...
+            case INSTRUCTION_AVM_RET:
+            {
+                // Return...
+                EmitHelperCall(Buffer, (size_t) &VirtualMachine::NativeReturn,
+                               NULL);
+                EmitExceptionCheck(Buffer, Layout, unIndex, Epilogue);
+
+                // Leave if the stack base was reached... (cmp eax, imm8; je)
+                EmitByte(Buffer, 0x83);
+                EmitByte(Buffer, 0xF8);
+                EmitByte(Buffer, NATIVE_TRUE);
+                EmitJump(Buffer, NATIVE_CONDITION_E, ExitStackBase);
+
+                // Continue...
+                EmitDispatch(Buffer, Layout, CurrentScript.ppNativeEntry,
+                             ExitStored);
+                break;
+            }
+
+            // Host calls, pauses, string operations, and anything else are
+            //  left to the interpreter...
+            default:
+                bCompiled = false;
+                break;
+        }
+
+        // Not compiled, so leave native code here to have it interpreted...
+        if(!bCompiled)
+        {
+            // Leave...
+            Buffer.Offset = pLabels[unIndex];
+            EmitStoreInstructionPointer(Buffer, Layout, unIndex);
+            EmitJump(Buffer, -1, ExitStored);
+        }
+
+        // Compiled, so it can be entered here...
+        else
+            CurrentScript.ppNativeEntry[unIndex] =
+                Buffer.pCode + pLabels[unIndex];
+    }
+
+    // Ran out of room...
+    if(Buffer.Offset > Buffer.Capacity)
+        goto Failed;
+
+    // Point forward branches at their targets...
+    for(unIndex = 0; unIndex < unFixups; unIndex++)
+        PatchDisplacement(Buffer, pFixups[unIndex].At,
+                          pLabels[pFixups[unIndex].unTarget]);
+
+    // Code is complete, so make it executable and no longer writable...
+    if(::mprotect(Buffer.pCode, Buffer.Capacity, PROT_READ | PROT_EXEC) != 0)
+        goto Failed;
+
+    // Done with temporaries...
+    ArenaFree(CurrentScript.ImageArena, pLabels);
+    ArenaFree(CurrentScript.ImageArena, pFixups);
+
+    // Native code is ready...
+    CurrentScript.pNativeCode       = Buffer.pCode;
+    CurrentScript.NativeCodeSize    = Buffer.Capacity;
+    return;
+
+// Failed to compile, so the script stays interpreted...
+Failed:
+
+    // Cleanup...
+    if(Buffer.pCode)
+        ::munmap(Buffer.pCode, Buffer.Capacity);
+    ArenaFree(CurrentScript.ImageArena, CurrentScript.ppNativeEntry);
+    CurrentScript.ppNativeEntry = NULL;
+    ArenaFree(CurrentScript.ImageArena, pLabels);
+    ArenaFree(CurrentScript.ImageArena, pFixups);
+
+#else
+
+    // Native code is not supported on this platform, so stay interpreted...
+    Scripts[hScript].pNativeCode = NULL;
+
+#endif
+}
+
+// Run a script's native code up to its next safe point, or an instruction it
+//  must interpret, and return true if the stack base was reached...
+bool VirtualMachine::ExecuteNativeCode(Script hScript)
+{
+    // Variables...
+    AVM_Script     &CurrentScript   = Scripts[hScript];
+    uint32          unStatus        = 0;
+
+    // Enter native code at the current instruction...
+    unStatus = reinterpret_cast<NativeEntryPoint>(CurrentScript.pNativeCode)(
+        this, hScript, &CurrentScript,
+        CurrentScript.ppNativeEntry[
+            CurrentScript.InstructionStream.unInstructionPointer],
+        NATIVE_SAFE_POINT_INTERVAL);
+
+    // Pass on an execution exception caught on its behalf...
+    if(unStatus == NATIVE_EXCEPTION)
+    {
+        // Execution exception...
+        if(CurrentScript.NativeExceptionType == NATIVE_EXCEPTION_EXECUTION)
+            throw CurrentScript.NativeException;
+
+        // Otherwise a string...
+        throw CurrentScript.pszNativeException;
+    }
+
+    // Done...
+    return (unStatus == NATIVE_TRUE);
+}
+
+// Release a script's native code...
+void VirtualMachine::FreeNativeCode(Script hScript)
+{
+    // Variables...
+    AVM_Script &CurrentScript = Scripts[hScript];
+
+    // Unmap code...
+#if defined(AGNI_NATIVE_CODE)
+    if(CurrentScript.pNativeCode)
+        ::munmap(CurrentScript.pNativeCode, CurrentScript.NativeCodeSize);
+#endif
+    CurrentScript.pNativeCode       = NULL;
+    CurrentScript.NativeCodeSize    = 0;
+
+    // Free table of native code addresses...
+    ArenaFree(CurrentScript.ImageArena, CurrentScript.ppNativeEntry);
+    CurrentScript.ppNativeEntry = NULL;
+}
+
+// Call a function on behalf of native code...
+uint32 VirtualMachine::NativeCall(VirtualMachine *pVirtualMachine,
+                                  Script hScript,
+                                  AVM_ThreadedInstruction *pInstruction)
+{
+    // Try to call...
+    try
+    {
+        // Return address is the instruction after the call...
+        pVirtualMachine->Scripts[hScript].InstructionStream.
+            unInstructionPointer = (pInstruction -
+                pVirtualMachine->Scripts[hScript].pThreadedCode) + 1;
+
+        // Invoke script function...
+        pVirtualMachine->CallFunctionImplementation(hScript,
+            pVirtualMachine->ResolveValueOf(hScript,
+                pInstruction->Operands[0]).nFunctionIndex);
+
+        // Done...
+        return NATIVE_FALSE;
+    }
+
+    // Failed...
+    NATIVE_CATCH(pVirtualMachine, hScript)
+}
+
+// Run a quickened instruction on behalf of native code...
+uint32 VirtualMachine::NativeQuickened(VirtualMachine *pVirtualMachine,
+                                       Script hScript,
+                                       AVM_ThreadedInstruction *pInstruction)
+{
+    // Try to run...
+    try
+    {
+        // Run the handler specialized on its operand kinds...
+        return (pVirtualMachine->*pInstruction->Quickened)(
+            hScript, pInstruction->Operands) ? NATIVE_TRUE : NATIVE_FALSE;
+    }
+
+    // Failed...
+    NATIVE_CATCH(pVirtualMachine, hScript)
+}
+
+// Return from a function on behalf of native code...
+uint32 VirtualMachine::NativeReturn(VirtualMachine *pVirtualMachine,
+                                    Script hScript)
+{
+    // Try to return...
+    try
+    {
+        // Return, noting if the bottom of the stack was found...
+        return pVirtualMachine->ReturnFromFunction(hScript) ? NATIVE_TRUE
+                                                             : NATIVE_FALSE;
+    }
+
+    // Failed...
+    NATIVE_CATCH(pVirtualMachine, hScript)
+}
@@ -0,0 +1,97 @@
+/*
+  Name:         Precompiled.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  VirtualMachine precompiled script support. The context the
+                bodies the translator generates run a thread through...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Constructor...
+VirtualMachine::PrecompiledContext::PrecompiledContext(
+    VirtualMachine &_Machine, Script _hScript)
+    : Machine(_Machine),
+      hScript(_hScript),
+      CurrentScript(_Machine.Scripts[_hScript])
+{
+
+}
+
+// Call the function an instruction names...
+void VirtualMachine::PrecompiledContext::Call(uint32 unIndex)
+{
+    // Return address is the instruction after the call...
+    CurrentScript.InstructionStream.unInstructionPointer = unIndex + 1;
+
+    // Invoke script function, which leaves us at its entry point...
+    Machine.CallFunctionImplementation(hScript,
+        Machine.ResolveValueOf(hScript,
+            CurrentScript.pThreadedCode[unIndex].Operands[0]).nFunctionIndex);
+}
+
+// Call the host function an instruction names...
+void VirtualMachine::PrecompiledContext::CallHost(uint32 unIndex)
+{
+    // Host may call back into the script, so it must return after...
+    CurrentScript.InstructionStream.unInstructionPointer = unIndex + 1;
+
+    // Invoke it...
+    Machine.InvokeHostFunction(hScript,
+        Machine.ResolveValueOf(hScript,
+            CurrentScript.pThreadedCode[unIndex].Operands[0]).
+                nHostFunctionIndex);
+
+    // It may have left values on the stack...
+    Machine.CheckStackBound(hScript);
+}
+
+// Stop the thread at an instruction...
+void VirtualMachine::PrecompiledContext::Exit(uint32 unIndex)
+{
+    // Flag the script as no longer running...
+    CurrentScript.bExecuting = false;
+    Machine.ScheduleScript(hScript);
+
+    // Resume after it, should it be started again...
+    CurrentScript.InstructionStream.unInstructionPointer = unIndex + 1;
+}
+
+// Leave an instruction to the interpreter...
+VirtualMachine::PrecompiledStatus
+    VirtualMachine::PrecompiledContext::Interpret(uint32 unIndex)
+{
+    // Scheduler interprets the instruction at the instruction pointer...
+    CurrentScript.InstructionStream.unInstructionPointer = unIndex;
+
+    // Done...
+    return Precompiled_Interpret;
+}
+
+// Pause for the duration an instruction names...
+void VirtualMachine::PrecompiledContext::Pause(uint32 unIndex)
+{
+    // Calculate and store the pause ending time...
+    CurrentScript.PauseEndTime = Machine.PauseEndTimeAfter(
+        Machine.CoerceValueToInteger(Machine.ResolveValueOf(hScript,
+            CurrentScript.pThreadedCode[unIndex].Operands[0])));
+
+    // Flag the script as paused...
+    CurrentScript.bPaused = true;
+    Machine.ScheduleScript(hScript);
+
+    // Resume after it...
+    CurrentScript.InstructionStream.unInstructionPointer = unIndex + 1;
+}
+
+// Return from a function and return true if the stack base was reached...
+bool VirtualMachine::PrecompiledContext::Return()
+{
+    // Return, which leaves us at the return address...
+    return Machine.ReturnFromFunction(hScript);
+}
@@ -0,0 +1,338 @@
+/*
+  Name:         SlabAllocator.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  Default allocator the virtual machine obtains memory from when
+                the host passes none. Blocks of each power of two size class
+                are carved from slabs and kept, once freed, on a lock-free
+                free list per class...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Free list head holding the given block and count of pops. The address takes
+//  the low SLAB_POINTER_BITS, which every 32-bit address fits, as do user space
+//  ones on x86-64 and AArch64 with the 48-bit virtual addresses Linux and
+//  Windows hand out unless a process asks for more, and any other 64-bit
+//  platform is refused below. Slabs are checked as they are obtained in case
+//  one is not. The count of pops above it is only 16 bits, so it wraps, and a
+//  pop would wrongly succeed if another thread popped exactly a multiple of
+//  65536 blocks and pushed its first back between the pop reading the head and
+//  swapping it, which is not guarded against...
+#define SLAB_HEAD(pBlock, Pops) \
+    ((unsigned long long) (size_t) (pBlock) | \
+     ((unsigned long long) (Pops) << SLAB_POINTER_BITS))
+
+// First block of a free list head, and its count of pops...
+#define SLAB_HEAD_BLOCK(Head) \
+    ((void *) (size_t) ((Head) & \
+        (((unsigned long long) 1 << SLAB_POINTER_BITS) - 1)))
+#define SLAB_HEAD_POPS(Head)    ((Head) >> SLAB_POINTER_BITS)
+
+// Fail to compile where addresses may not fit below the count of pops...
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || \
+    defined(_M_ARM64)
+    #define SLAB_POINTERS_FIT   1
+#else
+    #define SLAB_POINTERS_FIT   (sizeof(void *) * 8 <= SLAB_POINTER_BITS)
+#endif
+typedef char SlabPointersFit[SLAB_POINTERS_FIT ? 1 : -1];
+
+// Round an address up to an alignment, a power of two...
+#define SLAB_ALIGN_UP(Address, Alignment) \
+    (((size_t) (Address) + (Alignment) - 1) & ~((size_t) (Alignment) - 1))
+
+// Header at the start of each slab, linking the one obtained before it...
+typedef struct _SlabHeader
+{
+    // Slab obtained before this one...
+    struct _SlabHeader *pNext;
+
+}SlabHeader;
+
+// Constructor...
+VirtualMachine::SlabAllocator::SlabAllocator()
+{
+    // Nothing obtained yet...
+    memset((void *) FreeBlocks, '\x0', sizeof(FreeBlocks));
+    Slabs           = 0;
+    BytesReserved   = 0;
+}
+
+// Allocate a block, or NULL if out of memory...
+void *VirtualMachine::SlabAllocator::Allocate(size_t Size, size_t Alignment,
+                                              Script hTag)
+{
+    // Variables...
+    uint32              unClass     = SizeClass(Size, Alignment);
+    unsigned long long  Head        = 0;
+    void               *pBlock      = NULL;
+    void               *pNext       = NULL;
+    char               *pSystem     = NULL;
+
+    // Too large or too strictly aligned for any class...
+    if(unClass == SLAB_SIZE_CLASSES)
+    {
+        // Where it began is remembered just before it...
+        if(Alignment < sizeof(void *))
+            Alignment = sizeof(void *);
+
+        // Obtain it from the system, with room to align it and remember
+        //  where it began...
+        pSystem = (char *) malloc(Size + Alignment + sizeof(void *));
+
+            // Failed...
+            if(!pSystem)
+                return NULL;
+
+        // Align it past where it began...
+        pBlock = (void *) SLAB_ALIGN_UP(pSystem + sizeof(void *), Alignment);
+        ((void **) pBlock)[-1] = pSystem;
+
+        // Account...
+        AGNI_ATOMIC_ADD(&BytesReserved, Size + Alignment + sizeof(void *));
+
+        // Done...
+        return pBlock;
+    }
+
+    // Pop the first block of its class, refilling the class when empty...
+    for(;;)
+    {
+        // Read the head...
+        Head    = AGNI_ATOMIC_LOAD(&FreeBlocks[unClass]);
+        pBlock  = SLAB_HEAD_BLOCK(Head);
+
+        // Empty, so carve another slab...
+        if(!pBlock)
+        {
+            // Failed...
+            if(!Refill(unClass))
+                return NULL;
+
+            // Try again...
+            continue;
+        }
+
+        // Its link may be stale if another thread popped it meanwhile, but
+        //  slabs are never given back, so reading it is harmless and the
+        //  count of pops then fails the swap...
+        pNext = *(void * volatile *) pBlock;
+
+        // Popped...
+        if(AGNI_ATOMIC_COMPARE_AND_SWAP(&FreeBlocks[unClass], Head,
+                SLAB_HEAD(pNext, SLAB_HEAD_POPS(Head) + 1)))
+            return pBlock;
+    }
+}
+
+// Get the bytes obtained from the system allocator...
+size_t VirtualMachine::SlabAllocator::GetBytesReserved() const
+{
+    // Read...
+    return (size_t) AGNI_ATOMIC_LOAD(&BytesReserved);
+}
+
+// Free a block...
+void VirtualMachine::SlabAllocator::Free(void *pBlock, size_t Size,
+                                         size_t Alignment, Script hTag)
+{
+    // Variables...
+    uint32  unClass = SizeClass(Size, Alignment);
+
+    // Nothing...
+    if(!pBlock)
+        return;
+
+    // Obtained from the system, so give it back there...
+    if(unClass == SLAB_SIZE_CLASSES)
+    {
+        // Aligned as when allocated...
+        if(Alignment < sizeof(void *))
+            Alignment = sizeof(void *);
+
+        // Free from where it began...
+        free(((void **) pBlock)[-1]);
+
+        // Account...
+        AGNI_ATOMIC_ADD(&BytesReserved,
+                        -(unsigned long long) (Size + Alignment +
+                                               sizeof(void *)));
+
+        // Done...
+        return;
+    }
+
+    // Otherwise keep it for the next block of its class...
+    PushBlocks(unClass, pBlock, pBlock);
+}
+
+// Push a chain of blocks onto a free list...
+void VirtualMachine::SlabAllocator::PushBlocks(uint32 unClass, void *pFirst,
+                                               void *pLast)
+{
+    // Variables...
+    unsigned long long  Head    = 0;
+
+    // Link the chain in front of the first block...
+    do
+    {
+        // Read the head...
+        Head = AGNI_ATOMIC_LOAD(&FreeBlocks[unClass]);
+
+        // Chain leads to it...
+        *(void * volatile *) pLast = SLAB_HEAD_BLOCK(Head);
+    }
+    while(!AGNI_ATOMIC_COMPARE_AND_SWAP(&FreeBlocks[unClass], Head,
+            SLAB_HEAD(pFirst, SLAB_HEAD_POPS(Head))));
+}
+
+// Resize a block, or NULL if out of memory...
+void *VirtualMachine::SlabAllocator::Reallocate(void *pBlock, size_t OldSize,
+                                                size_t Size, size_t Alignment,
+                                                Script hTag)
+{
+    // Variables...
+    uint32  unClass     = SizeClass(Size, Alignment);
+    void   *pNewBlock   = NULL;
+
+    // Nothing yet, so allocate it...
+    if(!pBlock)
+        return Allocate(Size, Alignment, hTag);
+
+    // Still fits the block of its class...
+    if(unClass != SLAB_SIZE_CLASSES &&
+       unClass == SizeClass(OldSize, Alignment))
+        return pBlock;
+
+    // Otherwise move it...
+    pNewBlock = Allocate(Size, Alignment, hTag);
+
+        // Failed...
+        if(!pNewBlock)
+            return NULL;
+
+    // Copy and free the old one...
+    memcpy(pNewBlock, pBlock, (OldSize < Size) ? OldSize : Size);
+    Free(pBlock, OldSize, Alignment, hTag);
+
+    // Done...
+    return pNewBlock;
+}
+
+// Carve a new slab into a class's free list, or return false if out of
+//  memory...
+bool VirtualMachine::SlabAllocator::Refill(uint32 unClass)
+{
+    // Variables...
+    size_t              BlockSize       = 0;
+    size_t              Alignment       = 0;
+    size_t              Blocks          = 0;
+    size_t              Size            = 0;
+    SlabHeader         *pSlab           = NULL;
+    char               *pFirst          = NULL;
+    size_t              Block           = 0;
+    unsigned long long  Head            = 0;
+
+    // Size the slab, its blocks aligned to their size up to a limit...
+    BlockSize   = (size_t) 1 << (unClass + SLAB_SMALLEST_CLASS_SHIFT);
+    Alignment   = (BlockSize < SLAB_MAXIMUM_ALIGNMENT) ? BlockSize
+                                                       : SLAB_MAXIMUM_ALIGNMENT;
+    Blocks      = SLAB_SIZE / BlockSize;
+    if(Blocks < SLAB_MINIMUM_BLOCKS)
+        Blocks = SLAB_MINIMUM_BLOCKS;
+    Size        = sizeof(SlabHeader) + Alignment + Blocks * BlockSize;
+
+    // Obtain it...
+    pSlab = (SlabHeader *) malloc(Size);
+
+        // Failed...
+        if(!pSlab)
+            return false;
+
+        // Out of reach of a free list head, which would otherwise lose the
+        //  address's high bits and hand out blocks somewhere else entirely...
+        if(((unsigned long long) (size_t) pSlab + Size - 1) >>
+           SLAB_POINTER_BITS)
+        {
+            // Alert and abort...
+            fprintf(stderr, "Agni: slab at %p is above the %d bit addresses "
+                            "the allocator can hold...\n", (void *) pSlab,
+                    SLAB_POINTER_BITS);
+            abort();
+        }
+
+    // Account...
+    AGNI_ATOMIC_ADD(&BytesReserved, Size);
+
+    // Remember it, to give back when destroyed...
+    do
+    {
+        // Read the newest...
+        Head = AGNI_ATOMIC_LOAD(&Slabs);
+
+        // This one follows it...
+        pSlab->pNext = (SlabHeader *) (size_t) Head;
+    }
+    while(!AGNI_ATOMIC_COMPARE_AND_SWAP(&Slabs, Head,
+            (unsigned long long) (size_t) pSlab));
+
+    // Chain its blocks, each leading to the next...
+    pFirst = (char *) SLAB_ALIGN_UP(pSlab + 1, Alignment);
+    for(Block = 0; Block + 1 < Blocks; Block++)
+        *(void **) (pFirst + Block * BlockSize) =
+            pFirst + (Block + 1) * BlockSize;
+
+    // Push them all at once...
+    PushBlocks(unClass, pFirst, pFirst + (Blocks - 1) * BlockSize);
+
+    // Done...
+    return true;
+}
+
+// Size class a block of the given size and alignment is carved from, or
+//  SLAB_SIZE_CLASSES if none...
+uint32 VirtualMachine::SlabAllocator::SizeClass(size_t Size, size_t Alignment)
+{
+    // Variables...
+    uint32  unClass = 0;
+
+    // Aligned beyond what slabs are carved at...
+    if(Alignment > SLAB_MAXIMUM_ALIGNMENT)
+        return SLAB_SIZE_CLASSES;
+
+    // A block of a class is aligned to its size, so it must be at least as
+    //  large as the alignment...
+    if(Size < Alignment)
+        Size = Alignment;
+
+    // Find the smallest class it fits in...
+    while(unClass < SLAB_SIZE_CLASSES &&
+          ((size_t) 1 << (unClass + SLAB_SMALLEST_CLASS_SHIFT)) < Size)
+        unClass++;
+
+    // Done...
+    return unClass;
+}
+
+// Deconstructor gives back every slab...
+VirtualMachine::SlabAllocator::~SlabAllocator()
+{
+    // Variables...
+    SlabHeader *pSlab   = (SlabHeader *) (size_t) Slabs;
+    SlabHeader *pNext   = NULL;
+
+    // Free each...
+    while(pSlab)
+    {
+        // Free...
+        pNext = pSlab->pNext;
+        free(pSlab);
+        pSlab = pNext;
+    }
+}
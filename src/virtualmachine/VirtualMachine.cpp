@@ -12,100 +12,623 @@
 // Using the Agni namespace...
 using namespace Agni;
 
+// Dispatch engine used when the host does not request one...
+#ifndef AGNI_DEFAULT_DISPATCH_ENGINE
+    #define AGNI_DEFAULT_DISPATCH_ENGINE    Dispatch_Threaded
+#endif
+
 // Constructor initializes runtime enviroment...
 VirtualMachine::VirtualMachine(char *_pszHostName, uint8 _HostVersionMajor,
-                               uint8 _HostVersionMinor)
+                               uint8 _HostVersionMinor,
+                               DispatchEngine _Engine,
+                               uint32 _unQuickenThreshold,
+                               uint32 _unOptimizeThreshold,
+                               boolean _bInternStrings,
+                               Allocator *_pAllocator)
 {
+    // Allocate from the host's allocator, if it passed one, before anything...
+    pAllocator = _pAllocator ? _pAllocator : &DefaultAllocator;
+
     // Reset tables and variables to initial state...
-    memset(&HostProvidedFunctionTable, '\x0',
-           sizeof(HostProvidedFunctionTable));
+    pHostProvidedFunctions              = NULL;
+    unHostProvidedFunctionSlots         = 0;
+    unHostProvidedFunctionCount         = 0;
+    unHostProvidedFunctionSlotsUsed     = 0;
     memset(&Scripts, '\x0', sizeof(Scripts));
-    CurrentThreadingMode            = THREADING_MODE_MULTIPLE;
-    hCurrentThread                  = (uint32) -1;
-    unCurrentThreadActivationTime   = 0;
+    unHostProvidedFunctionGeneration = 0;
+    unScriptLoadSerial              = 0;
+    memset(&RunQueue, '\x0', sizeof(RunQueue));
+    unPausedScripts                 = 0;
+    InitializeWorkers();
 
     // Remember host version...
-    pszHostName         = _pszHostName ? strdup(_pszHostName) : NULL;
+    pszHostName         = _pszHostName ? (char *) pAllocator->Allocate(
+                            strlen(_pszHostName) + 1, ALLOCATION_ALIGNMENT,
+                            UNTAGGED_ALLOCATION) : NULL;
+    if(pszHostName)
+        strcpy(pszHostName, _pszHostName);
     HostVersionMajor = _HostVersionMajor;
     HostVersionMinor = _HostVersionMinor;
+
+    // Select instruction dispatch engine, resolving the build's default...
+    Engine = (_Engine == Dispatch_Default) ? AGNI_DEFAULT_DISPATCH_ENGINE
+                                           : _Engine;
+
+    // Remember tiering thresholds...
+    unQuickenThreshold  = _unQuickenThreshold;
+    unOptimizeThreshold = _unOptimizeThreshold;
+
+    // Intern strings, if requested, into a table allocated when first needed...
+    bInternStrings              = _bInternStrings;
+    pInternedStrings            = NULL;
+    unInternedStringSlots       = 0;
+    unInternedStringCount       = 0;
+    unInternedStringSlotsUsed   = 0;
+    unInternLookups             = 0;
+    unInternHits                = 0;
+    unInternedStringBytes       = 0;
 }
 
-// Calculate checksum of file at given path...
-uint32 VirtualMachine::CalculateCheckSumOfExecutable(const char *pszPath)
+// Find the deepest each function's own pushes take the stack above its frame,
+//  where that is known, or throw status code...
+void VirtualMachine::AnalyzeStackDepth(Script hScript)
 {
     // Variables...
-    FILE               *hFile                       = NULL;
-    Agni_MainHeader     DummyHeader;
-    int32               nFileCheckSumFieldStart     = 0x00000000;
-    int32               nFileCheckSumFieldEnd       = 0x00000000;
-    uint8               byte                        = 0x00;
+    AVM_Script         &CurrentScript   = Scripts[hScript];
+    AVM_Instruction    *pInstructions   = NULL;
+    AVM_RuntimeValue   *pTarget         = NULL;
+    int32              *pnDepths        = NULL;
+    uint32              unSize          = 0;
+    uint32              unFunction      = 0;
+    uint32              unIndex         = 0;
+    uint32              unPass          = 0;
+    uint32              unFrame         = 0;
+    int32               nDepth          = 0;
+    int32               nLimit          = 0;
+    bool                bChanged        = false;
+    bool                bBounded        = false;
+
+    // No function may take the stack deeper than it is...
+    nLimit = (int32) CurrentScript.MainHeader.unStackSize;
+
+    // Deepest the stack is known to be before each instruction, or -1 if not
+    //  yet reached...
+    unSize          = CurrentScript.InstructionStreamHeader.unSize;
+    pInstructions   = CurrentScript.InstructionStream.pInstructions;
+    pnDepths        = (int32 *) ArenaAllocate(CurrentScript.ImageArena,
+                                              (unSize + 1) * sizeof(int32));
 
-    // Calculate executable's checksum field's start offset...
-    nFileCheckSumFieldStart = (uint8 *) &DummyHeader.unCheckSum -
-                              (uint8 *) &DummyHeader;
+        // Failed...
+        if(!pnDepths)
+            throw Memory_Allocation;
 
-    // Calculate executable's checksum field's end offset...
-    nFileCheckSumFieldEnd = nFileCheckSumFieldStart;
-    nFileCheckSumFieldEnd += sizeof(DummyHeader.unCheckSum);
+        // Nothing reached yet...
+        memset(pnDepths, '\xff', (unSize + 1) * sizeof(int32));
+
+    // Analyze each function...
+    for(unFunction = 0; unFunction < CurrentScript.FunctionTableHeader.unSize;
+        unFunction++)
+    {
+        // Variables...
+        AVM_FunctionState  &State   = CurrentScript.pFunctionState[unFunction];
+
+        // Unchecked until proven otherwise...
+        State.bStackBounded         = false;
+        State.unMaximumStackDepth   = 0;
+
+            // Empty...
+            if(State.unFirstInstruction >= State.unLastInstruction)
+                continue;
+
+        // Stack holds nothing of its own on entry...
+        pnDepths[State.unFirstInstruction] = 0;
+
+        // Pass over it in order until every depth settles, taking whichever
+        //  is deeper where paths join, which a loop that keeps pushing never
+        //  does...
+        bBounded = true;
+        for(unPass = 0, bChanged = true;
+            bBounded && bChanged && unPass < MAXIMUM_STACK_DEPTH_PASSES;
+            unPass++)
+        {
+            // Nothing changed this pass yet...
+            bChanged = false;
+
+            // Follow each instruction reached so far...
+            for(unIndex = State.unFirstInstruction;
+                bBounded && unIndex < State.unLastInstruction; unIndex++)
+            {
+                // Not reached...
+                if(pnDepths[unIndex] < 0)
+                    continue;
+
+                // Depth after it, and where it branches to, if anywhere...
+                nDepth  = pnDepths[unIndex];
+                pTarget = NULL;
+                switch(pInstructions[unIndex].usOperationCode)
+                {
+                    // Push one...
+                    case INSTRUCTION_AVM_PUSH:
+                        nDepth++;
+                        break;
+
+                    // Pop one, if any are its own...
+                    case INSTRUCTION_AVM_POP:
+                        if(nDepth > 0)
+                            nDepth--;
+                        break;
+
+                    // Callee removes the parameters it was pushed, which is
+                    //  none if it is not known...
+                    case INSTRUCTION_AVM_CALL:
+                        if(pInstructions[unIndex].pOperandList[0].OperandType ==
+                                OT_AVM_INDEX_FUNCTION &&
+                           (uint32) pInstructions[unIndex].pOperandList[0].
+                                nFunctionIndex <
+                                CurrentScript.FunctionTableHeader.unSize)
+                            nDepth -= CurrentScript.pFunctionTable[
+                                pInstructions[unIndex].pOperandList[0].
+                                    nFunctionIndex].ParameterCount;
+                        if(nDepth < 0)
+                            nDepth = 0;
+                        break;
+
+                    // Host function removes however many parameters it likes,
+                    //  so depth is counted afresh after it, and checked again
+                    //  when it returns...
+                    case INSTRUCTION_AVM_CALLHOST:
+                        nDepth = 0;
+                        break;
+
+                    // Unconditional jump never falls through...
+                    case INSTRUCTION_AVM_JMP:
+                        pTarget = &pInstructions[unIndex].pOperandList[0];
+                        break;
+
+                    // Conditional jumps...
+                    case INSTRUCTION_AVM_JE:
+                    case INSTRUCTION_AVM_JNE:
+                    case INSTRUCTION_AVM_JG:
+                    case INSTRUCTION_AVM_JL:
+                    case INSTRUCTION_AVM_JGE:
+                    case INSTRUCTION_AVM_JLE:
+                        pTarget = &pInstructions[unIndex].pOperandList[2];
+                        break;
+
+                    // Returning leaves nothing to follow...
+                    case INSTRUCTION_AVM_RET:
+                        continue;
+
+                    // Anything else leaves the stack as it was...
+                    default:
+                        break;
+                }
+
+                // Too deep to ever fit...
+                if(nDepth >= nLimit)
+                {
+                    bBounded = false;
+                    break;
+                }
+
+                // Deepest so far...
+                if((uint32) nDepth > State.unMaximumStackDepth)
+                    State.unMaximumStackDepth = nDepth;
+
+                // Branches...
+                if(pTarget)
+                {
+                    // To somewhere only known at runtime or in another
+                    //  function, so it could be anywhere...
+                    if(pTarget->OperandType != OT_AVM_INDEX_INSTRUCTION ||
+                       (uint32) pTarget->nInstructionIndex <
+                            State.unFirstInstruction ||
+                       (uint32) pTarget->nInstructionIndex >=
+                            State.unLastInstruction)
+                    {
+                        bBounded = false;
+                        break;
+                    }
+
+                    // Deeper there than known...
+                    if(nDepth > pnDepths[pTarget->nInstructionIndex])
+                    {
+                        pnDepths[pTarget->nInstructionIndex] = nDepth;
+                        bChanged = true;
+                    }
+
+                    // Unconditional jump never falls through...
+                    if(pInstructions[unIndex].usOperationCode ==
+                        INSTRUCTION_AVM_JMP)
+                        continue;
+                }
+
+                // Falls through, and deeper there than known...
+                if(unIndex + 1 < State.unLastInstruction &&
+                   nDepth > pnDepths[unIndex + 1])
+                {
+                    pnDepths[unIndex + 1] = nDepth;
+                    bChanged = true;
+                }
+            }
+        }
+
+        // Known only if every depth settled...
+        State.bStackBounded = bBounded && !bChanged;
+    }
+
+    // Main() is entered with the globals and its frame already pushed, rather
+    //  than called, so its depth is checked here once instead...
+    unFunction = CurrentScript.MainHeader.unMainIndex;
+    if(unFunction < CurrentScript.FunctionTableHeader.unSize)
+    {
+        // Room it takes altogether...
+        unFrame = CurrentScript.MainHeader.unGlobalDataSize +
+                  CurrentScript.pFunctionTable[unFunction].unLocalDataSize + 1;
+
+        // Too much, so leave its pushes checked...
+        if((size_t) unFrame +
+           CurrentScript.pFunctionState[unFunction].unMaximumStackDepth >=
+           (size_t) CurrentScript.MainHeader.unStackSize - 1)
+            CurrentScript.pFunctionState[unFunction].bStackBounded = false;
+    }
+
+    // Done with the depths...
+    ArenaFree(CurrentScript.ImageArena, pnDepths);
+}
+
+// Bind each of a script's host functions to the host provided function
+//  registered under its name...
+void VirtualMachine::BindHostFunctions(Script hScript)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript       = Scripts[hScript];
+    AVM_HostProvidedFunction   *pHostProvidedFunction = NULL;
+    uint32                      unIndex             = 0;
+
+    // Bind each host function...
+    for(unIndex = 0; unIndex < CurrentScript.HostFunctionTableHeader.unSize;
+        unIndex++)
+    {
+        // Get the actual name of the desired host function...
+        const char *pszHostFunction =
+            CurrentScript.pHostFunctionTable[unIndex].szName;
+
+        // Prefer one registered to this thread, then a global one...
+        pHostProvidedFunction =
+            FindHostProvidedFunction(hScript, pszHostFunction);
+        if(!pHostProvidedFunction)
+            pHostProvidedFunction = FindHostProvidedFunction(
+                (Script) GLOBAL_HOST_FUNCTION, pszHostFunction);
+
+        // Bind, or leave unbound if the host provides none...
+        CurrentScript.ppHostFunctionBindings[unIndex] =
+            pHostProvidedFunction ? pHostProvidedFunction->pEntryPoint : NULL;
+    }
+
+    // Bound against the registry as it is now...
+    CurrentScript.unHostFunctionBindingGeneration =
+        unHostProvidedFunctionGeneration;
+}
+
+// Build a script's code image from its loaded instructions and string table or
+//  throw status code...
+void VirtualMachine::BuildCodeImage(Script hScript,
+                                    const AVM_ThreadedInstruction *pLoadedCode,
+                                    char **ppszStringTable)
+{
+    // Variables...
+    AVM_Script         &CurrentScript           = Scripts[hScript];
+    uint32              unSize                  = 0;
+    uint32              unStringCount           = 0;
+    size_t              ThreadedCodeSize        = 0;
+    size_t              InstructionStreamSize   = 0;
+    size_t              LiteralPoolSize         = 0;
+    char               *pCursor                 = NULL;
+    char              **ppszLiterals            = NULL;
+    uint32              unIndex                 = 0;
+    uint8               OperandIndex            = 0;
+    AVM_RuntimeValue   *pOperand                = NULL;
+
+    // Calculate the size of each part of the image...
+    unSize                  = CurrentScript.InstructionStreamHeader.unSize;
+    unStringCount           = ppszStringTable ?
+                                CurrentScript.StringStreamHeader.unSize : 0;
+    ThreadedCodeSize        = (unSize + 1) * sizeof(AVM_ThreadedInstruction);
+    InstructionStreamSize   = unSize * sizeof(AVM_Instruction);
+    for(unIndex = 0; unIndex < unStringCount && !bInternStrings; unIndex++)
+        LiteralPoolSize += AVM_STRING_SIZE(strlen(ppszStringTable[unIndex]));
+
+    // Allocate the image in one piece, with room to align it...
+    CurrentScript.pCodeImage = ArenaAllocate(CurrentScript.ImageArena,
+                                             CODE_IMAGE_ALIGNMENT - 1 +
+                                             ThreadedCodeSize +
+                                             InstructionStreamSize +
+                                             LiteralPoolSize);
+
+        // Failed...
+        if(!CurrentScript.pCodeImage)
+            throw Memory_Allocation;
+
+    // Allocate table to find each string literal's place in the pool...
+    if(unStringCount > 0)
+    {
+        // Allocate...
+        ppszLiterals = (char **) ArenaAllocateZeroed(CurrentScript.ImageArena,
+                                                     unStringCount,
+                                                     sizeof(char *));
+
+            // Failed...
+            if(!ppszLiterals)
+                throw Memory_Allocation;
+    }
+
+    // Threaded code starts on the first cache line boundary...
+    pCursor = (char *) CurrentScript.pCodeImage;
+    pCursor += (CODE_IMAGE_ALIGNMENT - ((size_t) pCursor % CODE_IMAGE_ALIGNMENT))
+                % CODE_IMAGE_ALIGNMENT;
+    CurrentScript.pThreadedCode = (AVM_ThreadedInstruction *) pCursor;
+    memcpy(CurrentScript.pThreadedCode, pLoadedCode, ThreadedCodeSize);
+    pCursor += ThreadedCodeSize;
+
+    // Instruction stream follows, indexing into the threaded code...
+    CurrentScript.InstructionStream.pInstructions = (AVM_Instruction *) pCursor;
+    pCursor += InstructionStreamSize;
+
+    // Interning strings, so literals are shared with every other script and
+    //  whatever host functions return, and the script holds a reference to
+    //  each until it is unloaded...
+    if(bInternStrings)
+    {
+        // Remember them to release...
+        CurrentScript.ppszInternedLiterals = ppszLiterals;
+
+        // Intern each...
+        for(unIndex = 0; unIndex < unStringCount; unIndex++)
+        {
+            // Intern...
+            ppszLiterals[unIndex] = InternString(
+                ppszStringTable[unIndex], strlen(ppszStringTable[unIndex]));
+
+                // Failed...
+                if(!ppszLiterals[unIndex])
+                    throw Memory_Allocation;
+        }
+    }
+
+    // Otherwise string literals are pooled at the end, one copy of each, which
+    //  every value the script copies them into shares uncounted...
+    else
+    {
+        // Pool each...
+        for(unIndex = 0; unIndex < unStringCount; unIndex++)
+        {
+            // Variables...
+            AVM_String *pLiteral = (AVM_String *) pCursor;
+
+            // Copy and remember where...
+            pLiteral->unReferences  = 0;
+            pLiteral->unLength      = strlen(ppszStringTable[unIndex]);
+            pLiteral->unCapacity    = pLiteral->unLength;
+            pLiteral->unHash        = 0;
+            pLiteral->hOwner        = hScript;
+            pLiteral->bInterned     = false;
+            memcpy(pLiteral->szCharacters, ppszStringTable[unIndex],
+                   pLiteral->unLength + 1);
+            ppszLiterals[unIndex] = pLiteral->szCharacters;
+            pCursor += AVM_STRING_SIZE(pLiteral->unLength);
+        }
+    }
+
+    // Index each instruction and convert string table indices to literals...
+    for(unIndex = 0; unIndex < unSize; unIndex++)
+    {
+        // Variables...
+        AVM_ThreadedInstruction &Threaded = CurrentScript.pThreadedCode[unIndex];
+        AVM_Instruction &Instruction =
+            CurrentScript.InstructionStream.pInstructions[unIndex];
+
+        // Index threaded instruction...
+        Instruction.usOperationCode = Threaded.usOperationCode;
+        Instruction.OperandCount    = Threaded.OperandCount;
+        Instruction.pOperandList    = Threaded.Operands;
+
+        // Scan operands for string table indices...
+        for(OperandIndex = 0; OperandIndex < Threaded.OperandCount;
+            OperandIndex++)
+        {
+            // Not a string index, skip...
+            pOperand = &Threaded.Operands[OperandIndex];
+            if(pOperand->OperandType != OT_AVM_INDEX_STRING)
+                continue;
+
+            // No such string...
+            //  (nStringTableIndex -> nLiteralInteger)
+            if((uint32) pOperand->nLiteralInteger >= unStringCount)
+            {
+                // Cleanup, unless the script now owns it...
+                if(!CurrentScript.ppszInternedLiterals)
+                    ArenaFree(CurrentScript.ImageArena, ppszLiterals);
+
+                // Abort...
+                throw Bad_Executable;
+            }
+
+            // Point to pooled literal and mark operand as string literal...
+            AVM_SET_LITERAL_STRING(*pOperand,
+                                   ppszLiterals[pOperand->nLiteralInteger]);
+            pOperand->OperandType       = OT_AVM_STRING;
+        }
+    }
+
+    // Running off the end of the stream terminates the script...
+    CurrentScript.pThreadedCode[unSize].usOperationCode = INSTRUCTION_AVM_EXIT;
+
+    // Done with literal table, unless the script now owns it...
+    if(!CurrentScript.ppszInternedLiterals)
+        ArenaFree(CurrentScript.ImageArena, ppszLiterals);
+}
+
+// Build a script's function export index or throw a status code...
+void VirtualMachine::BuildFunctionIndex(Script hScript)
+{
+    // Variables...
+    AVM_Script &CurrentScript   = Scripts[hScript];
+    uint32      unSlots         = 8;
+    uint32      unMask          = 0;
+    uint32      unSlot          = 0;
+
+    // No functions to index...
+    if(!CurrentScript.FunctionTableHeader.unSize)
+        return;
+
+    // Size it to a power of two at least twice the functions, keeping probe
+    //  sequences short...
+    while(unSlots < CurrentScript.FunctionTableHeader.unSize * 2)
+        unSlots <<= 1;
 
-    // Open file...
-    hFile = fopen(pszPath, "rb");
+    // Allocate...
+    CurrentScript.punFunctionIndex = (uint32 *) ArenaAllocateZeroed(
+        CurrentScript.ImageArena, unSlots, sizeof(uint32));
 
         // Failed...
-        if(!hFile)
-            return 0x00000000;
+        if(!CurrentScript.punFunctionIndex)
+            throw Memory_Allocation;
+
+    // Remember its size...
+    CurrentScript.unFunctionIndexSlots = unSlots;
+    unMask = unSlots - 1;
+
+    // Insert each function in table order, so that should two share a name
+    //  the first is still found first as before...
+    for(uint32 unIndex = 0; unIndex < CurrentScript.FunctionTableHeader.unSize;
+        unIndex++)
+    {
+        // Probe for an empty slot...
+        for(unSlot = HashName(CurrentScript.pFunctionTable[unIndex].szName) &
+                        unMask;
+            CurrentScript.punFunctionIndex[unSlot] != 0;
+            unSlot = (unSlot + 1) & unMask);
+
+        // Store it...
+        CurrentScript.punFunctionIndex[unSlot] = unIndex + 1;
+    }
+}
+
+// Calculate checksum of executable image...
+uint32 VirtualMachine::CalculateCheckSumOfImage(const AVM_ScriptImage &Image)
+{
+    // Variables...
+    Agni_MainHeader     DummyHeader;
+    uint32              unFileCheckSumFieldStart    = 0x00000000;
+    uint32              unFileCheckSumFieldEnd      = 0x00000000;
+
+    // Calculate executable's checksum field's start offset...
+    unFileCheckSumFieldStart = (uint8 *) &DummyHeader.unCheckSum -
+                               (uint8 *) &DummyHeader;
+
+    // Calculate executable's checksum field's end offset...
+    unFileCheckSumFieldEnd = unFileCheckSumFieldStart;
+    unFileCheckSumFieldEnd += sizeof(DummyHeader.unCheckSum);
 
     // Clear CRC register...
     unTempCheckSum = 0x00000000;
 
-    // Calculate for each byte, while there are some...
-    while(1 == fread(&byte, sizeof(byte), 1, hFile))
+    // Calculate for each byte...
+    for(uint32 unOffset = 0; unOffset < Image.unSize; unOffset++)
     {
         // We are reading the checksum field of the executable, assume zero...
-        if((nFileCheckSumFieldStart <= ftell(hFile) - 1) &&
-           (ftell(hFile) - 1 < nFileCheckSumFieldEnd))
-            byte = 0x00;
+        if((unFileCheckSumFieldStart <= unOffset) &&
+           (unOffset < unFileCheckSumFieldEnd))
+            CheckSum_PutByte(0x00);
 
         // Add byte to computation...
-        CheckSum_PutByte(byte);
+        else
+            CheckSum_PutByte(Image.pBytes[unOffset]);
     }
 
-    // Cleanup...
-    fclose(hFile);
-
     // Return checksum to caller...
     return unTempCheckSum;
 }
 
-// Call script function asynchronously... (blocking)
-boolean VirtualMachine::CallFunction(Script hScript, char *pszName)
+// Count the iterations a worker ran up to a read of the clock and size the
+//  quantum until its next read to a fraction of its current thread's time
+//  slice...
+void VirtualMachine::CalibrateClockQuantum(AVM_Worker &Worker,
+                                           uint32 unCurrentTime)
 {
     // Variables...
-    int32               nFunctionIndex          = 0;
-    uint8               PreviousThreadingMode   = 0;
-    Script              hPreviousThread         = 0;
-    AVM_RuntimeValue    StackBase;
+    uint32              unElapsed   = unCurrentTime -
+                                      Worker.unClockWindowStartTime;
+    uint32              unTimeSlice = THREAD_PRIORITY_LOW_DURATION;
+    unsigned long long  Quantum     = 0;
 
+    // Count the quantum just run...
+    Worker.unClockWindowIterations += Worker.unClockQuantum;
+
+    // Window is long enough to measure over even a coarse clock, so measure
+    //  and start another...
+    if(unElapsed >= CLOCK_CALIBRATION_WINDOW)
+    {
+        Worker.unIterationsPerMilliSecond   =
+            Worker.unClockWindowIterations / unElapsed;
+        Worker.unClockWindowIterations      = 0;
+        Worker.unClockWindowStartTime       = unCurrentTime;
+    }
+
+    // Current thread's time slice, if there is one...
+    if(Worker.hCurrentThread < MAXIMUM_THREADS &&
+       Scripts[Worker.hCurrentThread].unThreadTimeSlice)
+        unTimeSlice = Scripts[Worker.hCurrentThread].unThreadTimeSlice;
+
+    // Run enough to read the clock a few times each slice, or read it every
+    //  time until the rate is known...
+    Quantum = (unsigned long long) Worker.unIterationsPerMilliSecond *
+              unTimeSlice / CLOCK_READS_PER_TIME_SLICE;
+    if(Quantum < 1)
+        Quantum = 1;
+    if(Quantum > MAXIMUM_CLOCK_QUANTUM)
+        Quantum = MAXIMUM_CLOCK_QUANTUM;
+
+    // Start counting it down...
+    Worker.unClockQuantum   = (uint32) Quantum;
+    Worker.unClockCountdown = Worker.unClockQuantum;
+}
+
+// Call script function asynchronously... (blocking)
+boolean VirtualMachine::CallFunction(Script hScript, char *pszName)
+{
     // Check handle...
     if(!IsValidThread(hScript))
         return false;
 
-    // Locate function...
-    nFunctionIndex = GetFunctionIndexByName(hScript, pszName);
+    // Resolve the function and call it...
+    return CallFunction(hScript, ResolveFunction(hScript, pszName));
+}
 
-        // Failed...
-        if(nFunctionIndex == -1)
-            return false;
+// Call resolved script function asynchronously... (blocking)
+boolean VirtualMachine::CallFunction(Script hScript, Function hFunction)
+{
+    // Variables...
+    AVM_Worker          Worker;
+    AVM_RuntimeValue    StackBase;
+    int32               nFunctionIndex  = 0;
 
-    // Save current virtual machine state...
-    PreviousThreadingMode   = CurrentThreadingMode;
-    hPreviousThread         = hCurrentThread;
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
 
-    // Switch to single thread execution mode...
-    CurrentThreadingMode = THREADING_MODE_SINGLE;
+    // Check function handle, which may be stale...
+    nFunctionIndex = GetFunctionIndexByHandle(hScript, hFunction);
+    if(nFunctionIndex == -1)
+        return false;
 
-    // Switch active thread to user's script...
-    hCurrentThread = hScript;
+    // Run it on a worker of its own in single thread execution mode, leaving
+    //  whichever the caller may be running on as it was, with the clock read
+    //  as often as the host's thread reads it...
+    Worker                  = MainWorker;
+    Worker.ThreadingMode    = THREADING_MODE_SINGLE;
+    Worker.hCurrentThread   = hScript;
 
     // Call the function...
     CallFunctionImplementation(hScript, nFunctionIndex);
@@ -113,20 +636,16 @@ boolean VirtualMachine::CallFunction(Script hScript, char *pszName)
     // Set the stack base marker...
 
         // Find stack base...
-        StackBase = GetStackValue(hCurrentThread,
-                                  Scripts[hCurrentThread].Stack.nTopIndex - 1);
+        StackBase = GetStackValue(hScript,
+                                  Scripts[hScript].Stack.nTopIndex - 1);
 
         // Set it...
         StackBase.OperandType = OT_AVM_STACK_BASE_MARKER;
-        SetStackValue(hCurrentThread,
-                      Scripts[hCurrentThread].Stack.nTopIndex - 1, StackBase);
+        SetStackValue(hScript, Scripts[hScript].Stack.nTopIndex - 1,
+                      StackBase);
 
     // Let script run until it returns...
-    RunScripts(THREAD_PRIORITY_INFINITE);
-
-    // Restore the virtual machine state...
-    CurrentThreadingMode = PreviousThreadingMode;
-    hCurrentThread = hPreviousThread;
+    RunWorker(Worker, THREAD_PRIORITY_INFINITE);
 
     // Done...
     return true;
@@ -152,38 +671,78 @@ void VirtualMachine::CallFunctionImplementation(Script hScript, uint32 unIndex)
     CallerReturnAddress.nInstructionIndex =
         Scripts[hScript].InstructionStream.unInstructionPointer;
 
-    // Push caller's return address onto the stack...
-    Push(hScript, CallerReturnAddress);
+    // Callee's deepest use of the stack is known, so check once that all of
+    //  it fits and push without checking again...
+    if(Scripts[hScript].pFunctionState[unIndex].bStackBounded)
+    {
+        // Stack overflow, unless the first use past the stack touches its
+        //  upper guard instead...
+        #if !defined(AGNI_GUARDED_STACKS)
+        if((size_t) Scripts[hScript].Stack.nTopIndex + 1 +
+           DestinationFunction.unLocalDataSize + 1 +
+           Scripts[hScript].pFunctionState[unIndex].unMaximumStackDepth >=
+           (size_t) Scripts[hScript].MainHeader.unStackSize - 1)
+            throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+        #endif
+
+        // Push caller's return address onto the stack...
+        PushWithinBound(hScript, CallerReturnAddress);
+
+        // Push stack frame plus extra space for function index...
+        PushStackFrameWithinBound(hScript,
+                                  DestinationFunction.unLocalDataSize + 1);
+    }
+
+    // Otherwise check each push...
+    else
+    {
+        // Push caller's return address onto the stack...
+        Push(hScript, CallerReturnAddress);
 
-    // Push stack frame plus extra space for function index...
-    PushStackFrame(hScript, DestinationFunction.unLocalDataSize + 1);
+        // Push stack frame plus extra space for function index...
+        PushStackFrame(hScript, DestinationFunction.unLocalDataSize + 1);
+    }
 
     // Save new function's index and old stack frame to the top of the stack...
     FunctionIndex.nStackIndex[0] = unIndex;
-    FunctionIndex.nStackIndex[1] = nFrameIndex;
+    AVM_STACK_OFFSET(FunctionIndex) = nFrameIndex;
     SetStackValue(hScript, Scripts[hScript].Stack.nTopIndex - 1, FunctionIndex);
 
     // Jump to the script routine's entry point...
     Scripts[hScript].InstructionStream.unInstructionPointer
         = DestinationFunction.unEntryPoint;
+
+    // It is getting hotter...
+    CountHotness(hScript, unIndex, false);
 }
 
 // Call script function synchronously... (non-blocking)
 boolean VirtualMachine::CallFunctionSynchronously(Script hScript, char *pszName)
 {
-    // Variables..
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Resolve the function and call it...
+    return CallFunctionSynchronously(hScript,
+                                     ResolveFunction(hScript, pszName));
+}
+
+// Call resolved script function synchronously... (non-blocking)
+boolean VirtualMachine::CallFunctionSynchronously(Script hScript,
+                                                  Function hFunction)
+{
+    // Variables...
     int32 nFunctionIndex = 0;
 
     // Check handle...
     if(!IsValidThread(hScript))
         return false;
 
-    // Get the function index...
-    nFunctionIndex = GetFunctionIndexByName(hScript, pszName);
-
-        // Not found...
-        if(nFunctionIndex == -1)
-            return false;
+    // Check function handle, which may be stale...
+    nFunctionIndex = GetFunctionIndexByHandle(hScript, hFunction);
+    if(nFunctionIndex == -1)
+        return false;
 
     // Call the function...
     CallFunctionImplementation(hScript, nFunctionIndex);
@@ -192,6 +751,25 @@ boolean VirtualMachine::CallFunctionSynchronously(Script hScript, char *pszName)
     return true;
 }
 
+// Make sure whatever remains of the function a thread resumes in still fits on
+//  the stack, if its pushes go unchecked, now that a host function may have
+//  left values on it, or throw execution exception...
+void VirtualMachine::CheckStackBound(Script hScript)
+{
+    // Stack overflow, unless the first use past the stack touches its upper
+    //  guard instead...
+    #if !defined(AGNI_GUARDED_STACKS)
+    uint32 unFunctionIndex = Scripts[hScript].pThreadedCode[
+        Scripts[hScript].InstructionStream.unInstructionPointer].unFunctionIndex;
+    if(unFunctionIndex < Scripts[hScript].FunctionTableHeader.unSize &&
+       Scripts[hScript].pFunctionState[unFunctionIndex].bStackBounded &&
+       (size_t) Scripts[hScript].Stack.nTopIndex +
+       Scripts[hScript].pFunctionState[unFunctionIndex].unMaximumStackDepth >=
+       (size_t) Scripts[hScript].MainHeader.unStackSize - 1)
+        throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    #endif
+}
+
 // Acknowledge bit in calculation...
 inline void VirtualMachine::CheckSum_PutBit(boolean Bit)
 {
@@ -255,7 +833,8 @@ float32 VirtualMachine::CoerceValueToFloat(AVM_RuntimeValue RuntimeValue)
 
         // String...
         case OT_AVM_STRING:
-            return (float) atof(RuntimeValue.pszLiteralString);
+        case OT_AVM_SHORT_STRING:
+            return (float) atof(AVM_CHARACTERS_OF(RuntimeValue));
 
         // Anything else should be treated as invalid...
         default:
@@ -279,7 +858,8 @@ int32 VirtualMachine::CoerceValueToInteger(AVM_RuntimeValue RuntimeValue)
 
         // String...
         case OT_AVM_STRING:
-            return atoi(RuntimeValue.pszLiteralString);
+        case OT_AVM_SHORT_STRING:
+            return atoi(AVM_CHARACTERS_OF(RuntimeValue));
 
         // Anything else should be treated as invalid...
         default:
@@ -287,46 +867,35 @@ int32 VirtualMachine::CoerceValueToInteger(AVM_RuntimeValue RuntimeValue)
     }
 }
 
-// Coerce value to string or throw error string...
-char *VirtualMachine::CoerceValueToString(AVM_RuntimeValue RuntimeValue)
+// Coerce value to string, pointing into it if it holds a short string, or
+//  formatting a number into the given buffer of at least
+//  MAXIMUM_COERCION_LENGTH + 1 characters, or throw error string...
+char *VirtualMachine::CoerceValueToString(const AVM_RuntimeValue &RuntimeValue,
+                                          char *pszBuffer)
 {
-    // Variables...
-    char   *pszCoercion = NULL;
-
-    // Value is not already a string...
-    if(RuntimeValue.OperandType != OT_AVM_STRING)
-    {
-        // Allocate storage space...
-        pszCoercion = (char *) malloc(MAXIMUM_COERCION_LENGTH + 1);
-
-            // Failed...
-            if(!pszCoercion)
-                throw "memory allocation failed";
-    }
-
     // Coerce differently, depending on type...
     switch(RuntimeValue.OperandType)
     {
         // Float...
         case OT_AVM_FLOAT:
         {
-            // Convert to string and return it...
-            sprintf(pszCoercion, "%f", RuntimeValue.fLiteralFloat);
-            return pszCoercion;
+            // Format it and return it...
+            FormatFloat(RuntimeValue.fLiteralFloat, pszBuffer);
+            return pszBuffer;
         }
 
         // Integer...
         case OT_AVM_INTEGER:
         {
-            // Convert to string and return it...
-//            itoa(RuntimeValue.nLiteralInteger, pszCoercion, 10);
-            sprintf(pszCoercion, "%d", RuntimeValue.nLiteralInteger);
-            return pszCoercion;
+            // Format it and return it...
+            FormatInteger(RuntimeValue.nLiteralInteger, pszBuffer);
+            return pszBuffer;
         }
 
         // String...
         case OT_AVM_STRING:
-            return RuntimeValue.pszLiteralString;
+        case OT_AVM_SHORT_STRING:
+            return AVM_CHARACTERS_OF(RuntimeValue);
 
         // Anything else is invalid...
         default:
@@ -334,36 +903,176 @@ char *VirtualMachine::CoerceValueToString(AVM_RuntimeValue RuntimeValue)
     }
 }
 
-// Copy source value into destination or throw error string...
-void VirtualMachine::CopyValue(AVM_RuntimeValue *pDestinationValue,
-                      AVM_RuntimeValue SourceValue)
+// Append characters to a string value, in place if it is its own, growing it
+//  geometrically, or building the result inline if it is short enough, or throw
+//  error string...
+void VirtualMachine::ConcatenateString(Script hScript,
+                                       AVM_RuntimeValue *pDestination,
+                                       const char *pszSource)
 {
-    // Destination already contains a string, so free it...
-    if(pDestinationValue->OperandType == OT_AVM_STRING)
-        free(pDestinationValue->pszLiteralString);
+    // Variables...
+    char       *pszDestination  = AVM_CHARACTERS_OF(*pDestination);
+    AVM_String *pString         = NULL;
+    uint32      unLength        = 0;
+    uint32      unSourceLength  = strlen(pszSource);
+    uint32      unCapacity      = 0;
+    size_t      SourceOffset    = 0;
+    bool        bSourceInside   = false;
+    char        szShort[SHORT_STRING_SIZE];
+    char       *pszNew          = NULL;
+
+    // Find destination's length...
+    unLength = (pDestination->OperandType == OT_AVM_SHORT_STRING) ?
+                strlen(pszDestination) :
+                AVM_STRING_OF(pszDestination)->unLength;
+
+    // Result is still short, so build it inline...
+    if(unLength + unSourceLength < SHORT_STRING_SIZE)
+    {
+        // Build, as the source may be the destination itself...
+        memcpy(szShort, pszDestination, unLength);
+        memcpy(szShort + unLength, pszSource, unSourceLength);
 
-    // Copy source to destination...
+        // Store it...
+        StoreString(hScript, pDestination, szShort, unLength + unSourceLength);
+
+        // Done...
+        return;
+    }
 
-        // Copy data...
-       *pDestinationValue = SourceValue;
+    // Destination's string is its own, so append to it in place, unless it is
+    //  interned where others may yet find it...
+    if(pDestination->OperandType == OT_AVM_STRING &&
+       !AVM_STRING_OF(pszDestination)->bInterned &&
+       AVM_STRING_OF(pszDestination)->unReferences == 1)
+    {
+        // Find it...
+        pString = AVM_STRING_OF(pszDestination);
 
-        // Make a copy of the string, if necessary...
-        if(SourceValue.OperandType == OT_AVM_STRING)
+        // Not enough room, so double it, or more if still not enough, so that
+        //  a loop appending to it copies each character a constant number of
+        //  times on average...
+        if(pString->unCapacity < unLength + unSourceLength)
         {
-            // Allocate and copy...
-            pDestinationValue->pszLiteralString =
-                                        strdup(SourceValue.pszLiteralString);
+            // Source may be the destination itself, which is about to move...
+            bSourceInside   = (pszSource >= pszDestination &&
+                               pszSource <= pszDestination + unLength);
+            SourceOffset    = pszSource - pszDestination;
+
+            // Grow...
+            unCapacity = pString->unCapacity * 2;
+            if(unCapacity < unLength + unSourceLength)
+                unCapacity = unLength + unSourceLength;
+            pString = (AVM_String *) ArenaReallocate(
+                Scripts[pString->hOwner].RuntimeArena, pString,
+                AVM_STRING_SIZE(unCapacity));
 
                 // Failed...
-                if(!pDestinationValue->pszLiteralString)
-                {
-                    // Cleanup...
-                    SourceValue.OperandType = OT_AVM_NULL;
-
-                    // Abort...
+                if(!pString)
                     throw "memory allocation failed";
-                }
+
+            // Remember where it went...
+            pString->unCapacity = unCapacity;
+            pszDestination = pString->szCharacters;
+            AVM_SET_LITERAL_STRING(*pDestination, pszDestination);
+            if(bSourceInside)
+                pszSource = pszDestination + SourceOffset;
+        }
+
+        // Append...
+        memcpy(pszDestination + unLength, pszSource, unSourceLength);
+        pString->unLength += unSourceLength;
+        pszDestination[pString->unLength] = '\x0';
+
+        // Done...
+        return;
+    }
+
+    // Otherwise allocate a new string, with as much room again to append to
+    //  it in place next time...
+    pszNew = NewString(hScript, NULL, unLength + unSourceLength,
+                       (unLength + unSourceLength) * 2);
+
+        // Failed...
+        if(!pszNew)
+            throw "memory allocation failed";
+
+    // Build it...
+    memcpy(pszNew, pszDestination, unLength);
+    memcpy(pszNew + unLength, pszSource, unSourceLength);
+
+    // Replace old string with new one...
+    ReleaseValue(pDestination);
+    pDestination->OperandType       = OT_AVM_STRING;
+    AVM_SET_LITERAL_STRING(*pDestination, pszNew);
+}
+
+// Count a function's invocation or backward branch and promote it if that made
+//  it hot enough...
+void VirtualMachine::CountHotness(Script hScript, uint32 unFunctionIndex,
+                                  bool bBackwardBranch)
+{
+    // Variables...
+    AVM_Script     &CurrentScript   = Scripts[hScript];
+    uint32          unHotness       = 0;
+
+    // Not a function...
+    if(unFunctionIndex >= CurrentScript.FunctionTableHeader.unSize)
+        return;
+
+    // Count...
+    FunctionProfile &Profile =
+        CurrentScript.pFunctionState[unFunctionIndex].Profile;
+    if(bBackwardBranch)
+        Profile.unBackwardBranches++;
+    else
+        Profile.unInvocations++;
+
+    // Already as optimized as it will get...
+    if(!CurrentScript.bTiering || Profile.Tier == Tier_Optimized)
+        return;
+
+    // Promote, if hot enough...
+    unHotness = Profile.unInvocations + Profile.unBackwardBranches;
+    if(unHotness >= unOptimizeThreshold)
+        PromoteFunction(hScript, unFunctionIndex, Tier_Optimized);
+    else if(Profile.Tier == Tier_Interpreted && unHotness >= unQuickenThreshold)
+        PromoteFunction(hScript, unFunctionIndex, Tier_Quickened);
+}
+
+// Copy source value into destination, sharing any string...
+void VirtualMachine::CopyValue(AVM_RuntimeValue *pDestinationValue,
+                      AVM_RuntimeValue SourceValue)
+{
+    // Variables...
+    AVM_String *pString = NULL;
+
+    // Source's string gains its reference before the destination's loses one,
+    //  in case they are the same...
+    if(SourceValue.OperandType == OT_AVM_STRING)
+    {
+        // Find it...
+        pString = AVM_STRING_OF(AVM_LITERAL_STRING(SourceValue));
+
+        // Interned, and so shared by scripts that may be running in
+        //  parallel...
+        if(pString->bInterned)
+        {
+            LockInternedStrings();
+            pString->unReferences++;
+            UnlockInternedStrings();
         }
+
+        // Otherwise counted, unless a literal...
+        else if(pString->unReferences)
+            pString->unReferences++;
+    }
+
+    // Destination already contains a string, so release it...
+    ReleaseValue(pDestinationValue);
+
+    // Copy source to destination...
+   *pDestinationValue = SourceValue;
 }
 
 /* Display statistics...
@@ -425,1091 +1134,3721 @@ void VirtualMachine::DisplayStatistics(Script hScript) const
                                             == (unsigned) -1) ? "No" : "Yes");
 }*/
 
-// Get a function by index or return NULL on error...
-inline Agni_Function VirtualMachine::GetFunction(Script hScript, uint32 unIndex)
-{
-    // Return it...
-    return Scripts[hScript].pFunctionTable[unIndex];
-}
+// Threaded dispatch engine handler and dispatch macros...
+
+    // Handlers are labels and each dispatches straight to the next...
+    #if defined(AGNI_COMPUTED_GOTO)
+        #define THREADED_HANDLER(Name)      Handler_##Name:
+        #define THREADED_UNKNOWN_HANDLER()  Handler_Unknown:
+        #define THREADED_DISPATCH()         goto *pInstruction->pHandler
+
+    // Portable fallback switches on the operation code for every dispatch...
+    #else
+        #define THREADED_HANDLER(Name)      case INSTRUCTION_AVM_##Name:
+        #define THREADED_UNKNOWN_HANDLER()  default:
+        #define THREADED_DISPATCH()         continue
+    #endif
+
+    // Instruction index the given threaded instruction was translated from...
+    #define THREADED_INDEX(pThreaded)   \
+        (bRegisterCode ? \
+            CurrentScript.punRegisterSource[(pThreaded) - pCode] : \
+            (uint32) ((pThreaded) - pCode))
+
+    // Threaded instruction the given instruction index was translated into...
+    #define THREADED_AT(unIndex)        \
+        (&pCode[bRegisterCode ? CurrentScript.punRegisterIndex[unIndex] : \
+                                (unIndex)])
+
+    // Operand of the current threaded instruction...
+    #define THREADED_OPERAND(Index)     (pInstruction->Operands[Index])
+
+    // Advance to the next instruction and dispatch it...
+    #define THREADED_NEXT()             \
+        { pInstruction++; THREADED_DISPATCH(); }
+
+    // Shift to an instruction and hand control back to the scheduler...
+    #define THREADED_SAFE_POINT(pTarget) \
+        { pInstruction = (pTarget); goto SafePoint; }
+
+    // Branch to an instruction, but only backward branches can loop and so
+    //  only they need to give the scheduler a chance to run...
+    #define THREADED_BRANCH(pTarget)    \
+        { if((pTarget) <= pInstruction) \
+          { if(!bRegisterCode) \
+                CountHotness(hScript, pInstruction->unFunctionIndex, true); \
+            THREADED_SAFE_POINT(pTarget) } \
+          pInstruction = (pTarget); THREADED_DISPATCH(); }
+
+    // Branch target of the current instruction, resolving at runtime if it
+    //  could not be resolved at load time...
+    #define THREADED_TARGET(Index)      \
+        (pInstruction->pJumpTarget ? pInstruction->pJumpTarget : \
+            THREADED_AT(ResolveValueOf(hScript, THREADED_OPERAND(Index)). \
+                            nInstructionIndex))
+
+    // Arithmetic specialized on the source operand's type...
+    #define THREADED_ARITHMETIC(Operator) \
+        pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0)); \
+        Source          = ResolveValueOf(hScript, THREADED_OPERAND(1)); \
+        if(Source.OperandType == OT_AVM_INTEGER) \
+            pDestination->nLiteralInteger Operator \
+                CoerceValueToInteger(Source); \
+        else \
+            pDestination->fLiteralFloat Operator CoerceValueToFloat(Source);
+
+    // Bitwise operation, only defined for integral destinations...
+    #define THREADED_BITWISE(Operator) \
+        pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0)); \
+        Source          = ResolveValueOf(hScript, THREADED_OPERAND(1)); \
+        if(pDestination->OperandType == OT_AVM_INTEGER) \
+            pDestination->nLiteralInteger Operator \
+                CoerceValueToInteger(Source);
+
+    // Numeric comparison of the first operand against the second...
+    #define THREADED_COMPARE(Operator) \
+        Operand0 = ResolveValueOf(hScript, THREADED_OPERAND(0)); \
+        Operand1 = ResolveValueOf(hScript, THREADED_OPERAND(1)); \
+        switch(Operand0.OperandType) \
+        { \
+            case OT_AVM_INTEGER: \
+                bJump = (Operand0.nLiteralInteger Operator \
+                         Operand1.nLiteralInteger); \
+                break; \
+            case OT_AVM_FLOAT: \
+                bJump = (Operand0.fLiteralFloat Operator \
+                         Operand1.fLiteralFloat); \
+                break; \
+            case OT_AVM_STRING: \
+            case OT_AVM_SHORT_STRING: \
+                bJump = bStringsComparable && \
+                        ((StringsEqual(Operand0, Operand1) ? 0 : 1) \
+                            Operator 0); \
+                break; \
+            default: \
+                bJump = false; \
+        }
 
-// Get a function index by name or return -1 on error...
-int32 VirtualMachine::GetFunctionIndexByName(Script hScript, char *pszName)
+// Run a script's threaded code, or register code, up to its next safe point
+//  and return true if the stack base was reached...
+template <bool bRegisterCode>
+bool VirtualMachine::ExecuteThreadedCode(Script hScript)
 {
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return -1;
-
-    // Scan through function table...
-    for(uint32 unFunctionTableIndex = 0;
-        unFunctionTableIndex < Scripts[hScript].FunctionTableHeader.unSize;
-        unFunctionTableIndex++)
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_ThreadedInstruction    *pCode           = NULL;
+    AVM_ThreadedInstruction    *pInstruction    = NULL;
+    AVM_RuntimeValue           *pDestination    = NULL;
+    AVM_RuntimeValue            Source;
+    AVM_RuntimeValue            Operand0;
+    AVM_RuntimeValue            Operand1;
+    char                       *pszSource       = NULL;
+    char                        szCoercion[MAXIMUM_COERCION_LENGTH + 1];
+    char                        Character       = '\x0';
+    bool                        bStringsComparable  = false;
+    bool                        bJump           = false;
+    bool                        bStackBase      = false;
+
+    // Handler addresses, indexed by operation code...
+    #if defined(AGNI_COMPUTED_GOTO)
+    static const void * const HandlerTable[] =
     {
-        // Located...
-        if(strcasecmp(Scripts[hScript].pFunctionTable[unFunctionTableIndex].
-                        szName, pszName) == 0)
-            return unFunctionTableIndex;
-    }
+        &&Handler_Unknown,
+        &&Handler_MOV, &&Handler_ADD, &&Handler_SUB, &&Handler_MUL,
+        &&Handler_DIV, &&Handler_MOD, &&Handler_EXP, &&Handler_NEG,
+        &&Handler_INC, &&Handler_DEC, &&Handler_AND, &&Handler_OR,
+        &&Handler_XOR, &&Handler_NOT, &&Handler_SHL, &&Handler_SHR,
+        &&Handler_CONCAT, &&Handler_GETCHAR, &&Handler_SETCHAR,
+        &&Handler_JMP, &&Handler_JE, &&Handler_JNE, &&Handler_JG,
+        &&Handler_JL, &&Handler_JGE, &&Handler_JLE, &&Handler_PUSH,
+        &&Handler_POP, &&Handler_CALL, &&Handler_RET, &&Handler_CALLHOST,
+        &&Handler_RAND, &&Handler_PAUSE, &&Handler_EXIT,
+        &&Handler_QUICKENED, &&Handler_QUICKENED_BRANCH,
+        &&Handler_FUSED_PUSH_PUSH_CALLHOST, &&Handler_FUSED_STEP_JUMP,
+        &&Handler_FUSED_MOV_ARITHMETIC
+    };
+
+    #endif
+
+    // Select the code to run...
+    pCode = bRegisterCode ? CurrentScript.pRegisterCode
+                          : CurrentScript.pThreadedCode;
+
+    // Link code to handler addresses the first time it runs...
+    #if defined(AGNI_COMPUTED_GOTO)
+    boolean &bLinked = bRegisterCode ? CurrentScript.bRegisterCodeLinked
+                                     : CurrentScript.bThreadedCodeLinked;
+    if(!bLinked)
+    {
+        // Link each instruction, including the terminating one...
+        for(uint32 unIndex = 0;
+            unIndex <= (bRegisterCode ? CurrentScript.unRegisterCodeSize
+                        : CurrentScript.InstructionStreamHeader.unSize);
+            unIndex++)
+        {
+            // Variables...
+            AVM_ThreadedInstruction &Instruction = pCode[unIndex];
 
-    // Function not found...
-    return -1;
-}
+            // Known operation codes get their handler, others are skipped...
+            if(Instruction.usOperationCode <
+                sizeof(HandlerTable) / sizeof(HandlerTable[0]))
+                Instruction.pHandler = HandlerTable[Instruction.usOperationCode];
+            else
+                Instruction.pHandler = &&Handler_Unknown;
+        }
 
-// Get the script's host function name for the current thread by index...
-inline char *VirtualMachine::GetHostFunction(uint32 unIndex)
-{
-    // Return it...
-    return Scripts[hCurrentThread].pHostFunctionTable[unIndex].szName;
-}
+        // Remember...
+        bLinked = true;
+    }
+    #endif
 
-// Get operand type as exists in instruction stream...
-inline uint8 VirtualMachine::GetOperandType(uint8 OperandIndex)
-{
-    // Variables...
-    uint32  unCurrentInstruction    = 0;
+    // Resume where the thread left off...
+    pInstruction = THREADED_AT(
+                    CurrentScript.InstructionStream.unInstructionPointer);
 
-    // Get the current instruction's index...
-    unCurrentInstruction = Scripts[hCurrentThread].InstructionStream.
-                                unInstructionPointer;
+    // Execute until the next safe point...
+    try
+    {
+        // Begin dispatching...
+        #if defined(AGNI_COMPUTED_GOTO)
+        THREADED_DISPATCH();
+        #else
+        while(true)
+        switch(pInstruction->usOperationCode)
+        {
+        #endif
 
-    // Return operand type...
-    return Scripts[hCurrentThread].InstructionStream.
-            pInstructions[unCurrentInstruction].pOperandList[OperandIndex].
-            OperandType;
-}
+        // Move...
+        THREADED_HANDLER(MOV)
+        {
+            // Resolve both operands...
+            pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            Source          = ResolveValueOf(hScript, THREADED_OPERAND(1));
 
-// Get passed parameter as an integer...
-int VirtualMachine::GetParameterAsInteger(Script hScript, uint8 unParameter)
-{
-    // Variables...
-    int32               nTopIndex           = 0;
-    int32               nComputedLocation   = 0;
-    AVM_RuntimeValue    Parameter;
+            // Copy the source into the destination, unless they are the same...
+            if(pDestination != ResolvePointerTo(hScript, THREADED_OPERAND(1)))
+                CopyValue(pDestination, Source);
 
-    // Find the index of the top of this script's stack...
-    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+            // Next...
+            THREADED_NEXT();
+        }
 
-    // Compute the location of the parameter on the stack...
-    nComputedLocation = nTopIndex - (unParameter + 1);
+        // Add...
+        THREADED_HANDLER(ADD)
+        {
+            // Compute and dispatch next...
+            THREADED_ARITHMETIC(+=);
+            THREADED_NEXT();
+        }
 
-    // Extract the parameter...
-    Parameter = Scripts[hScript].Stack.pElements[nComputedLocation];
+        // Subtract...
+        THREADED_HANDLER(SUB)
+        {
+            // Compute and dispatch next...
+            THREADED_ARITHMETIC(-=);
+            THREADED_NEXT();
+        }
 
-    // Return the parameter coerced as an integer...
-    return CoerceValueToInteger(Parameter);
-}
+        // Multiply...
+        THREADED_HANDLER(MUL)
+        {
+            // Compute and dispatch next...
+            THREADED_ARITHMETIC(*=);
+            THREADED_NEXT();
+        }
 
-// Get passed parameter as a float...
-float VirtualMachine::GetParameterAsFloat(Script hScript, uint8 unParameter)
-{
-    // Variables...
-    int32               nTopIndex           = 0;
-    int32               nComputedLocation   = 0;
-    AVM_RuntimeValue    Parameter;
+        // Divide...
+        THREADED_HANDLER(DIV)
+        {
+            // Compute and dispatch next...
+            THREADED_ARITHMETIC(/=);
+            THREADED_NEXT();
+        }
 
-    // Find the index of the top of this script's stack...
-    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+        // Modulus...
+        THREADED_HANDLER(MOD)
+        {
+            // Resolve both operands...
+            pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            Source          = ResolveValueOf(hScript, THREADED_OPERAND(1));
 
-    // Compute the location of the parameter on the stack...
-    nComputedLocation = nTopIndex - (unParameter + 1);
+            // Modulus defined only for integral values...
+            pDestination->nLiteralInteger %= CoerceValueToInteger(Source);
 
-    // Extract the parameter...
-    Parameter = Scripts[hScript].Stack.pElements[nComputedLocation];
+            // Next...
+            THREADED_NEXT();
+        }
 
-    // Return the parameter coerced as a float...
-    return CoerceValueToFloat(Parameter);
-}
+        // Exponentiate...
+        THREADED_HANDLER(EXP)
+        {
+            // Resolve both operands...
+            pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            Source          = ResolveValueOf(hScript, THREADED_OPERAND(1));
 
-// Get passed parameter as a string...
-char *VirtualMachine::GetParameterAsString(Script hScript, uint8 unParameter)
-{
-    // Variables...
-    int32               nTopIndex           = 0;
-    int32               nComputedLocation   = 0;
-    AVM_RuntimeValue    Parameter;
+            // Integral source...
+            if(Source.OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger =
+                    (int) pow(pDestination->nLiteralInteger,
+                              CoerceValueToInteger(Source));
 
-    // Find the index of the top of this script's stack...
-    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+            // Assume, then, that it is a float...
+            else
+                pDestination->fLiteralFloat =
+                    (float) pow(pDestination->fLiteralFloat,
+                                CoerceValueToFloat(Source));
 
-    // Compute the location of the parameter on the stack...
-    nComputedLocation = nTopIndex - (unParameter + 1);
+            // Next...
+            THREADED_NEXT();
+        }
 
-    // Extract the parameter...
-    Parameter = Scripts[hScript].Stack.pElements[nComputedLocation];
+        // Negate...
+        THREADED_HANDLER(NEG)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-    // Return the parameter coerced as a string...
-    return CoerceValueToString(Parameter);
-}
+            // Is this an integral value, as it exists in the stream...
+            if(THREADED_OPERAND(0).OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger = -pDestination->nLiteralInteger;
 
-// Get return as a float from an asynchronous call...
-float VirtualMachine::GetReturnValueAsFloat(Script hScript)
-{
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return 0.0f;
+            // Assume, then, that it is a float...
+            else
+                pDestination->fLiteralFloat = -pDestination->fLiteralFloat;
 
-    // Return it...
-    return Scripts[hScript]._RegisterReturn.fLiteralFloat;
-}
+            // Next...
+            THREADED_NEXT();
+        }
 
-// Get return as an integer from an asynchronous call...
-int VirtualMachine::GetReturnValueAsInteger(Script hScript)
-{
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return 0;
+        // Increment...
+        THREADED_HANDLER(INC)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-    // Return it...
-    return Scripts[hScript]._RegisterReturn.nLiteralInteger;
-}
+            // Increment an integer?
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger++;
 
-// Get return as a string from an asynchronous call...
-char *VirtualMachine::GetReturnValueAsString(Script hScript, char *pszBuffer,
-                                             uint32 unBufferSize)
-{
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return NULL;
+            // Assume, then, that it is a float...
+            else
+                pDestination->fLiteralFloat++;
 
-    // Supplied buffer too small...
-    if(strlen(Scripts[hScript]._RegisterReturn.pszLiteralString) >
-       (unBufferSize - 1))
-        return NULL;
+            // Next...
+            THREADED_NEXT();
+        }
 
-    // Store it in caller's buffer...
-    strcpy(pszBuffer, Scripts[hScript]._RegisterReturn.pszLiteralString);
+        // Decrement...
+        THREADED_HANDLER(DEC)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-    // Done...
-    return pszBuffer;
-}
+            // Decrement an integer?
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger--;
 
-// Get a runtime value on the stack...
-inline VirtualMachine::AVM_RuntimeValue 
-    VirtualMachine::GetStackValue(Script hScript, int32 nIndex)
-{
-    // Get element at specified index...
-    return Scripts[hScript].Stack.pElements[ResolveStackIndex(hScript, nIndex)];
-}
+            // Assume, then, that it is a float...
+            else
+                pDestination->fLiteralFloat--;
 
-// Load bytes or throws error code...
-void VirtualMachine::LoadBytes(void *pStorageBuffer, uint32 unEachOfSize,
-                               uint32 unMembers, FILE *hFile)
-{
-    // Read and check for error...
-    if(unMembers != fread(pStorageBuffer, unEachOfSize, unMembers, hFile))
-        throw Bad_Executable;
-}
+            // Next...
+            THREADED_NEXT();
+        }
 
-// Load script, store handle, return a status code...
-VirtualMachine::Status 
-    VirtualMachine::LoadScript(const char *pszPath, Script &hScript)
-{
-    // Variables...
-    FILE   *hScriptFile                 = NULL;
-    char    szBuffer[1024]              = {0};
-    uint32  unCurrentInstructionIndex   = 0;
-    uint16  usCurrentOperandIndex       = 0;
-    uint16  usCurrentStringIndex        = 0;
-    uint16  usCurrentFunctionIndex      = 0;
-    uint16  usCurrentHostFunctionIndex  = 0;
+        // Bitwise AND...
+        THREADED_HANDLER(AND)
+        {
+            // Compute and dispatch next...
+            THREADED_BITWISE(&=);
+            THREADED_NEXT();
+        }
 
-    // Try to load script...
-    try
-    {
-        // Find a free script handle index...
-        for(hScript = 0; hScript < (MAXIMUM_THREADS - 1); hScript++)
+        // Bitwise OR...
+        THREADED_HANDLER(OR)
         {
-            // Found one...
-            if(!Scripts[hScript].bLoaded)
-                break;
+            // Compute and dispatch next...
+            THREADED_BITWISE(|=);
+            THREADED_NEXT();
         }
 
-            // Scanned entire list without finding vacancy, failed...
-            if(hScript + 1 == (MAXIMUM_THREADS - 1))
-                throw Threads_Exhausted;
+        // Bitwise XOR...
+        THREADED_HANDLER(XOR)
+        {
+            // Compute and dispatch next...
+            THREADED_BITWISE(^=);
+            THREADED_NEXT();
+        }
 
-        // Clear script...
-        memset(&Scripts[hScript], 0, sizeof(AVM_Script));
+        // Not...
+        THREADED_HANDLER(NOT)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-        // Open script...
-        hScriptFile = fopen(pszPath, "rb");
+            // Defined only for integral values, as it exists in the stream...
+            if(THREADED_OPERAND(0).OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger = ~pDestination->nLiteralInteger;
 
-            // Failed...
-            if(!hScriptFile)
-                throw Cannot_Open;
+            // Next...
+            THREADED_NEXT();
+        }
 
-        // Process main header...
+        // Shift left...
+        THREADED_HANDLER(SHL)
+        {
+            // Compute and dispatch next...
+            THREADED_BITWISE(<<=);
+            THREADED_NEXT();
+        }
 
-            // Load main header...
-            LoadBytes(&Scripts[hScript].MainHeader, sizeof(Agni_MainHeader), 1,
-                      hScriptFile);
+        // Shift right...
+        THREADED_HANDLER(SHR)
+        {
+            // Compute and dispatch next...
+            THREADED_BITWISE(>>=);
+            THREADED_NEXT();
+        }
 
-            // Check signature...
+        // String concatenation...
+        THREADED_HANDLER(CONCAT)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-                // Initialize...
-                memset(szBuffer, '\x90', sizeof(szBuffer));
-                strncpy(&szBuffer[2], "AGNI", strlen("AGNI"));
+                // Destination is not a string, ignore it...
+                if(!AVM_IS_STRING(*pDestination))
+                    THREADED_NEXT();
 
-                // Check...
-                if(memcmp(&Scripts[hScript].MainHeader.Signature, szBuffer,
-                          sizeof(Scripts[hScript].MainHeader.Signature)) != 0)
-                    throw Bad_Executable;
+            // Extract source and coerce it to a string...
+            Source      = ResolveValueOf(hScript, THREADED_OPERAND(1));
+            pszSource   = CoerceValueToString(Source, szCoercion);
 
-            // Check checksum...
-            if(CalculateCheckSumOfExecutable(pszPath) !=
-               Scripts[hScript].MainHeader.unCheckSum)
-                throw Bad_CheckSum;
+            // Append it...
+            ConcatenateString(hScript, pDestination, pszSource);
 
-            // Check required Agni runtime version...
-            if(!VersionSafe(AGNI_VERSION_MAJOR, AGNI_VERSION_MINOR,
-                            Scripts[hScript].MainHeader.ucMajorRequiredAgniVersion,
-                            Scripts[hScript].MainHeader.ucMinorRequiredAgniVersion))
-                throw Old_Agni_Runtime;
+            // Next...
+            THREADED_NEXT();
+        }
 
-            // Check host, if any host information provided...
-            if(Scripts[hScript].MainHeader.unHostStringIndex != (uint32) -1)
-            {
-                // Check host version...
-                if(!VersionSafe(HostVersionMajor, HostVersionMinor,
-                                Scripts[hScript].MainHeader.ucHostMajorVersion,
-                                Scripts[hScript].MainHeader.ucHostMinorVersion))
-                    throw Old_Host_Runtime;
-            }
+        // Get character...
+        THREADED_HANDLER(GETCHAR)
+        {
+            // Resolve destination, and source as a string...
+            pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            Source          = ResolveValueOf(hScript, THREADED_OPERAND(1));
+            pszSource       = CoerceValueToString(Source, szCoercion);
 
-            // Check for default stack size...
-            if(Scripts[hScript].MainHeader.unStackSize == (uint32) -1)
-                Scripts[hScript].MainHeader.unStackSize = DEFAULT_STACK_SIZE;
+            // Select the character...
+            Character = pszSource[CoerceValueToInteger(
+                ResolveValueOf(hScript, THREADED_OPERAND(2)))];
 
-            // Allocate runtime stack...
-            Scripts[hScript].Stack.pElements =
-                (AVM_RuntimeValue *) calloc(Scripts[hScript].MainHeader.unStackSize,
-                                            sizeof(AVM_RuntimeValue));
+            // Store it in the destination, inline...
+            StoreString(hScript, pDestination, &Character, 1);
 
-                // Failed...
-                if(!Scripts[hScript].Stack.pElements)
-                    throw Memory_Allocation;
+            // Next...
+            THREADED_NEXT();
+        }
 
-            // Set thread's time slice duration...
-            switch(Scripts[hScript].MainHeader.ThreadPriorityType)
-            {
-                // Low...
-                case THREAD_PRIORITY_LOW:
+        // Set character...
+        THREADED_HANDLER(SETCHAR)
+        {
+            // Resolve destination...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
 
-                    // Store default thread time slice for low priority...
-                    Scripts[hScript].unThreadTimeSlice =
-                        THREAD_PRIORITY_LOW_DURATION;
+                // Destination is not a string, ignore it...
+                if(!AVM_IS_STRING(*pDestination))
+                    THREADED_NEXT();
 
-                    // Done...
-                    break;
+            // Extract source string's first character...
+            Source      = ResolveValueOf(hScript, THREADED_OPERAND(2));
+            pszSource   = CoerceValueToString(Source, szCoercion);
+            Character   = pszSource[0];
 
-                // Medium...
-                case THREAD_PRIORITY_MEDIUM:
+            // Set the ith character in the destination's own copy...
+            SetCharacter(hScript, pDestination, CoerceValueToInteger(
+                ResolveValueOf(hScript, THREADED_OPERAND(1))), Character);
 
-                    // Store default thread time slice for medium priority...
-                    Scripts[hScript].unThreadTimeSlice =
-                        THREAD_PRIORITY_MEDIUM_DURATION;
+            // Next...
+            THREADED_NEXT();
+        }
 
-                    // Done...
-                    break;
+        // Jump...
+        THREADED_HANDLER(JMP)
+            THREADED_BRANCH(THREADED_TARGET(0));
 
-                // High...
-                case THREAD_PRIORITY_HIGH:
+        // Jump if equal...
+        THREADED_HANDLER(JE)
+        {
+            // Compare, strings included...
+            bStringsComparable = true;
+            THREADED_COMPARE(==);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                    // Store default thread time slice for high priority...
-                    Scripts[hScript].unThreadTimeSlice =
-                        THREAD_PRIORITY_HIGH_DURATION;
+        // Jump if not equal...
+        THREADED_HANDLER(JNE)
+        {
+            // Compare, strings included...
+            bStringsComparable = true;
+            THREADED_COMPARE(!=);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                    // Done...
-                    break;
+        // Jump if greater...
+        THREADED_HANDLER(JG)
+        {
+            // Compare numerically...
+            bStringsComparable = false;
+            THREADED_COMPARE(>);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                // User...
-                case THREAD_PRIORITY_USER:
+        // Jump if less...
+        THREADED_HANDLER(JL)
+        {
+            // Compare numerically...
+            bStringsComparable = false;
+            THREADED_COMPARE(<);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                    // Extract and store user time slice from main header...
-                    Scripts[hScript].unThreadTimeSlice =
-                        Scripts[hScript].MainHeader.unThreadPriorityUser;
+        // Jump if greater than or equal...
+        THREADED_HANDLER(JGE)
+        {
+            // Compare numerically...
+            bStringsComparable = false;
+            THREADED_COMPARE(>=);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                    // Done...
-                    break;
+        // Jump if less than or equal...
+        THREADED_HANDLER(JLE)
+        {
+            // Compare numerically...
+            bStringsComparable = false;
+            THREADED_COMPARE(<=);
+
+            // Jump or fall through...
+            if(bJump)
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                // Unknown...
-                default:
-                    throw Bad_Executable;
-            }
+        // Push value onto the stack...
+        THREADED_HANDLER(PUSH)
+        {
+            // Push and dispatch next...
+            Push(hScript, ResolveValueOf(hScript, THREADED_OPERAND(0)));
+            THREADED_NEXT();
+        }
 
-        // Process instruction stream...
+        // Pop value off of the stack...
+        THREADED_HANDLER(POP)
+        {
+            // Pop top most value on stack into destination, which takes over
+            //  its string reference...
+            Source          = Pop(hScript);
+            pDestination    = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            ReleaseValue(pDestination);
+           *pDestination    = Source;
+
+            // Next...
+            THREADED_NEXT();
+        }
 
-            // Load instruction stream header...
-            LoadBytes(&Scripts[hScript].InstructionStreamHeader,
-                      sizeof(Agni_InstructionStreamHeader), 1, hScriptFile);
+        // Call a function...
+        THREADED_HANDLER(CALL)
+        {
+            // Return address is the instruction after the call...
+            CurrentScript.InstructionStream.unInstructionPointer =
+                THREADED_INDEX(pInstruction) + 1;
+
+            // Invoke script function...
+            CallFunctionImplementation(hScript,
+                ResolveValueOf(hScript, THREADED_OPERAND(0)).nFunctionIndex);
+
+            // Continue at its entry point...
+            pInstruction = THREADED_AT(
+                CurrentScript.InstructionStream.unInstructionPointer);
+            THREADED_DISPATCH();
+        }
 
-            // Allocate instruction stream...
-            Scripts[hScript].InstructionStream.pInstructions =
-                (AVM_Instruction *) calloc(Scripts[hScript].
-                                            InstructionStreamHeader.unSize,
-                                           sizeof(AVM_Instruction));
+        // Return from a function...
+        THREADED_HANDLER(RET)
+        {
+            // Return, and terminate script if bottom of stack was found...
+            bStackBase = ReturnFromFunction(hScript);
 
-                // Failed...
-                if(!Scripts[hScript].InstructionStream.pInstructions)
-                    throw Memory_Allocation;
+            // Continue at the return address...
+            pInstruction = THREADED_AT(
+                CurrentScript.InstructionStream.unInstructionPointer);
 
-            // Load instruction stream...
-            for(unCurrentInstructionIndex = 0;
-                unCurrentInstructionIndex < Scripts[hScript].
-                    InstructionStreamHeader.unSize;
-                unCurrentInstructionIndex++)
-            {
-                // Variables...
-                uint8               OperandCount    = 0x00;
-                AVM_RuntimeValue   *pOperandList   = NULL;
+            // Scheduler must know if the stack base was reached...
+            if(bStackBase)
+                goto SafePoint;
+            THREADED_DISPATCH();
+        }
 
-                // Load this instructions operation code... (2 bytes)
-                LoadBytes(&Scripts[hScript].InstructionStream.
-                            pInstructions[unCurrentInstructionIndex].
-                            usOperationCode,
-                          sizeof(uint16), 1, hScriptFile);
+        // Call a host function...
+        THREADED_HANDLER(CALLHOST)
+        {
+            // Host may call back into the script, so it must return after...
+            CurrentScript.InstructionStream.unInstructionPointer =
+                THREADED_INDEX(pInstruction) + 1;
 
-                // Load operand count... (1 byte)
-                LoadBytes(&OperandCount, sizeof(uint8), 1, hScriptFile);
-                Scripts[hScript].InstructionStream.
-                    pInstructions[unCurrentInstructionIndex].OperandCount =
-                        OperandCount;
+            // Invoke it...
+            InvokeHostFunction(hScript,
+                ResolveValueOf(hScript, THREADED_OPERAND(0)).
+                    nHostFunctionIndex);
 
-                // This operation has operands, allocate storage space...
-                if(OperandCount > 0)
-                {
-                    // Allocate...
-                    pOperandList = (AVM_RuntimeValue *)
-                        calloc(OperandCount, sizeof(AVM_RuntimeValue));
-                }
+            // It may have left values on the stack...
+            CheckStackBound(hScript);
 
-                // Load operand list...
-                for(usCurrentOperandIndex = 0;
-                    usCurrentOperandIndex < OperandCount;
-                    usCurrentOperandIndex++)
-                {
-                    // Load operand type... (1 byte)
-                    LoadBytes(&pOperandList[usCurrentOperandIndex].OperandType,
-                              sizeof(uint8), 1, hScriptFile);
+            // Host may have paused, stopped, or redirected the script...
+            THREADED_SAFE_POINT(THREADED_AT(
+                CurrentScript.InstructionStream.unInstructionPointer));
+        }
 
-                    // Load operand data...
-                    switch(pOperandList[usCurrentOperandIndex].OperandType)
-                    {
-                        // Integer literal... (4 bytes)
-                        case OT_AVM_INTEGER:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nLiteralInteger, sizeof(int32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+        // Rand instruction...
+        THREADED_HANDLER(RAND)
+        {
+            // Generate ranged random number...
+            Source.OperandType      = OT_AVM_INTEGER;
+            Source.nLiteralInteger  = GenerateRandomNumber(CoerceValueToInteger(
+                ResolveValueOf(hScript, THREADED_OPERAND(1))));
+
+            // Store result...
+            pDestination = ResolvePointerTo(hScript, THREADED_OPERAND(0));
+            ReleaseValue(pDestination);
+           *pDestination = Source;
+
+            // Next...
+            THREADED_NEXT();
+        }
 
-                        // Floating-point literal... (4 bytes)
-                        case OT_AVM_FLOAT:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        fLiteralFloat, sizeof(float32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+        // Pause instruction...
+        THREADED_HANDLER(PAUSE)
+        {
+            // Calculate and store the pause ending time...
+            CurrentScript.PauseEndTime = PauseEndTimeAfter(
+                CoerceValueToInteger(ResolveValueOf(hScript,
+                                                    THREADED_OPERAND(0))));
 
-                        // String index... (4 bytes)
-                        case OT_AVM_INDEX_STRING:
-                        {
-                            // Load... (nStringTableIndex -> nLiteralInteger)
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nLiteralInteger, sizeof(int32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+            // Flag the script as paused...
+            CurrentScript.bPaused = true;
+            ScheduleScript(hScript);
 
-                        // Instruction index... (4 bytes)
-                        case OT_AVM_INDEX_INSTRUCTION:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nInstructionIndex, sizeof(int32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+            // Let the scheduler idle it...
+            THREADED_SAFE_POINT(pInstruction + 1);
+        }
 
-                        // Absolute stack index... (4 bytes)
-                        case OT_AVM_INDEX_STACK_ABSOLUTE:
-                        {
-                            // Load... (second element useful only for relative)
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nStackIndex[0], sizeof(int32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+        // Exit instruction...
+        THREADED_HANDLER(EXIT)
+        {
+            // Flag the script as no longer running...
+            CurrentScript.bExecuting = false;
+            ScheduleScript(hScript);
 
-                        // Relative stack index... (4 + 4 bytes)
-                        case OT_AVM_INDEX_STACK_RELATIVE:
-                        {
-                            // Load base index...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nStackIndex[0], sizeof(int32), 1,
-                                      hScriptFile);
+            // Let the scheduler find something else...
+            THREADED_SAFE_POINT(pInstruction + 1);
+        }
 
-                            // Load offset index...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nStackIndex[1], sizeof(int32), 1,
-                                      hScriptFile);
+        // Quickened instruction...
+        THREADED_HANDLER(QUICKENED)
+        {
+            // Run the handler specialized on its operand kinds...
+            (this->*pInstruction->Quickened)(hScript,
+                                             pInstruction->Operands);
 
-                            // Done...
-                            break;
-                        }
-                        
-                        // Absolute stack index in register... (1 byte)
-                        case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
-                        {
-                            // Load register identifier...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                      Register, sizeof(uint8), 1, hScriptFile);
-                            break;
-                        }
+            // Next...
+            THREADED_NEXT();
+        }
 
-                        // Function index... (4 bytes)
-                        case OT_AVM_INDEX_FUNCTION:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                      nFunctionIndex,
-                                      sizeof(int32), 1, hScriptFile);
-                            break;
-                        }
+        // Quickened conditional jump...
+        THREADED_HANDLER(QUICKENED_BRANCH)
+        {
+            // Jump or fall through...
+            if((this->*pInstruction->Quickened)(hScript,
+                                                pInstruction->Operands))
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                        // Host function index... (4 bytes)
-                        case OT_AVM_INDEX_FUNCTION_HOST:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        nHostFunctionIndex, sizeof(int32), 1,
-                                      hScriptFile);
-                            break;
-                        }
+        // Two pushes and a host call...
+        THREADED_HANDLER(FUSED_PUSH_PUSH_CALLHOST)
+        {
+            // Push both parameters...
+            (this->*pInstruction->Quickened)(hScript, pInstruction->Operands);
+            pInstruction++;
+            (this->*pInstruction->Quickened)(hScript, pInstruction->Operands);
+            pInstruction++;
+
+            // Host may call back into the script, so it must return after...
+            CurrentScript.InstructionStream.unInstructionPointer =
+                THREADED_INDEX(pInstruction) + 1;
+
+            // Invoke it...
+            InvokeHostFunction(hScript,
+                ResolveValueOf(hScript, THREADED_OPERAND(0)).
+                    nHostFunctionIndex);
+
+            // It may have left values on the stack...
+            CheckStackBound(hScript);
+
+            // Host may have paused, stopped, or redirected the script...
+            THREADED_SAFE_POINT(THREADED_AT(
+                CurrentScript.InstructionStream.unInstructionPointer));
+        }
 
-                        // Register... (1 byte)
-                        case OT_AVM_REGISTER:
-                        {
-                            // Load...
-                            LoadBytes(&pOperandList[usCurrentOperandIndex].
-                                        Register, sizeof(uint8), 1,
-                                      hScriptFile);
-                            break;
-                        }
+        // Increment or decrement and a conditional jump on the result...
+        THREADED_HANDLER(FUSED_STEP_JUMP)
+        {
+            // Step the variable...
+            (this->*pInstruction->Quickened)(hScript, pInstruction->Operands);
+            pInstruction++;
+
+            // Jump or fall through...
+            if((this->*pInstruction->Quickened)(hScript,
+                                                pInstruction->Operands))
+                THREADED_BRANCH(THREADED_TARGET(2));
+            THREADED_NEXT();
+        }
 
-                        // Unknown...
-                        default:
-                            throw Bad_Executable;
-                    }
-                }
+        // Move and an arithmetic operation on the same destination...
+        THREADED_HANDLER(FUSED_MOV_ARITHMETIC)
+        {
+            // Move...
+            (this->*pInstruction->Quickened)(hScript, pInstruction->Operands);
+            pInstruction++;
 
-                // Store operands in instruction stream...
-                Scripts[hScript].InstructionStream.
-                    pInstructions[unCurrentInstructionIndex].pOperandList =
-                        pOperandList;
-            }
+            // Operate on the result...
+            (this->*pInstruction->Quickened)(hScript, pInstruction->Operands);
 
-        // Process string stream...
+            // Next...
+            THREADED_NEXT();
+        }
 
-            // Process string stream header...
-            //  (sizeof(Agni_StringStreamHeader) bytes)
-            LoadBytes(&Scripts[hScript].StringStreamHeader,
-                      sizeof(Agni_StringStreamHeader), 1, hScriptFile);
+        // Unknown instruction, skip it...
+        THREADED_UNKNOWN_HANDLER()
+            THREADED_NEXT();
 
-            // Load string table, if any strings to load...
-            if(Scripts[hScript].StringStreamHeader.unSize > 0)
-            {
-                // Variables...
-                char  **ppszStringTable  = NULL;
+        #if !defined(AGNI_COMPUTED_GOTO)
+        }
+        #endif
+    }
 
-                // Allocate...
-                ppszStringTable = (char **)
-                    calloc(Scripts[hScript].StringStreamHeader.unSize,
-                           sizeof(char *));
+        // Execution exception, leave instruction pointer at culprit...
+        catch(...)
+        {
+            // Remember where the thread was...
+            CurrentScript.InstructionStream.unInstructionPointer =
+                THREADED_INDEX(pInstruction);
 
-                    // Failed...
-                    if(!ppszStringTable)
-                        throw Memory_Allocation;
+            // Pass on to host...
+            throw;
+        }
 
-                // Load each string...
-                for(usCurrentStringIndex = 0;
-                    usCurrentStringIndex < Scripts[hScript].StringStreamHeader.unSize;
-                    usCurrentStringIndex++)
-                {
-                    // Variables...
-                    uint32  unStringLength      = 0;
-                    char   *pszCurrentString    = NULL;
+// Safe point reached, store thread's instruction pointer...
+SafePoint:
+    CurrentScript.InstructionStream.unInstructionPointer =
+        THREADED_INDEX(pInstruction);
 
-                    // Load string length... (4 bytes)
-                    LoadBytes(&unStringLength, sizeof(uint32), 1, hScriptFile);
+    // Let scheduler know whether the stack base was reached...
+    return bStackBase;
+}
 
-                    // Allocate storage for string...
-                    pszCurrentString = (char *) malloc(unStringLength + 1);
+// Done with the threaded dispatch engine macros...
+#undef THREADED_HANDLER
+#undef THREADED_UNKNOWN_HANDLER
+#undef THREADED_DISPATCH
+#undef THREADED_INDEX
+#undef THREADED_AT
+#undef THREADED_OPERAND
+#undef THREADED_NEXT
+#undef THREADED_SAFE_POINT
+#undef THREADED_BRANCH
+#undef THREADED_TARGET
+#undef THREADED_ARITHMETIC
+#undef THREADED_BITWISE
+#undef THREADED_COMPARE
+
+// Flag each instruction execution can enter other than by falling through, or
+//  return NULL if branch targets are only known at runtime or throw status
+//  code...
+boolean *VirtualMachine::FindEnteredInstructions(Script hScript)
+{
+    // Variables...
+    AVM_Script         &CurrentScript   = Scripts[hScript];
+    AVM_Instruction    *pInstructions   = NULL;
+    AVM_RuntimeValue   *pTarget         = NULL;
+    boolean            *pEntered        = NULL;
+    uint32              unSize          = 0;
+    uint32              unIndex         = 0;
+
+    // Allocate a flag for each instruction, and the terminating one...
+    unSize          = CurrentScript.InstructionStreamHeader.unSize;
+    pInstructions   = CurrentScript.InstructionStream.pInstructions;
+    pEntered        = (boolean *) ArenaAllocateZeroed(CurrentScript.ImageArena,
+                                                      unSize + 1,
+                                                      sizeof(boolean));
 
-                        // Failed...
-                        if(!pszCurrentString)
-                        {
-                            // Cleanup...
-                            free(ppszStringTable);
+        // Failed...
+        if(!pEntered)
+            throw Memory_Allocation;
 
-                            // Abort...
-                            throw Memory_Allocation;
-                        }
+    // Function entry points are entered by a call...
+    for(unIndex = 0; unIndex < CurrentScript.FunctionTableHeader.unSize;
+        unIndex++)
+    {
+        // Flag it, if it is within the stream...
+        if(CurrentScript.pFunctionTable[unIndex].unEntryPoint < unSize)
+            pEntered[CurrentScript.pFunctionTable[unIndex].unEntryPoint] = true;
+    }
 
-                    // Load string and terminate... (unStringLength bytes)
-                    LoadBytes(pszCurrentString, unStringLength, 1, hScriptFile);
-                    pszCurrentString[unStringLength] = '\x0';
+    // Find branch targets and where threads resume after a safe point...
+    for(unIndex = 0; unIndex < unSize; unIndex++)
+    {
+        // Find a branch's target operand, if any...
+        switch(pInstructions[unIndex].usOperationCode)
+        {
+            // Unconditional jump...
+            case INSTRUCTION_AVM_JMP:
+                pTarget = &pInstructions[unIndex].pOperandList[0];
+                break;
 
-                    // Store in string table...
-                    ppszStringTable[usCurrentStringIndex] = pszCurrentString;
-                }
+            // Conditional jumps...
+            case INSTRUCTION_AVM_JE:
+            case INSTRUCTION_AVM_JNE:
+            case INSTRUCTION_AVM_JG:
+            case INSTRUCTION_AVM_JL:
+            case INSTRUCTION_AVM_JGE:
+            case INSTRUCTION_AVM_JLE:
+                pTarget = &pInstructions[unIndex].pOperandList[2];
+                break;
 
-                // Scan instruction stream's operands, converting string table
-                //  indices to string literals...
-                for(unCurrentInstructionIndex = 0;
-                    unCurrentInstructionIndex < Scripts[hScript].
-                        InstructionStreamHeader.unSize;
-                    unCurrentInstructionIndex++)
-                {
-                    // Variables...
-                    uint8               OperandCount    = 0;
-                    AVM_RuntimeValue   *pOperandList    = NULL;
+            // Threads return to or resume at the following instruction...
+            case INSTRUCTION_AVM_CALL:
+            case INSTRUCTION_AVM_CALLHOST:
+            case INSTRUCTION_AVM_PAUSE:
+                pEntered[unIndex + 1] = true;
+                continue;
 
-                    // Fetch operand count...
-                    OperandCount = Scripts[hScript].InstructionStream.
-                            pInstructions[unCurrentInstructionIndex].OperandCount;
+            // Anything else only falls through...
+            default:
+                continue;
+        }
 
-                    // Fetch operand list...
-                    pOperandList = Scripts[hScript].InstructionStream.
-                            pInstructions[unCurrentInstructionIndex].pOperandList;
+        // A target only known at runtime could land anywhere...
+        if(pTarget->OperandType != OT_AVM_INDEX_INSTRUCTION ||
+           (uint32) pTarget->nInstructionIndex >= unSize)
+        {
+            // Cleanup and abort...
+            ArenaFree(CurrentScript.ImageArena, pEntered);
+            return NULL;
+        }
 
-                    // Scan operands for string table indices...
-                    for(usCurrentOperandIndex = 0;
-                        usCurrentOperandIndex < OperandCount;
-                        usCurrentOperandIndex++)
-                    {
-                        // Variables...
-                        uint32  unStringTableIndex      = 0;
-                        char   *pszStringLiteralCopy    = NULL;
-
-                        // Not a string index, skip...
-                        if(pOperandList[usCurrentOperandIndex].OperandType !=
-                           OT_AVM_INDEX_STRING)
-                            continue;
-
-                        // Fetch string table index...
-                        //  (nStringTableIndex -> nLiteralInteger)
-                        unStringTableIndex =
-                            pOperandList[usCurrentOperandIndex].nLiteralInteger;
-
-                        // Allocate string literal copy...
-                        pszStringLiteralCopy =
-                                    strdup(ppszStringTable[unStringTableIndex]);
-
-                            // Failed...
-                            if(!pszStringLiteralCopy)
-                            {
-                                // Cleanup...
-                                free(ppszStringTable);
-
-                                // Abort...
-                                throw Memory_Allocation;
-                            }
-
-                        // Insert instance into instruction's operand data...
-                        pOperandList[usCurrentOperandIndex].pszLiteralString =
-                                                            pszStringLiteralCopy;
-
-                        // Mark operand as string literal now...
-                        pOperandList[usCurrentOperandIndex].OperandType =
-                                                                    OT_AVM_STRING;
-                    }
-                }
+        // Flag target...
+        pEntered[pTarget->nInstructionIndex] = true;
+    }
 
-                // The host and the script have both identified themselves...
-                if(Scripts[hScript].MainHeader.unHostStringIndex != (uint32) -1
-                    && pszHostName != NULL)
-                {
-                    // Host name does not match the scripts host name...
-                    if(strcasecmp(ppszStringTable[Scripts[hScript].MainHeader.
-                                    unHostStringIndex], pszHostName) != 0)
-                    {
-                        // Cleanup...
+    // Done...
+    return pEntered;
+}
 
-                            // Free temporary string table...
+// Find a host provided function registered under a name and visibility, or NULL
+//  if none...
+VirtualMachine::AVM_HostProvidedFunction *
+    VirtualMachine::FindHostProvidedFunction(Script hVisibleTo,
+                                             const char *pszName)
+{
+    // Variables...
+    uint32  unHash  = 0;
+    uint32  unSlot  = 0;
 
-                                // Free original strings...
-                                for(usCurrentStringIndex = 0;
-                                    usCurrentStringIndex < Scripts[hScript].
-                                        StringStreamHeader.unSize;
-                                    usCurrentStringIndex++)
-                                    free(ppszStringTable[usCurrentStringIndex]);
+    // Nothing registered yet...
+    if(!unHostProvidedFunctionSlots)
+        return NULL;
 
-                                // Free the table itself...
-                                free(ppszStringTable);
+    // Probe from where it hashes to until a slot never used...
+    unHash = HashHostProvidedFunction(hVisibleTo, pszName);
+    for(unSlot = unHash & (unHostProvidedFunctionSlots - 1);
+        pHostProvidedFunctions[unSlot].bLoaded ||
+            pHostProvidedFunctions[unSlot].bVacated;
+        unSlot = (unSlot + 1) & (unHostProvidedFunctionSlots - 1))
+    {
+        // Extract...
+        AVM_HostProvidedFunction &HostFunctionEntry =
+            pHostProvidedFunctions[unSlot];
 
-                        // Abort...
-                        throw Wrong_Host;
-                    }
-                }
+        // Found...
+        if(HostFunctionEntry.bLoaded && HostFunctionEntry.unHash == unHash &&
+           HostFunctionEntry.hScriptVisibleTo == hVisibleTo &&
+           strcasecmp(HostFunctionEntry.pszName, pszName) == 0)
+            return &HostFunctionEntry;
+    }
 
-                // Free temporary string table...
+    // Not found...
+    return NULL;
+}
 
-                    // Free original strings...
-                    for(usCurrentStringIndex = 0;
-                        usCurrentStringIndex < Scripts[hScript].StringStreamHeader.
-                            unSize;
-                        usCurrentStringIndex++)
-                        free(ppszStringTable[usCurrentStringIndex]);
+// Remove an interned string whose last reference was dropped from the interning
+//  table...
+void VirtualMachine::ForgetInternedString(AVM_String *pString)
+{
+    // Variables...
+    uint32  unSlot  = 0;
 
-                    // Free the table itself...
-                    free(ppszStringTable);
-            }
+    // Probe from where it hashes to until found...
+    for(unSlot = pString->unHash & (unInternedStringSlots - 1);
+        pInternedStrings[unSlot].pString != pString;
+        unSlot = (unSlot + 1) & (unInternedStringSlots - 1));
 
-        // Process function table...
+    // Vacate its slot, so lookups probe past it...
+    pInternedStrings[unSlot].pString    = NULL;
+    pInternedStrings[unSlot].bVacated   = true;
 
-            // Load function table header... (sizeof(AVM_FunctionTableHeader) bytes)
-            LoadBytes(&Scripts[hScript].FunctionTableHeader,
-                      sizeof(Agni_FunctionTableHeader), 1, hScriptFile);
+    // Account...
+    unInternedStringCount--;
+    unInternedStringBytes -= AVM_STRING_SIZE(pString->unCapacity);
+}
 
-            // Allocate function table, if necessary...
-            if(Scripts[hScript].FunctionTableHeader.unSize > 0)
-            {
-                // Allocate...
-                Scripts[hScript].pFunctionTable = (Agni_Function *)
-                    calloc(Scripts[hScript].FunctionTableHeader.unSize,
-                           sizeof(Agni_Function));
+// Format a float into a buffer as "%f" would, without allocating, and return
+//  its length...
+uint32 VirtualMachine::FormatFloat(float32 fValue, char *pszBuffer)
+{
+    // Variables...
+    uint32              unBits          = 0;
+    uint32              unExponent      = 0;
+    uint32              unMantissa      = 0;
+    int32               nShift          = 0;
+    uint32              unWhole[4]      = { 0, 0, 0, 0 };
+    unsigned long long  ullScaled       = 0;
+    unsigned long long  ullRemainder    = 0;
+    unsigned long long  ullHalf         = 0;
+    uint32              unMillionths    = 0;
+    char                szDigits[40];
+    uint32              unDigits        = 0;
+    uint32              unLength        = 0;
+    int32               nIndex          = 0;
+
+    // Split into sign, exponent, and mantissa...
+    memcpy(&unBits, &fValue, sizeof(unBits));
+    unExponent  = (unBits >> 23) & 0xFF;
+    unMantissa  = unBits & 0x7FFFFF;
+
+    // Negative, including zero and not a number, as "%f" does...
+    if(unBits >> 31)
+        pszBuffer[unLength++] = '-';
+
+    // Infinite or not a number...
+    if(unExponent == 0xFF)
+    {
+        // Name it...
+        strcpy(pszBuffer + unLength, unMantissa ? "nan" : "inf");
 
-                    // Failed...
-                    if(!Scripts[hScript].pFunctionTable)
-                        throw Memory_Allocation;
-            }
+        // Done...
+        return unLength + 3;
+    }
 
-            // Load each function...
-            for(usCurrentFunctionIndex = 0;
-                usCurrentFunctionIndex < Scripts[hScript].FunctionTableHeader.
-                    unSize;
-                usCurrentFunctionIndex++)
+    // Value is the mantissa scaled by a power of two, with an implicit leading
+    //  one unless it is denormal...
+    if(unExponent)
+    {
+        unMantissa |= 0x800000;
+        nShift      = (int32) unExponent - 150;
+    }
+    else
+        nShift = -149;
+
+    // No fraction, so the whole part is the mantissa shifted left, at most
+    //  into the fourth word...
+    if(nShift >= 0)
+    {
+        unWhole[nShift / 32] = unMantissa << (nShift % 32);
+        if(nShift % 32 && nShift / 32 < 3)
+            unWhole[nShift / 32 + 1] = unMantissa >> (32 - nShift % 32);
+    }
+
+    // Otherwise split off the fraction and round it to millionths, half to
+    //  even, exactly, since the mantissa times a million fits in 44 bits...
+    else
+    {
+        // Split...
+        nShift = -nShift;
+        unWhole[0] = (nShift < 32) ? (unMantissa >> nShift) : 0;
+        if(nShift < 32)
+            unMantissa &= (1u << nShift) - 1;
+
+        // Anything shifted further is less than half a millionth...
+        if(nShift < 45)
+        {
+            // Scale...
+            ullScaled        = (unsigned long long) unMantissa * 1000000;
+            unMillionths    = (uint32) (ullScaled >> nShift);
+            ullRemainder     = ullScaled & ((((unsigned long long) 1) << nShift) - 1);
+            ullHalf          = ((unsigned long long) 1) << (nShift - 1);
+
+            // Round...
+            if(ullRemainder > ullHalf ||
+               (ullRemainder == ullHalf && (unMillionths & 1)))
+                unMillionths++;
+
+            // Rounded up into the whole part...
+            if(unMillionths == 1000000)
             {
-                // Variables...
-                uint32  unEntryPoint        = 0x00000000;
-                uint8   ParameterCount      = 0;
-                uint32  unLocalDataSize     = 0;
-                uint32  unStackFrameSize    = 0;
-                uint8   NameLength          = 0;
+                unMillionths = 0;
+                unWhole[0]++;
+            }
+        }
+    }
 
-                // Load entry point... (4 bytes)
-                LoadBytes(&unEntryPoint, sizeof(uint32), 1, hScriptFile);
-                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
-                    unEntryPoint = unEntryPoint;
+    // Extract whole part's digits, least significant first...
+    do
+    {
+        // Divide by ten, carrying the remainder down through each word...
+        ullRemainder = 0;
+        for(nIndex = 3; nIndex >= 0; nIndex--)
+        {
+            ullRemainder = (ullRemainder << 32) | unWhole[nIndex];
+            unWhole[nIndex] = (uint32) (ullRemainder / 10);
+            ullRemainder %= 10;
+        }
 
-                // Load parameter count... (1 byte)
-                LoadBytes(&ParameterCount, sizeof(uint8), 1, hScriptFile);
-                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
-                    ParameterCount = ParameterCount;
+        // Store digit...
+        szDigits[unDigits++] = (char) ('0' + ullRemainder);
+    }
+    while(unWhole[0] | unWhole[1] | unWhole[2] | unWhole[3]);
 
-                // Load local data size...
-                LoadBytes(&unLocalDataSize, sizeof(uint32), 1, hScriptFile);
-                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
-                    unLocalDataSize = unLocalDataSize;
+    // Write them most significant first...
+    while(unDigits)
+        pszBuffer[unLength++] = szDigits[--unDigits];
 
-                // Calculate stack frame size so we don't have to waste cycles
-                //  recalculating...
-                unStackFrameSize = ParameterCount + 1 + unLocalDataSize;
-                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
-                    unStackFrameSize = unStackFrameSize;
+    // Then the millionths...
+    pszBuffer[unLength++] = '.';
+    for(nIndex = 5; nIndex >= 0; nIndex--)
+    {
+        pszBuffer[unLength + nIndex] = (char) ('0' + unMillionths % 10);
+        unMillionths /= 10;
+    }
+    unLength += 6;
 
-                // Load function name...
+    // Terminate...
+    pszBuffer[unLength] = '\x0';
+
+    // Done...
+    return unLength;
+}
+
+// Format an integer into a buffer, without allocating, and return its length...
+uint32 VirtualMachine::FormatInteger(int32 nValue, char *pszBuffer)
+{
+    // Variables...
+    uint32  unMagnitude = (uint32) nValue;
+    char    szDigits[10];
+    uint32  unDigits    = 0;
+    uint32  unLength    = 0;
+
+    // Negative, whose magnitude may only fit unsigned...
+    if(nValue < 0)
+    {
+        pszBuffer[unLength++] = '-';
+        unMagnitude = 0u - unMagnitude;
+    }
+
+    // Extract digits, least significant first...
+    do
+    {
+        szDigits[unDigits++] = (char) ('0' + unMagnitude % 10);
+        unMagnitude /= 10;
+    }
+    while(unMagnitude);
+
+    // Write them most significant first...
+    while(unDigits)
+        pszBuffer[unLength++] = szDigits[--unDigits];
+
+    // Terminate...
+    pszBuffer[unLength] = '\x0';
+
+    // Done...
+    return unLength;
+}
+
+// Fuse common instruction sequences within a range of threaded code, the last
+//  instruction exclusive, into superinstructions and return how many were fused
+//  or throw status code...
+uint32 VirtualMachine::FuseThreadedCode(Script hScript, uint32 unFirst,
+                                        uint32 unLast)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_Instruction            *pInstructions   = NULL;
+    AVM_ThreadedInstruction    *pThreaded       = NULL;
+    boolean                    *pEntered        = NULL;
+    uint32                      unSize          = 0;
+    uint32                      unIndex         = 0;
+    uint32                      unWidth         = 0;
+    uint32                      unFused         = 0;
+
+    // Too short to contain anything worth fusing...
+    unSize          = CurrentScript.InstructionStreamHeader.unSize;
+    pInstructions   = CurrentScript.InstructionStream.pInstructions;
+    pThreaded       = CurrentScript.pThreadedCode;
+    if(unLast > unSize)
+        unLast = unSize;
+    if(unFirst >= unLast || unLast - unFirst < 2)
+        return 0;
+
+    // Find instructions entered other than by falling through...
+    pEntered = FindEnteredInstructions(hScript);
+
+        // Branch targets could land anywhere, so fuse nothing...
+        if(!pEntered)
+            return 0;
+
+    // Fuse sequences of quickened instructions, none entered but the first...
+    for(unIndex = unFirst; unIndex + 1 < unLast; unIndex += unWidth)
+    {
+        // Variables...
+        AVM_Instruction &First  = pInstructions[unIndex];
+        AVM_Instruction &Second = pInstructions[unIndex + 1];
+
+        // Assume nothing can be fused here...
+        unWidth = 1;
+
+        // Both instructions must be quickened and the second not entered...
+        if(!pThreaded[unIndex].Quickened || !pThreaded[unIndex + 1].Quickened ||
+           pEntered[unIndex + 1])
+            continue;
+
+        // Two pushes and a host call...
+        if(First.usOperationCode == INSTRUCTION_AVM_PUSH &&
+           Second.usOperationCode == INSTRUCTION_AVM_PUSH &&
+           unIndex + 2 < unLast && !pEntered[unIndex + 2] &&
+           pInstructions[unIndex + 2].usOperationCode ==
+            INSTRUCTION_AVM_CALLHOST)
+        {
+            // Fuse...
+            pThreaded[unIndex].usOperationCode =
+                INSTRUCTION_AVM_FUSED_PUSH_PUSH_CALLHOST;
+            unWidth = 3;
+        }
+
+        // Increment or decrement and a conditional jump on the result...
+        else if((First.usOperationCode == INSTRUCTION_AVM_INC ||
+                 First.usOperationCode == INSTRUCTION_AVM_DEC) &&
+                pThreaded[unIndex + 1].usOperationCode ==
+                    INSTRUCTION_AVM_QUICKENED_BRANCH &&
+                IsSameOperand(First.pOperandList[0], Second.pOperandList[0]))
+        {
+            // Fuse...
+            pThreaded[unIndex].usOperationCode =
+                INSTRUCTION_AVM_FUSED_STEP_JUMP;
+            unWidth = 2;
+        }
+
+        // Move and an arithmetic operation on the same destination...
+        else if(First.usOperationCode == INSTRUCTION_AVM_MOV &&
+                (Second.usOperationCode == INSTRUCTION_AVM_ADD ||
+                 Second.usOperationCode == INSTRUCTION_AVM_SUB ||
+                 Second.usOperationCode == INSTRUCTION_AVM_MUL ||
+                 Second.usOperationCode == INSTRUCTION_AVM_DIV ||
+                 Second.usOperationCode == INSTRUCTION_AVM_MOD) &&
+                IsSameOperand(First.pOperandList[0], Second.pOperandList[0]))
+        {
+            // Fuse...
+            pThreaded[unIndex].usOperationCode =
+                INSTRUCTION_AVM_FUSED_MOV_ARITHMETIC;
+            unWidth = 2;
+        }
+
+        // Nothing fused...
+        else
+            continue;
+
+        // Count it...
+        unFused++;
+    }
+
+    // Done with flags...
+    ArenaFree(CurrentScript.ImageArena, pEntered);
+
+    // Done...
+    return unFused;
+}
+
+// Generate a random number within zero and range inclusive...
+int32 VirtualMachine::GenerateRandomNumber(int32 nRange)
+{
+    // Variables...
+    //static  uint32  unPreviousRandomNumber  = 17489;
+    static volatile unsigned long long  PreviousRandomNumber    =
+                                            GetSystemMilliSeconds();
+    unsigned long long                  Previous                = 0;
+    uint32                              unRandomNumber          = 0;
+
+    // Generate random number, again if a worker running in parallel generated
+    //  one meanwhile...
+    do
+    {
+        Previous        = AGNI_ATOMIC_LOAD(&PreviousRandomNumber);
+        unRandomNumber  = (25173 * (uint32) Previous + 13849);
+    }
+    while(!AGNI_ATOMIC_COMPARE_AND_SWAP(&PreviousRandomNumber, Previous,
+                                        (unsigned long long) unRandomNumber));
+
+    // Return it within range...
+    return unRandomNumber % (1 + nRange);
+}
+
+// Get a function by index or return NULL on error...
+inline Agni_Function VirtualMachine::GetFunction(Script hScript, uint32 unIndex)
+{
+    // Return it...
+    return Scripts[hScript].pFunctionTable[unIndex];
+}
+
+// Get a function index by resolved handle or return -1 if it is stale or was
+//  never valid...
+int32 VirtualMachine::GetFunctionIndexByHandle(Script hScript,
+                                               Function hFunction)
+{
+    // Variables...
+    uint32  unIndex = 0;
+
+    // Check handle...
+    if(!IsValidThread(hScript) || hFunction < 0)
+        return -1;
+
+    // Resolved against another load...
+    if(((uint32) hFunction >> FUNCTION_HANDLE_INDEX_BITS) !=
+       Scripts[hScript].unLoadSerial)
+        return -1;
+
+    // Not one of its functions...
+    unIndex = (uint32) hFunction & ((1u << FUNCTION_HANDLE_INDEX_BITS) - 1);
+    if(unIndex >= Scripts[hScript].FunctionTableHeader.unSize)
+        return -1;
+
+    // Done...
+    return unIndex;
+}
+
+// Get a function index by name or return -1 on error...
+int32 VirtualMachine::GetFunctionIndexByName(Script hScript,
+                                             const char *pszName)
+{
+    // Variables...
+    uint32  unMask  = 0;
+    uint32  unSlot  = 0;
+    uint32  unEntry = 0;
+
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return -1;
+
+    // No functions to look through...
+    if(!Scripts[hScript].punFunctionIndex)
+        return -1;
+
+    // Probe the export index from where the name hashes to until an empty
+    //  slot...
+    unMask = Scripts[hScript].unFunctionIndexSlots - 1;
+    for(unSlot = HashName(pszName) & unMask;
+        (unEntry = Scripts[hScript].punFunctionIndex[unSlot]) != 0;
+        unSlot = (unSlot + 1) & unMask)
+    {
+        // Located...
+        if(strcasecmp(Scripts[hScript].pFunctionTable[unEntry - 1].szName,
+                      pszName) == 0)
+            return unEntry - 1;
+    }
+
+    // Function not found...
+    return -1;
+}
+
+// Get a function's hotness and tier, or return false if there is no such
+//  function...
+boolean VirtualMachine::GetFunctionProfile(Script hScript, char *pszName,
+                                           FunctionProfile &Profile)
+{
+    // Variables...
+    int32 nFunctionIndex = 0;
+
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Get the function index...
+    nFunctionIndex = GetFunctionIndexByName(hScript, pszName);
+
+        // Not found...
+        if(nFunctionIndex == -1)
+            return false;
+
+    // Store it...
+    Profile = Scripts[hScript].pFunctionState[nFunctionIndex].Profile;
+
+    // Done...
+    return true;
+}
+
+// Classify an operand by what is known of it after loading...
+VirtualMachine::OperandKind
+    VirtualMachine::GetOperandKind(const AVM_RuntimeValue &Operand)
+{
+    // Classify by operand type...
+    switch(Operand.OperandType)
+    {
+        // Integer literal...
+        case OT_AVM_INTEGER:
+            return OperandKind_Integer;
+
+        // Float literal...
+        case OT_AVM_FLOAT:
+            return OperandKind_Float;
+
+        // Other values inlined in the instruction stream...
+        case OT_AVM_STRING:
+        case OT_AVM_INDEX_INSTRUCTION:
+        case OT_AVM_INDEX_FUNCTION:
+        case OT_AVM_INDEX_FUNCTION_HOST:
+            return OperandKind_Literal;
+
+        // Absolute stack index, negative if within the stack frame...
+        case OT_AVM_INDEX_STACK_ABSOLUTE:
+            return (Operand.nStackIndex[0] < 0) ? OperandKind_StackLocal
+                                                : OperandKind_StackGlobal;
+
+        // Relative stack index...
+        case OT_AVM_INDEX_STACK_RELATIVE:
+            return OperandKind_StackRelative;
+
+        // Register, if it is one we know of...
+        case OT_AVM_REGISTER:
+            return (Operand.Register == REGISTER_AVM_T0 ||
+                    Operand.Register == REGISTER_AVM_T1 ||
+                    Operand.Register == REGISTER_AVM_RETURN)
+                        ? OperandKind_Register : OperandKind_Unknown;
+
+        // Anything else must be resolved generically...
+        default:
+            return OperandKind_Unknown;
+    }
+}
+
+// Get the string interning table's statistics, or return false if strings are
+//  not being interned...
+boolean VirtualMachine::GetInternStatistics(InternStatistics &Statistics) const
+{
+    // Not interning...
+    if(!bInternStrings)
+        return false;
+
+    // Fill in...
+    Statistics.unLookups    = unInternLookups;
+    Statistics.unHits       = unInternHits;
+    Statistics.unStrings    = unInternedStringCount;
+    Statistics.unBytes      = unInternedStringBytes +
+                              unInternedStringSlots * sizeof(AVM_InternedString);
+
+    // Done...
+    return true;
+}
+
+// Get the bytes a script's arenas have obtained, or zero if there is no such
+//  script...
+uint32 VirtualMachine::GetMemoryUsed(Script hScript) const
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return 0;
+
+    // Both arenas...
+    return Scripts[hScript].ImageArena.unBytesReserved +
+           Scripts[hScript].RuntimeArena.unBytesReserved;
+}
+
+// Get the bytes the virtual machine occupies, including every script's
+//  arenas...
+uint32 VirtualMachine::GetMemoryUsed() const
+{
+    // Variables...
+    uint32  unBytes = sizeof(VirtualMachine);
+
+    // Each script's arenas...
+    for(Script hScript = 0; hScript < MAXIMUM_THREADS; hScript++)
+        unBytes += GetMemoryUsed(hScript);
+
+    // Host provided function registry...
+    unBytes += unHostProvidedFunctionSlots * sizeof(AVM_HostProvidedFunction);
+
+    // String interning table and the strings interned...
+    unBytes += unInternedStringBytes +
+               unInternedStringSlots * sizeof(AVM_InternedString);
+
+    // Done...
+    return unBytes;
+}
+
+// Get the microseconds until a script is next due to run, zero if one can run
+//  now, or return false if none is executing...
+boolean VirtualMachine::GetNextWakeup(uint32 &unMicroSeconds) const
+{
+    // Variables...
+    unsigned long long  CurrentTime = 0;
+    unsigned long long  WakeTime    = 0;
+    boolean             bExecuting  = true;
+
+    // Workers running in parallel may be changing the queues meanwhile...
+    LockScheduler();
+
+    // Something can run now, or is running on a worker...
+    if(RunQueue.unSize > 0 || unHeldScripts > 0)
+        unMicroSeconds = 0;
+
+    // Nothing is executing...
+    else if(unPausedScripts == 0)
+        bExecuting = false;
+
+    // Time until the first paused script is due, as much as fits...
+    else
+    {
+        CurrentTime = GetSystemMicroSeconds();
+        WakeTime    = Scripts[PauseHeap[0]].PauseEndTime;
+        if(WakeTime <= CurrentTime)
+            unMicroSeconds = 0;
+        else if(WakeTime - CurrentTime > 0xFFFFFFFF)
+            unMicroSeconds = 0xFFFFFFFF;
+        else
+            unMicroSeconds = (uint32) (WakeTime - CurrentTime);
+    }
+
+    // Done...
+    UnlockScheduler();
+    return bExecuting;
+}
+
+// Get the hotness at which functions are optimized, or zero if they are
+//  optimized when loaded...
+uint32 VirtualMachine::GetOptimizeThreshold() const
+{
+    // Return it...
+    return unOptimizeThreshold;
+}
+
+// Get operand type as exists in a script's instruction stream...
+inline uint8 VirtualMachine::GetOperandType(Script hScript, uint8 OperandIndex)
+{
+    // Variables...
+    uint32  unCurrentInstruction    = 0;
+
+    // Get the current instruction's index...
+    unCurrentInstruction = Scripts[hScript].InstructionStream.
+                                unInstructionPointer;
+
+    // Return operand type...
+    return Scripts[hScript].InstructionStream.
+            pInstructions[unCurrentInstruction].pOperandList[OperandIndex].
+            OperandType;
+}
+
+// Get passed parameter as an integer...
+int VirtualMachine::GetParameterAsInteger(Script hScript, uint8 unParameter)
+{
+    // Variables...
+    int32               nTopIndex           = 0;
+    int32               nComputedLocation   = 0;
+    AVM_RuntimeValue    Parameter;
+
+    // Find the index of the top of this script's stack...
+    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+
+    // Compute the location of the parameter on the stack...
+    nComputedLocation = nTopIndex - (unParameter + 1);
+
+    // Extract the parameter...
+    Parameter = Scripts[hScript].Stack.pElements[nComputedLocation];
+
+    // Return the parameter coerced as an integer...
+    return CoerceValueToInteger(Parameter);
+}
+
+// Get passed parameter as a float...
+float VirtualMachine::GetParameterAsFloat(Script hScript, uint8 unParameter)
+{
+    // Variables...
+    int32               nTopIndex           = 0;
+    int32               nComputedLocation   = 0;
+    AVM_RuntimeValue    Parameter;
+
+    // Find the index of the top of this script's stack...
+    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+
+    // Compute the location of the parameter on the stack...
+    nComputedLocation = nTopIndex - (unParameter + 1);
+
+    // Extract the parameter...
+    Parameter = Scripts[hScript].Stack.pElements[nComputedLocation];
+
+    // Return the parameter coerced as a float...
+    return CoerceValueToFloat(Parameter);
+}
+
+// Get passed parameter as a string...
+char *VirtualMachine::GetParameterAsString(Script hScript, uint8 unParameter)
+{
+    // Variables...
+    AVM_Script         &CurrentScript       = Scripts[hScript];
+    int32               nTopIndex           = 0;
+    int32               nComputedLocation   = 0;
+    AVM_RuntimeValue   *pParameter          = NULL;
+    char               *pszScratch          = NULL;
+    uint32              unLength            = 0;
+
+    // Find the index of the top of this script's stack...
+    nTopIndex = CurrentScript.Stack.nTopIndex;
+
+    // Compute the location of the parameter on the stack...
+    nComputedLocation = nTopIndex - (unParameter + 1);
+    pParameter = &CurrentScript.Stack.pElements[nComputedLocation];
+
+    // Already a string, so return it in place, as a short one lives inline...
+    if(AVM_IS_STRING(*pParameter))
+        return AVM_CHARACTERS_OF(*pParameter);
+
+    // Scratch not needed until now...
+    if(!CurrentScript.pszCoercionScratch)
+        CurrentScript.pszCoercionScratch = (char *) ArenaAllocate(
+            CurrentScript.ImageArena, COERCION_SCRATCH_SIZE);
+
+    // Scratch could not be allocated or has no room left for the longest
+    //  number, so store the number formatted in the parameter itself, which
+    //  owns whatever that allocates...
+    if(!CurrentScript.pszCoercionScratch ||
+       CurrentScript.unCoercionScratchUsed + MAXIMUM_COERCION_LENGTH + 1 >
+        COERCION_SCRATCH_SIZE)
+    {
+        // Store...
+        char szCoercion[MAXIMUM_COERCION_LENGTH + 1];
+        pszScratch = CoerceValueToString(*pParameter, szCoercion);
+        StoreString(hScript, pParameter, pszScratch, strlen(pszScratch));
+
+        // Return it...
+        return AVM_CHARACTERS_OF(*pParameter);
+    }
+
+    // Otherwise format it into the scratch, where it stays until the host
+    //  function returns...
+    pszScratch = CurrentScript.pszCoercionScratch +
+                 CurrentScript.unCoercionScratchUsed;
+    CoerceValueToString(*pParameter, pszScratch);
+    unLength = strlen(pszScratch);
+    CurrentScript.unCoercionScratchUsed += unLength + 1;
+
+    // Done...
+    return pszScratch;
+}
+
+// Get the hotness at which functions are quickened...
+uint32 VirtualMachine::GetQuickenThreshold() const
+{
+    // Return it...
+    return unQuickenThreshold;
+}
+
+// Get return as a float from an asynchronous call...
+float VirtualMachine::GetReturnValueAsFloat(Script hScript)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return 0.0f;
+
+    // Return it...
+    return Scripts[hScript]._RegisterReturn.fLiteralFloat;
+}
+
+// Get return as an integer from an asynchronous call...
+int VirtualMachine::GetReturnValueAsInteger(Script hScript)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return 0;
+
+    // Return it...
+    return Scripts[hScript]._RegisterReturn.nLiteralInteger;
+}
+
+// Get return as a string from an asynchronous call...
+char *VirtualMachine::GetReturnValueAsString(Script hScript, char *pszBuffer,
+                                             uint32 unBufferSize)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return NULL;
+
+    // Supplied buffer too small...
+    if(strlen(AVM_CHARACTERS_OF(Scripts[hScript]._RegisterReturn)) >
+       (unBufferSize - 1))
+        return NULL;
+
+    // Store it in caller's buffer...
+    strcpy(pszBuffer, AVM_CHARACTERS_OF(Scripts[hScript]._RegisterReturn));
+
+    // Done...
+    return pszBuffer;
+}
+
+// Get how many superinstructions have been fused so far...
+uint32 VirtualMachine::GetFusedInstructionCount(Script hScript)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return 0;
+
+    // Return it...
+    return Scripts[hScript].unFusedInstructions;
+}
+
+// Get a runtime value on the stack...
+inline VirtualMachine::AVM_RuntimeValue 
+    VirtualMachine::GetStackValue(Script hScript, int32 nIndex)
+{
+    // Get element at specified index...
+    return Scripts[hScript].Stack.pElements[ResolveStackIndex(hScript, nIndex)];
+}
+
+// Does an operand name one variable or register, known at load time?
+bool VirtualMachine::IsNamedSlot(const AVM_RuntimeValue &Operand)
+{
+    // Check its kind...
+    switch(GetOperandKind(Operand))
+    {
+        // Variable or register...
+        case OperandKind_StackGlobal:
+        case OperandKind_StackLocal:
+        case OperandKind_Register:
+            return true;
+
+        // Literal, or something only known at runtime...
+        default:
+            return false;
+    }
+}
+
+// Do two operands name the same runtime value?
+bool VirtualMachine::IsSameOperand(const AVM_RuntimeValue &Operand0,
+                                   const AVM_RuntimeValue &Operand1)
+{
+    // Different kinds of operand never do...
+    if(Operand0.OperandType != Operand1.OperandType)
+        return false;
+
+    // Compare by kind...
+    switch(Operand0.OperandType)
+    {
+        // Absolute stack index...
+        case OT_AVM_INDEX_STACK_ABSOLUTE:
+            return Operand0.nStackIndex[0] == Operand1.nStackIndex[0];
+
+        // Base stack index and variable offset...
+        case OT_AVM_INDEX_STACK_RELATIVE:
+            return Operand0.nStackIndex[0] == Operand1.nStackIndex[0] &&
+                   AVM_STACK_OFFSET(Operand0) == AVM_STACK_OFFSET(Operand1);
+
+        // Register...
+        case OT_AVM_REGISTER:
+            return Operand0.Register == Operand1.Register;
+
+        // Literals are not runtime values...
+        default:
+            return false;
+    }
+}
+
+// Rehash the host provided function registry into room for another function,
+//  or return false if out of memory...
+bool VirtualMachine::GrowHostProvidedFunctions()
+{
+    // Variables...
+    AVM_HostProvidedFunction   *pOldFunctions   = pHostProvidedFunctions;
+    uint32                      unOldSlots      = unHostProvidedFunctionSlots;
+    uint32                      unSlots         = 0;
+    uint32                      unIndex         = 0;
+    uint32                      unSlot          = 0;
+
+    // Double, unless clearing vacated slots alone leaves room enough...
+    if(!unOldSlots)
+        unSlots = INITIAL_HOST_PROVIDED_FUNCTION_SLOTS;
+    else if((unHostProvidedFunctionCount + 1) * 2 > unOldSlots)
+        unSlots = unOldSlots * 2;
+    else
+        unSlots = unOldSlots;
+
+    // Allocate...
+    pHostProvidedFunctions = (AVM_HostProvidedFunction *)
+        pAllocator->Allocate(unSlots * sizeof(AVM_HostProvidedFunction),
+                             ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+
+        // Failed, keep the old registry...
+        if(!pHostProvidedFunctions)
+        {
+            pHostProvidedFunctions = pOldFunctions;
+            return false;
+        }
+
+    // Every slot starts vacant...
+    memset(pHostProvidedFunctions, '\x0',
+           unSlots * sizeof(AVM_HostProvidedFunction));
+
+    // Reinsert each registered function...
+    for(unIndex = 0; unIndex < unOldSlots; unIndex++)
+    {
+        // Vacant...
+        if(!pOldFunctions[unIndex].bLoaded)
+            continue;
+
+        // Probe for a free slot...
+        for(unSlot = pOldFunctions[unIndex].unHash & (unSlots - 1);
+            pHostProvidedFunctions[unSlot].bLoaded;
+            unSlot = (unSlot + 1) & (unSlots - 1));
+
+        // Move...
+        pHostProvidedFunctions[unSlot] = pOldFunctions[unIndex];
+    }
+
+    // Done with the old registry...
+    if(pOldFunctions)
+        pAllocator->Free(pOldFunctions,
+                         unOldSlots * sizeof(AVM_HostProvidedFunction),
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+    unHostProvidedFunctionSlots     = unSlots;
+    unHostProvidedFunctionSlotsUsed = unHostProvidedFunctionCount;
+
+    // Done...
+    return true;
+}
+
+// Rehash the interning table into room for another string, or return false if
+//  out of memory...
+bool VirtualMachine::GrowInternedStrings()
+{
+    // Variables...
+    AVM_InternedString *pOldStrings = pInternedStrings;
+    uint32              unOldSlots  = unInternedStringSlots;
+    uint32              unSlots     = 0;
+    uint32              unIndex     = 0;
+    uint32              unSlot      = 0;
+
+    // Double, unless clearing vacated slots alone leaves room enough...
+    if(!unOldSlots)
+        unSlots = INITIAL_INTERNED_STRING_SLOTS;
+    else if((unInternedStringCount + 1) * 2 > unOldSlots)
+        unSlots = unOldSlots * 2;
+    else
+        unSlots = unOldSlots;
+
+    // Allocate...
+    pInternedStrings = (AVM_InternedString *)
+        pAllocator->Allocate(unSlots * sizeof(AVM_InternedString),
+                             ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+
+        // Failed, keep the old table...
+        if(!pInternedStrings)
+        {
+            pInternedStrings = pOldStrings;
+            return false;
+        }
+
+    // Every slot starts vacant...
+    memset(pInternedStrings, '\x0', unSlots * sizeof(AVM_InternedString));
+
+    // Reinsert each interned string...
+    for(unIndex = 0; unIndex < unOldSlots; unIndex++)
+    {
+        // Vacant...
+        if(!pOldStrings[unIndex].pString)
+            continue;
+
+        // Probe for a free slot...
+        for(unSlot = pOldStrings[unIndex].pString->unHash & (unSlots - 1);
+            pInternedStrings[unSlot].pString;
+            unSlot = (unSlot + 1) & (unSlots - 1));
+
+        // Move...
+        pInternedStrings[unSlot].pString = pOldStrings[unIndex].pString;
+    }
+
+    // Done with the old table...
+    if(pOldStrings)
+        pAllocator->Free(pOldStrings, unOldSlots * sizeof(AVM_InternedString),
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+    unInternedStringSlots       = unSlots;
+    unInternedStringSlotsUsed   = unInternedStringCount;
+
+    // Done...
+    return true;
+}
+
+// Hash a host provided function's case folded name and visibility...
+uint32 VirtualMachine::HashHostProvidedFunction(Script hVisibleTo,
+                                                const char *pszName)
+{
+    // Fold the visibility into the name's hash...
+    return (HashName(pszName) ^ hVisibleTo) * 16777619u;
+}
+
+// Hash a case folded name...
+uint32 VirtualMachine::HashName(const char *pszName)
+{
+    // Variables...
+    uint32  unHash  = 2166136261u;
+
+    // Fold in each character, case insensitively...
+    for(; *pszName; pszName++)
+        unHash = (unHash ^ (uint8) tolower((uint8) *pszName)) * 16777619u;
+
+    // Done...
+    return unHash;
+}
+
+// Hash a string's characters, case sensitively...
+uint32 VirtualMachine::HashString(const char *pszCharacters, uint32 unLength)
+{
+    // Variables...
+    uint32  unHash  = 2166136261u;
+
+    // Fold in each character...
+    while(unLength--)
+        unHash = (unHash ^ (uint8) *pszCharacters++) * 16777619u;
+
+    // Done...
+    return unHash;
+}
+
+// Sleep until a time in microseconds, or until the main timeslice that started
+//  at a time in milliseconds and lasts a duration ends if that is sooner, then
+//  read the clock into a worker's calibration and return true if the main
+//  timeslice has ended...
+bool VirtualMachine::IdleUntil(AVM_Worker &Worker, unsigned long long WakeTime,
+                               uint32 unMainTimeSliceStartTime,
+                               uint32 unDuration, uint32 &unCurrentTime)
+{
+    // Variables...
+    unsigned long long  CurrentTime         = GetSystemMicroSeconds();
+    unsigned long long  MainTimeSliceEnd    = 0;
+
+    // We are not running indefinetely...
+    if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+    {
+        // Check if main timeslice has expired...
+        unCurrentTime = (uint32) (CurrentTime / 1000);
+        if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+            return true;
+
+        // Wake no later than just after it does...
+        MainTimeSliceEnd = CurrentTime + (unsigned long long)
+            (unMainTimeSliceStartTime + unDuration - unCurrentTime + 1) * 1000;
+        if(MainTimeSliceEnd < WakeTime)
+            WakeTime = MainTimeSliceEnd;
+    }
+
+    // Sleep, if it is not time already...
+    if(WakeTime > CurrentTime)
+        SleepMicroSeconds(WakeTime - CurrentTime);
+
+    // Read the clock again, and leave idling out of the calibration...
+    unCurrentTime                   = GetSystemMilliSeconds();
+    Worker.unClockWindowIterations  = 0;
+    Worker.unClockWindowStartTime   = unCurrentTime;
+
+    // Done...
+    return false;
+}
+
+// Add a script to the pause heap...
+void VirtualMachine::InsertPausedScript(Script hScript)
+{
+    // Put it at the bottom and move it up to where it is due...
+    PauseHeap[unPausedScripts++] = hScript;
+    SiftPausedScript(unPausedScripts - 1);
+}
+
+// Find or intern a string of the given characters, adding a reference to it, or
+//  NULL if out of memory...
+char *VirtualMachine::InternString(const char *pszCharacters, uint32 unLength)
+{
+    // Variables...
+    uint32      unHash      = HashString(pszCharacters, unLength);
+    uint32      unSlot      = 0;
+    AVM_String *pString     = NULL;
+    char       *pszString   = NULL;
+
+    // Count the lookup...
+    unInternLookups++;
+
+    // Probe from where it hashes to until a slot never used...
+    for(unSlot = unHash & (unInternedStringSlots - 1);
+        unInternedStringSlots && (pInternedStrings[unSlot].pString ||
+                                  pInternedStrings[unSlot].bVacated);
+        unSlot = (unSlot + 1) & (unInternedStringSlots - 1))
+    {
+        // Extract...
+        pString = pInternedStrings[unSlot].pString;
+
+        // Found, so share it...
+        if(pString && pString->unHash == unHash &&
+           pString->unLength == unLength &&
+           memcmp(pString->szCharacters, pszCharacters, unLength) == 0)
+        {
+            // Share...
+            pString->unReferences++;
+            unInternHits++;
+
+            // Done...
+            return pString->szCharacters;
+        }
+    }
+
+    // Keep the table no more than three quarters full...
+    if((unInternedStringSlotsUsed + 1) * 4 > unInternedStringSlots * 3 &&
+       !GrowInternedStrings())
+        return NULL;
+
+    // Allocate...
+    pszString = NewString(HEAP_STRING_OWNER, pszCharacters, unLength, unLength);
+
+        // Failed...
+        if(!pszString)
+            return NULL;
+
+    // Mark as interned...
+    pString             = AVM_STRING_OF(pszString);
+    pString->unHash     = unHash;
+    pString->bInterned  = true;
+
+    // Probe for a free or vacated slot...
+    for(unSlot = unHash & (unInternedStringSlots - 1);
+        pInternedStrings[unSlot].pString;
+        unSlot = (unSlot + 1) & (unInternedStringSlots - 1));
+
+    // A slot never used before fills the table further...
+    if(!pInternedStrings[unSlot].bVacated)
+        unInternedStringSlotsUsed++;
+
+    // Intern...
+    pInternedStrings[unSlot].pString    = pString;
+    pInternedStrings[unSlot].bVacated   = false;
+    unInternedStringCount++;
+    unInternedStringBytes += AVM_STRING_SIZE(unLength);
+
+    // Done...
+    return pszString;
+}
+
+// Invoke a script's host function by index...
+void VirtualMachine::InvokeHostFunction(Script hScript, uint32 unIndex)
+{
+    // Variables...
+    AVM_Script &CurrentScript           = Scripts[hScript];
+    uint32      unCoercionScratchUsed   = 0;
+
+    // Not one of the script's host functions...
+    if(unIndex >= CurrentScript.HostFunctionTableHeader.unSize)
+        return;
+
+    // Host functions registered since binding may bind differently...
+    if(CurrentScript.unHostFunctionBindingGeneration !=
+        unHostProvidedFunctionGeneration)
+        BindHostFunctions(hScript);
+
+    // Not provided by the host...
+    if(!CurrentScript.ppHostFunctionBindings[unIndex])
+        return;
+
+    // Invoke it, then free the scratch its parameters were formatted into,
+    //  keeping whatever any host function calling back into the script still
+    //  has in use...
+    unCoercionScratchUsed = CurrentScript.unCoercionScratchUsed;
+    CurrentScript.ppHostFunctionBindings[unIndex](hScript);
+    CurrentScript.unCoercionScratchUsed = unCoercionScratchUsed;
+}
+
+// Link a script onto the end of a queue...
+void VirtualMachine::LinkScript(AVM_ScriptQueue &Queue, Script hScript)
+{
+    // Variables...
+    Script  hTail   = 0;
+
+    // Queue is empty, so it is the only one...
+    if(Queue.unSize == 0)
+    {
+        Scripts[hScript].hNextQueued        = hScript;
+        Scripts[hScript].hPreviousQueued    = hScript;
+        Queue.hHead                         = hScript;
+    }
+
+    // Otherwise it goes behind the last, just before the head comes around
+    //  again...
+    else
+    {
+        hTail                                   = Scripts[Queue.hHead].
+                                                    hPreviousQueued;
+        Scripts[hScript].hNextQueued            = Queue.hHead;
+        Scripts[hScript].hPreviousQueued        = hTail;
+        Scripts[hTail].hNextQueued              = hScript;
+        Scripts[Queue.hHead].hPreviousQueued    = hScript;
+    }
+
+    // Remember where it is...
+    Scripts[hScript].pQueue = &Queue;
+    Queue.unSize++;
+}
+
+// Load bytes or throws error code...
+void VirtualMachine::LoadBytes(void *pStorageBuffer, uint32 unEachOfSize,
+                               uint32 unMembers, AVM_ScriptImage &Image)
+{
+    // Variables...
+    uint32  unBytes = unEachOfSize * unMembers;
+
+    // Check for reading past the end of the image...
+    if(unBytes > Image.unSize - Image.unOffset)
+        throw Bad_Executable;
+
+    // Read and advance...
+    memcpy(pStorageBuffer, &Image.pBytes[Image.unOffset], unBytes);
+    Image.unOffset += unBytes;
+}
+
+// Load script, store handle, return a status code...
+VirtualMachine::Status 
+    VirtualMachine::LoadScript(const char *pszPath, Script &hScript)
+{
+    // Variables...
+    FILE   *hScriptFile                 = NULL;
+    uint8  *pImage                      = NULL;
+    long    ImageSize                   = 0;
+    Status  Result                      = Ok;
+
+    // Invalid until loaded...
+    hScript = (Script) -1;
+
+    // Open script...
+    hScriptFile = fopen(pszPath, "rb");
+
+        // Failed...
+        if(!hScriptFile)
+            return Cannot_Open;
+
+    // Find its size...
+    if(fseek(hScriptFile, 0, SEEK_END) != 0 ||
+       (ImageSize = ftell(hScriptFile)) < 0 ||
+       fseek(hScriptFile, 0, SEEK_SET) != 0)
+    {
+        // Cleanup and abort...
+        fclose(hScriptFile);
+        return Bad_Executable;
+    }
+
+    // Allocate room for the whole image...
+    pImage = (uint8 *) pAllocator->Allocate(ImageSize + 1,
+                                            ALLOCATION_ALIGNMENT,
+                                            UNTAGGED_ALLOCATION);
+
+        // Failed...
+        if(!pImage)
+        {
+            // Cleanup and abort...
+            fclose(hScriptFile);
+            return Memory_Allocation;
+        }
+
+    // Read it...
+    if(fread(pImage, 1, ImageSize, hScriptFile) != (size_t) ImageSize)
+    {
+        // Cleanup and abort...
+        pAllocator->Free(pImage, ImageSize + 1, ALLOCATION_ALIGNMENT,
+                         UNTAGGED_ALLOCATION);
+        fclose(hScriptFile);
+        return Bad_Executable;
+    }
+
+    // Done with file...
+    fclose(hScriptFile);
+
+    // Load from image, which nothing refers to once loaded...
+    Result = LoadScriptImage(pImage, (uint32) ImageSize, NULL, hScript);
+
+    // Cleanup...
+    pAllocator->Free(pImage, ImageSize + 1, ALLOCATION_ALIGNMENT,
+                     UNTAGGED_ALLOCATION);
+
+    // Done...
+    return Result;
+}
+
+// Load a precompiled script, store handle, return a status code...
+VirtualMachine::Status 
+    VirtualMachine::LoadScript(const PrecompiledScript &Precompiled,
+                               Script &hScript)
+{
+    // Load its executable image and run its body instead...
+    return LoadScriptImage(Precompiled.pImage, Precompiled.unImageSize,
+                           Precompiled.pBody, hScript);
+}
+
+// Load script from an executable image, to be run by a precompiled body if
+//  one is given, store handle, return a status code...
+VirtualMachine::Status 
+    VirtualMachine::LoadScriptImage(const uint8 *pImage, uint32 unImageSize,
+                                    PrecompiledBody pBody, Script &hScript)
+{
+    // Variables...
+    AVM_ScriptImage Image;
+    char    szBuffer[1024]              = {0};
+    uint32  unCurrentInstructionIndex   = 0;
+    AVM_ThreadedInstruction  *pLoadedCode       = NULL;
+    char                    **ppszStringTable   = NULL;
+    uint16  usCurrentOperandIndex       = 0;
+    uint16  usCurrentStringIndex        = 0;
+    uint16  usCurrentFunctionIndex      = 0;
+    uint16  usCurrentHostFunctionIndex  = 0;
+    int32   nOffsetIndex                = 0;
+
+    // Try to load script...
+    try
+    {
+        // Find a free script handle index...
+        for(hScript = 0; hScript < (MAXIMUM_THREADS - 1); hScript++)
+        {
+            // Found one...
+            if(!Scripts[hScript].bLoaded)
+                break;
+        }
+
+            // Scanned entire list without finding vacancy, failed...
+            if(hScript + 1 == (MAXIMUM_THREADS - 1))
+                throw Threads_Exhausted;
+
+        // Clear script...
+        memset(&Scripts[hScript], 0, sizeof(AVM_Script));
+
+        // Tag its arenas' chunks as its own...
+        Scripts[hScript].ImageArena.hOwner      = hScript;
+        Scripts[hScript].RuntimeArena.hOwner    = hScript;
+
+        // Read from the start of the image...
+        Image.pBytes    = pImage;
+        Image.unSize    = unImageSize;
+        Image.unOffset  = 0;
+
+        // Run by precompiled body, if any...
+        Scripts[hScript].pPrecompiledBody = pBody;
+
+        // Process main header...
+
+            // Load main header...
+            LoadBytes(&Scripts[hScript].MainHeader, sizeof(Agni_MainHeader), 1,
+                      Image);
+
+            // Check signature...
+
+                // Initialize...
+                memset(szBuffer, '\x90', sizeof(szBuffer));
+                memcpy(&szBuffer[2], "AGNI", strlen("AGNI"));
+
+                // Check...
+                if(memcmp(&Scripts[hScript].MainHeader.Signature, szBuffer,
+                          sizeof(Scripts[hScript].MainHeader.Signature)) != 0)
+                    throw Bad_Executable;
+
+            // Check checksum...
+            if(CalculateCheckSumOfImage(Image) !=
+               Scripts[hScript].MainHeader.unCheckSum)
+                throw Bad_CheckSum;
+
+            // Check required Agni runtime version...
+            if(!VersionSafe(AGNI_VERSION_MAJOR, AGNI_VERSION_MINOR,
+                            Scripts[hScript].MainHeader.ucMajorRequiredAgniVersion,
+                            Scripts[hScript].MainHeader.ucMinorRequiredAgniVersion))
+                throw Old_Agni_Runtime;
+
+            // Check host, if any host information provided...
+            if(Scripts[hScript].MainHeader.unHostStringIndex != (uint32) -1)
+            {
+                // Check host version...
+                if(!VersionSafe(HostVersionMajor, HostVersionMinor,
+                                Scripts[hScript].MainHeader.ucHostMajorVersion,
+                                Scripts[hScript].MainHeader.ucHostMinorVersion))
+                    throw Old_Host_Runtime;
+            }
+
+            // Check for default stack size...
+            if(Scripts[hScript].MainHeader.unStackSize == (uint32) -1)
+                Scripts[hScript].MainHeader.unStackSize = DEFAULT_STACK_SIZE;
+
+            #if defined(AGNI_COMPACT_VALUES)
+            // Too large for a saved stack frame to fit in a runtime value...
+            if(Scripts[hScript].MainHeader.unStackSize > MAXIMUM_STACK_SIZE)
+                throw Bad_Executable;
+            #endif
+
+            // Allocate runtime stack, unless guarded and so reserved once
+            //  frame sizes are known...
+            #if !defined(AGNI_GUARDED_STACKS)
+            Scripts[hScript].Stack.pElements = (AVM_RuntimeValue *)
+                ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                    Scripts[hScript].MainHeader.unStackSize,
+                                    sizeof(AVM_RuntimeValue));
+
+                // Failed...
+                if(!Scripts[hScript].Stack.pElements)
+                    throw Memory_Allocation;
+            #endif
+
+            // Set thread's time slice duration...
+            switch(Scripts[hScript].MainHeader.ThreadPriorityType)
+            {
+                // Low...
+                case THREAD_PRIORITY_LOW:
+
+                    // Store default thread time slice for low priority...
+                    Scripts[hScript].unThreadTimeSlice =
+                        THREAD_PRIORITY_LOW_DURATION;
+
+                    // Done...
+                    break;
+
+                // Medium...
+                case THREAD_PRIORITY_MEDIUM:
+
+                    // Store default thread time slice for medium priority...
+                    Scripts[hScript].unThreadTimeSlice =
+                        THREAD_PRIORITY_MEDIUM_DURATION;
+
+                    // Done...
+                    break;
+
+                // High...
+                case THREAD_PRIORITY_HIGH:
+
+                    // Store default thread time slice for high priority...
+                    Scripts[hScript].unThreadTimeSlice =
+                        THREAD_PRIORITY_HIGH_DURATION;
+
+                    // Done...
+                    break;
+
+                // User...
+                case THREAD_PRIORITY_USER:
+
+                    // Extract and store user time slice from main header...
+                    Scripts[hScript].unThreadTimeSlice =
+                        Scripts[hScript].MainHeader.unThreadPriorityUser;
+
+                    // Done...
+                    break;
+
+                // Unknown...
+                default:
+                    throw Bad_Executable;
+            }
+
+        // Process instruction stream...
+
+            // Load instruction stream header...
+            LoadBytes(&Scripts[hScript].InstructionStreamHeader,
+                      sizeof(Agni_InstructionStreamHeader), 1, Image);
+
+            // Allocate room to load instructions into until the code image
+            //  can be built, including a terminating instruction...
+            pLoadedCode = (AVM_ThreadedInstruction *)
+                ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                    Scripts[hScript].InstructionStreamHeader.unSize + 1,
+                    sizeof(AVM_ThreadedInstruction));
+
+                // Failed...
+                if(!pLoadedCode)
+                    throw Memory_Allocation;
+
+            // Load instruction stream...
+            for(unCurrentInstructionIndex = 0;
+                unCurrentInstructionIndex < Scripts[hScript].
+                    InstructionStreamHeader.unSize;
+                unCurrentInstructionIndex++)
+            {
+                // Variables...
+                uint8               OperandCount    = 0x00;
+                AVM_RuntimeValue   *pOperandList   = NULL;
+
+                // Load this instructions operation code... (2 bytes)
+                LoadBytes(&pLoadedCode[unCurrentInstructionIndex].
+                            usOperationCode,
+                          sizeof(uint16), 1, Image);
+
+                // Load operand count... (1 byte)
+                LoadBytes(&OperandCount, sizeof(uint8), 1, Image);
+                pLoadedCode[unCurrentInstructionIndex].OperandCount =
+                    OperandCount;
+
+                    // More than any instruction takes...
+                    if(OperandCount > MAXIMUM_OPERANDS)
+                        throw Bad_Executable;
+
+                // Operands are inlined into the instruction...
+                pOperandList = pLoadedCode[unCurrentInstructionIndex].Operands;
+
+                // Load operand list...
+                for(usCurrentOperandIndex = 0;
+                    usCurrentOperandIndex < OperandCount;
+                    usCurrentOperandIndex++)
+                {
+                    // Load operand type... (1 byte)
+                    LoadBytes(&pOperandList[usCurrentOperandIndex].OperandType,
+                              sizeof(uint8), 1, Image);
+
+                    // Load operand data...
+                    switch(pOperandList[usCurrentOperandIndex].OperandType)
+                    {
+                        // Integer literal... (4 bytes)
+                        case OT_AVM_INTEGER:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nLiteralInteger, sizeof(int32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Floating-point literal... (4 bytes)
+                        case OT_AVM_FLOAT:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        fLiteralFloat, sizeof(float32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // String index... (4 bytes)
+                        case OT_AVM_INDEX_STRING:
+                        {
+                            // Load... (nStringTableIndex -> nLiteralInteger)
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nLiteralInteger, sizeof(int32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Instruction index... (4 bytes)
+                        case OT_AVM_INDEX_INSTRUCTION:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nInstructionIndex, sizeof(int32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Absolute stack index... (4 bytes)
+                        case OT_AVM_INDEX_STACK_ABSOLUTE:
+                        {
+                            // Load... (second element useful only for relative)
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nStackIndex[0], sizeof(int32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Relative stack index... (4 + 4 bytes)
+                        case OT_AVM_INDEX_STACK_RELATIVE:
+                        {
+                            // Load base index...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nStackIndex[0], sizeof(int32), 1,
+                                      Image);
+
+                            // Load offset index...
+                            LoadBytes(&nOffsetIndex, sizeof(int32), 1, Image);
+
+                            // Store it, unless too far to fit...
+                            AVM_STACK_OFFSET(
+                                pOperandList[usCurrentOperandIndex]) =
+                                    nOffsetIndex;
+                            if(AVM_STACK_OFFSET(
+                                pOperandList[usCurrentOperandIndex]) !=
+                                    nOffsetIndex)
+                                throw Bad_Executable;
+
+                            // Done...
+                            break;
+                        }
+                        
+                        // Absolute stack index in register... (1 byte)
+                        case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
+                        {
+                            // Load register identifier...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                      Register, sizeof(uint8), 1, Image);
+                            break;
+                        }
+
+                        // Function index... (4 bytes)
+                        case OT_AVM_INDEX_FUNCTION:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                      nFunctionIndex,
+                                      sizeof(int32), 1, Image);
+                            break;
+                        }
+
+                        // Host function index... (4 bytes)
+                        case OT_AVM_INDEX_FUNCTION_HOST:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        nHostFunctionIndex, sizeof(int32), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Register... (1 byte)
+                        case OT_AVM_REGISTER:
+                        {
+                            // Load...
+                            LoadBytes(&pOperandList[usCurrentOperandIndex].
+                                        Register, sizeof(uint8), 1,
+                                      Image);
+                            break;
+                        }
+
+                        // Unknown...
+                        default:
+                            throw Bad_Executable;
+                    }
+                }
+            }
+
+        // Process string stream...
+
+            // Process string stream header...
+            //  (sizeof(Agni_StringStreamHeader) bytes)
+            LoadBytes(&Scripts[hScript].StringStreamHeader,
+                      sizeof(Agni_StringStreamHeader), 1, Image);
+
+            // Load string table, if any strings to load...
+            if(Scripts[hScript].StringStreamHeader.unSize > 0)
+            {
+                // Allocate...
+                ppszStringTable = (char **)
+                    ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                        Scripts[hScript].StringStreamHeader.
+                                            unSize,
+                                        sizeof(char *));
+
+                    // Failed...
+                    if(!ppszStringTable)
+                        throw Memory_Allocation;
+
+                // Load each string...
+                for(usCurrentStringIndex = 0;
+                    usCurrentStringIndex < Scripts[hScript].StringStreamHeader.unSize;
+                    usCurrentStringIndex++)
+                {
+                    // Variables...
+                    uint32  unStringLength      = 0;
+                    char   *pszCurrentString    = NULL;
+
+                    // Load string length... (4 bytes)
+                    LoadBytes(&unStringLength, sizeof(uint32), 1, Image);
+
+                    // Allocate storage for string...
+                    pszCurrentString = (char *)
+                        ArenaAllocate(Scripts[hScript].ImageArena,
+                                      (size_t) unStringLength + 1);
+
+                        // Failed...
+                        if(!pszCurrentString)
+                            throw Memory_Allocation;
+
+                    // Load string and terminate... (unStringLength bytes)
+                    LoadBytes(pszCurrentString, unStringLength, 1, Image);
+                    pszCurrentString[unStringLength] = '\x0';
+
+                    // Store in string table...
+                    ppszStringTable[usCurrentStringIndex] = pszCurrentString;
+                }
+
+                // The host and the script have both identified themselves...
+                if(Scripts[hScript].MainHeader.unHostStringIndex != (uint32) -1
+                    && pszHostName != NULL)
+                {
+                    // Host name does not match the scripts host name...
+                    if(strcasecmp(ppszStringTable[Scripts[hScript].MainHeader.
+                                    unHostStringIndex], pszHostName) != 0)
+                        throw Wrong_Host;
+                }
+            }
+
+        // Build the code image, converting string table indices to string
+        //  literals...
+        BuildCodeImage(hScript, pLoadedCode, ppszStringTable);
+
+            // Free loaded instructions, now copied into the code image...
+            ArenaFree(Scripts[hScript].ImageArena, pLoadedCode);
+            pLoadedCode = NULL;
+
+            // Free temporary string table...
+            if(ppszStringTable)
+            {
+                // Free original strings...
+                for(usCurrentStringIndex = 0;
+                    usCurrentStringIndex < Scripts[hScript].StringStreamHeader.
+                        unSize;
+                    usCurrentStringIndex++)
+                    ArenaFree(Scripts[hScript].ImageArena,
+                              ppszStringTable[usCurrentStringIndex]);
+
+                // Free the table itself...
+                ArenaFree(Scripts[hScript].ImageArena, ppszStringTable);
+                ppszStringTable = NULL;
+            }
+
+        // Process function table...
+
+            // Load function table header... (sizeof(AVM_FunctionTableHeader) bytes)
+            LoadBytes(&Scripts[hScript].FunctionTableHeader,
+                      sizeof(Agni_FunctionTableHeader), 1, Image);
+
+            // Allocate function table, if necessary...
+            if(Scripts[hScript].FunctionTableHeader.unSize > 0)
+            {
+                // Allocate...
+                Scripts[hScript].pFunctionTable = (Agni_Function *)
+                    ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                        Scripts[hScript].FunctionTableHeader.
+                                            unSize,
+                                        sizeof(Agni_Function));
+
+                    // Failed...
+                    if(!Scripts[hScript].pFunctionTable)
+                        throw Memory_Allocation;
+
+                // Allocate each function's runtime state...
+                Scripts[hScript].pFunctionState = (AVM_FunctionState *)
+                    ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                        Scripts[hScript].FunctionTableHeader.
+                                            unSize,
+                                        sizeof(AVM_FunctionState));
+
+                    // Failed...
+                    if(!Scripts[hScript].pFunctionState)
+                        throw Memory_Allocation;
+            }
+
+            // Load each function...
+            for(usCurrentFunctionIndex = 0;
+                usCurrentFunctionIndex < Scripts[hScript].FunctionTableHeader.
+                    unSize;
+                usCurrentFunctionIndex++)
+            {
+                // Variables...
+                uint32  unEntryPoint        = 0x00000000;
+                uint8   ParameterCount      = 0;
+                uint32  unLocalDataSize     = 0;
+                uint32  unStackFrameSize    = 0;
+                uint8   NameLength          = 0;
+
+                // Load entry point... (4 bytes)
+                LoadBytes(&unEntryPoint, sizeof(uint32), 1, Image);
+                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
+                    unEntryPoint = unEntryPoint;
+
+                // Load parameter count... (1 byte)
+                LoadBytes(&ParameterCount, sizeof(uint8), 1, Image);
+                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
+                    ParameterCount = ParameterCount;
+
+                // Load local data size...
+                LoadBytes(&unLocalDataSize, sizeof(uint32), 1, Image);
+                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
+                    unLocalDataSize = unLocalDataSize;
+
+                // Calculate stack frame size so we don't have to waste cycles
+                //  recalculating...
+                unStackFrameSize = ParameterCount + 1 + unLocalDataSize;
+                Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
+                    unStackFrameSize = unStackFrameSize;
+
+                // Load function name...
+
+                    // Name length... (1 byte)
+                    LoadBytes(&NameLength, sizeof(uint8), 1, Image);
+
+                    // Name... (NameLength bytes)
+                    LoadBytes(&Scripts[hScript].
+                              pFunctionTable[usCurrentFunctionIndex].szName,
+                              NameLength, 1, Image);
+
+                        // Terminate...
+                        Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
+                            szName[NameLength] = '\x0';
+            }
+
+            #if defined(AGNI_GUARDED_STACKS)
+            // Reserve the runtime stack between guards large enough for the
+            //  largest frame...
+            ReserveGuardedStack(hScript);
+            #endif
+
+            // Index each function by name...
+            BuildFunctionIndex(hScript);
+
+        // Process host function table...
+
+            // Load host function table header...
+            LoadBytes(&Scripts[hScript].HostFunctionTableHeader,
+                  sizeof(Agni_HostFunctionTableHeader), 1, Image);
+
+            // Allocate host function table, if necessary...
+            if(Scripts[hScript].HostFunctionTableHeader.unSize > 0)
+            {
+                // Allocate...
+                Scripts[hScript].pHostFunctionTable = (Agni_HostFunction *)
+                    ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                        Scripts[hScript].
+                                            HostFunctionTableHeader.unSize,
+                                        sizeof(Agni_HostFunction));
+
+                    // Failed...
+                    if(!Scripts[hScript].pHostFunctionTable)
+                        throw Memory_Allocation;
+
+                // Allocate each host function's binding...
+                Scripts[hScript].ppHostFunctionBindings =
+                    (HostProvidedFunction **)
+                        ArenaAllocateZeroed(Scripts[hScript].ImageArena,
+                                            Scripts[hScript].
+                                                HostFunctionTableHeader.unSize,
+                                            sizeof(HostProvidedFunction *));
+
+                    // Failed...
+                    if(!Scripts[hScript].ppHostFunctionBindings)
+                        throw Memory_Allocation;
+            }
+
+            // Load each host function...
+            for(usCurrentHostFunctionIndex = 0;
+                usCurrentHostFunctionIndex < Scripts[hScript].
+                    HostFunctionTableHeader.unSize;
+                usCurrentHostFunctionIndex++)
+            {
+                // Variables...
+                uint8 NameLength    = 0;
+
+                // Load name...
+
+                    // Length... (1 byte)
+                    LoadBytes(&NameLength, sizeof(uint8), 1, Image);
+
+                    // Name...
+                    LoadBytes(&Scripts[hScript].
+                              pHostFunctionTable[usCurrentHostFunctionIndex].
+                                szName, NameLength, 1, Image);
+
+                        // Terminate...
+                        Scripts[hScript].
+                            pHostFunctionTable[usCurrentHostFunctionIndex].
+                            szName[NameLength] = '\x0';
+            }
+
+            // Bind host functions to those registered so far...
+            BindHostFunctions(hScript);
+
+        // Resolve branch targets, quicken, and fuse threaded code now that
+        //  function entry points are known...
+        PrepareThreadedCode(hScript);
+
+    }
+
+        // Failed to load script...
+        catch(Status Reason)
+        {
+            // Cleanup...
+
+                // Interned string literals, if necessary, those interned so
+                //  far, which outlive the arenas...
+                if(Scripts[hScript].ppszInternedLiterals)
+                {
+                    // Release each...
+                    for(usCurrentStringIndex = 0;
+                        usCurrentStringIndex < Scripts[hScript].
+                            StringStreamHeader.unSize;
+                        usCurrentStringIndex++)
+                        ReleaseString(Scripts[hScript].ppszInternedLiterals[
+                            usCurrentStringIndex]);
+                }
+
+                // Native code, if necessary...
+                FreeNativeCode(hScript);
+
+                #if defined(AGNI_GUARDED_STACKS)
+                // Guarded runtime stack, if reserved...
+                ReleaseGuardedStack(hScript);
+                #endif
+
+                // Everything else allocated so far, in one shot...
+                ArenaRelease(Scripts[hScript].ImageArena);
+                ArenaRelease(Scripts[hScript].RuntimeArena);
+
+            // Mark script as fully unloaded...
+            memset(&Scripts[hScript], '\x0', sizeof(AVM_Script));
+
+            // Invalidate script thread handle...
+            hScript = (Script) -1;
+
+            // Abort...
+            return Reason;
+        }
+
+    // Set loaded flag, under a serial of its own, never zero, so handles
+    //  resolved against whatever was loaded here before are refused...
+    unScriptLoadSerial = (unScriptLoadSerial % FUNCTION_HANDLE_SERIAL_MASK) + 1;
+    Scripts[hScript].unLoadSerial = unScriptLoadSerial;
+    Scripts[hScript].bLoaded = true;
+
+    /* Display statistics... (for debugging purposes only)
+    DisplayStatistics(hScript);*/
+
+    // Done...
+    return Ok;
+}
+
+// Allocate a string of the given length and room holding a copy of the given
+//  characters, or left for the caller to fill in if none, with a single
+//  reference, or NULL if out of memory...
+char *VirtualMachine::NewString(Script hOwner, const char *pszCharacters,
+                                uint32 unLength, uint32 unCapacity)
+{
+    // Variables...
+    AVM_String *pString = NULL;
+
+    // Allocate from the owner's runtime arena, or the heap if none...
+    pString = (AVM_String *) ((hOwner == HEAP_STRING_OWNER) ?
+        pAllocator->Allocate(AVM_STRING_SIZE(unCapacity),
+                             ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION) :
+        ArenaAllocate(Scripts[hOwner].RuntimeArena,
+                      AVM_STRING_SIZE(unCapacity)));
+
+        // Failed...
+        if(!pString)
+            return NULL;
+
+    // Initialize...
+    pString->unReferences   = 1;
+    pString->unLength       = unLength;
+    pString->unCapacity     = unCapacity;
+    pString->unHash         = 0;
+    pString->hOwner         = hOwner;
+    pString->bInterned      = false;
+    if(pszCharacters)
+        memcpy(pString->szCharacters, pszCharacters, unLength);
+    pString->szCharacters[unLength] = '\x0';
+
+    // Done...
+    return pString->szCharacters;
+}
+
+// Pass float parameter...
+boolean VirtualMachine::PassFloatParameter(Script hScript, float fValue)
+{
+    // Variables...
+    AVM_RuntimeValue    FloatParameter;
+
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Initialize parameter...
+    FloatParameter.OperandType      = OT_AVM_FLOAT;
+    FloatParameter.fLiteralFloat    = fValue;
+
+    // Try to push parameter onto the script's stack...
+    try
+    {
+        // Push it...
+        Push(hScript, FloatParameter);
+    }
+
+        // Failed...
+        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
+        {
+            // Let caller know it failed...
+            return false;
+        }
+
+    // Done...
+    return true;
+}
+
+// Pass integer parameter...
+boolean VirtualMachine::PassIntegerParameter(Script hScript, int nValue)
+{
+    // Variables...
+    AVM_RuntimeValue    IntegerParameter;
+
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Initialize parameter...
+    IntegerParameter.OperandType        = OT_AVM_INTEGER;
+    IntegerParameter.nLiteralInteger    = nValue;
+
+    // Try to push parameter onto the script's stack...
+    try
+    {
+        // Push it...
+        Push(hScript, IntegerParameter);
+    }
+
+        // Failed...
+        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
+        {
+            // Let caller know it failed...
+            return false;
+        }
+
+    // Done...
+    return true;
+}
+
+// Pass string parameter...
+boolean VirtualMachine::PassStringParameter(Script hScript, char *pszValue)
+{
+    // Variables...
+    AVM_RuntimeValue    StringParameter;
+
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Initialize parameter...
+    StringParameter.OperandType = OT_AVM_NULL;
+
+    // Try to push parameter onto the script's stack...
+    try
+    {
+        // Store a copy of it...
+        StoreString(hScript, &StringParameter, pszValue, strlen(pszValue));
+
+        // Push it, which takes its own reference...
+        Push(hScript, StringParameter);
+    }
+
+        // Out of memory...
+        catch(const char *pszException)
+        {
+            // Let caller know it failed...
+            return false;
+        }
+
+        // Failed...
+        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
+        {
+            // Cleanup...
+            ReleaseValue(&StringParameter);
+
+            // Let caller know it failed...
+            return false;
+        }
+
+    // Done with ours...
+    ReleaseValue(&StringParameter);
+
+    // Done...
+    return true;
+}
+
+// Time in microseconds a pause lasting some milliseconds from now ends, one
+//  that is negative having already ended...
+unsigned long long VirtualMachine::PauseEndTimeAfter(long long Duration)
+{
+    // Variables...
+    unsigned long long  CurrentTime = GetSystemMicroSeconds();
+
+    // Already over...
+    if(Duration <= 0)
+        return CurrentTime;
+
+    // Done...
+    return CurrentTime + (unsigned long long) Duration * 1000;
+}
+
+// Pause a script for a certain duration...
+boolean VirtualMachine::PauseScript(Script hScript, uint32 unDuration)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Trigger pause...
+    Scripts[hScript].bPaused = true;
+    Scripts[hScript].PauseEndTime = PauseEndTimeAfter(unDuration);
+    ScheduleScript(hScript);
+
+    // Done...
+    return true;
+}
+
+// Pop value off of the stack or throw execution exception...
+inline VirtualMachine::AVM_RuntimeValue VirtualMachine::Pop(Script hScript)
+{
+    // Variables...
+    AVM_RuntimeValue    PoppedValue;
+    int32               nNewTopIndex    = 0;
+
+    // Check for stack underflow, unless popping below the stack touches its
+    //  lower guard instead...
+    #if !defined(AGNI_GUARDED_STACKS)
+    if(Scripts[hScript].Stack.nTopIndex <= 0)
+        throw SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+    #endif
+
+    // Decrement top index...
+    Scripts[hScript].Stack.nTopIndex--;
+
+    // Get new top index...
+    nNewTopIndex = Scripts[hScript].Stack.nTopIndex;
+
+    // Top index + 1 is location of now popped off element, whose string
+    //  reference, if any, moves with it to the caller...
+    PoppedValue = Scripts[hScript].Stack.pElements[nNewTopIndex];
+    Scripts[hScript].Stack.pElements[nNewTopIndex].OperandType = OT_AVM_NULL;
+
+    // Return popped off value to caller...
+    return PoppedValue;
+}
+
+// Push a stack frame onto the stack or throw execution exception...
+inline void VirtualMachine::PushStackFrame(Script hScript, uint32 unSize)
+{
+    // Check for stack overflow, unless the frame's first use touches the
+    //  stack's upper guard instead...
+    #if !defined(AGNI_GUARDED_STACKS)
+    if(Scripts[hScript].Stack.nTopIndex + unSize >=
+       Scripts[hScript].MainHeader.unStackSize - 1)
+        throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    #endif
+
+    // Push...
+    PushStackFrameWithinBound(hScript, unSize);
+}
+
+// Push a stack frame onto the stack already known to have room...
+inline void VirtualMachine::PushStackFrameWithinBound(Script hScript,
+                                                      uint32 unSize)
+{
+    // Stack must now accomodate nSize elements for new stack frame...
+    Scripts[hScript].Stack.nTopIndex += unSize;
+
+    // Shift frame index to match to top of the new stack frame...
+    Scripts[hScript].Stack.unCurrentStackFrameTopIndex
+        = Scripts[hScript].Stack.nTopIndex;
+}
+
+// Pop stack frame off of the stack or throw execution exception...
+inline void VirtualMachine::PopStackFrame(Script hScript, uint32 unSize)
+{
+    // Stack underflow, unless the next use below the stack touches its lower
+    //  guard instead...
+    #if !defined(AGNI_GUARDED_STACKS)
+    if(Scripts[hScript].Stack.nTopIndex - unSize < 0)
+        throw SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+    #endif
+
+    // Shift stack top down...
+    Scripts[hScript].Stack.nTopIndex -= unSize;
+
+    /* Note: We will not modify the stack's frame pointer,
+             unCurrentStackFrameTopIndex, because Call and Ret instructions
+             will manually set it... */
+}
+
+// Resolve branch targets, quicken, and fuse a script's threaded code or throw
+//  status code...
+void VirtualMachine::PrepareThreadedCode(Script hScript)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    uint32                      unSize          = 0;
+    uint32                      unIndex         = 0;
+    AVM_Instruction            *pInstruction    = NULL;
+    AVM_ThreadedInstruction    *pThreaded       = NULL;
+    AVM_RuntimeValue           *pTarget         = NULL;
+
+    // Prepare each instruction...
+    unSize = CurrentScript.InstructionStreamHeader.unSize;
+    for(unIndex = 0; unIndex < unSize; unIndex++)
+    {
+        // Find the instruction and its threaded counterpart...
+        pInstruction    = &CurrentScript.InstructionStream.pInstructions[unIndex];
+        pThreaded       = &CurrentScript.pThreadedCode[unIndex];
+
+        // Find a branch's target operand, if any...
+        switch(pInstruction->usOperationCode)
+        {
+            // Unconditional jump...
+            case INSTRUCTION_AVM_JMP:
+                pTarget = &pInstruction->pOperandList[0];
+                break;
+
+            // Conditional jumps...
+            case INSTRUCTION_AVM_JE:
+            case INSTRUCTION_AVM_JNE:
+            case INSTRUCTION_AVM_JG:
+            case INSTRUCTION_AVM_JL:
+            case INSTRUCTION_AVM_JGE:
+            case INSTRUCTION_AVM_JLE:
+                pTarget = &pInstruction->pOperandList[2];
+                break;
 
-                    // Name length... (1 byte)
-                    LoadBytes(&NameLength, sizeof(uint8), 1, hScriptFile);
+            // Not a branch...
+            default:
+                pTarget = NULL;
+        }
 
-                    // Name... (NameLength bytes)
-                    LoadBytes(&Scripts[hScript].
-                              pFunctionTable[usCurrentFunctionIndex].szName,
-                              NameLength, 1, hScriptFile);
+        // Resolve the target now if it is a valid instruction index...
+        if(pTarget && pTarget->OperandType == OT_AVM_INDEX_INSTRUCTION &&
+           (uint32) pTarget->nInstructionIndex < unSize)
+            pThreaded->pJumpTarget =
+                &CurrentScript.pThreadedCode[pTarget->nInstructionIndex];
+    }
 
-                        // Terminate...
-                        Scripts[hScript].pFunctionTable[usCurrentFunctionIndex].
-                            szName[NameLength] = '\x0';
-            }
+    // Find each function's instructions and whether to tier them...
+    PrepareTiering(hScript);
 
-        // Process host function table...
+    // Handler addresses are linked the first time the code runs...
+    CurrentScript.bThreadedCodeLinked = false;
 
-            // Load host function table header...
-            LoadBytes(&Scripts[hScript].HostFunctionTableHeader,
-                  sizeof(Agni_HostFunctionTableHeader), 1, hScriptFile);
+        // Functions are quickened and fused as they get hot...
+        if(CurrentScript.bTiering)
+            return;
 
-            // Allocate host function table, if necessary...
-            if(Scripts[hScript].HostFunctionTableHeader.unSize > 0)
-            {
-                // Allocate...
-                Scripts[hScript].pHostFunctionTable = (Agni_HostFunction *)
-                    calloc(Scripts[hScript].HostFunctionTableHeader.unSize,
-                           sizeof(Agni_HostFunction));
+    // Otherwise quicken everything up front...
+    QuickenThreadedCode(hScript, 0, unSize);
 
-                    // Failed...
-                    if(!Scripts[hScript].pHostFunctionTable)
-                        throw Memory_Allocation;
-            }
+    // Translate for the register tier, before fusion rearranges anything,
+    //  unless a precompiled body runs the script instead...
+    if(Engine == Dispatch_Register && !CurrentScript.pPrecompiledBody)
+        TranslateToRegisterCode(hScript);
 
-            // Load each host function...
-            for(usCurrentHostFunctionIndex = 0;
-                usCurrentHostFunctionIndex < Scripts[hScript].
-                    HostFunctionTableHeader.unSize;
-                usCurrentHostFunctionIndex++)
-            {
-                // Variables...
-                uint8 NameLength    = 0;
+    // Compile to native code, also before fusion, where supported...
+    #if defined(AGNI_NATIVE_CODE)
+    if(Engine == Dispatch_Native && !CurrentScript.pPrecompiledBody)
+        CompileNativeCode(hScript);
+    #endif
 
-                // Load name...
+    // Fuse quickened sequences into superinstructions...
+    CurrentScript.unFusedInstructions = FuseThreadedCode(hScript, 0, unSize);
+}
 
-                    // Length... (1 byte)
-                    LoadBytes(&NameLength, sizeof(uint8), 1, hScriptFile);
+// Find each function's instructions and start it at its tier...
+void VirtualMachine::PrepareTiering(Script hScript)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_ThreadedInstruction    *pThreaded       = CurrentScript.pThreadedCode;
+    uint32                      unSize          = 0;
+    uint32                      unFunctions     = 0;
+    uint32                      unIndex         = 0;
+    uint32                      unCurrent       = (uint32) -1;
+
+    // Belonging to no function, until entry points are marked...
+    unSize      = CurrentScript.InstructionStreamHeader.unSize;
+    unFunctions = CurrentScript.FunctionTableHeader.unSize;
+    for(unIndex = 0; unIndex <= unSize; unIndex++)
+        pThreaded[unIndex].unFunctionIndex = (uint32) -1;
+
+    // Mark each function's entry point...
+    for(unIndex = 0; unIndex < unFunctions; unIndex++)
+    {
+        // Variables...
+        AVM_FunctionState  &State       = CurrentScript.pFunctionState[unIndex];
+        uint32              unEntry     =
+            CurrentScript.pFunctionTable[unIndex].unEntryPoint;
 
-                    // Name...
-                    LoadBytes(&Scripts[hScript].
-                              pHostFunctionTable[usCurrentHostFunctionIndex].
-                                szName, NameLength, 1, hScriptFile);
+        // Empty until its extent is known...
+        State.unFirstInstruction    = (unEntry < unSize) ? unEntry : unSize;
+        State.unLastInstruction     = State.unFirstInstruction;
 
-                        // Terminate...
-                        Scripts[hScript].
-                            pHostFunctionTable[usCurrentHostFunctionIndex].
-                            szName[NameLength] = '\x0';
-            }
+        // Mark...
+        if(unEntry < unSize)
+            pThreaded[unEntry].unFunctionIndex = unIndex;
     }
 
-        // Failed to load script...
-        catch(Status Reason)
+    // Each function extends up to the next one's entry point...
+    for(unIndex = 0; unIndex < unSize; unIndex++)
+    {
+        // Another function begins here...
+        if(pThreaded[unIndex].unFunctionIndex != (uint32) -1)
         {
-            // Cleanup...
+            // End the one before it...
+            if(unCurrent != (uint32) -1)
+                CurrentScript.pFunctionState[unCurrent].unLastInstruction =
+                    unIndex;
 
-                // Close script file, if necessary...
-                if(hScriptFile)
-                    fclose(hScriptFile);
-
-                // Runtime stack, if necessary...
-                if(Scripts[hScript].Stack.pElements)
-                    free(Scripts[hScript].Stack.pElements);
+            // Continue with this one...
+            unCurrent = pThreaded[unIndex].unFunctionIndex;
+        }
 
-                // Instruction stream, if necessary...
-                for(unCurrentInstructionIndex = 0;
-                    unCurrentInstructionIndex <
-                        Scripts[hScript].InstructionStreamHeader.unSize &&
-                    Scripts[hScript].InstructionStream.pInstructions;
-                    unCurrentInstructionIndex++)
-                {
-                    // Variables...
-                    uint8               OperandCount    = 0;
-                    AVM_RuntimeValue   *pOperandList    = NULL;
+        // Still the same function...
+        else
+            pThreaded[unIndex].unFunctionIndex = unCurrent;
+    }
 
-                    // Extract number of operands...
-                    OperandCount = Scripts[hScript].InstructionStream.
-                                    pInstructions[unCurrentInstructionIndex].
-                                    OperandCount;
+        // End the last one...
+        if(unCurrent != (uint32) -1)
+            CurrentScript.pFunctionState[unCurrent].unLastInstruction = unSize;
 
-                    // Extract operand list...
-                    pOperandList = Scripts[hScript].InstructionStream.
-                                    pInstructions[unCurrentInstructionIndex].
-                                    pOperandList;
+    // Find how deep each takes the stack, before any is quickened...
+    AnalyzeStackDepth(hScript);
 
-                    // If operand list was allocated, free...
-                    if(pOperandList)
-                    {
-                        // String literals must be freed...
-                        for(usCurrentOperandIndex = 0;
-                            usCurrentOperandIndex < OperandCount;
-                            usCurrentOperandIndex++)
-                        {
-                            // String found...
-                            if(pOperandList[usCurrentOperandIndex].OperandType
-                                == OT_AVM_STRING)
-                            {
-                                // Free...
-                                free(pOperandList[usCurrentOperandIndex].
-                                     pszLiteralString);
-                                pOperandList[usCurrentOperandIndex].
-                                     pszLiteralString = NULL;
-                            }
-                        }
+    // Only the threaded engine tiers, and only if functions would ever get
+    //  hot enough to optimize...
+    CurrentScript.bTiering = (Engine == Dispatch_Threaded &&
+                              !CurrentScript.pPrecompiledBody &&
+                              unOptimizeThreshold > 0 && unFunctions > 0);
 
-                        // Free the operand list itself...
-                        free(pOperandList);
-                    }
-                }
+    // Start each function at its tier...
+    for(unIndex = 0; unIndex < unFunctions; unIndex++)
+    {
+        // Everything is prepared up front when not tiering...
+        if(!CurrentScript.bTiering)
+            CurrentScript.pFunctionState[unIndex].Profile.Tier =
+                Tier_Optimized;
 
-                // Free instruction stream itself, if necessary...
-                if(Scripts[hScript].InstructionStream.pInstructions)
-                    free(Scripts[hScript].InstructionStream.pInstructions);
+        // Quickened before ever running...
+        else if(unQuickenThreshold == 0)
+            PromoteFunction(hScript, unIndex, Tier_Quickened);
 
-                // Function table, if necessary...
-                if(Scripts[hScript].pFunctionTable)
-                    free(Scripts[hScript].pFunctionTable);
+        // Interpreted until hot...
+        else
+            CurrentScript.pFunctionState[unIndex].Profile.Tier =
+                Tier_Interpreted;
+    }
+}
 
-                // Host function table, if necessary...
-                if(Scripts[hScript].pHostFunctionTable)
-                    free(Scripts[hScript].pHostFunctionTable);
+// Promote a function to a tier...
+void VirtualMachine::PromoteFunction(Script hScript, uint32 unFunctionIndex,
+                                     ExecutionTier Tier)
+{
+    // Variables...
+    AVM_Script         &CurrentScript   = Scripts[hScript];
+    AVM_FunctionState  &State           =
+        CurrentScript.pFunctionState[unFunctionIndex];
+    uint32              unIndex         = 0;
+
+    // Quicken...
+    if(State.Profile.Tier < Tier_Quickened && Tier >= Tier_Quickened)
+        QuickenThreadedCode(hScript, State.unFirstInstruction,
+                            State.unLastInstruction);
+
+    // Fuse, which may only fail to find memory to do so...
+    if(State.Profile.Tier < Tier_Optimized && Tier >= Tier_Optimized)
+    {
+        // Try to fuse...
+        try
+        {
+            CurrentScript.unFusedInstructions +=
+                FuseThreadedCode(hScript, State.unFirstInstruction,
+                                 State.unLastInstruction);
+        }
 
-            // Mark script as fully unloaded...
-            memset(&Scripts[hScript], '\x0', sizeof(AVM_Script));
+            // Failed, but quickened code runs just as correctly...
+            catch(Status)
+            {
+            }
+    }
 
-            // Invalidate script thread handle...
-            hScript = (Script) -1;
+    // Remember...
+    State.Profile.Tier = Tier;
 
-            // Abort...
-            return Reason;
-        }
+    // Changed handlers are linked the next time the code runs...
+    CurrentScript.bThreadedCodeLinked = false;
 
-    // Cleanup...
-    fclose(hScriptFile);
+    // Keep tiering while any function could still be promoted...
+    for(unIndex = 0; unIndex < CurrentScript.FunctionTableHeader.unSize;
+        unIndex++)
+    {
+        // Found one...
+        if(CurrentScript.pFunctionState[unIndex].Profile.Tier != Tier_Optimized)
+            return;
+    }
 
-    // Set loaded flag...
-    Scripts[hScript].bLoaded = true;
+    // Every function is optimized...
+    CurrentScript.bTiering = false;
+}
 
-    /* Display statistics... (for debugging purposes only)
-    DisplayStatistics(hScript);*/
+// Push value onto the stack or throw execution exception...
+inline void VirtualMachine::Push(Script hScript, AVM_RuntimeValue RuntimeValue)
+{
+    // Stack overflow, unless pushing past the stack touches its upper guard
+    //  instead...
+    #if !defined(AGNI_GUARDED_STACKS)
+    if(Scripts[hScript].Stack.nTopIndex >=
+       (int32) Scripts[hScript].MainHeader.unStackSize - 1)
+        throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    #endif
 
-    // Done...
-    return Ok;
+    // Push...
+    PushWithinBound(hScript, RuntimeValue);
 }
 
-// Pass float parameter...
-boolean VirtualMachine::PassFloatParameter(Script hScript, float fValue)
+// Push value onto the stack already known to have room...
+inline void VirtualMachine::PushWithinBound(Script hScript,
+                                            AVM_RuntimeValue RuntimeValue)
 {
     // Variables...
-    AVM_RuntimeValue    FloatParameter;
+    int32   nTopIndex   = 0;
 
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return false;
+    // Get the current top index...
+    nTopIndex = Scripts[hScript].Stack.nTopIndex;
 
-    // Initialize parameter...
-    FloatParameter.OperandType      = OT_AVM_FLOAT;
-    FloatParameter.fLiteralFloat    = fValue;
+    // nTopIndex + 1 is array element of newly added stack element...
+    CopyValue(&Scripts[hScript].Stack.pElements[nTopIndex], RuntimeValue);
 
-    // Try to push parameter onto the script's stack...
-    try
+    // Increment top index...
+    Scripts[hScript].Stack.nTopIndex++;
+}
+
+// Quicken a range of threaded code, the last instruction exclusive...
+void VirtualMachine::QuickenThreadedCode(Script hScript, uint32 unFirst,
+                                         uint32 unLast)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_Instruction            *pInstruction    = NULL;
+    AVM_ThreadedInstruction    *pThreaded       = NULL;
+    uint32                      unIndex         = 0;
+
+    // Quicken each instruction...
+    for(unIndex = unFirst; unIndex < unLast; unIndex++)
     {
-        // Push it...
-        Push(hScript, FloatParameter);
+        // Find the instruction and its threaded counterpart...
+        pInstruction    = &CurrentScript.InstructionStream.pInstructions[unIndex];
+        pThreaded       = &CurrentScript.pThreadedCode[unIndex];
+
+        // Quicken, if a handler specialized on its operand kinds exists,
+        //  leaving pushes unchecked where its function's depth is known...
+        pThreaded->Quickened = SelectQuickenedHandler(*pInstruction,
+            pThreaded->unFunctionIndex != (uint32) -1 &&
+            CurrentScript.pFunctionState[pThreaded->unFunctionIndex].
+                bStackBounded);
+        if(pThreaded->Quickened)
+            pThreaded->usOperationCode =
+                (pInstruction->usOperationCode >= INSTRUCTION_AVM_JE &&
+                 pInstruction->usOperationCode <= INSTRUCTION_AVM_JLE) ?
+                    INSTRUCTION_AVM_QUICKENED_BRANCH :
+                    INSTRUCTION_AVM_QUICKENED;
     }
+}
 
-        // Failed...
-        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
-        {
-            // Let caller know it failed...
-            return false;
+// Quickened handler helpers...
+
+    // Is a source of a known kind integral, deciding by value only if unknown...
+    #define QUICKENED_IS_INTEGER(Kind, Value) \
+        ((Kind) == OperandKind_Integer || \
+         ((Kind) != OperandKind_Float && (Value).OperandType == OT_AVM_INTEGER))
+
+    // A source of a known kind as an integer...
+    #define QUICKENED_AS_INTEGER(Kind, Value) \
+        ((Kind) == OperandKind_Integer ? (Value).nLiteralInteger \
+                                       : CoerceValueToInteger(Value))
+
+    // A source of a known kind as a float...
+    #define QUICKENED_AS_FLOAT(Kind, Value) \
+        ((Kind) == OperandKind_Float ? (Value).fLiteralFloat \
+                                     : CoerceValueToFloat(Value))
+
+    // Compare a field of both operands as the conditional jump requires...
+    #define QUICKENED_COMPARE(Field) \
+        switch(Operation) \
+        { \
+            case INSTRUCTION_AVM_JE:  return pOperand0->Field == pOperand1->Field; \
+            case INSTRUCTION_AVM_JNE: return pOperand0->Field != pOperand1->Field; \
+            case INSTRUCTION_AVM_JG:  return pOperand0->Field >  pOperand1->Field; \
+            case INSTRUCTION_AVM_JL:  return pOperand0->Field <  pOperand1->Field; \
+            case INSTRUCTION_AVM_JGE: return pOperand0->Field >= pOperand1->Field; \
+            case INSTRUCTION_AVM_JLE: return pOperand0->Field <= pOperand1->Field; \
+            default:                  return false; \
         }
 
-    // Done...
-    return true;
+// Quickened binary operation...
+template <int Operation, int DestinationKind, int SourceKind>
+bool VirtualMachine::QuickenedBinary(Script hScript,
+                                     AVM_RuntimeValue *pOperandList)
+{
+    // Variables...
+    AVM_RuntimeValue   *pDestination    = NULL;
+    AVM_RuntimeValue   *pSource         = NULL;
+
+    // Resolve both operands without inspecting their types...
+    pDestination    = QuickenedOperand<DestinationKind>(hScript, pOperandList[0]);
+    pSource         = QuickenedOperand<SourceKind>(hScript, pOperandList[1]);
+
+    // Perform binary operation, which the compiler selects statically...
+    switch(Operation)
+    {
+        // Move, unless source and destination are the same...
+        case INSTRUCTION_AVM_MOV:
+            if(pDestination != pSource)
+                CopyValue(pDestination, *pSource);
+            break;
+
+        // Add...
+        case INSTRUCTION_AVM_ADD:
+            if(QUICKENED_IS_INTEGER(SourceKind, *pSource))
+                pDestination->nLiteralInteger +=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            else
+                pDestination->fLiteralFloat +=
+                    QUICKENED_AS_FLOAT(SourceKind, *pSource);
+            break;
+
+        // Subtract...
+        case INSTRUCTION_AVM_SUB:
+            if(QUICKENED_IS_INTEGER(SourceKind, *pSource))
+                pDestination->nLiteralInteger -=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            else
+                pDestination->fLiteralFloat -=
+                    QUICKENED_AS_FLOAT(SourceKind, *pSource);
+            break;
+
+        // Multiply...
+        case INSTRUCTION_AVM_MUL:
+            if(QUICKENED_IS_INTEGER(SourceKind, *pSource))
+                pDestination->nLiteralInteger *=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            else
+                pDestination->fLiteralFloat *=
+                    QUICKENED_AS_FLOAT(SourceKind, *pSource);
+            break;
+
+        // Divide...
+        case INSTRUCTION_AVM_DIV:
+            if(QUICKENED_IS_INTEGER(SourceKind, *pSource))
+                pDestination->nLiteralInteger /=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            else
+                pDestination->fLiteralFloat /=
+                    QUICKENED_AS_FLOAT(SourceKind, *pSource);
+            break;
+
+        // Modulus defined only for integral values...
+        case INSTRUCTION_AVM_MOD:
+            pDestination->nLiteralInteger %=
+                QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+
+        // Bitwise AND, only defined for integral values...
+        case INSTRUCTION_AVM_AND:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger &=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+
+        // Bitwise OR, only defined for integral values...
+        case INSTRUCTION_AVM_OR:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger |=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+
+        // Bitwise XOR, only defined for integral values...
+        case INSTRUCTION_AVM_XOR:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger ^=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+
+        // Shift left, only defined for integral values...
+        case INSTRUCTION_AVM_SHL:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger <<=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+
+        // Shift right, only defined for integral values...
+        case INSTRUCTION_AVM_SHR:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger >>=
+                    QUICKENED_AS_INTEGER(SourceKind, *pSource);
+            break;
+    }
+
+    // Never branches...
+    return false;
 }
 
-// Pass integer parameter...
-boolean VirtualMachine::PassIntegerParameter(Script hScript, int nValue)
+// Quickened comparison for a conditional jump...
+template <int Operation, int Kind0, int Kind1>
+bool VirtualMachine::QuickenedCompare(Script hScript,
+                                      AVM_RuntimeValue *pOperandList)
 {
     // Variables...
-    AVM_RuntimeValue    IntegerParameter;
-
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return false;
+    AVM_RuntimeValue   *pOperand0   = NULL;
+    AVM_RuntimeValue   *pOperand1   = NULL;
 
-    // Initialize parameter...
-    IntegerParameter.OperandType        = OT_AVM_INTEGER;
-    IntegerParameter.nLiteralInteger    = nValue;
+    // Resolve both operands without inspecting their types...
+    pOperand0 = QuickenedOperand<Kind0>(hScript, pOperandList[0]);
+    pOperand1 = QuickenedOperand<Kind1>(hScript, pOperandList[1]);
 
-    // Try to push parameter onto the script's stack...
-    try
+    // Compare according to the type of the first operand's value...
+    switch(pOperand0->OperandType)
     {
-        // Push it...
-        Push(hScript, IntegerParameter);
-    }
+        // Integer...
+        case OT_AVM_INTEGER:
+            QUICKENED_COMPARE(nLiteralInteger);
 
-        // Failed...
-        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
+        // Float...
+        case OT_AVM_FLOAT:
+            QUICKENED_COMPARE(fLiteralFloat);
+
+        // String, which can only be tested for equality...
+        case OT_AVM_STRING:
+        case OT_AVM_SHORT_STRING:
         {
-            // Let caller know it failed...
+            // Equal...
+            if(Operation == INSTRUCTION_AVM_JE)
+                return StringsEqual(*pOperand0, *pOperand1);
+
+            // Not equal...
+            if(Operation == INSTRUCTION_AVM_JNE)
+                return !StringsEqual(*pOperand0, *pOperand1);
+
+            // Anything else never jumps...
             return false;
         }
 
-    // Done...
-    return true;
+        // Anything else never jumps...
+        default:
+            return false;
+    }
 }
 
-// Pass string parameter...
-boolean VirtualMachine::PassStringParameter(Script hScript, char *pszValue)
+// Resolve an operand of a known kind to its runtime value...
+template <int Kind>
+inline VirtualMachine::AVM_RuntimeValue *
+    VirtualMachine::QuickenedOperand(Script hScript, AVM_RuntimeValue &Operand)
 {
     // Variables...
-    AVM_RuntimeValue    StringParameter;
+    int32   nOffsetIndex    = 0;
+    int32   nIndex          = 0;
 
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return false;
+    // Resolve, which the compiler selects statically...
+    switch(Kind)
+    {
+        // Global variable...
+        case OperandKind_StackGlobal:
+            return &Scripts[hScript].Stack.pElements[Operand.nStackIndex[0]];
+
+        // Variable in the current stack frame...
+        case OperandKind_StackLocal:
+            return &Scripts[hScript].Stack.pElements[
+                Operand.nStackIndex[0] +
+                    Scripts[hScript].Stack.unCurrentStackFrameTopIndex];
+
+        // Array element, offset by the value of a variable...
+        case OperandKind_StackRelative:
+        {
+            // Find the offset variable and add its value to the base...
+            nOffsetIndex    = AVM_STACK_OFFSET(Operand);
+            nIndex          = Operand.nStackIndex[0] + Scripts[hScript].Stack.
+                pElements[ResolveStackIndex(hScript, nOffsetIndex)].
+                    nLiteralInteger;
 
-    // Initialize parameter...
-    StringParameter.OperandType         = OT_AVM_STRING;
-    StringParameter.pszLiteralString    = strdup(pszValue);
+            // Return location...
+            return &Scripts[hScript].Stack.pElements[
+                ResolveStackIndex(hScript, nIndex)];
+        }
 
-        // Failed...
-        if(!StringParameter.pszLiteralString)
-            return false;
+        // Register...
+        case OperandKind_Register:
+            return ResolveRegister(hScript, Operand.Register);
 
-    // Try to push parameter onto the script's stack...
-    try
-    {
-        // Push it...
-        Push(hScript, StringParameter);
+        // Anything else is inlined in the instruction stream...
+        default:
+            return &Operand;
     }
+}
 
-        // Failed...
-        catch(SCRIPT_EXECUTION_EXCEPTION Exception)
-        {
-            // Let caller know it failed...
-            return false;
-        }
+// Quickened pop...
+template <int Kind>
+bool VirtualMachine::QuickenedPop(Script hScript,
+                                  AVM_RuntimeValue *pOperandList)
+{
+    // Variables...
+    AVM_RuntimeValue    Value;
+    AVM_RuntimeValue   *pDestination    = NULL;
 
-    // Done...
-    return true;
+    // Pop top most value on stack into destination, which takes over its
+    //  string reference...
+    Value           = Pop(hScript);
+    pDestination    = QuickenedOperand<Kind>(hScript, pOperandList[0]);
+    ReleaseValue(pDestination);
+   *pDestination    = Value;
+
+    // Never branches...
+    return false;
 }
 
-// Pause a script for a certain duration...
-boolean VirtualMachine::PauseScript(Script hScript, uint32 unDuration)
+// Quickened push, checked unless its function's stack depth was checked when
+//  it was called...
+template <int Kind, bool bStackBounded>
+bool VirtualMachine::QuickenedPush(Script hScript,
+                                   AVM_RuntimeValue *pOperandList)
 {
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return false;
+    // Push value onto stack...
+    if(bStackBounded)
+        PushWithinBound(hScript,
+                        *QuickenedOperand<Kind>(hScript, pOperandList[0]));
+    else
+        Push(hScript, *QuickenedOperand<Kind>(hScript, pOperandList[0]));
 
-    // Trigger pause...
-    Scripts[hScript].bPaused = true;
-    Scripts[hScript].unPauseEndTime = GetSystemMilliSeconds() + unDuration;
+    // Never branches...
+    return false;
+}
+
+// Quickened unary operation...
+template <int Operation, int DestinationKind>
+bool VirtualMachine::QuickenedUnary(Script hScript,
+                                    AVM_RuntimeValue *pOperandList)
+{
+    // Variables...
+    AVM_RuntimeValue   *pDestination    = NULL;
+
+    // Resolve destination without inspecting its type...
+    pDestination = QuickenedOperand<DestinationKind>(hScript, pOperandList[0]);
+
+    // Perform unary operation, which the compiler selects statically...
+    switch(Operation)
+    {
+        /* Note: NEG and NOT test the operand's type as it was encoded in the
+                 instruction stream, which for a quickened destination is
+                 never an integer... */
+
+        // Negate...
+        case INSTRUCTION_AVM_NEG:
+            pDestination->fLiteralFloat = -pDestination->fLiteralFloat;
+            break;
+
+        // Not...
+        case INSTRUCTION_AVM_NOT:
+            break;
+
+        // Increment...
+        case INSTRUCTION_AVM_INC:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger++;
+            else
+                pDestination->fLiteralFloat++;
+            break;
+
+        // Decrement...
+        case INSTRUCTION_AVM_DEC:
+            if(pDestination->OperandType == OT_AVM_INTEGER)
+                pDestination->nLiteralInteger--;
+            else
+                pDestination->fLiteralFloat--;
+            break;
+    }
 
-    // Done...
-    return true;
+    // Never branches...
+    return false;
 }
 
-// Pop value off of the stack or throw execution exception...
-inline VirtualMachine::AVM_RuntimeValue VirtualMachine::Pop(Script hScript)
+// Done with the quickened handler helpers...
+#undef QUICKENED_IS_INTEGER
+#undef QUICKENED_AS_INTEGER
+#undef QUICKENED_AS_FLOAT
+#undef QUICKENED_COMPARE
+
+// Register host provided function, replacing any already registered under the
+//  same name and visibility...
+bool VirtualMachine::RegisterHostProvidedFunction(Script hThread,
+    const char *pszName, HostProvidedFunction *pHostProvidedFunction)
 {
     // Variables...
-    AVM_RuntimeValue    PoppedValue;
-    uint32              unNewTopIndex   = 0;
+    AVM_HostProvidedFunction   *pHostFunctionEntry  = NULL;
+    uint32                      unHash              = 0;
+    uint32                      unSlot              = 0;
+    char                       *pszNameCopy         = NULL;
 
-    // Check for stack underflow...
-    if(Scripts[hScript].Stack.nTopIndex <= 0)
-        throw SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+    // Verify parameters...
+    if(!pszName || !pHostProvidedFunction)
+        return false;
 
-    // Decrement top index...
-    Scripts[hScript].Stack.nTopIndex--;
+    // Already registered, replace its entry point...
+    pHostFunctionEntry = FindHostProvidedFunction(hThread, pszName);
+    if(pHostFunctionEntry)
+    {
+        // Replace...
+        pHostFunctionEntry->pEntryPoint = pHostProvidedFunction;
 
-    // Get new top index...
-    unNewTopIndex = Scripts[hScript].Stack.nTopIndex;
+        // Scripts must bind their host functions again...
+        unHostProvidedFunctionGeneration++;
 
-    // Top index + 1 is location of now popped off element...
-    CopyValue(&PoppedValue, Scripts[hScript].Stack.pElements[unNewTopIndex]);
+        // Done...
+        return true;
+    }
 
-    // Return popped off value to caller...
-    return PoppedValue;
-}
+    // Keep the registry no more than three quarters full...
+    if((unHostProvidedFunctionSlotsUsed + 1) * 4 >
+        unHostProvidedFunctionSlots * 3 && !GrowHostProvidedFunctions())
+        return false;
 
-// Push a stack frame onto the stack or throw execution exception...
-inline void VirtualMachine::PushStackFrame(Script hScript, uint32 unSize)
-{
-    // Check for stack overflow...
-    if(Scripts[hScript].Stack.nTopIndex + unSize >=
-       Scripts[hScript].MainHeader.unStackSize - 1)
-        throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    // Copy name...
+    pszNameCopy = (char *) pAllocator->Allocate(strlen(pszName) + 1,
+                                                ALLOCATION_ALIGNMENT,
+                                                UNTAGGED_ALLOCATION);
 
-    // Stack must now accomodate nSize elements for new stack frame...
-    Scripts[hScript].Stack.nTopIndex += unSize;
+        // Failed...
+        if(!pszNameCopy)
+            return false;
+    strcpy(pszNameCopy, pszName);
 
-    // Shift frame index to match to top of the new stack frame...
-    Scripts[hScript].Stack.unCurrentStackFrameTopIndex
-        = Scripts[hScript].Stack.nTopIndex;
-}
+    // Probe for a free or vacated slot...
+    unHash = HashHostProvidedFunction(hThread, pszName);
+    for(unSlot = unHash & (unHostProvidedFunctionSlots - 1);
+        pHostProvidedFunctions[unSlot].bLoaded;
+        unSlot = (unSlot + 1) & (unHostProvidedFunctionSlots - 1));
 
-// Pop stack frame off of the stack or throw execution exception...
-inline void VirtualMachine::PopStackFrame(Script hScript, uint32 unSize)
-{
-    // Stack underflow...
-    if(Scripts[hScript].Stack.nTopIndex - unSize < 0)
-        throw SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+    // Extract...
+    pHostFunctionEntry = &pHostProvidedFunctions[unSlot];
 
-    // Shift stack top down...
-    Scripts[hScript].Stack.nTopIndex -= unSize;
+        // A slot never used before fills the registry further...
+        if(!pHostFunctionEntry->bVacated)
+            unHostProvidedFunctionSlotsUsed++;
 
-    /* Note: We will not modify the stack's frame pointer,
-             unCurrentStackFrameTopIndex, because Call and Ret instructions
-             will manually set it... */
-}
+    // Configure the host provided function...
+    pHostFunctionEntry->bVacated            = false;
+    pHostFunctionEntry->unHash              = unHash;
+    pHostFunctionEntry->hScriptVisibleTo    = hThread;
+    pHostFunctionEntry->pszName             = pszNameCopy;
+    pHostFunctionEntry->pEntryPoint         = pHostProvidedFunction;
 
-// Push value onto the stack or throw execution exception...
-inline void VirtualMachine::Push(Script hScript, AVM_RuntimeValue RuntimeValue)
-{
-    // Variables...
-    int32   nTopIndex   = 0;
+    // Remember that this entry is loaded...
+    pHostFunctionEntry->bLoaded = true;
+    unHostProvidedFunctionCount++;
 
-    // Stack overflow...
-    if(Scripts[hScript].Stack.nTopIndex >=
-       (int32) Scripts[hScript].MainHeader.unStackSize - 1)
-        throw SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW;
+    // Scripts must bind their host functions again...
+    unHostProvidedFunctionGeneration++;
 
-    // Get the current top index...
-    nTopIndex = Scripts[hScript].Stack.nTopIndex;
+    // Done...
+    return true;
+}
 
-    // nTopIndex + 1 is array element of newly added stack element...
-    CopyValue(&Scripts[hScript].Stack.pElements[nTopIndex], RuntimeValue);
+// Drop the reference a value holds to its string, if any, freeing the string if
+//  it was the last...
+void VirtualMachine::ReleaseValue(AVM_RuntimeValue *pValue)
+{
+    // Not a string...
+    if(pValue->OperandType != OT_AVM_STRING)
+        return;
 
-    // Increment top index...
-    Scripts[hScript].Stack.nTopIndex++;
+    // Drop reference...
+    ReleaseString(AVM_LITERAL_STRING(*pValue));
+
+    // Value no longer holds anything...
+    pValue->OperandType = OT_AVM_NULL;
 }
 
-// Register host provided function...
-bool VirtualMachine::RegisterHostProvidedFunction(Script hThread,
-    const char *pszName, HostProvidedFunction *pHostProvidedFunction)
+// Drop a reference to a string, unless a literal, freeing it if it was the
+//  last...
+void VirtualMachine::ReleaseString(char *pszCharacters)
 {
     // Variables...
-    uint32                      unCurrentHostProvidedFunction   = 0;
+    AVM_String *pString = NULL;
 
-    // Find a vacant host function entry in the table...
-    for(unCurrentHostProvidedFunction = 0;
-        unCurrentHostProvidedFunction < MAXIMUM_HOST_PROVIDED_FUNCTIONS;
-        unCurrentHostProvidedFunction++)
-    {
-        // Extract...
-        AVM_HostProvidedFunction &HostFunctionEntry =
-            HostProvidedFunctionTable[unCurrentHostProvidedFunction];
+    // Nothing...
+    if(!pszCharacters)
+        return;
+
+    // Find it...
+    pString = AVM_STRING_OF(pszCharacters);
 
-        // Found vacancy...
-        if(!HostFunctionEntry.bLoaded)
+    // Interned, and so shared by scripts that may be running in parallel, so
+    //  drop the reference and, if that was the last, no longer intern it
+    //  before another script can find it...
+    if(pString->bInterned)
+    {
+        // Drop reference...
+        LockInternedStrings();
+        if(--pString->unReferences)
         {
-            // Verify parameters...
-            if(!pszName || !pHostProvidedFunction ||
-               strlen(pszName) >= sizeof(HostFunctionEntry.szName))
-                return false;
+            UnlockInternedStrings();
+            return;
+        }
 
-            // Clear entry...
-            memset(&HostFunctionEntry, 0, sizeof(AVM_HostProvidedFunction));
+        // Forget it...
+        ForgetInternedString(pString);
+        UnlockInternedStrings();
+    }
 
-            // Configure the host provided function...
-            HostFunctionEntry.hScriptVisibleTo = hThread;
-            strcpy(HostFunctionEntry.szName, pszName);
-            HostFunctionEntry.pEntryPoint      = pHostProvidedFunction;
+    // Otherwise drop reference, unless a literal which is never counted...
+    else if(!pString->unReferences || --pString->unReferences)
+        return;
 
-            // Remember that this entry is loaded...
-            HostFunctionEntry.bLoaded = true;
+    // Free it, back to whichever it came from...
+    if(pString->hOwner == HEAP_STRING_OWNER)
+        pAllocator->Free(pString, AVM_STRING_SIZE(pString->unCapacity),
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+    else
+        ArenaFree(Scripts[pString->hOwner].RuntimeArena, pString);
+}
 
-            // Done...
-            return true;
-        }
-    }
+// Take a script out of the pause heap...
+void VirtualMachine::RemovePausedScript(Script hScript)
+{
+    // Variables...
+    uint32  unSlot  = Scripts[hScript].unPauseHeapSlot - 1;
 
-    // Table is full...
-    return false;
+    // Forget its slot...
+    Scripts[hScript].unPauseHeapSlot = 0;
 
+    // Fill it with the last, unless it was the last, and move that to where
+    //  it is due...
+    if(unSlot != --unPausedScripts)
+    {
+        PauseHeap[unSlot] = PauseHeap[unPausedScripts];
+        SiftPausedScript(unSlot);
+    }
 }
 
 // Reset a script...
@@ -1532,6 +4871,9 @@ boolean VirtualMachine::ResetScript(Script hScript)
         // Initialize instruction pointer...
         Scripts[hScript].InstructionStream.unInstructionPointer =
             Scripts[hScript].pFunctionTable[unMainIndex].unEntryPoint;
+
+        // Main() is getting hotter...
+        CountHotness(hScript, unMainIndex, false);
     }
 
     // Reset stack...
@@ -1540,11 +4882,21 @@ boolean VirtualMachine::ResetScript(Script hScript)
         Scripts[hScript].Stack.nTopIndex                    = 0;
         Scripts[hScript].Stack.unCurrentStackFrameTopIndex  = 0;
 
+        // No host function has parameters formatted in scratch any more...
+        Scripts[hScript].unCoercionScratchUsed              = 0;
+
         // Set entire stack to NULL...
         for(unStackIndex = 0;
             unStackIndex < Scripts[hScript].MainHeader.unStackSize;
             unStackIndex++)
         {
+            // Release any string it held...
+            ReleaseValue(&Scripts[hScript].Stack.pElements[unStackIndex]);
+
+            // Guarded stacks are zeroed, which is NULL, all at once below
+            //  instead, without committing pages never touched...
+            #if !defined(AGNI_GUARDED_STACKS)
+
             // Clear element...
             memset(&Scripts[hScript].Stack.pElements[unStackIndex],
                    '\x0', sizeof(AVM_RuntimeValue));
@@ -1552,11 +4904,27 @@ boolean VirtualMachine::ResetScript(Script hScript)
             // Set operand type to NULL for no apparent reason...
             Scripts[hScript].Stack.pElements[unStackIndex].OperandType
                 = OT_AVM_NULL;
+            #endif
         }
 
+        #if defined(AGNI_GUARDED_STACKS)
+        // Give back the pages touched last run...
+        DecommitGuardedStack(hScript);
+        #endif
+
+    // Release strings held in registers...
+    ReleaseValue(&Scripts[hScript]._RegisterT0);
+    ReleaseValue(&Scripts[hScript]._RegisterT1);
+    ReleaseValue(&Scripts[hScript]._RegisterReturn);
+
+    // Nothing refers to the strings the script made any more, so release them
+    //  in one shot...
+    ArenaRelease(Scripts[hScript].RuntimeArena);
+
     // Reset paused timer...
     Scripts[hScript].bPaused = false;
-    Scripts[hScript].unPauseEndTime = 0;
+    Scripts[hScript].PauseEndTime = 0;
+    ScheduleScript(hScript);
 
     // Allocate space for script's globals...
     PushStackFrame(hScript, Scripts[hScript].MainHeader.unGlobalDataSize);
@@ -1571,102 +4939,107 @@ boolean VirtualMachine::ResetScript(Script hScript)
     return true;
 }
 
+// Resolve a script function's name once to a handle, or INVALID_FUNCTION if
+//  none...
+VirtualMachine::Function VirtualMachine::ResolveFunction(Script hScript,
+                                                         const char *pszName)
+{
+    // Variables...
+    int32 nFunctionIndex = 0;
+
+    // Check handle...
+    if(!IsValidThread(hScript) || !pszName)
+        return INVALID_FUNCTION;
+
+    // Look it up in the export index...
+    nFunctionIndex = GetFunctionIndexByName(hScript, pszName);
+
+        // Not found, or past what a handle can hold...
+        if(nFunctionIndex == -1 ||
+           nFunctionIndex >= (1 << FUNCTION_HANDLE_INDEX_BITS))
+            return INVALID_FUNCTION;
+
+    // Done, tagged with the load it was resolved against...
+    return (Function) ((Scripts[hScript].unLoadSerial <<
+                        FUNCTION_HANDLE_INDEX_BITS) | nFunctionIndex);
+}
+
 // Resolve operand as float or throw error string...
-inline float32 VirtualMachine::ResolveOperandAsFloat(uint8 OperandIndex)
+inline float32 VirtualMachine::ResolveOperandAsFloat(Script hScript,
+                                                     uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Get requested operand's runtime value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Return coerced float value...
     return CoerceValueToFloat(OperandValue);
 }
 
 // Resolve operand as an integer or throw error string...
-inline int32 VirtualMachine::ResolveOperandAsInteger(uint8 OperandIndex)
+inline int32 VirtualMachine::ResolveOperandAsInteger(Script hScript,
+                                                     uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Get requested operand's runtime value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Return coerced integer value...
     return CoerceValueToInteger(OperandValue);
 }
 
-// Resolve operand as string or throw error string...
-inline char *VirtualMachine::ResolveOperandAsString(uint8 OperandIndex)
+// Resolve operand as string, formatting a number into the given coercion
+//  buffer, or throw error string...
+inline char *VirtualMachine::ResolveOperandAsString(Script hScript,
+                                                    uint8 OperandIndex,
+                                                    char *pszBuffer)
 {
     // Variables...
-    AVM_RuntimeValue    OperandValue;
+    AVM_RuntimeValue   *pOperandValue   = NULL;
 
-    // Get requested operand's runtime value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    // Operand lives somewhere, so coerce it in place, as a short string
+    //  lives inline...
+    pOperandValue = ResolveOperandAsPointer(hScript, OperandIndex);
+    if(pOperandValue)
+        return CoerceValueToString(*pOperandValue, pszBuffer);
 
-    // Return coerced string...
-    return CoerceValueToString(OperandValue);
+    // Otherwise it is a literal, which is never short...
+    return CoerceValueToString(ResolveOperandValue(hScript, OperandIndex),
+                               pszBuffer);
 }
 
 // Resolve an operand's stack index, whether absolute or relative or throw
 //  error string...
-inline int32 VirtualMachine::ResolveOperandStackIndex(uint8 OperandIndex)
+inline int32 VirtualMachine::ResolveOperandStackIndex(Script hScript,
+                                                      uint8 OperandIndex)
 {
     // Variables...
     uint32              unCurrentInstruction    = 0;
-    AVM_RuntimeValue    OperandValue;
-    int32               nBaseIndex              = 0;
-    int32               nOffsetIndex            = 0;
-    AVM_RuntimeValue    StackValue;
 
     // Get the current instruction's index...
-    unCurrentInstruction = Scripts[hCurrentThread].InstructionStream.
+    unCurrentInstruction = Scripts[hScript].InstructionStream.
                             unInstructionPointer;
 
-    // Get requested operand's runtime value...
-    OperandValue = Scripts[hCurrentThread].InstructionStream.
-                pInstructions[unCurrentInstruction].pOperandList[OperandIndex];
-
-    // Resolve stack index based on the type...
-    switch(OperandValue.OperandType)
-    {
-        // Already an absolute stack index, needn't be resolved further...
-        case OT_AVM_INDEX_STACK_ABSOLUTE:
-            return OperandValue.nStackIndex[0];
-
-        // Relative stack index, resolve...
-        case OT_AVM_INDEX_STACK_RELATIVE:
-        {
-            // Fetch base index...
-            nBaseIndex = OperandValue.nStackIndex[0];
-
-            // Fetch offset index...
-            nOffsetIndex = OperandValue.nStackIndex[1];
-
-            // Get variable's value...
-            StackValue = GetStackValue(hCurrentThread, nOffsetIndex);
-
-            // Variables integer field + base index is absolute index...
-            return nBaseIndex + StackValue.nLiteralInteger;
-        }
-
-        // Zero for everything else, but this should not happen...
-        default:
-            throw "cannot resolve stack index on non-stack index operand";
-    }
+    // Resolve requested operand's stack index...
+    return ResolveStackIndexOf(hScript,
+        Scripts[hScript].InstructionStream.
+            pInstructions[unCurrentInstruction].pOperandList[OperandIndex]);
 }
 
 // Resolves final type of operand and returns the resolved type or throw error
 //  string...
-inline uint8 VirtualMachine::ResolveOperandType(uint8 OperandIndex)
+inline uint8 VirtualMachine::ResolveOperandType(Script hScript,
+                                                uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Fetch operand...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Return the runtime value's type to caller...
     return OperandValue.OperandType;
@@ -1674,137 +5047,59 @@ inline uint8 VirtualMachine::ResolveOperandType(uint8 OperandIndex)
 
 // Resolve operand's value or throw error string...
 inline VirtualMachine::AVM_RuntimeValue 
-    VirtualMachine::ResolveOperandValue(uint8 OperandIndex)
+    VirtualMachine::ResolveOperandValue(Script hScript, uint8 OperandIndex)
 {
     // Variables...
     uint32              unCurrentInstruction    = 0;
-    AVM_RuntimeValue    OperandValue;
-    int32               nAbsoluteStackIndex     = 0;
 
     // Get the current instruction's index...
-    unCurrentInstruction = Scripts[hCurrentThread].InstructionStream.
+    unCurrentInstruction = Scripts[hScript].InstructionStream.
                             unInstructionPointer;
 
-    // Get requested operand's runtime value...
-    OperandValue = Scripts[hCurrentThread].InstructionStream.
-                pInstructions[unCurrentInstruction].pOperandList[OperandIndex];
-
-    // What are we to return?
-    switch(OperandValue.OperandType)
-    {
-        // Stack index, resolve...
-        case OT_AVM_INDEX_STACK_ABSOLUTE:
-        case OT_AVM_INDEX_STACK_RELATIVE:
-        {
-            // Calculate absolute stack index...
-            nAbsoluteStackIndex = ResolveOperandStackIndex(OperandIndex);
-
-            // Return it...
-            return GetStackValue(hCurrentThread, nAbsoluteStackIndex);
-        }
-        
-        // Stack index via register, resolve...
-        case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
-        {
-            // Calculate absolute stack index for given register...
-            switch(OperandValue.Register)
-            {
-                // First general purpose register...
-                case REGISTER_AVM_T0:
-                    
-                    // Get stack index at Stack[_RegisterT0]...
-                    nAbsoluteStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterT0);
-                    
-                    // Done...
-                    break;
-                
-                // Second general purpose register...
-                case REGISTER_AVM_T1:
-                    
-                    // Get stack index at Stack[_RegisterT1]...
-                    nAbsoluteStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterT1);
-                    
-                    // Done...
-                    break;
-
-                // Return value...
-                case REGISTER_AVM_RETURN:
-
-                    // Get stack index at Stack[_RegisterReturn]...
-                    nAbsoluteStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterReturn);
-                    
-                    // Done...
-                    break;
-            }
-            
-            // Return it...
-            return GetStackValue(hCurrentThread, nAbsoluteStackIndex);
-        }
-
-        // Register...
-        case OT_AVM_REGISTER:
-        {
-            // Which one?
-            switch(OperandValue.Register)
-            {
-                // First general purpose register...
-                case REGISTER_AVM_T0:
-                    return Scripts[hCurrentThread]._RegisterT0;
-                
-                // Second general purpose register...
-                case REGISTER_AVM_T1:
-                    return Scripts[hCurrentThread]._RegisterT1;
-
-                // Return value...
-                case REGISTER_AVM_RETURN:
-                    return Scripts[hCurrentThread]._RegisterReturn;
-            }
-        }
-
-        // Everything else is fine as is...
-        default:
-            return OperandValue;
-    }
+    // Resolve requested operand's runtime value...
+    return ResolveValueOf(hScript,
+        Scripts[hScript].InstructionStream.
+            pInstructions[unCurrentInstruction].pOperandList[OperandIndex]);
 }
 
 // Resolve operand as an instruction index or throw error string...
 inline int32 
-    VirtualMachine::ResolveOperandAsInstructionIndex(uint8 OperandIndex)
+    VirtualMachine::ResolveOperandAsInstructionIndex(Script hScript,
+                                                     uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Resolve operand value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Resolve operand value as an instruction index...
     return OperandValue.nInstructionIndex;
 }
 
 // Resolve operand as a function index or throw error string...
-inline int32 VirtualMachine::ResolveOperandAsFunctionIndex(uint8 OperandIndex)
+inline int32 VirtualMachine::ResolveOperandAsFunctionIndex(Script hScript,
+                                                           uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Resolve operand value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Resolve operand value as a function index...
     return OperandValue.nFunctionIndex;
 }
 
 // Resolve operand as a host function index or throw error string...
-int32 VirtualMachine::ResolveOperandAsHostFunctionIndex(uint8 OperandIndex)
+int32 VirtualMachine::ResolveOperandAsHostFunctionIndex(Script hScript,
+                                                        uint8 OperandIndex)
 {
     // Variables...
     AVM_RuntimeValue    OperandValue;
 
     // Resolve operand value...
-    OperandValue = ResolveOperandValue(OperandIndex);
+    OperandValue = ResolveOperandValue(hScript, OperandIndex);
 
     // Return host name...
     return OperandValue.nHostFunctionIndex;
@@ -1813,100 +5108,185 @@ int32 VirtualMachine::ResolveOperandAsHostFunctionIndex(uint8 OperandIndex)
 // Resolves operand and returns a pointer to it's runtime value or NULL if not
 // applicable...
 inline VirtualMachine::AVM_RuntimeValue *
-    VirtualMachine::ResolveOperandAsPointer(uint8 OperandIndex)
+    VirtualMachine::ResolveOperandAsPointer(Script hScript, uint8 OperandIndex)
 {
     // Variables...
     uint32              unCurrentInstruction    = 0;
+
+    // Get the current instruction's index...
+    unCurrentInstruction = Scripts[hScript].InstructionStream.
+                            unInstructionPointer;
+
+    // Return a pointer to wherever the operand is...
+    return ResolvePointerTo(hScript,
+        Scripts[hScript].InstructionStream.
+            pInstructions[unCurrentInstruction].pOperandList[OperandIndex]);
+}
+
+// Resolve a given operand to a pointer to its runtime value for a script, or
+//  NULL if not applicable...
+inline VirtualMachine::AVM_RuntimeValue *
+    VirtualMachine::ResolvePointerTo(Script hScript,
+                                     const AVM_RuntimeValue &Operand)
+{
+    // Variables...
     int32               nStackIndex             = 0;
+    AVM_RuntimeValue   *pRegister               = NULL;
 
     // Return a pointer to wherever the operand is...
-    switch(GetOperandType(OperandIndex))
+    switch(Operand.OperandType)
     {
         // Operand is on the stack...
         case OT_AVM_INDEX_STACK_ABSOLUTE:
         case OT_AVM_INDEX_STACK_RELATIVE:
         {
             // Fetch stack index...
-            nStackIndex = ResolveOperandStackIndex(OperandIndex);
+            nStackIndex = ResolveStackIndexOf(hScript, Operand);
 
             // Return location...
-            return &Scripts[hCurrentThread].Stack.
-                pElements[ResolveStackIndex(hCurrentThread, nStackIndex)];
+            return &Scripts[hScript].Stack.
+                pElements[ResolveStackIndex(hScript, nStackIndex)];
+        }
+
+        // Stack index via register, resolve...
+        case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
+        {
+            // Get stack index at Stack[Register], if register is known...
+            pRegister = ResolveRegister(hScript, Operand.Register);
+            if(pRegister)
+                nStackIndex = CoerceValueToInteger(*pRegister);
+
+            // Return location...
+            return &Scripts[hScript].Stack.
+                pElements[ResolveStackIndex(hScript, nStackIndex)];
+        }
+
+        // Register...
+        case OT_AVM_REGISTER:
+            return ResolveRegister(hScript, Operand.Register);
+
+        // Anything else is inlined in the instruction stream...
+        default:
+            return NULL;
+    }
+}
+
+// Get a pointer to one of a script's registers or NULL...
+inline VirtualMachine::AVM_RuntimeValue *
+    VirtualMachine::ResolveRegister(Script hScript, uint8 Register)
+{
+    // Which register do we want the address of?
+    switch(Register)
+    {
+        // First general purpose register value...
+        case REGISTER_AVM_T0:
+            return &Scripts[hScript]._RegisterT0;
+
+        // Second general purpose register value...
+        case REGISTER_AVM_T1:
+            return &Scripts[hScript]._RegisterT1;
+
+        // Return value...
+        case REGISTER_AVM_RETURN:
+            return &Scripts[hScript]._RegisterReturn;
+
+        // Unknown...
+        default:
+            return NULL;
+    }
+}
+
+// Resolve a given operand's stack index for a script, whether absolute or
+//  relative, or throw error string...
+inline int32 VirtualMachine::ResolveStackIndexOf(Script hScript,
+                                                 const AVM_RuntimeValue &Operand)
+{
+    // Variables...
+    int32               nBaseIndex              = 0;
+    int32               nOffsetIndex            = 0;
+    AVM_RuntimeValue    StackValue;
+
+    // Resolve stack index based on the type...
+    switch(Operand.OperandType)
+    {
+        // Already an absolute stack index, needn't be resolved further...
+        case OT_AVM_INDEX_STACK_ABSOLUTE:
+            return Operand.nStackIndex[0];
+
+        // Relative stack index, resolve...
+        case OT_AVM_INDEX_STACK_RELATIVE:
+        {
+            // Fetch base index...
+            nBaseIndex = Operand.nStackIndex[0];
+
+            // Fetch offset index...
+            nOffsetIndex = AVM_STACK_OFFSET(Operand);
+
+            // Get variable's value...
+            StackValue = GetStackValue(hScript, nOffsetIndex);
+
+            // Variables integer field + base index is absolute index...
+            return nBaseIndex + StackValue.nLiteralInteger;
+        }
+
+        // Zero for everything else, but this should not happen...
+        default:
+            throw "cannot resolve stack index on non-stack index operand";
+    }
+}
+
+// Resolve a given operand's value for a script or throw error string...
+inline VirtualMachine::AVM_RuntimeValue
+    VirtualMachine::ResolveValueOf(Script hScript,
+                                   const AVM_RuntimeValue &Operand)
+{
+    // Variables...
+    int32               nAbsoluteStackIndex     = 0;
+    AVM_RuntimeValue   *pRegister               = NULL;
+
+    // What are we to return?
+    switch(Operand.OperandType)
+    {
+        // Stack index, resolve...
+        case OT_AVM_INDEX_STACK_ABSOLUTE:
+        case OT_AVM_INDEX_STACK_RELATIVE:
+        {
+            // Calculate absolute stack index...
+            nAbsoluteStackIndex = ResolveStackIndexOf(hScript, Operand);
+
+            // Return it...
+            return GetStackValue(hScript, nAbsoluteStackIndex);
         }
 
         // Stack index via register, resolve...
         case OT_AVM_INDEX_STACK_ABSOLUTE_VIA_REGISTER:
         {
-            // Calculate absolute stack index for given register...
-            switch(Scripts[hCurrentThread].InstructionStream.
-                    pInstructions[unCurrentInstruction].
-                    pOperandList[OperandIndex].Register)
-            {
-                // First general purpose register...
-                case REGISTER_AVM_T0:
-                
-                    // Get stack index at Stack[_RegisterT0]...
-                    nStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterT0);
-
-                    // Done...
-                    break;
-                
-                // Second general purpose register...
-                case REGISTER_AVM_T1:
-
-                    // Get stack index at Stack[_RegisterT1]...
-                    nStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterT1);
-
-                    // Done...
-                    break;
+            // Get stack index at Stack[Register], if register is known...
+            pRegister = ResolveRegister(hScript, Operand.Register);
+            if(pRegister)
+                nAbsoluteStackIndex = CoerceValueToInteger(*pRegister);
 
-                // Return value...
-                case REGISTER_AVM_RETURN:
-
-                    // Get stack index at Stack[_RegisterReturn]...
-                    nStackIndex = CoerceValueToInteger(
-                        Scripts[hCurrentThread]._RegisterReturn);
-
-                    // Done...
-                    break;
-            }
-            
-            // Return location...
-            return &Scripts[hCurrentThread].Stack.
-                pElements[ResolveStackIndex(hCurrentThread, nStackIndex)];
+            // Return it...
+            return GetStackValue(hScript, nAbsoluteStackIndex);
         }
 
         // Register...
         case OT_AVM_REGISTER:
         {
-            // Fetch the current instruction...
-            unCurrentInstruction = Scripts[hCurrentThread].InstructionStream.
-                                unInstructionPointer;
+            // Get the register...
+            pRegister = ResolveRegister(hScript, Operand.Register);
 
-            // Which register do we want the address of?
-            switch(Scripts[hCurrentThread].InstructionStream.
-                    pInstructions[unCurrentInstruction].
-                    pOperandList[OperandIndex].Register)
-            {
-                // First general purpose register value...
-                case REGISTER_AVM_T0:
-                    return &Scripts[hCurrentThread]._RegisterT0;
-                
-                // Second general purpose register value...
-                case REGISTER_AVM_T1:
-                    return &Scripts[hCurrentThread]._RegisterT1;
-                
-                // Return value...
-                case REGISTER_AVM_RETURN:
-                    return &Scripts[hCurrentThread]._RegisterReturn;
-            }
+            // Return its value, if it was a known register...
+            if(pRegister)
+                return *pRegister;
+
+            // Otherwise fine as is...
+            return Operand;
         }
 
-        // Anything else is inlined in the instruction stream...
+        // Everything else is fine as is...
         default:
-            return NULL;
+            return Operand;
     }
 }
 
@@ -1925,6 +5305,7 @@ void VirtualMachine::ReturnIntegerFromHost(Script hScript, uint8 unParameters,
     Scripts[hScript].Stack.nTopIndex -= unParameters;
 
     // Store the return value in the return value register...
+    ReleaseValue(&Scripts[hScript]._RegisterReturn);
     Scripts[hScript]._RegisterReturn.OperandType        = OT_AVM_INTEGER;
     Scripts[hScript]._RegisterReturn.nLiteralInteger    = nReturnValue;
 }
@@ -1937,6 +5318,7 @@ void VirtualMachine::ReturnFloatFromHost(Script hScript, uint8 unParameters,
     Scripts[hScript].Stack.nTopIndex -= unParameters;
 
     // Store the return value in the return value register...
+    ReleaseValue(&Scripts[hScript]._RegisterReturn);
     Scripts[hScript]._RegisterReturn.OperandType    = OT_AVM_FLOAT;
     Scripts[hScript]._RegisterReturn.fLiteralFloat  = fReturnValue;
 }
@@ -1946,118 +5328,320 @@ void VirtualMachine::ReturnStringFromHost(Script hScript, uint8 unParameters,
                                           char *pszReturnValue)
 {
     // Variables...
-    AVM_RuntimeValue    ReturnValue;
+    uint32  unLength    = strlen(pszReturnValue);
+    char   *pszInterned = NULL;
 
     // Clear off the parameters that were originally pushed onto the stack...
     Scripts[hScript].Stack.nTopIndex -= unParameters;
 
-    // Prepare to store the return value...
-    ReturnValue.OperandType         = OT_AVM_STRING;
-    ReturnValue.pszLiteralString    = pszReturnValue;
+    // Interning strings, and too long to live inline, so share the interned
+    //  copy of the return value...
+    if(bInternStrings && unLength >= SHORT_STRING_SIZE)
+    {
+        // Intern...
+        LockInternedStrings();
+        pszInterned = InternString(pszReturnValue, unLength);
+        UnlockInternedStrings();
+
+            // Failed...
+            if(!pszInterned)
+                throw "memory allocation failed";
+
+        // Store in the return register...
+        ReleaseValue(&Scripts[hScript]._RegisterReturn);
+        Scripts[hScript]._RegisterReturn.OperandType        = OT_AVM_STRING;
+        AVM_SET_LITERAL_STRING(Scripts[hScript]._RegisterReturn, pszInterned);
+
+        // Done...
+        return;
+    }
+
+    // Otherwise store a copy of the return value in the return register...
+    StoreString(hScript, &Scripts[hScript]._RegisterReturn, pszReturnValue,
+                unLength);
+}
+
+// Return from the current script function and return true if the stack base
+//  was reached or throw error string...
+bool VirtualMachine::ReturnFromFunction(Script hScript)
+{
+    // Variables...
+    AVM_RuntimeValue    CurrentFunctionIndex;
+    Agni_Function       CurrentFunction;
+    uint32              unFrameIndex            = 0;
+    AVM_RuntimeValue    ReturnAddress;
+    bool                bStackBase              = false;
+
+    // Gather some information on returning function...
+
+        // Function index is in the top of the stack...
+        CurrentFunctionIndex = Pop(hScript);
+
+        // Bottom of stack found, so script should terminate...
+        if(CurrentFunctionIndex.OperandType == OT_AVM_STACK_BASE_MARKER)
+            bStackBase = true;
 
-    // Store the return value safely back into the return register...
-    CopyValue(&Scripts[hScript]._RegisterReturn, ReturnValue);
+        // Extract frame index from function structure...
+        CurrentFunction =
+            GetFunction(hScript, CurrentFunctionIndex.nFunctionIndex);
+        unFrameIndex = AVM_STACK_OFFSET(CurrentFunctionIndex);
+
+    // Extract the return address which is the next element under the local
+    //  data...
+    ReturnAddress =
+        GetStackValue(hScript, Scripts[hScript].Stack.nTopIndex -
+                                (CurrentFunction.unLocalDataSize + 1));
+
+    // Remove the stack frame of the returning function...
+    PopStackFrame(hScript, CurrentFunction.unStackFrameSize);
+
+    // Restore the previous stack frame's index...
+    Scripts[hScript].Stack.unCurrentStackFrameTopIndex = unFrameIndex;
+
+    // Finally jump to the return address...
+    Scripts[hScript].InstructionStream.unInstructionPointer
+        = ReturnAddress.nInstructionIndex;
+
+    // Let caller know whether the stack base was reached...
+    return bStackBase;
 }
 
 // Run scripts for specified milliseconds, or 0 until all return...
 boolean VirtualMachine::RunScripts(uint32 unDuration)
+{
+    // Run them on the host's thread...
+    return RunWorker(MainWorker, unDuration);
+}
+
+// Run scripts on a worker for specified milliseconds, or 0 until all return...
+boolean VirtualMachine::RunWorker(AVM_Worker &Worker, uint32 unDuration)
 {
     // Variables...
+    Script             &hCurrentThread                      =
+                            Worker.hCurrentThread;
     bool                bBreakExecution                     = false;
     uint32              unMainTimeSliceStartTime            = 0;
     uint32              unCurrentTime                       = 0;
-    bool                bStillRunningSomething              = false;
-    Script              hTempCurrentThread                  = 0;
     uint32              unCurrentInstructionPointer         = 0;
     uint16              usOperationCode                     = 0;
     AVM_RuntimeValue    DestinationOperand;
     AVM_RuntimeValue    SourceOperand;
     uint8               DestinationType                     = 0x00;
     char               *pszSource                           = NULL;
-    char               *pszNew                              = NULL;
+    char                szCoercion[MAXIMUM_COERCION_LENGTH + 1];
+    char                Character                           = '\x0';
     uint32              unTargetIndex                       = 0;
     AVM_RuntimeValue    Operand0;
     AVM_RuntimeValue    Operand1;
     bool                bJump                               = false;
+    bool                bBranched                           = false;
+    bool                bStackBase                          = false;
     uint32              unFunctionIndex                     = 0;
-    AVM_RuntimeValue    CurrentFunctionIndex;
-    Agni_Function       CurrentFunction;
-    uint32              unFrameIndex                        = 0;
-    AVM_RuntimeValue    ReturnAddress;
-    char               *pszHostFunction                     = NULL;
     AVM_RuntimeValue    HostFunctionIndex;
-    uint32              unCurrentHostProvidedFunctionIndex  = 0;
-    uint32              unPauseDuration                          = 0;
 
     // Get the current time the main timeslice started...
-    unMainTimeSliceStartTime = GetSystemMilliSeconds();
+    unMainTimeSliceStartTime    = GetSystemMilliSeconds();
+    unCurrentTime               = unMainTimeSliceStartTime;
+
+    // Time spent outside of here was the host's, so calibrate only from now...
+    Worker.unClockWindowIterations  = 0;
+    Worker.unClockWindowStartTime   = unCurrentTime;
 
     // Enter instruction execution loop... (break conditions are nested)
     while(true)
     {
-        // If all threads have terminated, then execution needn't continue...
-        for(bStillRunningSomething = false, hTempCurrentThread = 0;
-            hTempCurrentThread < MAXIMUM_THREADS;
-            hTempCurrentThread++)
+        // If all threads have terminated, then execution needn't continue.
+        //  Workers running in parallel find out as they switch threads...
+        if(!bParallel && RunQueue.unSize == 0 && unPausedScripts == 0)
+            break;
+
+        // Remember the current time, read only once each quantum of
+        //  iterations rather than every instruction. Threaded and native code
+        //  return here only at backward branches, calls, and the like...
+        if(--Worker.unClockCountdown == 0)
         {
-            // This thread contains a loaded script that is running...
-            if(Scripts[hTempCurrentThread].bLoaded &&
-               Scripts[hTempCurrentThread].bExecuting)
-                bStillRunningSomething = true;
+            unCurrentTime = GetSystemMilliSeconds();
+            CalibrateClockQuantum(Worker, unCurrentTime);
         }
 
-            // Nothing still running, so stop execution...
-            if(!bStillRunningSomething)
-                break;
-
-        // Remember the current time...
-        unCurrentTime = GetSystemMilliSeconds();
-
         // Machine is configured for multithreading, perform context switch...
-        if(CurrentThreadingMode == THREADING_MODE_MULTIPLE)
+        if(Worker.ThreadingMode == THREADING_MODE_MULTIPLE)
         {
-            // Current thread's time slice has either full elapsed or terminated,
-            //  switch to the next valid thread...
-            if((unCurrentTime > unCurrentThreadActivationTime +
-                                Scripts[hCurrentThread].unThreadTimeSlice) ||
-               !Scripts[hCurrentThread].bExecuting)
+            // Current thread's time slice has either full elapsed or it can no
+            //  longer run, switch to the next runnable thread...
+            if(Scripts[hCurrentThread].pQueue != &RunQueue ||
+               (unCurrentTime > Worker.unCurrentThreadActivationTime +
+                                Scripts[hCurrentThread].unThreadTimeSlice))
             {
-                // Find the next thread... (there must be at least one)
-                while(true)
-                {
-                    // Seek to next thread...
-                    hCurrentThread++;
+                // Paused threads whose time is up can take their turns...
+                if(unPausedScripts > 0)
+                    WakePausedScripts(GetSystemMicroSeconds());
 
-                        // Reached the end, loop back to the beginning...
-                        if(hCurrentThread >= MAXIMUM_THREADS)
-                            hCurrentThread = 0;
-
-                    // Check thread to see if anything is loaded and executing...
-                    if(Scripts[hCurrentThread].bLoaded &&
-                       Scripts[hCurrentThread].bExecuting)
+                // Nothing is runnable, so sleep until the first paused thread
+                //  is due, unless the main timeslice ends first...
+                if(RunQueue.unSize == 0)
+                {
+                    // Sleep...
+                    if(IdleUntil(Worker, Scripts[PauseHeap[0]].PauseEndTime,
+                                 unMainTimeSliceStartTime, unDuration,
+                                 unCurrentTime))
                         break;
+
+                    // Try again...
+                    continue;
                 }
 
+                // Pass the head on from the current thread, if it still holds
+                //  it, which leaves the next one in turn there...
+                if(hCurrentThread == RunQueue.hHead &&
+                   Scripts[hCurrentThread].pQueue == &RunQueue)
+                    RunQueue.hHead = Scripts[hCurrentThread].hNextQueued;
+
+                // Switch to it...
+                hCurrentThread = RunQueue.hHead;
+
                 // This thread takes over beginning now...
-                unCurrentThreadActivationTime = GetSystemMilliSeconds();
+                Worker.unCurrentThreadActivationTime = unCurrentTime;
+            }
+        }
+
+        #if defined(AGNI_WORKER_THREADS)
+        // Running in parallel, so hand back the current thread once its time
+        //  slice has elapsed or it can no longer run, or another worker asked
+        //  the rest to stop, and hold the next runnable one...
+        else if(Worker.ThreadingMode == THREADING_MODE_PARALLEL)
+        {
+            // Switch...
+            if(!Worker.bHolding || !Scripts[hCurrentThread].bExecuting ||
+               Scripts[hCurrentThread].bPaused ||
+               (unCurrentTime > Worker.unCurrentThreadActivationTime +
+                                Scripts[hCurrentThread].unThreadTimeSlice) ||
+               AGNI_ATOMIC_LOAD(&StopWorkers))
+            {
+                // Stop if told to, or the main timeslice ends first...
+                if(SwitchWorkerScript(Worker, unMainTimeSliceStartTime,
+                                      unDuration, unCurrentTime))
+                    break;
             }
         }
+        #endif
 
-        // Is the script paused?...
-        if(Scripts[hCurrentThread].bPaused)
+        // Otherwise only the current thread runs, is it paused?...
+        else if(Scripts[hCurrentThread].bPaused)
         {
             // If the pause time has elapsed, then unpause script...
-            if(unCurrentTime >= Scripts[hCurrentThread].unPauseEndTime)
+            if(GetSystemMicroSeconds() >= Scripts[hCurrentThread].PauseEndTime)
+            {
                 Scripts[hCurrentThread].bPaused = false;
+                ScheduleScript(hCurrentThread);
+            }
 
-            // Otherwise, let the thread idle for this execution cycle...
+            // Otherwise, sleep until it is, unless the main timeslice ends
+            //  first...
             else
+            {
+                // Sleep...
+                if(IdleUntil(Worker, Scripts[hCurrentThread].PauseEndTime,
+                             unMainTimeSliceStartTime, unDuration,
+                             unCurrentTime))
+                    break;
+
+                // Try again...
+                continue;
+            }
+        }
+
+        // Precompiled scripts run their body up to its next safe point,
+        //  leaving what it could not translate to the switch below...
+        if(Scripts[hCurrentThread].pPrecompiledBody)
+        {
+            // Variables...
+            PrecompiledContext  Context(*this, hCurrentThread);
+            PrecompiledStatus   Result = Precompiled_SafePoint;
+
+            // Run...
+            Result = Scripts[hCurrentThread].pPrecompiledBody(Context);
+
+            // Terminate script if bottom of stack was found...
+            if(Result == Precompiled_StackBase)
+                break;
+
+            // Safe point reached...
+            if(Result == Precompiled_SafePoint)
+            {
+                // We are not running indefinetely...
+                if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+                {
+                    // Check if main timeslice has expired...
+                    if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+                        break;
+                }
+
+                // Reschedule...
+                continue;
+            }
+        }
+
+        // Native engine runs the thread's native code up to its next safe
+        //  point, leaving what it could not compile to the switch below...
+        #if defined(AGNI_NATIVE_CODE)
+        else if(Engine == Dispatch_Native &&
+                Scripts[hCurrentThread].pNativeCode)
+        {
+            // Current instruction was compiled...
+            if(Scripts[hCurrentThread].ppNativeEntry[
+                Scripts[hCurrentThread].InstructionStream.unInstructionPointer])
+            {
+                // Run, and terminate script if bottom of stack was found...
+                if(ExecuteNativeCode(hCurrentThread))
+                    break;
+
+                // We are not running indefinetely...
+                if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+                {
+                    // Check if main timeslice has expired...
+                    if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+                        break;
+                }
+
+                // Reschedule...
                 continue;
+            }
+        }
+        #endif
+
+        // Threaded engines run the thread in bursts up to its next safe
+        //  point, in register code if the script was translated to it, as
+        //  does the native engine where nothing was compiled...
+        else if(Engine != Dispatch_Switch)
+        {
+            // Run...
+            if(Engine == Dispatch_Register &&
+               Scripts[hCurrentThread].pRegisterCode)
+                bStackBase = ExecuteThreadedCode<true>(hCurrentThread);
+            else
+                bStackBase = ExecuteThreadedCode<false>(hCurrentThread);
+
+            // Terminate script if bottom of stack was found...
+            if(bStackBase)
+                break;
+
+            // We are not running indefinetely...
+            if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+            {
+                // Check if main timeslice has expired...
+                if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+                    break;
+            }
+
+            // Reschedule...
+            continue;
         }
 
         // Remember the current instruction pointer to compare with later...
         unCurrentInstructionPointer = Scripts[hCurrentThread].InstructionStream.
                                         unInstructionPointer;
+        bBranched                   = false;
 
         // Extract the current operation code...
         usOperationCode = Scripts[hCurrentThread].InstructionStream.
@@ -2083,8 +5667,8 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_SHR:
             {
                 // Extract destination and source operand...
-                DestinationOperand  = ResolveOperandValue(0);
-                SourceOperand       = ResolveOperandValue(1);
+                DestinationOperand  = ResolveOperandValue(hCurrentThread, 0);
+                SourceOperand       = ResolveOperandValue(hCurrentThread, 1);
 
                 // Perform binary operation...
                 switch(usOperationCode)
@@ -2093,7 +5677,8 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                     case INSTRUCTION_AVM_MOV:
                     {
                         // Source and destination same, so nothing to move...
-                        if(ResolveOperandAsPointer(0) == ResolveOperandAsPointer(1))
+                        if(ResolveOperandAsPointer(hCurrentThread, 0) ==
+                           ResolveOperandAsPointer(hCurrentThread, 1))
                             break;
 
                         // Copy the source operand into the destination...
@@ -2109,12 +5694,12 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Is destination an integer?
                         if(SourceOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger +=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Assume, then, that it is a float...
                         else
                             DestinationOperand.fLiteralFloat +=
-                            ResolveOperandAsFloat(1);
+                            ResolveOperandAsFloat(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2126,12 +5711,12 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Is destination an integer?
                         if(SourceOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger -=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Assume, then, that it is a float...
                         else
                             DestinationOperand.fLiteralFloat -=
-                            ResolveOperandAsFloat(1);
+                            ResolveOperandAsFloat(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2143,12 +5728,12 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Is destination an integer?
                         if(SourceOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger *=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Assume, then, that it is a float...
                         else
                             DestinationOperand.fLiteralFloat *=
-                            ResolveOperandAsFloat(1);
+                            ResolveOperandAsFloat(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2160,12 +5745,12 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Is destination an integer?
                         if(SourceOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger /=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Assume, then, that it is a float...
                         else
                             DestinationOperand.fLiteralFloat /=
-                            ResolveOperandAsFloat(1);
+                            ResolveOperandAsFloat(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2176,7 +5761,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                     {
                         // Modulus defined only for integral values...
                         DestinationOperand.nLiteralInteger %=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2191,7 +5776,8 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                             // Compute...
                             DestinationOperand.nLiteralInteger =
                                 (int) pow(DestinationOperand.nLiteralInteger,
-                                        ResolveOperandAsInteger(1));
+                                        ResolveOperandAsInteger(hCurrentThread,
+                                                                1));
                         }
 
                         // Assume, then, that it is a float...
@@ -2200,7 +5786,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                             // Compute...
                             DestinationOperand.fLiteralFloat =
                                 (float) pow(DestinationOperand.fLiteralFloat,
-                                    ResolveOperandAsFloat(1));
+                                    ResolveOperandAsFloat(hCurrentThread, 1));
                         }
 
                         // Done...
@@ -2213,7 +5799,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Only defined for integral values...
                         if(DestinationOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger &=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2225,7 +5811,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Only defined for integral values...
                         if(DestinationOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger |=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2237,7 +5823,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Only defined for integral values...
                         if(DestinationOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger ^=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2249,7 +5835,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Only defined for integral values...
                         if(DestinationOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger <<=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2261,7 +5847,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                         // Only defined for integral values...
                         if(DestinationOperand.OperandType == OT_AVM_INTEGER)
                             DestinationOperand.nLiteralInteger >>=
-                            ResolveOperandAsInteger(1);
+                            ResolveOperandAsInteger(hCurrentThread, 1);
 
                         // Done...
                         break;
@@ -2269,7 +5855,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                 }
 
                 // Now store the result...
-               *ResolveOperandAsPointer(0) = DestinationOperand;
+               *ResolveOperandAsPointer(hCurrentThread, 0) = DestinationOperand;
 
                 // Done performing binary operation...
                 break;
@@ -2282,10 +5868,10 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_DEC:
             {
                 // Remember the destination operand type...
-                DestinationType = GetOperandType(0);
+                DestinationType = GetOperandType(hCurrentThread, 0);
 
                 // Extract the destination value...
-                DestinationOperand = ResolveOperandValue(0);
+                DestinationOperand = ResolveOperandValue(hCurrentThread, 0);
 
                 // Implement unary operators...
                 switch(usOperationCode)
@@ -2351,7 +5937,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                 }
 
                 // Store result of unary operation...
-               *ResolveOperandAsPointer(0) = DestinationOperand;
+               *ResolveOperandAsPointer(hCurrentThread, 0) = DestinationOperand;
 
                 // Done with unary operation...
                 break;
@@ -2361,30 +5947,22 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_CONCAT:
             {
                 // Extract destination operand...
-                DestinationOperand = ResolveOperandValue(0);
+                DestinationOperand = ResolveOperandValue(hCurrentThread, 0);
 
                     // Destination is not a string, ignore it...
-                    if(DestinationOperand.OperandType != OT_AVM_STRING)
+                    if(!AVM_IS_STRING(DestinationOperand))
                         break;
 
                 // Extract a pointer to the source string....
-                pszSource = ResolveOperandAsString(1);
-
-                // Allocate storage space for the new string...
-                pszNew = (char *)
-                    malloc(strlen(DestinationOperand.pszLiteralString) +
-                           strlen(pszSource) + 1);
+                pszSource = ResolveOperandAsString(hCurrentThread, 1,
+                                                   szCoercion);
 
-                // Build new string...
-                strcpy(pszNew, DestinationOperand.pszLiteralString);
-                strcat(pszNew, pszSource);
-
-                // Replace old string with new one...
-                free(DestinationOperand.pszLiteralString);
-                DestinationOperand.pszLiteralString = pszNew;
+                // Append it...
+                ConcatenateString(hCurrentThread, &DestinationOperand,
+                                  pszSource);
 
                 // Shove the final value back into the instruction stream...
-               *ResolveOperandAsPointer(0) = DestinationOperand;
+               *ResolveOperandAsPointer(hCurrentThread, 0) = DestinationOperand;
 
                 // Done...
                 break;
@@ -2394,44 +5972,20 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_GETCHAR:
             {
                 // Extract destination operand...
-                DestinationOperand = ResolveOperandValue(0);
-
-                // Extract source string...
-                pszSource = ResolveOperandAsString(1);
-
-                // Check if the destination operand is already a string...
-                if(DestinationOperand.OperandType == OT_AVM_STRING)
-                {
-                    // It's too small for a character...
-                    if(strlen(DestinationOperand.pszLiteralString) < 1)
-                    {
-                        // Resize and extract it...
-                        free(DestinationOperand.pszLiteralString);
-                        pszNew = (char *) malloc(2);
-                    }
-
-                    // Appropriate size, extract...
-                    else
-                        pszNew = DestinationOperand.pszLiteralString;
-                }
-
-                // Destination operand is not a string...
-                else
-                {
-                    // Create a string and remember operand's new type...
-                    pszNew = (char *) malloc(2);
-                    DestinationOperand.OperandType = OT_AVM_STRING;
-                }
+                DestinationOperand = ResolveOperandValue(hCurrentThread, 0);
 
-                // Copy the selected character into the source now...
-                pszNew[0] = pszSource[ResolveOperandAsInteger(2)];
-                pszNew[1] = '\x0';
+                // Extract the selected character of the source string...
+                pszSource = ResolveOperandAsString(hCurrentThread, 1,
+                                                   szCoercion);
+                Character = pszSource[ResolveOperandAsInteger(hCurrentThread,
+                                                              2)];
 
-                // Replace old destination string with newly computed...
-                DestinationOperand.pszLiteralString = pszNew;
+                // Store it in the destination, inline...
+                StoreString(hCurrentThread, &DestinationOperand, &Character,
+                            1);
 
                 // Finally plug computed value back into instruction stream...
-               *ResolveOperandAsPointer(0) = DestinationOperand;
+               *ResolveOperandAsPointer(hCurrentThread, 0) = DestinationOperand;
 
                 // Done...
                 break;
@@ -2441,15 +5995,19 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_SETCHAR:
             {
                 // Destination is not a string, ignore it...
-                if(ResolveOperandType(0) != OT_AVM_STRING)
+                if(ResolveOperandType(hCurrentThread, 0) != OT_AVM_STRING &&
+                   ResolveOperandType(hCurrentThread, 0) != OT_AVM_SHORT_STRING)
                     break;
 
                 // Extract source string...
-                pszSource = ResolveOperandAsString(2);
+                pszSource = ResolveOperandAsString(hCurrentThread, 2,
+                                                   szCoercion);
 
-                // Set the ith character in the destination to source...
-                ResolveOperandAsPointer(0)->
-                    pszLiteralString[ResolveOperandAsInteger(1)] = pszSource[0];
+                // Set the ith character in the destination's own copy...
+                SetCharacter(hCurrentThread,
+                             ResolveOperandAsPointer(hCurrentThread, 0),
+                             ResolveOperandAsInteger(hCurrentThread, 1),
+                             pszSource[0]);
 
                 // Done...
                 break;
@@ -2459,11 +6017,13 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_JMP:
             {
                 // Extract new address...
-                unTargetIndex = ResolveOperandAsInstructionIndex(0);
+                unTargetIndex =
+                    ResolveOperandAsInstructionIndex(hCurrentThread, 0);
 
                 // Shift instruction pointer to new address...
                 Scripts[hCurrentThread].InstructionStream.unInstructionPointer
                     = unTargetIndex;
+                bBranched = true;
 
                 // Done...
                 break;
@@ -2478,11 +6038,12 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_JLE:
             {
                 // Extract that which we are to compare...
-                Operand0 = ResolveOperandValue(0);
-                Operand1 = ResolveOperandValue(1);
+                Operand0 = ResolveOperandValue(hCurrentThread, 0);
+                Operand1 = ResolveOperandValue(hCurrentThread, 1);
 
                 // Extact target instruction index...
-                unTargetIndex = ResolveOperandAsInstructionIndex(2);
+                unTargetIndex =
+                    ResolveOperandAsInstructionIndex(hCurrentThread, 2);
 
                 // Perform appropriate comparison now and jump if necessary...
                 bJump = false;
@@ -2512,11 +6073,10 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
 
                             // String...
                             case OT_AVM_STRING:
+                            case OT_AVM_SHORT_STRING:
 
                                 // Compare...
-                                bJump = (strcmp(Operand0.pszLiteralString,
-                                                Operand1.pszLiteralString)
-                                         == 0);
+                                bJump = StringsEqual(Operand0, Operand1);
                                 break;
                         }
 
@@ -2548,11 +6108,10 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
 
                             // String...
                             case OT_AVM_STRING:
+                            case OT_AVM_SHORT_STRING:
 
                                 // Compare...
-                                bJump = (strcmp(Operand0.pszLiteralString,
-                                                Operand1.pszLiteralString)
-                                         != 0);
+                                bJump = !StringsEqual(Operand0, Operand1);
                                 break;
                         }
 
@@ -2673,11 +6232,13 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
                 if(bJump)
                 {
                     // Extract target instruction address...
-                    unTargetIndex = ResolveOperandAsInstructionIndex(2);
+                    unTargetIndex =
+                        ResolveOperandAsInstructionIndex(hCurrentThread, 2);
 
                     // Shift instruction pointer to new address...
                     Scripts[hCurrentThread].InstructionStream.
                         unInstructionPointer = unTargetIndex;
+                    bBranched = true;
                 }
 
                 // Done...
@@ -2688,7 +6249,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_PUSH:
             {
                 // Extract source value operand...
-                SourceOperand = ResolveOperandValue(0);
+                SourceOperand = ResolveOperandValue(hCurrentThread, 0);
 
                 // Push value onto stack...
                 Push(hCurrentThread, SourceOperand);
@@ -2700,8 +6261,11 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             // Pop value off of the stack...
             case INSTRUCTION_AVM_POP:
             {
-                // Pop top most value on stack into destination...
-               *ResolveOperandAsPointer(0) = Pop(hCurrentThread);
+                // Pop top most value on stack into destination, which takes
+                //  over its string reference...
+                SourceOperand = Pop(hCurrentThread);
+                ReleaseValue(ResolveOperandAsPointer(hCurrentThread, 0));
+               *ResolveOperandAsPointer(hCurrentThread, 0) = SourceOperand;
 
                 // Done...
                 break;
@@ -2711,7 +6275,8 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             case INSTRUCTION_AVM_CALL:
             {
                 // Extract function index before we lose the operand...
-                unFunctionIndex = ResolveOperandAsFunctionIndex(0);
+                unFunctionIndex =
+                    ResolveOperandAsFunctionIndex(hCurrentThread, 0);
 
                 // Instruction pointer increments to point after call...
                 Scripts[hCurrentThread].InstructionStream.
@@ -2719,6 +6284,7 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
 
                 // Invoke script function...
                 CallFunctionImplementation(hCurrentThread, unFunctionIndex);
+                bBranched = true;
 
                 // Done...
                 break;
@@ -2727,169 +6293,490 @@ boolean VirtualMachine::RunScripts(uint32 unDuration)
             // Return from a function...
             case INSTRUCTION_AVM_RET:
             {
-                // Gather some information on returning function...
+                // Return and terminate script if bottom of stack was found...
+                if(ReturnFromFunction(hCurrentThread))
+                    bBreakExecution = true;
 
-                    // Function index is in the top of the stack...
-                    CurrentFunctionIndex = Pop(hCurrentThread);
+                // Done...
+                break;
+            }
 
-                    // Bottom of stack found, so terminate script...
-                    if(CurrentFunctionIndex.OperandType == OT_AVM_STACK_BASE_MARKER)
-                        bBreakExecution = true;
+            // Call a host function...
+            case INSTRUCTION_AVM_CALLHOST:
+            {
+                // Extract the desire host function index...
+                HostFunctionIndex = ResolveOperandValue(hCurrentThread, 0);
 
-                    // Extract frame index from function structure...
-                    CurrentFunction =
-                        GetFunction(hCurrentThread,
-                                    CurrentFunctionIndex.nFunctionIndex);
-                    unFrameIndex = CurrentFunctionIndex.nStackIndex[1];
+                // Invoke it...
+                InvokeHostFunction(hCurrentThread,
+                                   HostFunctionIndex.nHostFunctionIndex);
 
-                // Extract the return address which is the next element under
-                //  the local data...
-                ReturnAddress =
-                    GetStackValue(hCurrentThread,
-                                  Scripts[hCurrentThread].Stack.nTopIndex -
-                                    (CurrentFunction.unLocalDataSize + 1));
+                // It may have left values on the stack...
+                CheckStackBound(hCurrentThread);
 
-                // Remove the stack frame of the returning function...
-                PopStackFrame(hCurrentThread, CurrentFunction.unStackFrameSize);
+                // Done...
+                break;
+            }
 
-                // Restore the previous stack frame's index...
-                Scripts[hCurrentThread].Stack.unCurrentStackFrameTopIndex =
-                    unFrameIndex;
+            // Rand instruction...
+            case INSTRUCTION_AVM_RAND:
+            {
+                // Store ranged random number in destination...
+                DestinationOperand.OperandType      = OT_AVM_INTEGER;
+                DestinationOperand.nLiteralInteger
+                    = GenerateRandomNumber(
+                        ResolveOperandAsInteger(hCurrentThread, 1));
 
-                // Finally jump to the return address...
-                Scripts[hCurrentThread].InstructionStream.unInstructionPointer
-                    = ReturnAddress.nInstructionIndex;
+                // Store result...
+                ReleaseValue(ResolveOperandAsPointer(hCurrentThread, 0));
+               *ResolveOperandAsPointer(hCurrentThread, 0) = DestinationOperand;
 
                 // Done...
                 break;
             }
 
-            // Call a host function...
-            case INSTRUCTION_AVM_CALLHOST:
+            // Pause instruction...
+            case INSTRUCTION_AVM_PAUSE:
             {
-                // Extract the desire host function index...
-                HostFunctionIndex = ResolveOperandValue(0);
-
-                // Get the actual name of the desired host function...
-                pszHostFunction =
-                    GetHostFunction(HostFunctionIndex.nHostFunctionIndex);
-
-                // Search through the provided host function table until we
-                //  find the host provided function and that this thread is
-                //  privy to it or it is a global host function...
-                for(unCurrentHostProvidedFunctionIndex = 0;
-                    unCurrentHostProvidedFunctionIndex <
-                                            MAXIMUM_HOST_PROVIDED_FUNCTIONS;
-                    unCurrentHostProvidedFunctionIndex++)
-                {
-                    // Extract host provided function...
-                    AVM_HostProvidedFunction HostProvidedFunction =
-                        HostProvidedFunctionTable
-                                        [unCurrentHostProvidedFunctionIndex];
+                // Calculate and store the pause ending time...
+                Scripts[hCurrentThread].PauseEndTime =
+                    PauseEndTimeAfter(
+                        ResolveOperandAsInteger(hCurrentThread, 0));
 
-                    // This host function table entry is not loaded, skip...
-                    if(!HostProvidedFunction.bLoaded)
-                        continue;
+                // Flag the script as paused...
+                Scripts[hCurrentThread].bPaused = true;
+                ScheduleScript(hCurrentThread);
 
-                    // Possible match...
-                    if(strcasecmp(HostProvidedFunction.szName, pszHostFunction) == 0)
-                    {
-                        // If the host function is registered to this thread or
-                        //  it is a global host function, then match found...
-                        if((HostProvidedFunction.hScriptVisibleTo
-                                == hCurrentThread) ||
-                           (HostProvidedFunction.hScriptVisibleTo
-                                == (uint32) GLOBAL_HOST_FUNCTION))
-                        {
-                            // Match found, invoke host function...
-                            HostProvidedFunction.pEntryPoint(hCurrentThread);
+                // Done...
+                break;
+            }
 
-                            // Done...
-                            break;
-                        }
-                    }
-                }
+            // Exit instruction...
+            case INSTRUCTION_AVM_EXIT:
+            {
+                /* TODO (Kip#3#): Figure out what we want to do with the exit
+                                  code in operand zero here. */
+
+                // Flag the script as no longer running...
+                Scripts[hCurrentThread].bExecuting = false;
+                ScheduleScript(hCurrentThread);
+
+                // Done...
+                break;
+            }
+        }
+
+        // If the instruction pointer wasn't changed by an instruction,
+        //  increment it. CALL, for example, increments automatically, and a
+        //  branch may land on the very instruction that took it...
+        if(!bBranched &&
+           Scripts[hCurrentThread].InstructionStream.unInstructionPointer ==
+           unCurrentInstructionPointer)
+            Scripts[hCurrentThread].InstructionStream.unInstructionPointer++;
+
+        // We are not running indefinetely...
+        if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+        {
+            // Check if main timeslice has expired...
+            if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+                break;
+        }
+
+        // If the script has terminated, then exit the execution loop....
+        if(bBreakExecution)
+            break;
+    }
+
+    #if defined(AGNI_WORKER_THREADS)
+    // Hand back whichever thread the worker still holds...
+    if(Worker.ThreadingMode == THREADING_MODE_PARALLEL)
+        ReleaseWorkerScript(Worker);
+    #endif
+
+    // Done...
+    return true;
+}
+
+// Queue a script where its state says it belongs, or nowhere if it is not
+//  executing...
+void VirtualMachine::ScheduleScript(Script hScript)
+{
+    // Variables...
+    bool    bExecuting  = Scripts[hScript].bLoaded &&
+                          Scripts[hScript].bExecuting;
+
+    // A worker running it in parallel holds it out of every queue, and will
+    //  schedule it when it hands it back...
+    if(Scripts[hScript].bHeld)
+        return;
+
+    // Leave the pause heap, if only to take a place again by a new time...
+    if(Scripts[hScript].unPauseHeapSlot)
+        RemovePausedScript(hScript);
+
+    // Paused...
+    if(bExecuting && Scripts[hScript].bPaused)
+    {
+        UnlinkScript(hScript);
+        InsertPausedScript(hScript);
+    }
+
+    // Runnable, and not already queued to run...
+    else if(bExecuting)
+    {
+        if(Scripts[hScript].pQueue != &RunQueue)
+            LinkScript(RunQueue, hScript);
+    }
+
+    // Or neither...
+    else
+        UnlinkScript(hScript);
+}
+
+// Select a binary operation handler for the given kinds...
+template <int Operation>
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedBinary(OperandKind DestinationKind,
+                                          OperandKind SourceKind)
+{
+    // Only variables and registers can be written to...
+    switch(DestinationKind)
+    {
+        case OperandKind_StackGlobal:
+            return SelectQuickenedBinarySource<Operation,
+                    OperandKind_StackGlobal>(SourceKind);
+
+        case OperandKind_StackLocal:
+            return SelectQuickenedBinarySource<Operation,
+                    OperandKind_StackLocal>(SourceKind);
+
+        case OperandKind_StackRelative:
+            return SelectQuickenedBinarySource<Operation,
+                    OperandKind_StackRelative>(SourceKind);
+
+        case OperandKind_Register:
+            return SelectQuickenedBinarySource<Operation,
+                    OperandKind_Register>(SourceKind);
+
+        default:
+            return NULL;
+    }
+}
+
+// Select a binary operation handler for the given source kind when the
+//  destination kind is already known...
+template <int Operation, int DestinationKind>
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedBinarySource(OperandKind SourceKind)
+{
+    // Any readable kind can be a source...
+    switch(SourceKind)
+    {
+        case OperandKind_Integer:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_Integer>;
+
+        case OperandKind_Float:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_Float>;
+
+        case OperandKind_Literal:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_Literal>;
+
+        case OperandKind_StackGlobal:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_StackGlobal>;
+
+        case OperandKind_StackLocal:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_StackLocal>;
+
+        case OperandKind_StackRelative:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_StackRelative>;
+
+        case OperandKind_Register:
+            return &VirtualMachine::QuickenedBinary<Operation,
+                    DestinationKind, OperandKind_Register>;
+
+        default:
+            return NULL;
+    }
+}
+
+// Select a conditional jump handler for the given kinds...
+template <int Operation>
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedCompare(OperandKind Kind0, OperandKind Kind1)
+{
+    // Comparisons depend only on values, so literals are all alike...
+    switch(Kind0)
+    {
+        case OperandKind_Integer:
+        case OperandKind_Float:
+        case OperandKind_Literal:
+            return SelectQuickenedCompareSecond<Operation,
+                    OperandKind_Literal>(Kind1);
+
+        case OperandKind_StackGlobal:
+            return SelectQuickenedCompareSecond<Operation,
+                    OperandKind_StackGlobal>(Kind1);
+
+        case OperandKind_StackLocal:
+            return SelectQuickenedCompareSecond<Operation,
+                    OperandKind_StackLocal>(Kind1);
+
+        case OperandKind_StackRelative:
+            return SelectQuickenedCompareSecond<Operation,
+                    OperandKind_StackRelative>(Kind1);
+
+        case OperandKind_Register:
+            return SelectQuickenedCompareSecond<Operation,
+                    OperandKind_Register>(Kind1);
+
+        default:
+            return NULL;
+    }
+}
+
+// Select a conditional jump handler for the given second operand kind when the
+//  first is already known...
+template <int Operation, int Kind0>
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedCompareSecond(OperandKind Kind1)
+{
+    // Comparisons depend only on values, so literals are all alike...
+    switch(Kind1)
+    {
+        case OperandKind_Integer:
+        case OperandKind_Float:
+        case OperandKind_Literal:
+            return &VirtualMachine::QuickenedCompare<Operation, Kind0,
+                    OperandKind_Literal>;
 
-                // Done...
-                break;
-            }
+        case OperandKind_StackGlobal:
+            return &VirtualMachine::QuickenedCompare<Operation, Kind0,
+                    OperandKind_StackGlobal>;
 
-            // Rand instruction...
-            case INSTRUCTION_AVM_RAND:
-            {
-                // Variables...
-                //static  uint32  unPreviousRandomNumber  = 17489;
-                static  uint32  unPreviousRandomNumber
-                                                = GetSystemMilliSeconds();
+        case OperandKind_StackLocal:
+            return &VirtualMachine::QuickenedCompare<Operation, Kind0,
+                    OperandKind_StackLocal>;
 
-                // Generate random number...
-                unPreviousRandomNumber =
-                    (25173 * unPreviousRandomNumber + 13849);
+        case OperandKind_StackRelative:
+            return &VirtualMachine::QuickenedCompare<Operation, Kind0,
+                    OperandKind_StackRelative>;
 
-                // Store ranged random number in destination...
-                DestinationOperand.OperandType      = OT_AVM_INTEGER;
-                DestinationOperand.nLiteralInteger
-                    = unPreviousRandomNumber % (1 + ResolveOperandAsInteger(1));
+        case OperandKind_Register:
+            return &VirtualMachine::QuickenedCompare<Operation, Kind0,
+                    OperandKind_Register>;
 
-                // Store result...
-               *ResolveOperandAsPointer(0) = DestinationOperand;
+        default:
+            return NULL;
+    }
+}
 
-                // Done...
-                break;
+// Select a handler specialized on an instruction's operand kinds, or NULL if it
+//  cannot be quickened...
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedHandler(const AVM_Instruction &Instruction,
+                                           bool bStackBounded)
+{
+    // Variables...
+    OperandKind     Kind0   = OperandKind_Unknown;
+    OperandKind     Kind1   = OperandKind_Unknown;
+
+    // Classify whichever operands are present...
+    if(Instruction.OperandCount > 0)
+        Kind0 = GetOperandKind(Instruction.pOperandList[0]);
+    if(Instruction.OperandCount > 1)
+        Kind1 = GetOperandKind(Instruction.pOperandList[1]);
+
+    // Select by operation...
+    switch(Instruction.usOperationCode)
+    {
+        // Binary operations...
+        case INSTRUCTION_AVM_MOV:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_MOV>(Kind0, Kind1);
+        case INSTRUCTION_AVM_ADD:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_ADD>(Kind0, Kind1);
+        case INSTRUCTION_AVM_SUB:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_SUB>(Kind0, Kind1);
+        case INSTRUCTION_AVM_MUL:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_MUL>(Kind0, Kind1);
+        case INSTRUCTION_AVM_DIV:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_DIV>(Kind0, Kind1);
+        case INSTRUCTION_AVM_MOD:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_MOD>(Kind0, Kind1);
+        case INSTRUCTION_AVM_AND:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_AND>(Kind0, Kind1);
+        case INSTRUCTION_AVM_OR:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_OR>(Kind0, Kind1);
+        case INSTRUCTION_AVM_XOR:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_XOR>(Kind0, Kind1);
+        case INSTRUCTION_AVM_SHL:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_SHL>(Kind0, Kind1);
+        case INSTRUCTION_AVM_SHR:
+            return SelectQuickenedBinary<INSTRUCTION_AVM_SHR>(Kind0, Kind1);
+
+        // Unary operations...
+        case INSTRUCTION_AVM_NEG:
+            return SelectQuickenedUnary<INSTRUCTION_AVM_NEG>(Kind0);
+        case INSTRUCTION_AVM_NOT:
+            return SelectQuickenedUnary<INSTRUCTION_AVM_NOT>(Kind0);
+        case INSTRUCTION_AVM_INC:
+            return SelectQuickenedUnary<INSTRUCTION_AVM_INC>(Kind0);
+        case INSTRUCTION_AVM_DEC:
+            return SelectQuickenedUnary<INSTRUCTION_AVM_DEC>(Kind0);
+
+        // Conditional jumps...
+        case INSTRUCTION_AVM_JE:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JE>(Kind0, Kind1);
+        case INSTRUCTION_AVM_JNE:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JNE>(Kind0, Kind1);
+        case INSTRUCTION_AVM_JG:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JG>(Kind0, Kind1);
+        case INSTRUCTION_AVM_JL:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JL>(Kind0, Kind1);
+        case INSTRUCTION_AVM_JGE:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JGE>(Kind0, Kind1);
+        case INSTRUCTION_AVM_JLE:
+            return SelectQuickenedCompare<INSTRUCTION_AVM_JLE>(Kind0, Kind1);
+
+        // Push reads any kind, checked unless its function's depth is
+        //  known...
+        case INSTRUCTION_AVM_PUSH:
+        {
+            switch(Kind0)
+            {
+                case OperandKind_Integer:
+                case OperandKind_Float:
+                case OperandKind_Literal:
+                    return bStackBounded
+                        ? &VirtualMachine::QuickenedPush<
+                            OperandKind_Literal, true>
+                        : &VirtualMachine::QuickenedPush<
+                            OperandKind_Literal, false>;
+                case OperandKind_StackGlobal:
+                    return bStackBounded
+                        ? &VirtualMachine::QuickenedPush<
+                            OperandKind_StackGlobal, true>
+                        : &VirtualMachine::QuickenedPush<
+                            OperandKind_StackGlobal, false>;
+                case OperandKind_StackLocal:
+                    return bStackBounded
+                        ? &VirtualMachine::QuickenedPush<
+                            OperandKind_StackLocal, true>
+                        : &VirtualMachine::QuickenedPush<
+                            OperandKind_StackLocal, false>;
+                case OperandKind_StackRelative:
+                    return bStackBounded
+                        ? &VirtualMachine::QuickenedPush<
+                            OperandKind_StackRelative, true>
+                        : &VirtualMachine::QuickenedPush<
+                            OperandKind_StackRelative, false>;
+                case OperandKind_Register:
+                    return bStackBounded
+                        ? &VirtualMachine::QuickenedPush<
+                            OperandKind_Register, true>
+                        : &VirtualMachine::QuickenedPush<
+                            OperandKind_Register, false>;
+                default:
+                    return NULL;
             }
+        }
 
-            // Pause instruction...
-            case INSTRUCTION_AVM_PAUSE:
+        // Pop writes only to variables and registers...
+        case INSTRUCTION_AVM_POP:
+        {
+            switch(Kind0)
             {
-                // Extract the duration time...
-                unPauseDuration = ResolveOperandAsInteger(0);
+                case OperandKind_StackGlobal:
+                    return &VirtualMachine::QuickenedPop<
+                            OperandKind_StackGlobal>;
+                case OperandKind_StackLocal:
+                    return &VirtualMachine::QuickenedPop<
+                            OperandKind_StackLocal>;
+                case OperandKind_StackRelative:
+                    return &VirtualMachine::QuickenedPop<
+                            OperandKind_StackRelative>;
+                case OperandKind_Register:
+                    return &VirtualMachine::QuickenedPop<OperandKind_Register>;
+                default:
+                    return NULL;
+            }
+        }
 
-                // Calculate and store the pause ending time...
-                Scripts[hCurrentThread].unPauseEndTime =
-                                            unCurrentTime + unPauseDuration;
+        // Everything else runs its generic handler...
+        default:
+            return NULL;
+    }
+}
 
-                // Flag the script as paused...
-                Scripts[hCurrentThread].bPaused = true;
+// Select a unary operation handler for the given kind...
+template <int Operation>
+VirtualMachine::QuickenedHandler
+    VirtualMachine::SelectQuickenedUnary(OperandKind DestinationKind)
+{
+    // Only variables and registers can be written to...
+    switch(DestinationKind)
+    {
+        case OperandKind_StackGlobal:
+            return &VirtualMachine::QuickenedUnary<Operation,
+                    OperandKind_StackGlobal>;
 
-                // Done...
-                break;
-            }
+        case OperandKind_StackLocal:
+            return &VirtualMachine::QuickenedUnary<Operation,
+                    OperandKind_StackLocal>;
 
-            // Exit instruction...
-            case INSTRUCTION_AVM_EXIT:
-            {
-                /* TODO (Kip#3#): Figure out what we want to do with the exit
-                                  code in operand zero here. */
+        case OperandKind_StackRelative:
+            return &VirtualMachine::QuickenedUnary<Operation,
+                    OperandKind_StackRelative>;
 
-                // Flag the script as no longer running...
-                Scripts[hCurrentThread].bExecuting = false;
+        case OperandKind_Register:
+            return &VirtualMachine::QuickenedUnary<Operation,
+                    OperandKind_Register>;
 
-                // Done...
-                break;
-            }
-        }
+        default:
+            return NULL;
+    }
+}
 
-        // If the instruction pointer wasn't changed by an instruction,
-        //  increment it. CALL, for example, increments automatically...
-        if(Scripts[hCurrentThread].InstructionStream.unInstructionPointer ==
-           unCurrentInstructionPointer)
-            Scripts[hCurrentThread].InstructionStream.unInstructionPointer++;
+// Set a character of a value's string, copying the string first if it is shared
+//  or a literal, ignoring an index outside the string, or throw error string...
+void VirtualMachine::SetCharacter(Script hScript, AVM_RuntimeValue *pValue,
+                                  int32 nIndex, char Character)
+{
+    // Variables...
+    char   *pszString = NULL;
 
-        // We are not running indefinetely...
-        if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
-        {
-            // Check if main timeslice has expired...
-            if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
-                break;
-        }
+    // Short strings are never shared, so set it in place...
+    if(pValue->OperandType == OT_AVM_SHORT_STRING)
+    {
+        // Outside the string, ignore it rather than overwrite whatever
+        //  follows the value...
+        if(nIndex < 0 || (size_t) nIndex >= strlen(pValue->szShortString))
+            return;
 
-        // If the script has terminated, then exit the execution loop....
-        if(bBreakExecution)
-            break;
+        // Set it...
+        pValue->szShortString[nIndex] = Character;
+
+        // Done...
+        return;
     }
 
-    // Done...
-    return true;
+    // Outside the string, ignore it rather than write past it...
+    if(nIndex < 0 || (uint32) nIndex >=
+       AVM_STRING_OF(AVM_LITERAL_STRING(*pValue))->unLength)
+        return;
+
+    // Set it in the value's own copy...
+    pszString = UniqueString(hScript, pValue);
+    pszString[nIndex] = Character;
+
+    // Terminating it early shortens it...
+    if(!Character)
+        AVM_STRING_OF(pszString)->unLength = nIndex;
 }
 
 // Set stack value...
@@ -2901,6 +6788,54 @@ inline void VirtualMachine::SetStackValue(Script hScript, int32 nIndex,
         = RuntimeValue;
 }
 
+// Move the script in a slot of the pause heap up or down until it is due after
+//  its parent and before its children...
+void VirtualMachine::SiftPausedScript(uint32 unSlot)
+{
+    // Variables...
+    Script              hScript     = PauseHeap[unSlot];
+    unsigned long long  WakeTime    = Scripts[hScript].PauseEndTime;
+    uint32              unParent    = 0;
+    uint32              unChild     = 0;
+
+    // Up, while it is due before its parent...
+    while(unSlot > 0)
+    {
+        // Parent is due first, so stop here...
+        unParent = (unSlot - 1) / 2;
+        if(Scripts[PauseHeap[unParent]].PauseEndTime <= WakeTime)
+            break;
+
+        // Swap...
+        PauseHeap[unSlot] = PauseHeap[unParent];
+        Scripts[PauseHeap[unSlot]].unPauseHeapSlot = unSlot + 1;
+        unSlot = unParent;
+    }
+
+    // Down, while either child is due before it...
+    while((unChild = 2 * unSlot + 1) < unPausedScripts)
+    {
+        // Take the child due first...
+        if(unChild + 1 < unPausedScripts &&
+           Scripts[PauseHeap[unChild + 1]].PauseEndTime <
+           Scripts[PauseHeap[unChild]].PauseEndTime)
+            unChild++;
+
+        // It is due first, so stop here...
+        if(WakeTime <= Scripts[PauseHeap[unChild]].PauseEndTime)
+            break;
+
+        // Swap...
+        PauseHeap[unSlot] = PauseHeap[unChild];
+        Scripts[PauseHeap[unSlot]].unPauseHeapSlot = unSlot + 1;
+        unSlot = unChild;
+    }
+
+    // Settle it...
+    PauseHeap[unSlot] = hScript;
+    Scripts[hScript].unPauseHeapSlot = unSlot + 1;
+}
+
 // Start the execution of a script...
 boolean VirtualMachine::StartScript(Script hScript)
 {
@@ -2910,12 +6845,20 @@ boolean VirtualMachine::StartScript(Script hScript)
 
     // Trigger execution flag...
     Scripts[hScript].bExecuting = true;
+    ScheduleScript(hScript);
 
-    // Set current thread to this one...
-    hCurrentThread = hScript;
+    // Workers running scripts in parallel schedule them themselves...
+    if(bParallel)
+        return true;
+
+    // Set current thread to this one, at the head of the run queue if it is
+    //  not paused...
+    MainWorker.hCurrentThread = hScript;
+    if(Scripts[hScript].pQueue == &RunQueue)
+        RunQueue.hHead = hScript;
 
     // Set execution activation time...
-    unCurrentThreadActivationTime = GetSystemMilliSeconds();
+    MainWorker.unCurrentThreadActivationTime = GetSystemMilliSeconds();
 
     // Done...
     return true;
@@ -2930,111 +6873,412 @@ boolean VirtualMachine::StopScript(Script hScript)
 
     // Stop execution...
     Scripts[hScript].bExecuting = false;
+    ScheduleScript(hScript);
 
     // Done...
     return true;
 }
 
-// Unload script...
-boolean VirtualMachine::UnloadScript(Script &hScript)
+// Store a copy of the given characters in a value, releasing whatever it held,
+//  inline if short enough, or throw error string...
+void VirtualMachine::StoreString(Script hScript, AVM_RuntimeValue *pValue,
+                                 const char *pszCharacters, uint32 unLength)
 {
-    // Check handle...
-    if(!IsValidThread(hScript))
-        return false;
+    // Variables...
+    char   *pszString   = NULL;
+
+    // Short enough to live inline...
+    if(unLength < SHORT_STRING_SIZE)
+    {
+        // Copy first, as the characters may be what the value is releasing...
+        char szShort[SHORT_STRING_SIZE];
+        memcpy(szShort, pszCharacters, unLength);
+        szShort[unLength] = '\x0';
+
+        // Store...
+        ReleaseValue(pValue);
+        pValue->OperandType = OT_AVM_SHORT_STRING;
+        memcpy(pValue->szShortString, szShort, SHORT_STRING_SIZE);
+
+        // Done...
+        return;
+    }
+
+    // Otherwise allocate it...
+    pszString = NewString(hScript, pszCharacters, unLength, unLength);
+
+        // Failed...
+        if(!pszString)
+            throw "memory allocation failed";
+
+    // Store...
+    ReleaseValue(pValue);
+    pValue->OperandType         = OT_AVM_STRING;
+    AVM_SET_LITERAL_STRING(*pValue, pszString);
+}
+
+// Are two string values equal? Interned strings are equal only if they are the
+//  same string...
+bool VirtualMachine::StringsEqual(const AVM_RuntimeValue &Value0,
+                                  const AVM_RuntimeValue &Value1)
+{
+    // Both shared strings, so compare them by identity where that decides it...
+    if(Value0.OperandType == OT_AVM_STRING &&
+       Value1.OperandType == OT_AVM_STRING)
+    {
+        // The same string...
+        if(AVM_LITERAL_STRING(Value0) == AVM_LITERAL_STRING(Value1))
+            return true;
+
+        // Different interned strings never hold the same characters...
+        if(AVM_STRING_OF(AVM_LITERAL_STRING(Value0))->bInterned &&
+           AVM_STRING_OF(AVM_LITERAL_STRING(Value1))->bInterned)
+            return false;
+    }
+
+    // Otherwise compare characters...
+    return (strcmp(AVM_CHARACTERS_OF(Value0), AVM_CHARACTERS_OF(Value1)) == 0);
+}
+
+// Translate threaded code into register code, turning stack traffic into moves,
+//  or throw status code...
+void VirtualMachine::TranslateToRegisterCode(Script hScript)
+{
+    // Variables...
+    AVM_Script                 &CurrentScript   = Scripts[hScript];
+    AVM_Instruction            *pInstructions   = NULL;
+    AVM_ThreadedInstruction    *pThreaded       = NULL;
+    AVM_ThreadedInstruction    *pCode           = NULL;
+    AVM_RuntimeValue           *pDestination    = NULL;
+    boolean                    *pEntered        = NULL;
+    char                       *pCursor         = NULL;
+    bool                        bNamed          = false;
+    uint32                      unSize          = 0;
+    uint32                      unIndex         = 0;
+    uint32                      unLength        = 0;
+    uint32                      unPending       = 0;
+    uint32                      unPendingCount  = 0;
+    uint32                      unPopped        = 0;
+    uint32                      punPending[MAXIMUM_DEFERRED_PUSHES];
+
+    // Find instructions entered other than by falling through...
+    pEntered = FindEnteredInstructions(hScript);
+
+        // Branch targets could land anywhere, so leave it to threaded code...
+        if(!pEntered)
+            return;
+
+    // Allocate the image in one piece, with room to align it, since register
+    //  code is never longer than the threaded code it came from...
+    unSize = CurrentScript.InstructionStreamHeader.unSize;
+    CurrentScript.pRegisterImage = ArenaAllocate(CurrentScript.ImageArena,
+        CODE_IMAGE_ALIGNMENT - 1 +
+        (unSize + 1) * (sizeof(AVM_ThreadedInstruction) + 2 * sizeof(uint32)));
+
+        // Failed...
+        if(!CurrentScript.pRegisterImage)
+        {
+            // Cleanup and abort...
+            ArenaFree(CurrentScript.ImageArena, pEntered);
+            throw Memory_Allocation;
+        }
 
-    // Instruction stream, if necessary...
-    for(uint32 unCurrentInstructionIndex = 0;
-        unCurrentInstructionIndex <
-            Scripts[hScript].InstructionStreamHeader.unSize &&
-        Scripts[hScript].InstructionStream.pInstructions;
-        unCurrentInstructionIndex++)
+    // Register code starts on the first cache line boundary, then the maps...
+    pCursor = (char *) CurrentScript.pRegisterImage;
+    pCursor += (CODE_IMAGE_ALIGNMENT - ((size_t) pCursor % CODE_IMAGE_ALIGNMENT))
+                % CODE_IMAGE_ALIGNMENT;
+    pCode = (AVM_ThreadedInstruction *) pCursor;
+    pCursor += (unSize + 1) * sizeof(AVM_ThreadedInstruction);
+    CurrentScript.punRegisterIndex = (uint32 *) pCursor;
+    pCursor += (unSize + 1) * sizeof(uint32);
+    CurrentScript.punRegisterSource = (uint32 *) pCursor;
+
+    // Emit a copy of an instruction's threaded code...
+    #define REGISTER_EMIT(unSource) \
+        { pCode[unLength] = pThreaded[unSource]; \
+          CurrentScript.punRegisterSource[unLength++] = (unSource); }
+
+    // Emit every push still deferred, in the order they were made...
+    #define REGISTER_FLUSH() \
+        { for(unPending = 0; unPending < unPendingCount; unPending++) \
+            REGISTER_EMIT(punPending[unPending]) \
+          unPendingCount = 0; }
+
+    // Translate each instruction...
+    pInstructions   = CurrentScript.InstructionStream.pInstructions;
+    pThreaded       = CurrentScript.pThreadedCode;
+    for(unIndex = 0; unIndex < unSize; unIndex++)
     {
         // Variables...
-        uint8               OperandCount    = 0;
-        AVM_RuntimeValue   *pOperandList    = NULL;
-
-        // Extract number of operands...
-        OperandCount = Scripts[hScript].InstructionStream.
-                        pInstructions[unCurrentInstructionIndex].
-                        OperandCount;
-
-        // Extract operand list...
-        pOperandList = Scripts[hScript].InstructionStream.
-                        pInstructions[unCurrentInstructionIndex].
-                        pOperandList;
-
-        // String literal operands must be freed...
-        for(uint16 usCurrentOperandIndex = 0;
-            usCurrentOperandIndex < OperandCount;
-            usCurrentOperandIndex++)
-        {
-            // String found...
-            if(pOperandList[usCurrentOperandIndex].OperandType
-                == OT_AVM_STRING)
+        AVM_Instruction &Instruction = pInstructions[unIndex];
+
+        // Nothing can be deferred across an entry, so it gets its own place...
+        if(pEntered[unIndex])
+            REGISTER_FLUSH()
+        CurrentScript.punRegisterIndex[unIndex] = unLength;
+
+        // Translate...
+        switch(Instruction.usOperationCode)
+        {
+            // Defer a push of a value that can only change by a write naming
+            //  it, until it is either popped or needed on the stack...
+            case INSTRUCTION_AVM_PUSH:
+            {
+                // Cannot defer, so push any earlier ones and this one...
+                if(unPendingCount == MAXIMUM_DEFERRED_PUSHES ||
+                   !pThreaded[unIndex].Quickened ||
+                   GetOperandKind(Instruction.pOperandList[0]) ==
+                    OperandKind_StackRelative)
+                {
+                    REGISTER_FLUSH()
+                    REGISTER_EMIT(unIndex)
+                }
+
+                // Defer...
+                else
+                    punPending[unPendingCount++] = unIndex;
+
+                break;
+            }
+
+            // Pop a deferred push straight into the destination...
+            case INSTRUCTION_AVM_POP:
+            {
+                // Nothing deferred, the value is really on the stack...
+                if(unPendingCount == 0)
+                {
+                    REGISTER_EMIT(unIndex)
+                    break;
+                }
+
+                // Writing the destination must not change a value still
+                //  deferred beneath...
+                pDestination = &Instruction.pOperandList[0];
+                bNamed = IsNamedSlot(*pDestination);
+                for(unPending = 0; unPending + 1 < unPendingCount; unPending++)
+                {
+                    // Push those before this one if it might...
+                    if(!bNamed || IsSameOperand(*pDestination, pInstructions[
+                                    punPending[unPending]].pOperandList[0]))
+                    {
+                        // Flush all but the one being popped...
+                        unPopped = punPending[--unPendingCount];
+                        REGISTER_FLUSH()
+                        punPending[unPendingCount++] = unPopped;
+                        break;
+                    }
+                }
+
+                // Move the pushed value into the destination...
+                AVM_ThreadedInstruction &Move = pCode[unLength];
+                AVM_Instruction          MoveInstruction;
+                memset(&Move, '\x0', sizeof(AVM_ThreadedInstruction));
+                Move.usOperationCode    = INSTRUCTION_AVM_MOV;
+                Move.OperandCount       = 2;
+                Move.Operands[0]        = *pDestination;
+                Move.Operands[1]        = pInstructions[
+                    punPending[--unPendingCount]].pOperandList[0];
+
+                // Quicken it...
+                MoveInstruction.usOperationCode = INSTRUCTION_AVM_MOV;
+                MoveInstruction.OperandCount    = 2;
+                MoveInstruction.pOperandList    = Move.Operands;
+                Move.Quickened = SelectQuickenedHandler(MoveInstruction, false);
+                if(Move.Quickened)
+                    Move.usOperationCode = INSTRUCTION_AVM_QUICKENED;
+
+                // It came from the pop...
+                CurrentScript.punRegisterSource[unLength++] = unIndex;
+                break;
+            }
+
+            // Straight line instructions that write only their first operand
+            //  can run with pushes still deferred, unless they write one...
+            case INSTRUCTION_AVM_MOV:
+            case INSTRUCTION_AVM_ADD:
+            case INSTRUCTION_AVM_SUB:
+            case INSTRUCTION_AVM_MUL:
+            case INSTRUCTION_AVM_DIV:
+            case INSTRUCTION_AVM_MOD:
+            case INSTRUCTION_AVM_EXP:
+            case INSTRUCTION_AVM_NEG:
+            case INSTRUCTION_AVM_INC:
+            case INSTRUCTION_AVM_DEC:
+            case INSTRUCTION_AVM_AND:
+            case INSTRUCTION_AVM_OR:
+            case INSTRUCTION_AVM_XOR:
+            case INSTRUCTION_AVM_NOT:
+            case INSTRUCTION_AVM_SHL:
+            case INSTRUCTION_AVM_SHR:
+            case INSTRUCTION_AVM_CONCAT:
+            case INSTRUCTION_AVM_GETCHAR:
+            case INSTRUCTION_AVM_SETCHAR:
+            case INSTRUCTION_AVM_RAND:
+            {
+                // Check the destination against each deferred push...
+                pDestination = &Instruction.pOperandList[0];
+                bNamed = IsNamedSlot(*pDestination);
+                for(unPending = 0; unPending < unPendingCount; unPending++)
+                {
+                    // Might write it, so push them all now...
+                    if(!bNamed || IsSameOperand(*pDestination, pInstructions[
+                                    punPending[unPending]].pOperandList[0]))
+                    {
+                        REGISTER_FLUSH()
+                        break;
+                    }
+                }
+
+                // Emit it...
+                REGISTER_EMIT(unIndex)
+                break;
+            }
+
+            // Anything else can branch, or use the stack itself...
+            default:
             {
-                // Free...
-                free(pOperandList[usCurrentOperandIndex].
-                     pszLiteralString);
-                pOperandList[usCurrentOperandIndex].
-                     pszLiteralString = NULL;
+                // Push all deferred and emit it...
+                REGISTER_FLUSH()
+                REGISTER_EMIT(unIndex)
+                break;
             }
         }
+    }
+
+    // Running off the end of the stream terminates the script...
+    REGISTER_FLUSH()
+    CurrentScript.punRegisterIndex[unSize] = unLength;
+    CurrentScript.unRegisterCodeSize = unLength;
+    REGISTER_EMIT(unSize)
 
-        // Free the operand list itself...
-        free(pOperandList);
-        pOperandList = NULL;
+    // Done with the translation macros...
+    #undef REGISTER_EMIT
+    #undef REGISTER_FLUSH
+
+    // Retarget branches into the register code...
+    for(unIndex = 0; unIndex < unLength; unIndex++)
+    {
+        // Resolved at load time...
+        if(pCode[unIndex].pJumpTarget)
+            pCode[unIndex].pJumpTarget = &pCode[CurrentScript.punRegisterIndex[
+                pCode[unIndex].pJumpTarget - pThreaded]];
     }
 
-    // Instruction stream itself, if necessary...
-    if(Scripts[hScript].InstructionStreamHeader.unSize)
+    // Done with flags...
+    ArenaFree(CurrentScript.ImageArena, pEntered);
+
+    // Register code is ready, and linked the first time it runs...
+    CurrentScript.pRegisterCode         = pCode;
+    CurrentScript.bRegisterCodeLinked   = false;
+}
+
+// Make a value's string its own to modify, copying it first if it is shared, a
+//  literal, or interned, or throw error string...
+char *VirtualMachine::UniqueString(Script hScript, AVM_RuntimeValue *pValue)
+{
+    // Variables...
+    AVM_String *pString = AVM_STRING_OF(AVM_LITERAL_STRING(*pValue));
+    char       *pszCopy = NULL;
+
+    // Already its own, and not interned where others may yet find it...
+    if(!pString->bInterned && pString->unReferences == 1)
+        return AVM_LITERAL_STRING(*pValue);
+
+    // Copy it...
+    pszCopy = NewString(hScript, pString->szCharacters, pString->unLength,
+                        pString->unLength);
+
+        // Failed...
+        if(!pszCopy)
+            throw "memory allocation failed";
+
+    // Release the shared one and hold the copy instead...
+    ReleaseValue(pValue);
+    pValue->OperandType         = OT_AVM_STRING;
+    AVM_SET_LITERAL_STRING(*pValue, pszCopy);
+
+    // Done...
+    return pszCopy;
+}
+
+// Unlink a script from whichever queue it is in, if any...
+void VirtualMachine::UnlinkScript(Script hScript)
+{
+    // Variables...
+    AVM_ScriptQueue    *pQueue  = Scripts[hScript].pQueue;
+
+    // Not queued...
+    if(!pQueue)
+        return;
+
+    // Close the gap it leaves, passing the head on to the script after it,
+    //  which is next in turn...
+    if(pQueue->unSize > 1)
     {
-        // Free it...
-        free(Scripts[hScript].InstructionStream.pInstructions);
-        Scripts[hScript].InstructionStream.pInstructions = NULL;
+        Scripts[Scripts[hScript].hPreviousQueued].hNextQueued =
+            Scripts[hScript].hNextQueued;
+        Scripts[Scripts[hScript].hNextQueued].hPreviousQueued =
+            Scripts[hScript].hPreviousQueued;
+        if(pQueue->hHead == hScript)
+            pQueue->hHead = Scripts[hScript].hNextQueued;
     }
 
-    // Free any string literals allocated on the runtime stack...
+    // Forget it...
+    Scripts[hScript].pQueue = NULL;
+    pQueue->unSize--;
+}
+
+// Unload script...
+boolean VirtualMachine::UnloadScript(Script &hScript)
+{
+    // Check handle...
+    if(!IsValidThread(hScript))
+        return false;
+
+    // Release any strings held on the runtime stack, as those interned outlive
+    //  the script's arenas...
     for(uint32 unCurrentStackIndex = 0;
         unCurrentStackIndex < Scripts[hScript].MainHeader.unStackSize;
         unCurrentStackIndex++)
-    {
-        // Found one...
-        if(Scripts[hScript].Stack.pElements[unCurrentStackIndex].OperandType
-            == OT_AVM_STRING)
-        {
-            // Free...
-            free(Scripts[hScript].Stack.pElements[unCurrentStackIndex].
-                pszLiteralString);
-            Scripts[hScript].Stack.pElements[unCurrentStackIndex].
-                pszLiteralString = NULL;
-        }
-    }
+        ReleaseValue(&Scripts[hScript].Stack.pElements[unCurrentStackIndex]);
 
-    // Free the runtime stack itself...
-    free(Scripts[hScript].Stack.pElements);
-    Scripts[hScript].Stack.pElements = NULL;
+    // And in registers...
+    ReleaseValue(&Scripts[hScript]._RegisterT0);
+    ReleaseValue(&Scripts[hScript]._RegisterT1);
+    ReleaseValue(&Scripts[hScript]._RegisterReturn);
 
-    // Function table, if necessary...
-    if(Scripts[hScript].FunctionTableHeader.unSize)
+    // Interned string literals, if strings are being interned...
+    if(Scripts[hScript].ppszInternedLiterals)
     {
-        // Free it...
-        free(Scripts[hScript].pFunctionTable);
-        Scripts[hScript].pFunctionTable = NULL;
-    }
+        // Release each...
+        for(uint32 unIndex = 0;
+            unIndex < Scripts[hScript].StringStreamHeader.unSize; unIndex++)
+            ReleaseString(Scripts[hScript].ppszInternedLiterals[unIndex]);
 
-    // Host function table, if necessary...
-    if(Scripts[hScript].HostFunctionTableHeader.unSize)
-    {
-        // Free it...
-        free(Scripts[hScript].pHostFunctionTable);
-        Scripts[hScript].pHostFunctionTable = NULL;
+        // Done with the table...
+        Scripts[hScript].ppszInternedLiterals = NULL;
     }
 
-    // Clear header...
-    memset(&Scripts[hScript], '\x0', sizeof(AVM_Script));
+    // Native code, if it was compiled...
+    FreeNativeCode(hScript);
 
-    // Mark as unloaded, for no particular reason...
+    #if defined(AGNI_GUARDED_STACKS)
+    // Guarded runtime stack...
+    ReleaseGuardedStack(hScript);
+    #endif
+
+    // Mark as unloaded, and take it off the scheduler's queues while it still
+    //  knows where it is in them...
     Scripts[hScript].bLoaded = false;
+    ScheduleScript(hScript);
+
+    // Everything else the script allocated, code image, runtime stack, tables,
+    //  and strings alike, in one shot...
+    ArenaRelease(Scripts[hScript].ImageArena);
+    ArenaRelease(Scripts[hScript].RuntimeArena);
+
+    // Clear header...
+    memset(&Scripts[hScript], '\x0', sizeof(AVM_Script));
 
     // Invalidate user's script thread handle to make debugging on their part
     //  easier...
@@ -3053,6 +7297,37 @@ boolean VirtualMachine::UnPauseScript(Script hScript)
 
     // Reset pause flag...
     Scripts[hScript].bPaused = false;
+    ScheduleScript(hScript);
+
+    // Done...
+    return true;
+}
+
+// Unregister host provided function...
+bool VirtualMachine::UnregisterHostProvidedFunction(Script hThread,
+                                                    const char *pszName)
+{
+    // Variables...
+    AVM_HostProvidedFunction   *pHostFunctionEntry  = NULL;
+
+    // Find it...
+    pHostFunctionEntry = pszName ? FindHostProvidedFunction(hThread, pszName)
+                                 : NULL;
+
+        // Not registered...
+        if(!pHostFunctionEntry)
+            return false;
+
+    // Vacate its slot, which lookups must still probe past...
+    pAllocator->Free(pHostFunctionEntry->pszName,
+                     strlen(pHostFunctionEntry->pszName) + 1,
+                     ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+    memset(pHostFunctionEntry, '\x0', sizeof(AVM_HostProvidedFunction));
+    pHostFunctionEntry->bVacated = true;
+    unHostProvidedFunctionCount--;
+
+    // Scripts must bind their host functions again...
+    unHostProvidedFunctionGeneration++;
 
     // Done...
     return true;
@@ -3083,9 +7358,29 @@ bool VirtualMachine::VersionSafe(uint8 AvailableMajor, uint8 AvailableMinor,
         return false;
 }
 
+// Make runnable every paused script whose pause has elapsed...
+void VirtualMachine::WakePausedScripts(unsigned long long CurrentTime)
+{
+    // Variables...
+    Script  hScript = 0;
+
+    // Take each due from the top of the heap...
+    while(unPausedScripts > 0 &&
+          Scripts[PauseHeap[0]].PauseEndTime <= CurrentTime)
+    {
+        // Unpause it...
+        hScript = PauseHeap[0];
+        Scripts[hScript].bPaused = false;
+        ScheduleScript(hScript);
+    }
+}
+
 // Deconstructor shuts down runtime enviroment...
 VirtualMachine::~VirtualMachine()
 {
+    // Stop the pool's threads, if any were started...
+    ShutdownWorkers();
+
     // Unload all loaded scripts, if any...
     for(Script hCurrentScript = 0; hCurrentScript < MAXIMUM_THREADS;
         hCurrentScript++)
@@ -3095,7 +7390,29 @@ VirtualMachine::~VirtualMachine()
             UnloadScript(hCurrentScript);
     }
 
+    // Free host provided function registry...
+    for(uint32 unSlot = 0; unSlot < unHostProvidedFunctionSlots; unSlot++)
+    {
+        // Free name, if registered...
+        if(pHostProvidedFunctions[unSlot].bLoaded)
+            pAllocator->Free(pHostProvidedFunctions[unSlot].pszName,
+                             strlen(pHostProvidedFunctions[unSlot].pszName) + 1,
+                             ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+    }
+    if(pHostProvidedFunctions)
+        pAllocator->Free(pHostProvidedFunctions,
+                         unHostProvidedFunctionSlots *
+                            sizeof(AVM_HostProvidedFunction),
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+
+    // Free string interning table, emptied as scripts released their strings...
+    if(pInternedStrings)
+        pAllocator->Free(pInternedStrings,
+                         unInternedStringSlots * sizeof(AVM_InternedString),
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
+
     // Free host name, if necessary...
     if(pszHostName)
-        free(pszHostName);
+        pAllocator->Free(pszHostName, strlen(pszHostName) + 1,
+                         ALLOCATION_ALIGNMENT, UNTAGGED_ALLOCATION);
 }
@@ -0,0 +1,524 @@
+/*
+  Name:         Workers.cpp (implementation)
+  Copyright:    Kip Warner (Kip@TheVertigo.com)
+  Description:  VirtualMachine worker threads. Scripts can be run in parallel
+                on a pool of them, the host's thread among them. A worker
+                holds the script it runs out of the scheduler's queues so no
+                other runs it meanwhile, and takes the next in turn under the
+                scheduler's lock whenever its time slice ends...
+*/
+
+// Includes...
+
+    // Virtual machine definition...
+    #include "../include/Agni.h"
+
+    // Processors online...
+    #if defined(AGNI_WORKER_THREADS)
+    #include <unistd.h>
+    #endif
+
+// Using the Agni namespace...
+using namespace Agni;
+
+// Exception a pool thread caught, by type...
+#define POOL_EXCEPTION_NONE         0
+#define POOL_EXCEPTION_EXECUTION    1
+#define POOL_EXCEPTION_STRING       2
+#define POOL_EXCEPTION_STATUS       3
+
+// Reset every worker and prepare the pool...
+void VirtualMachine::InitializeWorkers()
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Variables...
+    pthread_condattr_t  ConditionAttributes;
+    #endif
+
+    // Host's thread runs scripts serially, and each worker in parallel...
+    ResetWorker(MainWorker, THREADING_MODE_MULTIPLE);
+    for(uint32 unWorker = 0; unWorker < MAXIMUM_WORKERS; unWorker++)
+        ResetWorker(Workers[unWorker], THREADING_MODE_PARALLEL);
+
+    // Nothing is running in parallel yet...
+    unHeldScripts   = 0;
+    bParallel       = false;
+    StopWorkers     = 0;
+
+    #if defined(AGNI_WORKER_THREADS)
+    // Conditions are waited on until times read from the scheduler's clock...
+    pthread_condattr_init(&ConditionAttributes);
+    pthread_condattr_setclock(&ConditionAttributes, CLOCK_MONOTONIC);
+
+    // Locks and conditions...
+    pthread_mutex_init(&SchedulerLock, NULL);
+    pthread_cond_init(&SchedulerCondition, &ConditionAttributes);
+    pthread_mutex_init(&InternedStringLock, NULL);
+    pthread_mutex_init(&PoolLock, NULL);
+    pthread_cond_init(&PoolCondition, &ConditionAttributes);
+    pthread_condattr_destroy(&ConditionAttributes);
+
+    // No pool threads started until a run needs them...
+    unWorkerThreads         = 0;
+    unPoolGeneration        = 0;
+    unPoolWorkers           = 0;
+    unPoolWorkersRunning    = 0;
+    unPoolDuration          = 0;
+    bPoolShutdown           = false;
+    PoolExceptionType       = POOL_EXCEPTION_NONE;
+    PoolException           = SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW;
+    pszPoolException        = NULL;
+    PoolStatus              = Ok;
+    #endif
+}
+
+// Lock the string interning table, if running in parallel...
+void VirtualMachine::LockInternedStrings()
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Only workers running in parallel contend for it...
+    if(bParallel)
+        pthread_mutex_lock(&InternedStringLock);
+    #endif
+}
+
+// Lock the queues and pause heap, if running in parallel...
+void VirtualMachine::LockScheduler() const
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Only workers running in parallel change them meanwhile...
+    if(bParallel)
+        pthread_mutex_lock(&SchedulerLock);
+    #endif
+}
+
+// Reset a worker's scheduler state...
+void VirtualMachine::ResetWorker(AVM_Worker &Worker, uint8 ThreadingMode)
+{
+    // Running nothing yet, with the clock read every iteration until the rate
+    //  is known...
+    Worker.pMachine                         = this;
+    Worker.ThreadingMode                    = ThreadingMode;
+    Worker.hCurrentThread                   = (uint32) -1;
+    Worker.unCurrentThreadActivationTime    = 0;
+    Worker.bHolding                         = false;
+    Worker.unClockQuantum                   = 1;
+    Worker.unClockCountdown                 = 1;
+    Worker.unIterationsPerMilliSecond       = 0;
+    Worker.unClockWindowIterations          = 0;
+    Worker.unClockWindowStartTime           = 0;
+}
+
+// Run scripts for specified milliseconds, or 0 until all return, on a number
+//  of worker threads, or one per core...
+boolean VirtualMachine::RunScriptsInParallel(uint32 unDuration,
+                                             uint32 unWorkers)
+{
+#if defined(AGNI_WORKER_THREADS)
+
+    // Variables...
+    long    nProcessors = 0;
+    uint8   Type        = POOL_EXCEPTION_NONE;
+
+    // One per core, if not told how many...
+    if(unWorkers == AUTOMATIC_WORKERS)
+    {
+        nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        unWorkers   = (nProcessors > 0) ? (uint32) nProcessors : 1;
+    }
+
+    // No more than there can be...
+    if(unWorkers > MAXIMUM_WORKERS)
+        unWorkers = MAXIMUM_WORKERS;
+
+    // Start a pool thread for each worker after the host's without one...
+    while(unWorkerThreads + 1 < unWorkers)
+    {
+        // Start...
+        if(pthread_create(&WorkerThreads[unWorkerThreads], NULL,
+                          PoolThreadEntry, &Workers[unWorkerThreads + 1]) != 0)
+            break;
+
+        // Started...
+        unWorkerThreads++;
+    }
+
+        // Make do with those there are...
+        if(unWorkers > unWorkerThreads + 1)
+            unWorkers = unWorkerThreads + 1;
+
+    // Only the host's thread, so run serially...
+    if(unWorkers <= 1)
+        return RunScripts(unDuration);
+
+    // Start the run on the pool threads taking part...
+    pthread_mutex_lock(&PoolLock);
+    bParallel               = true;
+    StopWorkers             = 0;
+    unPoolDuration          = unDuration;
+    unPoolWorkers           = unWorkers - 1;
+    unPoolWorkersRunning    = unWorkers - 1;
+    unPoolGeneration++;
+    pthread_cond_broadcast(&PoolCondition);
+    pthread_mutex_unlock(&PoolLock);
+
+    // And on the host's, as the first worker...
+    try
+    {
+        RunWorker(Workers[0], unDuration);
+    }
+
+        // Stop the rest and pass it on once they have...
+        catch(...)
+        {
+            ReleaseWorkerScript(Workers[0]);
+            StopWorkerThreads();
+            WaitForPoolThreads();
+            throw;
+        }
+
+    // Wait for the rest to finish...
+    WaitForPoolThreads();
+
+    // Pass on whatever a pool thread caught first...
+    Type                = PoolExceptionType;
+    PoolExceptionType   = POOL_EXCEPTION_NONE;
+    switch(Type)
+    {
+        // Execution exception...
+        case POOL_EXCEPTION_EXECUTION:
+            throw PoolException;
+
+        // Error string...
+        case POOL_EXCEPTION_STRING:
+            throw pszPoolException;
+
+        // Status code...
+        case POOL_EXCEPTION_STATUS:
+            throw PoolStatus;
+    }
+
+    // Done...
+    return true;
+
+#else
+
+    // Threads are not supported on this platform, so run serially...
+    (void) unWorkers;
+    return RunScripts(unDuration);
+
+#endif
+}
+
+// Shut the pool down, joining its threads...
+void VirtualMachine::ShutdownWorkers()
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Wake every pool thread to exit...
+    pthread_mutex_lock(&PoolLock);
+    bPoolShutdown = true;
+    pthread_cond_broadcast(&PoolCondition);
+    pthread_mutex_unlock(&PoolLock);
+
+    // Join them...
+    for(uint32 unThread = 0; unThread < unWorkerThreads; unThread++)
+        pthread_join(WorkerThreads[unThread], NULL);
+    unWorkerThreads = 0;
+
+    // Locks and conditions...
+    pthread_cond_destroy(&PoolCondition);
+    pthread_mutex_destroy(&PoolLock);
+    pthread_mutex_destroy(&InternedStringLock);
+    pthread_cond_destroy(&SchedulerCondition);
+    pthread_mutex_destroy(&SchedulerLock);
+    #endif
+}
+
+// Unlock the string interning table, if running in parallel...
+void VirtualMachine::UnlockInternedStrings()
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Only workers running in parallel contend for it...
+    if(bParallel)
+        pthread_mutex_unlock(&InternedStringLock);
+    #endif
+}
+
+// Unlock the queues and pause heap, if running in parallel...
+void VirtualMachine::UnlockScheduler() const
+{
+    #if defined(AGNI_WORKER_THREADS)
+    // Only workers running in parallel change them meanwhile...
+    if(bParallel)
+        pthread_mutex_unlock(&SchedulerLock);
+    #endif
+}
+
+// Pool threads supported on this platform...
+#if defined(AGNI_WORKER_THREADS)
+
+// Pool thread's entry point, which runs its worker whenever a run it takes
+//  part in starts, until shut down...
+void *VirtualMachine::PoolThreadEntry(void *pWorker)
+{
+    // Variables...
+    AVM_Worker     &Worker          = *(AVM_Worker *) pWorker;
+    VirtualMachine &Machine         = *Worker.pMachine;
+    uint32          unIndex         = (uint32) (&Worker - Machine.Workers);
+    uint32          unGeneration    = 0;
+
+    // Serve runs...
+    pthread_mutex_lock(&Machine.PoolLock);
+    while(true)
+    {
+        // Wait for a run not yet seen, or to be shut down...
+        while(!Machine.bPoolShutdown &&
+              (unGeneration == Machine.unPoolGeneration ||
+               Machine.unPoolWorkersRunning == 0))
+            pthread_cond_wait(&Machine.PoolCondition, &Machine.PoolLock);
+
+        // Shut down...
+        if(Machine.bPoolShutdown)
+            break;
+
+        // Seen, but not taking part...
+        unGeneration = Machine.unPoolGeneration;
+        if(unIndex > Machine.unPoolWorkers)
+            continue;
+
+        // Run, catching anything to be passed on to the host's thread...
+        pthread_mutex_unlock(&Machine.PoolLock);
+        try
+        {
+            Machine.RunWorker(Worker, Machine.unPoolDuration);
+        }
+
+            // Execution exception...
+            catch(SCRIPT_EXECUTION_EXCEPTION Exception)
+            {
+                Machine.ReleaseWorkerScript(Worker);
+                Machine.RecordPoolException(POOL_EXCEPTION_EXECUTION,
+                                            Exception, NULL, Ok);
+            }
+
+            // Error string...
+            catch(const char *pszException)
+            {
+                Machine.ReleaseWorkerScript(Worker);
+                Machine.RecordPoolException(
+                    POOL_EXCEPTION_STRING,
+                    SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW, pszException,
+                    Ok);
+            }
+
+            // Status code...
+            catch(Status ExceptionStatus)
+            {
+                Machine.ReleaseWorkerScript(Worker);
+                Machine.RecordPoolException(
+                    POOL_EXCEPTION_STATUS,
+                    SCRIPT_EXECUTION_EXCEPTION_STACK_UNDERFLOW, NULL,
+                    ExceptionStatus);
+            }
+
+        // Finished, so let the host's thread know if it was the last...
+        pthread_mutex_lock(&Machine.PoolLock);
+        if(--Machine.unPoolWorkersRunning == 0)
+            pthread_cond_broadcast(&Machine.PoolCondition);
+    }
+    pthread_mutex_unlock(&Machine.PoolLock);
+
+    // Done...
+    return NULL;
+}
+
+// Record the first exception a pool thread caught, and ask every worker to
+//  stop...
+void VirtualMachine::RecordPoolException(uint8 Type,
+                                         SCRIPT_EXECUTION_EXCEPTION Exception,
+                                         const char *pszException,
+                                         Status ExceptionStatus)
+{
+    // Record, unless another was first...
+    pthread_mutex_lock(&PoolLock);
+    if(PoolExceptionType == POOL_EXCEPTION_NONE)
+    {
+        PoolExceptionType   = Type;
+        PoolException       = Exception;
+        pszPoolException    = pszException;
+        PoolStatus          = ExceptionStatus;
+    }
+    pthread_mutex_unlock(&PoolLock);
+
+    // Stop...
+    StopWorkerThreads();
+}
+
+// Hand back the script a worker holds, if any...
+void VirtualMachine::ReleaseWorkerScript(AVM_Worker &Worker)
+{
+    // Nothing held...
+    if(!Worker.bHolding)
+        return;
+
+    // Queue it where its state now says it belongs, and let any worker
+    //  waiting for one know...
+    pthread_mutex_lock(&SchedulerLock);
+    Scripts[Worker.hCurrentThread].bHeld = false;
+    Worker.bHolding = false;
+    unHeldScripts--;
+    ScheduleScript(Worker.hCurrentThread);
+    pthread_cond_broadcast(&SchedulerCondition);
+    pthread_mutex_unlock(&SchedulerLock);
+}
+
+// Ask every worker to stop...
+void VirtualMachine::StopWorkerThreads()
+{
+    // Raise the flag each checks as it runs...
+    AGNI_ATOMIC_COMPARE_AND_SWAP(&StopWorkers, 0, 1);
+
+    // And wake those waiting for a script to become runnable...
+    pthread_mutex_lock(&SchedulerLock);
+    pthread_cond_broadcast(&SchedulerCondition);
+    pthread_mutex_unlock(&SchedulerLock);
+}
+
+// Hand back the script a worker holds, if any, and hold the next runnable one,
+//  waiting until there is one unless the main timeslice that started at a time
+//  in milliseconds and lasts a duration ends first, then read the clock and
+//  return true if the worker is to stop...
+bool VirtualMachine::SwitchWorkerScript(AVM_Worker &Worker,
+                                        uint32 unMainTimeSliceStartTime,
+                                        uint32 unDuration,
+                                        uint32 &unCurrentTime)
+{
+    // Variables...
+    unsigned long long  CurrentTime         = 0;
+    unsigned long long  WakeTime            = 0;
+    unsigned long long  MainTimeSliceEnd    = 0;
+    bool                bWakeTime           = false;
+    bool                bWaited             = false;
+    bool                bStop               = false;
+    struct timespec     WakeSpecification;
+
+    // Only one worker schedules at a time...
+    pthread_mutex_lock(&SchedulerLock);
+
+    // Hand back the current thread, queued where its state says it belongs,
+    //  and let any worker waiting for one know...
+    if(Worker.bHolding)
+    {
+        Scripts[Worker.hCurrentThread].bHeld = false;
+        Worker.bHolding = false;
+        unHeldScripts--;
+        ScheduleScript(Worker.hCurrentThread);
+        pthread_cond_broadcast(&SchedulerCondition);
+    }
+
+    // Find the next runnable thread...
+    while(true)
+    {
+        // Another worker asked the rest to stop...
+        if(AGNI_ATOMIC_LOAD(&StopWorkers))
+        {
+            bStop = true;
+            break;
+        }
+
+        // Paused threads whose time is up can take their turns...
+        CurrentTime = GetSystemMicroSeconds();
+        if(unPausedScripts > 0)
+            WakePausedScripts(CurrentTime);
+
+        // Hold the one whose turn it is, out of the run queue so no other
+        //  worker runs it meanwhile...
+        if(RunQueue.unSize > 0)
+        {
+            Worker.hCurrentThread = RunQueue.hHead;
+            UnlinkScript(Worker.hCurrentThread);
+            Scripts[Worker.hCurrentThread].bHeld = true;
+            Worker.bHolding = true;
+            unHeldScripts++;
+            break;
+        }
+
+        // If all threads have terminated, then execution needn't continue on
+        //  any worker...
+        if(unPausedScripts == 0 && unHeldScripts == 0)
+        {
+            pthread_cond_broadcast(&SchedulerCondition);
+            bStop = true;
+            break;
+        }
+
+        // Otherwise wait for another worker to hand one back, or the first
+        //  paused thread to be due...
+        bWakeTime = (unPausedScripts > 0);
+        if(bWakeTime)
+            WakeTime = Scripts[PauseHeap[0]].PauseEndTime;
+
+        // ...unless the main timeslice ends first, if we are not running
+        //  indefinetely...
+        if(unDuration != (unsigned) THREAD_PRIORITY_INFINITE)
+        {
+            // Check if main timeslice has expired...
+            unCurrentTime = (uint32) (CurrentTime / 1000);
+            if(unCurrentTime > (unMainTimeSliceStartTime + unDuration))
+            {
+                bStop = true;
+                break;
+            }
+
+            // Wake no later than just after it does...
+            MainTimeSliceEnd = CurrentTime + (unsigned long long)
+                (unMainTimeSliceStartTime + unDuration - unCurrentTime + 1) *
+                1000;
+            if(!bWakeTime || MainTimeSliceEnd < WakeTime)
+                WakeTime = MainTimeSliceEnd;
+            bWakeTime = true;
+        }
+
+        // Wait...
+        if(bWakeTime)
+        {
+            WakeSpecification.tv_sec    = (time_t) (WakeTime / 1000000);
+            WakeSpecification.tv_nsec   = (long) (WakeTime % 1000000) * 1000;
+            pthread_cond_timedwait(&SchedulerCondition, &SchedulerLock,
+                                   &WakeSpecification);
+        }
+        else
+            pthread_cond_wait(&SchedulerCondition, &SchedulerLock);
+        bWaited = true;
+    }
+    pthread_mutex_unlock(&SchedulerLock);
+
+    // Read the clock again, this thread taking over beginning now...
+    unCurrentTime                           = GetSystemMilliSeconds();
+    Worker.unCurrentThreadActivationTime    = unCurrentTime;
+
+    // Leave waiting out of the calibration...
+    if(bWaited)
+    {
+        Worker.unClockWindowIterations  = 0;
+        Worker.unClockWindowStartTime   = unCurrentTime;
+    }
+
+    // Done...
+    return bStop;
+}
+
+// Wait for every pool thread taking part in the current run to finish it...
+void VirtualMachine::WaitForPoolThreads()
+{
+    // Wait...
+    pthread_mutex_lock(&PoolLock);
+    while(unPoolWorkersRunning > 0)
+        pthread_cond_wait(&PoolCondition, &PoolLock);
+
+    // Scripts no longer run in parallel...
+    bParallel = false;
+    pthread_mutex_unlock(&PoolLock);
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+  Name:         VirtualMachineBenchmark.cpp
+  Author:       Kip Warner
+  Description:  Code to implement AgniBenchmark which times a script and
+                reports the memory it occupies, for comparing builds of the
+                virtual machine with different runtime value layouts. Link
+                against the build to measure...
+*/
+
+// Includes...
+#include <Agni.h>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+// Using the standard namespace...
+using namespace std;
+
+// Agni virtual machine instance...
+Agni::VirtualMachine    Machine((char *) "AgniBenchmark", 1, 1);
+
+// Entry point...
+int main(int nArguments, char *ppszArguments[])
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript         = 0;
+    const char                     *pszScriptPath   = "Benchmark.age";
+    int                             nRuns           = 10;
+    clock_t                         Start           = 0;
+    double                          dSeconds        = 0.0;
+
+    // Script and number of runs may be given on the command line...
+    if(nArguments > 1)
+        pszScriptPath = ppszArguments[1];
+    if(nArguments > 2)
+        nRuns = atoi(ppszArguments[2]);
+
+    // Report which layout this build uses...
+    #if defined(AGNI_COMPACT_VALUES)
+    cout << "] Runtime values packed into a single word..." << endl;
+    #else
+    cout << "] Runtime values as an operand type alongside an operand..."
+         << endl;
+    #endif
+
+    // Load the script...
+    cout << "] Loading \"" << pszScriptPath << "\"...";
+    if(Machine.LoadScript(pszScriptPath, hScript) != Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Time each run from the start...
+    Start = clock();
+    for(int nRun = 0; nRun < nRuns; nRun++)
+    {
+        // Run it to completion...
+        Machine.ResetScript(hScript);
+        Machine.StartScript(hScript);
+        Machine.RunScripts(Agni::THREAD_PRIORITY_INFINITE);
+    }
+    dSeconds = (double) (clock() - Start) / CLOCKS_PER_SEC;
+
+    // Report...
+    cout << "] " << nRuns << " runs in " << dSeconds << " seconds, "
+         << (dSeconds * 1000.0 / (nRuns ? nRuns : 1)) << " milliseconds each"
+         << endl;
+    cout << "] Script occupies " << Machine.GetMemoryUsed(hScript)
+         << " bytes, the virtual machine " << Machine.GetMemoryUsed()
+         << " bytes" << endl;
+
+    // Done...
+    Machine.UnloadScript(hScript);
+    return 0;
+}
@@ -8,14 +8,72 @@
 
 // Includes...
 #include <Agni.h>
+#include <cfloat>
+#include <climits>
+#include <cstdio>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 // Using the standard namespace...
 using namespace std;
 
+// Copies of a script the parallel test runs at once, and the workers it runs
+//  them on...
+#define PARALLEL_TEST_SCRIPTS   8
+#define PARALLEL_TEST_WORKERS   4
+
+// Milliseconds the wakeup test pauses a script for...
+#define WAKEUP_TEST_PAUSE       50
+
+// Engines the cross engine test runs a script under, each of which must
+//  leave the same behind...
+const Agni::VirtualMachine::DispatchEngine Engines[] =
+{
+    Agni::VirtualMachine::Dispatch_Switch,
+    Agni::VirtualMachine::Dispatch_Threaded,
+    Agni::VirtualMachine::Dispatch_Register,
+    #if defined(AGNI_NATIVE_CODE)
+    Agni::VirtualMachine::Dispatch_Native
+    #endif
+};
+#define ENGINE_COUNT    (sizeof(Engines) / sizeof(Engines[0]))
+
+// Integers and floats the formatting test has a script format, each of which
+//  must come out as the C library formats it...
+const int FormattedIntegers[] =
+{
+    0, 1, -1, 9, 10, -10, 99, 100, 12345, -12345, 1000000000, -1000000000,
+    INT_MAX, -INT_MAX, INT_MIN
+};
+const float FormattedFloats[] =
+{
+    0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -1.5f, 0.1f, 3.14159265f, 123456.789f,
+    16777216.0f, 16777217.0f, 1e10f, -1e10f, 1e38f, FLT_MAX, -FLT_MAX,
+    1e-6f, 1e-7f, 5e-7f, 4.9999e-7f, 5.0001e-7f, 1.5e-6f, 2.5e-6f,
+    0.9999995f, 0.99999949f, 1.0000005f, 999999.94f, 1e-30f, FLT_MIN,
+    -FLT_MIN, 1e-45f, -1e-45f, INFINITY, -INFINITY, NAN
+};
+
+// Functions in Overflow.age the overflow test calls, each of which must
+//  overflow the stack, none taking parameters since the host passes none...
+const char *OverflowingFunctions[] =
+{
+    "Recurse", "Flood", "Ping", "Descend"
+};
+
 // Agni virtual machine instance...
-Agni::VirtualMachine    Machine("AgniDriver", 1, 1);
+Agni::VirtualMachine    Machine((char *) "AgniDriver", 1, 1);
+
+// Engines.age, translated into C++ by the translator...
+extern const Agni::VirtualMachine::PrecompiledScript PrecompiledEngines;
+
+// Machine whose scripts are recording, which the cross engine test swaps...
+Agni::VirtualMachine   *pRecordingMachine = &Machine;
+
+// What each script has recorded, kept apart since scripts running in parallel
+//  may record at once...
+string                  Recorded[MAXIMUM_THREADS];
 
 // Print a string from a script...
 void PrintString(Agni::VirtualMachine::Script hScript)
@@ -36,12 +94,673 @@ void PrintString(Agni::VirtualMachine::Script hScript)
     Machine.ReturnVoidFromHost(hScript, 2);
 }
 
+// Record a string from a script...
+void RecordString(Agni::VirtualMachine::Script hScript)
+{
+    // Append it to the script's own record...
+    Recorded[hScript] += pRecordingMachine->GetParameterAsString(hScript, 0);
+    Recorded[hScript] += "\n";
+
+    // Cleanup stack...
+    pRecordingMachine->ReturnVoidFromHost(hScript, 1);
+}
+
+// Record a string from a script, marked as recorded by whatever replaced
+//  RecordString()...
+void RecordStringReplaced(Agni::VirtualMachine::Script hScript)
+{
+    // Mark it, then record it...
+    Recorded[hScript] += "replaced ";
+    RecordString(hScript);
+}
+
+// Have a script on the recording machine format an integer...
+void FormatInteger(Agni::VirtualMachine::Script hScript, int nValue)
+{
+    // Pass it in and call...
+    pRecordingMachine->PassIntegerParameter(hScript, nValue);
+    pRecordingMachine->CallFunction(hScript, (char *) "Format");
+}
+
+// Run a script under every engine on a machine of its own, then its
+//  translation, and check each recorded its globals and returned the same as
+//  the switch engine...
+bool TestEngines(const char *pszScriptPath,
+                 const Agni::VirtualMachine::PrecompiledScript &Precompiled)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    Agni::VirtualMachine::Status    LoadStatus  = Agni::VirtualMachine::Ok;
+    string                          Outcome[ENGINE_COUNT + 1];
+    bool                            bSame       = true;
+
+    // Run it under each engine, then precompiled...
+    for(unsigned int unEngine = 0; unEngine <= ENGINE_COUNT; unEngine++)
+    {
+        // Variables...
+        ostringstream                   Returned;
+        bool                            bOverflowed = false;
+        Agni::uint32                    unWakeup    = 0;
+        unsigned int                    unSlices    = 0;
+
+        // Create a machine running this engine, or whichever precompiled
+        //  scripts run regardless of, which scripts record with...
+        pRecordingMachine = new Agni::VirtualMachine(
+            (char *) "AgniDriver", 1, 1, (unEngine < ENGINE_COUNT) ?
+                Engines[unEngine] : Agni::VirtualMachine::Dispatch_Default);
+        pRecordingMachine->RegisterHostProvidedFunction(
+            (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION,
+            "RecordString", RecordString);
+
+        // Load the executable, or its translation...
+        if(unEngine < ENGINE_COUNT)
+            LoadStatus = pRecordingMachine->LoadScript(pszScriptPath, hScript);
+        else
+            LoadStatus = pRecordingMachine->LoadScript(Precompiled, hScript);
+        if(LoadStatus != Agni::VirtualMachine::Ok)
+        {
+            // Alert and abort...
+            cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+            delete pRecordingMachine;
+            pRecordingMachine = &Machine;
+            return false;
+        }
+
+        // Start it, with nothing recorded yet...
+        Recorded[hScript].clear();
+        pRecordingMachine->ResetScript(hScript);
+        pRecordingMachine->StartScript(hScript);
+
+        // Call a function from the host and note what it returned...
+        pRecordingMachine->PassIntegerParameter(hScript, 100);
+        pRecordingMachine->CallFunction(hScript, (char *) "SumTo");
+        Returned << "SumTo(100) returned "
+                 << pRecordingMachine->GetReturnValueAsInteger(hScript)
+                 << endl;
+
+        // Run Main() a millisecond at a time, as a host's event loop
+        //  would, recording its globals until it overflows its stack as it
+        //  ends by doing...
+        try
+        {
+            // Run...
+            while(pRecordingMachine->GetNextWakeup(unWakeup))
+            {
+                pRecordingMachine->RunScripts(1);
+                unSlices++;
+            }
+            bOverflowed = false;
+        }
+
+            // Overflowed, or so it should be...
+            catch(Agni::VirtualMachine::SCRIPT_EXECUTION_EXCEPTION Exception)
+            {
+                bOverflowed = (Exception == Agni::VirtualMachine::
+                                    SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW);
+            }
+        Outcome[unEngine] = Returned.str() + Recorded[hScript];
+
+        // Check against the switch engine's, and that it handed control
+        //  back at least while it paused...
+        if(Recorded[hScript].empty() || !bOverflowed || unSlices < 2 ||
+           Outcome[unEngine] != Outcome[0])
+        {
+            // Alert...
+            if(unEngine < ENGINE_COUNT)
+                cout << "engine " << Engines[unEngine] << " differed...";
+            else
+                cout << "precompiled differed...";
+            bSame = false;
+        }
+
+        // Done with it and its machine...
+        pRecordingMachine->UnloadScript(hScript);
+        delete pRecordingMachine;
+        pRecordingMachine = &Machine;
+    }
+
+    // Done...
+    return bSame;
+}
+
+// Run a script under every engine on a machine of its own, interning its
+//  strings or not, and check each recorded what was expected...
+bool TestRecords(const char *pszScriptPath, const string &Expected,
+                 bool bInternStrings = false)
+{
+    // Variables...
+    Agni::VirtualMachine::Script            hScript     = 0;
+    Agni::VirtualMachine::InternStatistics  Statistics;
+    bool                                    bSame       = true;
+
+    // Run it under each engine...
+    for(unsigned int unEngine = 0; unEngine < ENGINE_COUNT; unEngine++)
+    {
+        // Create a machine running this engine, which scripts record with...
+        pRecordingMachine = new Agni::VirtualMachine(
+            (char *) "AgniDriver", 1, 1, Engines[unEngine],
+            DEFAULT_QUICKEN_THRESHOLD, DEFAULT_OPTIMIZE_THRESHOLD,
+            bInternStrings);
+        pRecordingMachine->RegisterHostProvidedFunction(
+            (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION,
+            "RecordString", RecordString);
+
+        // Load...
+        if(pRecordingMachine->LoadScript(pszScriptPath, hScript) !=
+           Agni::VirtualMachine::Ok)
+        {
+            // Alert and abort...
+            cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+            delete pRecordingMachine;
+            pRecordingMachine = &Machine;
+            return false;
+        }
+
+        // Interning only if asked, and then its literals were looked up...
+        if(pRecordingMachine->GetInternStatistics(Statistics) !=
+               bInternStrings ||
+           (bInternStrings &&
+            (Statistics.unLookups == 0 || Statistics.unStrings == 0)))
+        {
+            // Alert...
+            cout << "engine " << Engines[unEngine] << " interned wrongly...";
+            bSame = false;
+        }
+
+        // Run Main() to completion, with nothing recorded yet...
+        Recorded[hScript].clear();
+        pRecordingMachine->ResetScript(hScript);
+        pRecordingMachine->StartScript(hScript);
+        pRecordingMachine->RunScripts(Agni::THREAD_PRIORITY_INFINITE);
+
+        // Check it recorded what was expected...
+        if(Recorded[hScript] != Expected)
+        {
+            // Alert...
+            cout << "engine " << Engines[unEngine] << " recorded \""
+                 << Recorded[hScript] << "\"...";
+            bSame = false;
+        }
+
+        // Done with it and its machine...
+        pRecordingMachine->UnloadScript(hScript);
+        delete pRecordingMachine;
+        pRecordingMachine = &Machine;
+    }
+
+    // Done...
+    return bSame;
+}
+
+// Have a script format each integer and float from the table into a string,
+//  then pass it as it is to the host to ask for as one, and check each comes
+//  out as the C library's "%d" and "%f" would...
+bool TestFormatting(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    char                            szExpected[MAXIMUM_COERCION_LENGTH + 2];
+    unsigned int                    unValue     = 0;
+    bool                            bSame       = true;
+
+    // Load and start it, which has no Main() to reset to...
+    if(Machine.LoadScript(pszScriptPath, hScript) != Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+        return false;
+    }
+    Machine.StartScript(hScript);
+
+    // Format each integer, then each float, by the script then the host...
+    for(unValue = 0; unValue < 2 * (sizeof(FormattedIntegers) / sizeof(int) +
+                                    sizeof(FormattedFloats) / sizeof(float));
+        unValue++)
+    {
+        // Variables...
+        unsigned int unEntry = unValue / 2;
+
+        // Pass it in and have it formatted, with nothing recorded yet...
+        Recorded[hScript].clear();
+        if(unEntry < sizeof(FormattedIntegers) / sizeof(int))
+        {
+            // Integer...
+            Machine.PassIntegerParameter(hScript, FormattedIntegers[unEntry]);
+            snprintf(szExpected, sizeof(szExpected), "=%d\n",
+                     FormattedIntegers[unEntry]);
+        }
+        else
+        {
+            // Float...
+            float fValue = FormattedFloats[
+                unEntry - sizeof(FormattedIntegers) / sizeof(int)];
+            Machine.PassFloatParameter(hScript, fValue);
+            snprintf(szExpected, sizeof(szExpected), "=%f\n",
+                     (double) fValue);
+        }
+        Machine.CallFunction(hScript, (unValue % 2) ? (char *) "Record"
+                                                    : (char *) "Format");
+
+        // Check it came out the same, without the = the host never adds...
+        if(Recorded[hScript] != szExpected + unValue % 2)
+        {
+            // Alert...
+            cout << "formatted \"" << Recorded[hScript] << "\" not \""
+                 << szExpected << "\"...";
+            bSame = false;
+        }
+    }
+
+    // Done with it...
+    Machine.UnloadScript(hScript);
+    return bSame;
+}
+
+// Have a script on a machine of its own record as its host function is
+//  registered, replaced, registered to it alone, and unregistered, and check
+//  each call went to whatever was registered at the time...
+bool TestRebinding(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    bool                            bSame       = true;
+
+    // Create a machine with nothing registered, which it records with...
+    pRecordingMachine = new Agni::VirtualMachine((char *) "AgniDriver", 1, 1);
+
+    // Load and start it...
+    if(pRecordingMachine->LoadScript(pszScriptPath, hScript) !=
+       Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+        delete pRecordingMachine;
+        pRecordingMachine = &Machine;
+        return false;
+    }
+    Recorded[hScript].clear();
+    pRecordingMachine->StartScript(hScript);
+
+    // Bound to the global one once it is registered...
+    pRecordingMachine->RegisterHostProvidedFunction(
+        (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION, "RecordString",
+        RecordString);
+    FormatInteger(hScript, 1);
+
+    // Then to whatever replaces it...
+    pRecordingMachine->RegisterHostProvidedFunction(
+        (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION, "RecordString",
+        RecordStringReplaced);
+    FormatInteger(hScript, 2);
+
+    // Preferring one registered to the script alone...
+    pRecordingMachine->RegisterHostProvidedFunction(
+        hScript, "RecordString", RecordString);
+    FormatInteger(hScript, 3);
+
+    // Until that is unregistered again...
+    pRecordingMachine->UnregisterHostProvidedFunction(hScript, "RecordString");
+    FormatInteger(hScript, 4);
+
+    // And back to the first once the replacement is unregistered and it is
+    //  registered again, which a script cannot call in between as nothing
+    //  would take its parameters off the stack...
+    pRecordingMachine->UnregisterHostProvidedFunction(
+        (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION, "RecordString");
+    pRecordingMachine->RegisterHostProvidedFunction(
+        (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION, "RecordString",
+        RecordString);
+    FormatInteger(hScript, 5);
+
+    // Check each went where it should have...
+    if(Recorded[hScript] != "=1\nreplaced =2\n=3\nreplaced =4\n=5\n")
+    {
+        // Alert...
+        cout << "recorded \"" << Recorded[hScript] << "\"...";
+        bSame = false;
+    }
+
+    // Done with it and its machine...
+    pRecordingMachine->UnloadScript(hScript);
+    delete pRecordingMachine;
+    pRecordingMachine = &Machine;
+    return bSame;
+}
+
+// Resolve a script's function, then check the handle calls it only while the
+//  script it was resolved against is loaded, not once another has been loaded
+//  in its place, and that neither resolves through a stale script handle...
+bool TestStaleHandles(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    Agni::VirtualMachine::Script    hUnloaded   = 0;
+    Agni::VirtualMachine::Function  hFunction   = INVALID_FUNCTION;
+    string                          First;
+    bool                            bSame       = true;
+
+    // Load and start it...
+    if(Machine.LoadScript(pszScriptPath, hScript) != Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+        return false;
+    }
+    Recorded[hScript].clear();
+    Machine.StartScript(hScript);
+
+    // Resolve, which only names it exports do...
+    hFunction = Machine.ResolveFunction(hScript, "Format");
+    if(hFunction == INVALID_FUNCTION ||
+       Machine.ResolveFunction(hScript, "Missing") != INVALID_FUNCTION)
+    {
+        // Alert...
+        cout << "resolved wrongly...";
+        bSame = false;
+    }
+
+    // Call through it, and through one it never handed out...
+    Machine.PassIntegerParameter(hScript, 1);
+    if(!Machine.CallFunction(hScript, hFunction) ||
+       Machine.CallFunction(hScript, hFunction | 0xFFFF) ||
+       Machine.CallFunctionSynchronously(hScript, hFunction | 0xFFFF))
+    {
+        // Alert...
+        cout << "called wrongly...";
+        bSame = false;
+    }
+
+    // Unload it, then nothing resolves or calls through its old handle...
+    First = Recorded[hScript];
+    hUnloaded = hScript;
+    Machine.UnloadScript(hScript);
+    if(Machine.ResolveFunction(hUnloaded, "Format") != INVALID_FUNCTION ||
+       Machine.CallFunction(hUnloaded, hFunction))
+    {
+        // Alert...
+        cout << "called through an unloaded script...";
+        bSame = false;
+    }
+
+    // Load it again, likely where it was, which the old function handle
+    //  must not call...
+    if(Machine.LoadScript(pszScriptPath, hScript) != Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "cannot load \"" << pszScriptPath << "\" again" << endl;
+        return false;
+    }
+    Recorded[hScript].clear();
+    Machine.StartScript(hScript);
+    if(Machine.CallFunction(hScript, hFunction) ||
+       Machine.CallFunctionSynchronously(hScript, hFunction))
+    {
+        // Alert...
+        cout << "called through a stale function handle...";
+        bSame = false;
+    }
+
+    // Though resolving it again does...
+    hFunction = Machine.ResolveFunction(hScript, "Format");
+    Machine.PassIntegerParameter(hScript, 2);
+    if(!Machine.CallFunction(hScript, hFunction))
+    {
+        // Alert...
+        cout << "could not call once resolved again...";
+        bSame = false;
+    }
+
+    // Check only the calls that should have were made...
+    if(First != "=1\n" || Recorded[hScript] != "=2\n")
+    {
+        // Alert...
+        cout << "recorded \"" << First << "\" then \""
+             << Recorded[hScript] << "\"...";
+        bSame = false;
+    }
+
+    // Done with it...
+    Machine.UnloadScript(hScript);
+    return bSame;
+}
+
+// Call each function that must overflow the stack under every engine, on a
+//  machine of its own each time, and check each raises a stack overflow rather
+//  than running off the end, whether its bounds are checked by each push or,
+//  with guarded stacks, by the guard pages...
+bool TestOverflow(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    bool                            bSame       = true;
+
+    // Call each under each engine...
+    for(unsigned int unFunction = 0;
+        unFunction < sizeof(OverflowingFunctions) / sizeof(const char *);
+        unFunction++)
+    {
+        for(unsigned int unEngine = 0; unEngine < ENGINE_COUNT; unEngine++)
+        {
+            // Variables...
+            bool    bOverflowed = false;
+
+            // Create a machine running this engine...
+            pRecordingMachine = new Agni::VirtualMachine(
+                (char *) "AgniDriver", 1, 1, Engines[unEngine]);
+
+            // Load and start it...
+            if(pRecordingMachine->LoadScript(pszScriptPath, hScript) !=
+               Agni::VirtualMachine::Ok)
+            {
+                // Alert and abort...
+                cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+                delete pRecordingMachine;
+                pRecordingMachine = &Machine;
+                return false;
+            }
+            pRecordingMachine->StartScript(hScript);
+
+            // Call it...
+            try
+            {
+                // Call...
+                pRecordingMachine->CallFunction(
+                    hScript, (char *) OverflowingFunctions[unFunction]);
+            }
+
+                // Overflowed, or so it should be...
+                catch(Agni::VirtualMachine::SCRIPT_EXECUTION_EXCEPTION
+                        Exception)
+                {
+                    bOverflowed = (Exception == Agni::VirtualMachine::
+                                    SCRIPT_EXECUTION_EXCEPTION_STACK_OVERFLOW);
+                }
+
+            // Check it did...
+            if(!bOverflowed)
+            {
+                // Alert...
+                cout << OverflowingFunctions[unFunction] << " under engine "
+                     << Engines[unEngine] << " did not overflow...";
+                bSame = false;
+            }
+
+            // Done with it and its machine...
+            pRecordingMachine->UnloadScript(hScript);
+            delete pRecordingMachine;
+            pRecordingMachine = &Machine;
+        }
+    }
+
+    // Done...
+    return bSame;
+}
+
+// Check when a machine says its scripts are next due to run, as a script is
+//  loaded, started, paused by the host, due again, and done...
+bool TestWakeup(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScript     = 0;
+    Agni::uint32                    unWakeup    = 0;
+    unsigned long long              Before      = 0;
+    unsigned long long              After       = 0;
+    bool                            bSame       = true;
+
+    // Create a machine with nothing loaded, which scripts record with...
+    pRecordingMachine = new Agni::VirtualMachine((char *) "AgniDriver", 1, 1);
+    pRecordingMachine->RegisterHostProvidedFunction(
+        (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION, "RecordString",
+        RecordString);
+
+    // Nothing is due while nothing is loaded...
+    if(pRecordingMachine->GetNextWakeup(unWakeup))
+    {
+        // Alert...
+        cout << "due with nothing loaded...";
+        bSame = false;
+    }
+
+    // Load...
+    if(pRecordingMachine->LoadScript(pszScriptPath, hScript) !=
+       Agni::VirtualMachine::Ok)
+    {
+        // Alert and abort...
+        cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+        delete pRecordingMachine;
+        pRecordingMachine = &Machine;
+        return false;
+    }
+
+    // Nor before it is started...
+    if(pRecordingMachine->GetNextWakeup(unWakeup))
+    {
+        // Alert...
+        cout << "due before starting...";
+        bSame = false;
+    }
+
+    // Due right away once it is...
+    pRecordingMachine->ResetScript(hScript);
+    pRecordingMachine->StartScript(hScript);
+    if(!pRecordingMachine->GetNextWakeup(unWakeup) || unWakeup != 0)
+    {
+        // Alert...
+        cout << "not due once started...";
+        bSame = false;
+    }
+
+    // Paused, it is due no later than the pause ends, and no sooner than
+    //  that less however long it took to ask...
+    Before = Agni::GetSystemMicroSeconds();
+    pRecordingMachine->PauseScript(hScript, WAKEUP_TEST_PAUSE);
+    if(!pRecordingMachine->GetNextWakeup(unWakeup))
+        unWakeup = 0;
+    After = Agni::GetSystemMicroSeconds();
+    if(unWakeup > WAKEUP_TEST_PAUSE * 1000 ||
+       unWakeup + (After - Before) < WAKEUP_TEST_PAUSE * 1000)
+    {
+        // Alert...
+        cout << "due in " << unWakeup << " microseconds after pausing...";
+        bSame = false;
+    }
+
+    // Due right away once the pause has passed...
+    Agni::SleepMicroSeconds(unWakeup);
+    if(!pRecordingMachine->GetNextWakeup(unWakeup) || unWakeup != 0)
+    {
+        // Alert...
+        cout << "not due once the pause passed...";
+        bSame = false;
+    }
+
+    // And never again once it has run to completion...
+    Recorded[hScript].clear();
+    pRecordingMachine->RunScripts(Agni::THREAD_PRIORITY_INFINITE);
+    if(pRecordingMachine->GetNextWakeup(unWakeup) || Recorded[hScript].empty())
+    {
+        // Alert...
+        cout << "due once done...";
+        bSame = false;
+    }
+
+    // Done with it and its machine...
+    pRecordingMachine->UnloadScript(hScript);
+    delete pRecordingMachine;
+    pRecordingMachine = &Machine;
+    return bSame;
+}
+
+// Run copies of a script one after another, then in parallel, and check each
+//  recorded the same both times...
+bool TestParallel(const char *pszScriptPath)
+{
+    // Variables...
+    Agni::VirtualMachine::Script    hScripts[PARALLEL_TEST_SCRIPTS];
+    string                          Serial[PARALLEL_TEST_SCRIPTS];
+    bool                            bSame   = true;
+
+    // Run them serially, then in parallel...
+    for(int nRun = 0; nRun < 2; nRun++)
+    {
+        // Load and start every copy, with nothing recorded yet...
+        for(int nScript = 0; nScript < PARALLEL_TEST_SCRIPTS; nScript++)
+        {
+            // Load...
+            if(Machine.LoadScript(pszScriptPath, hScripts[nScript]) !=
+               Agni::VirtualMachine::Ok)
+            {
+                // Alert and abort...
+                cout << "cannot load \"" << pszScriptPath << "\"" << endl;
+                return false;
+            }
+
+            // Start from Main()...
+            Recorded[hScripts[nScript]].clear();
+            Machine.ResetScript(hScripts[nScript]);
+            Machine.StartScript(hScripts[nScript]);
+        }
+
+        // Run them all to completion...
+        if(nRun == 0)
+            Machine.RunScripts(Agni::THREAD_PRIORITY_INFINITE);
+        else
+            Machine.RunScriptsInParallel(Agni::THREAD_PRIORITY_INFINITE,
+                                         PARALLEL_TEST_WORKERS);
+
+        // Compare what each recorded with the serial run, then unload it...
+        for(int nScript = 0; nScript < PARALLEL_TEST_SCRIPTS; nScript++)
+        {
+            // Remember the serial run's...
+            if(nRun == 0)
+                Serial[nScript] = Recorded[hScripts[nScript]];
+
+            // Or check the parallel run's against it...
+            else if(Serial[nScript].empty() ||
+                    Recorded[hScripts[nScript]] != Serial[nScript])
+            {
+                // Alert...
+                cout << "copy " << nScript << " recorded differently...";
+                bSame = false;
+            }
+
+            // Unload...
+            Machine.UnloadScript(hScripts[nScript]);
+        }
+    }
+
+    // Done...
+    return bSame;
+}
+
 // Entry point...
 int main(int nArguments, char *ppszArguments[])
 {
     // Variables...
     Agni::VirtualMachine::Script    hScript = 0;
     const char     *pszScriptPath = "Random.age";   
+    ostringstream   Built;
+    string          StringsExpected;
 
     // Greet user...
     cout << "] VirtualMachine initialized..." << endl;
@@ -162,7 +881,156 @@ int main(int nArguments, char *ppszArguments[])
 
     // Call PrintRandomNumbers asynchronously...
     cout << "] Calling PrintRandomNumbers..." << endl;
-    Machine.CallFunction(hScript, "PrintRandomNumbers");
+    Machine.CallFunction(hScript, (char *) "PrintRandomNumbers");
+
+    // Done with it...
+    Machine.UnloadScript(hScript);
+
+    // Register the host provided function scripts record with...
+    cout << "] Registering global host provided function...";
+    if(!Machine.RegisterHostProvidedFunction(
+            (Agni::VirtualMachine::Script) GLOBAL_HOST_FUNCTION,
+            "RecordString", RecordString))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Run a script under each engine, and translated, and check they all
+    //  agree...
+    cout << "] Running Engines.age under each dispatch engine and "
+            "precompiled...";
+    if(!TestEngines("Engines.age", PrecompiledEngines))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check strings stay as they were when another variable sharing them
+    //  is changed, grow past what fits inline, ignore characters set outside
+    //  them, and can be built up a piece at a time...
+    Built << "Built";
+    for(int nPiece = 0; nPiece < 200; nPiece++)
+        Built << " " << nPiece;
+    StringsExpected = "shared by two variables and concatenated\n"
+                      "Shared by two variables\n"
+                      "tiny\n"
+                      "Tiny\n"
+                      "Passed to a function changed\n"
+                      "passed to a function\n"
+                      "a\nab\nabc\nabcd\nabcde\nabcdef\nabcdefg\nabcdefgh\n"
+                      "abcdefghi\nabcdefghij\nabcdefghijk\n"
+                      "inlinE\n"
+                      "on the heaP\n" +
+                      Built.str() + "\n" +
+                      Built.str() + Built.str() + "\n" +
+                      Built.str() + "\n" +
+                      "built equals literal\n"
+                      "literal equals literal\n"
+                      "literal differs from shorter literal\n";
+    cout << "] Running Strings.age under each dispatch engine...";
+    if(!TestRecords("Strings.age", StringsExpected))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check they record the same with their strings interned...
+    cout << "] Running Strings.age again interning strings...";
+    if(!TestRecords("Strings.age", StringsExpected, true))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check numbers are formatted into strings as the C library would...
+    cout << "] Running Formatting.age against the C library...";
+    if(!TestFormatting("Formatting.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check host functions are bound to whatever is registered when called...
+    cout << "] Rebinding host functions as they are registered...";
+    if(!TestRebinding("Formatting.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check function handles are refused once their script is unloaded...
+    cout << "] Calling through stale handles...";
+    if(!TestStaleHandles("Formatting.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check recursing without end overflows the stack...
+    cout << "] Overflowing the stack under each dispatch engine...";
+    if(!TestOverflow("Overflow.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Check when scripts are said to be next due to run...
+    cout << "] Waking a paused script...";
+    if(!TestWakeup("Strings.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
+
+    // Run copies of a script on several worker threads at once and check
+    //  they record what they do when run one after another...
+    cout << "] Running Parallel.age serially and in parallel...";
+    if(!TestParallel("Parallel.age"))
+    {
+        // Alert and abort...
+        cout << "failed" << endl;
+        return 1;
+    }
+
+        // Done...
+        cout << "ok" << endl;
 
     /* Call TestStuff script function asynchronously...
     cout << "] Calling TestStuff() script side function asynchronously..." 